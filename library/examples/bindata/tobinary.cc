@@ -0,0 +1,48 @@
+// tobinary.cc
+//
+// Converts a text data file into the memory-mapped binary format
+// described in "bindata.h". The binary file can then be used in place
+// of the text file:
+//
+//   * A Touchstone file becomes an SDATA file, to be loaded using
+//     S_interp::binary() or sdata_interp::binary() rather than
+//     touchstone(). The matrices are stored as S matrices normalized
+//     to device::Z0 (50 Ohms), including any noise data.
+//
+//   * A column data file (such as an SIS DC IV curve or its Kramers-
+//     Kronig transform) becomes a TABLE file. class datafile reads it
+//     automatically, so the binary file names may be given directly to
+//     class ivcurve, for example. class bindata_table uses the mapped
+//     file data in place, without copying it.
+//
+// Usage:
+//   tobinary -t <ports> <touchstone file> <output file>
+//   tobinary -d <data file> <output file>
+//
+// ---------------------------------------------------------------------------
+
+#include "supermix.h"
+#include <cstdlib>
+#include <cstring>
+
+void prompt(const char * name)
+{
+  cerr << "Usage:" << endl
+       << "  " << name << " -t <ports> <touchstone file> <output file>" << endl
+       << "  " << name << " -d <data file> <output file>" << endl;
+  exit(1);
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc == 5 && strcmp(argv[1], "-t") == 0) {
+    int ports = atoi(argv[2]);
+    if (ports < 1) prompt(argv[0]);
+    return touchstone_to_bindata(argv[3], argv[4], ports) ? 0 : 1;
+  }
+  else if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    return datafile_to_bindata(argv[2], argv[3]) ? 0 : 1;
+  }
+  else
+    prompt(argv[0]);
+}
@@ -26,6 +26,10 @@
 // using a piecewise-linear interpolation between points for the
 // integrand.
 //
+// Class ivcurve can now calculate the transform itself, if it is given
+// only the DC IV data (see supermix/include/junction.h); this program
+// remains useful for generating Ikk files to be used with other programs.
+//
 // An input file name must be included on the command line. Type the
 // program name with no arguments to get a usage prompt.
 //
@@ -33,7 +33,7 @@ SINCLUDE = include
 SUPERMIXINCLUDE = $(SUPERMIXDIR)/$(SINCLUDE)
 
 # Include compiler flags here that you always want to use 
-CFLAGS = $(FLAGS) -Wall -I$(SUPERMIXINCLUDE)
+CFLAGS = $(FLAGS) -Wall -pthread -I$(SUPERMIXINCLUDE)
 
 # clear out default implicit rule searches
 .SUFFIXES:
@@ -50,8 +50,16 @@
 // Ascalesub(cD, cS, cF, L)  subtract elemnts of S, each multiplied by
 // Ascalesub(dD, dS, dF, L)  F first, from elements of D (S unmodified)
 //
+// Aaxpy(cD, cS, cF, L)      add elements of S, each multiplied by F,
+//                           to elements of D
+//
+// Amul(cD, cS, L)           multiply elements of D by elements of S
+// Adiv(cD, cS, L)           divide elements of D by elements of S
+//
 // c Adot(cS1, cS2, L)       return dot product of S1 and S2: <S1|S2>
 // d Adot(dS1, dS2, L)
+// c Adotu(cS1, cS2, L)      return sum of products of S1 and S2, without
+//                           conjugating S1
 //
 // Aapply(cD, Func, L)       replace each element e of D with the result
 // Aapply(dD, Func, L)       F(e).  F is called L times.
@@ -63,6 +71,22 @@
 // Additionally Func may accept types <type>& and const <type>&, where
 // type is Complex or double, as appropriate.
 //
+// SIMD kernels:
+//  The Complex versions of Aadd, Asub, Amul, Adiv, Ascale(cD, cF, L),
+//  Ascalesub, Aaxpy, Adot and Adotu use the widest SIMD instructions the
+//  processor supports (AVX-512, AVX2 or SSE2, on x86 processors), chosen
+//  at run time. All but Adot and Adotu give exactly the results of the
+//  scalar Complex operators. Dot products of Adot_simd_min or more
+//  elements sum in a different order, so may differ in the last bits;
+//  shorter ones use the scalar loop, summing from the last element down.
+//
+// Asimd()                   return the name of the kernel set in use:
+//                           "avx512", "avx2", "sse2" or "scalar"
+// Asimd(name)               use the named kernel set instead, returning
+//                           1, or 0 (and no change) if the processor
+//                           doesn't support it. Not to be called while
+//                           other threads may be using the routines.
+//
 // ********************************************************************
 
 #ifndef A_MATH_H
@@ -104,7 +128,13 @@ void Asub( Complex *dest, const double *source, int len );
 void Ascalesub( Complex *dest, const Complex *source, Complex scale, int len );
 void Ascalesub( double *dest, const double *source, double scale, int len );
 
+void Aaxpy( Complex *dest, const Complex *source, Complex scale, int len );
+
+void Amul( Complex *dest, const Complex *source, int len );
+void Adiv( Complex *dest, const Complex *source, int len );
+
 Complex Adot( const Complex *a1, const Complex *a2, int len );
+Complex Adotu( const Complex *a1, const Complex *a2, int len );
 // inline Complex Adot( Complex *a1, Complex *a2, int len )
 // { return Adot( (const Complex *)a1, (const Complex *)a2, len); }
 double Adot( const double *a1, const double *a2, int len );
@@ -118,4 +148,10 @@ void Aapply( double a[], double (* f)(double), int len);
 void Aapply( double a[], double (* f)(double &), int len);
 void Aapply( double a[], double (* f)(const double &), int len);
 
+const char * Asimd();
+int Asimd( const char * name );
+
+// the shortest dot product given to the SIMD kernels
+const int Adot_simd_min = 16;
+
 #endif /* A_MATH_H */
@@ -0,0 +1,195 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ************************************************************************
+// adaptive_sweeper.h
+//
+// class adaptive_sweeper: a sweeper which chooses its own points
+// class sweep_monitor:    a quantity used to choose the points
+// class s_monitor:        |S(out,in)| of an nport
+// class tn_monitor:       noise temperature of an nport
+//
+// ************************************************************************
+// Using the adaptive_sweeper class:
+//
+// A sweeper (see sweeper.h) steps through a fixed grid of values, so a
+// frequency sweep must use a step small enough for the narrowest feature in
+// the response, and then oversamples all the smooth parts. An
+// adaptive_sweeper sweeps a single parameter over a range, choosing the
+// points as it goes from the values of one or more monitored quantities
+// at the points it has already visited, in the manner of adaptive<> (see
+// adaptive.h): it adds points where linear interpolation of a quantity
+// between its neighbours would be in error by more than a tolerance.
+//
+//   circuit amp;
+//   s_monitor gain(amp, 1, 2);           // watch |S21|
+//   tn_monitor noise(amp, 1, 2);         // and the noise temperature
+//   adaptive_sweeper band;
+//   band.sweep(device::f, 4*GHz, 8*GHz);
+//   band.monitor(gain, 0.002).monitor(noise, 0.0, 0.01);
+//
+// monitor(m, abs_tol, rel_tol) gives the tolerance for m as abs_tol +
+// rel_tol * (the largest magnitude of m seen so far in the sweep). The
+// sweep begins with an evenly spaced grid (9 points by default; see
+// sweep()), then repeatedly divides in two the interval with the largest
+// estimated error relative to the tolerances, until all of them are within
+// tolerance, or an interval would be narrower than min_step(), or
+// point_limit() points have been visited. A feature narrower than the
+// spacing of the starting grid may be missed entirely, just as it would by
+// a coarse sweeper, so the starting grid must resolve the response at
+// least roughly.
+//
+// An adaptive_sweeper is used just like a sweeper, either in a loop:
+//
+//   for(band.reset(); !band.finished(); band++) { your calculation here }
+//
+// or with an error_func, which passes along the state_tag of its own
+// calculations at each point so that the monitors needn't recalculate the
+// circuit (see the notes on measure() in sweeper.h). Since the points are
+// not evenly spaced, error_func averages its terms over an
+// adaptive_sweeper using the trapezoid rule weights given by weight(),
+// so that the result approximates the mean of each term over the range;
+// see the notes on add_term() in error_func.h.
+//
+// Parameters which must be held at fixed values during the sweep are set
+// with initialize(), as for a sweeper; sweep() only accepts the one
+// parameter and range.
+//
+// ************************************************************************
+
+#ifndef ADAPTIVE_SWEEPER_H
+#define ADAPTIVE_SWEEPER_H
+
+#include "sweeper.h"
+#include "nport.h"
+#include <vector>
+
+
+// ************************************************************************
+// A quantity calculated at each point of an adaptive sweep. Derive from
+// this class and define get() to monitor some other quantity; get() should
+// pass on its state_tag to the nports it uses.
+
+class sweep_monitor
+{
+public:
+  virtual double get(state_tag) = 0;
+  virtual ~sweep_monitor() { }
+};
+
+
+// The magnitude of S(out, in) of an nport.
+class s_monitor : public sweep_monitor
+{
+public:
+  s_monitor(nport & ckt, int input = 1, int output = 2)
+    : np(&ckt), in_port(input), out_port(output) { }
+  double get(state_tag tag) { return abs(np->get_data(tag).S.read(out_port, in_port)); }
+private:
+  nport *np;
+  int in_port, out_port;
+};
+
+
+// The input noise temperature of an nport, for a signal at port in and
+// output at port out (see sdata::tn()).
+class tn_monitor : public sweep_monitor
+{
+public:
+  tn_monitor(nport & ckt, int input = 1, int output = 2)
+    : np(&ckt), in_port(input), out_port(output) { }
+  double get(state_tag tag) { return np->get_data(tag).tn(out_port, in_port); }
+private:
+  nport *np;
+  int in_port, out_port;
+};
+
+
+// ************************************************************************
+class adaptive_sweeper : public sweeper
+{
+public:
+
+  adaptive_sweeper();
+
+  // Sweep rp from start to stop, beginning with an evenly spaced grid of
+  // initial points (at least 2, unless start == stop).
+  void sweep(real_parameter &rp, double start, double stop, int initial = 9);
+
+  // Include a scale factor (units) for the range
+  void sweep(real_parameter &rp, double start, double stop, int initial,
+	     double units)
+    { sweep(rp, start*units, stop*units, initial); }
+
+  // Add a monitored quantity, with its tolerances. The monitor must exist
+  // as long as the sweeper uses it.
+  adaptive_sweeper & monitor(sweep_monitor & m, double abs_tol, double rel_tol = 0.0);
+
+  // The largest number of points in a sweep (default 200)
+  adaptive_sweeper & point_limit(int n);
+  int point_limit() const { return max_n; }
+
+  // No interval is divided if the halves would be narrower than h
+  // (default: a millionth of the range)
+  adaptive_sweeper & min_step(double h) { min_h = h; return *this; }
+  double min_step() const { return min_h; }
+
+  // The number of points visited since reset(); once the sweep is
+  // finished, this is the number of points in the sweep.
+  int npoints() { return visited; }
+
+  void reset();
+  adaptive_sweeper & operator ++(int);
+  adaptive_sweeper & operator ++() { return (*this)++; }
+  bool finished() { return done; }
+
+  // Calculate the monitors at the current point, using the state_tag.
+  // If measure() isn't called, then ++ calls it with a new state_tag.
+  void measure(state_tag);
+
+  // The trapezoid rule weights of the points, in the order visited. They
+  // are only available once the sweep is finished.
+  bool weighted() const { return true; }
+  double weight(int k) const;
+
+  // The value of the swept parameter at the k'th point visited.
+  double point(int k) const;
+
+private:
+
+  struct watched {
+    sweep_monitor *m;
+    double abs_tol, rel_tol;
+  };
+
+  real_parameter *rpr;             // the swept parameter
+  double startv, stopv;            // its range
+  int initial;                     // the number of points in the starting grid
+  int max_n;                       // point_limit()
+  double min_h;                    // min_step()
+  std::vector<watched> monitors;
+
+  // The points visited so far, sorted by value
+  std::vector<double> xs;                  // the values of the parameter
+  std::vector<int> order;                  // the order they were visited
+  std::vector< std::vector<double> > ys;   // the monitors' results
+  std::vector<double> weights;             // by order, when finished
+
+  int visited;                     // the number of points so far
+  double current;                  // the current value of the parameter
+  bool measured;                   // the current point has been measured
+  bool done;
+
+  // set the parameter and any initialized parameters to x
+  void go(double x);
+
+  // choose the next point, returning false if there is none
+  bool next(double & x) const;
+
+  // the estimated error of interval j relative to the tolerances
+  double interval_error(int j, const std::vector<double> & tol) const;
+
+  void set_weights();
+};
+
+#endif /* ADAPTIVE_SWEEPER_H */
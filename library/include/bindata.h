@@ -0,0 +1,182 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ********************************************************************
+// bindata.h
+//
+// Classes and functions to write and read a binary, memory-mapped form
+// of the numerical data SuperMix usually reads from text files: the
+// columns of a datafile (such as an SIS I-V curve), and the S and noise
+// correlation matrices of a Touchstone file.
+//
+// Converting a large text file once with one of the bindata_write()
+// functions below lets later programs load it with no parsing at all:
+// the file is mapped into memory and its numbers are used in place,
+// aliased by real_matrix and complex_matrix objects (see table.h).
+//
+// File format (version 1):
+//
+// All values are in the native byte order and floating point format of
+// the machine which wrote the file; a marker in the header lets a
+// reader detect (and refuse) a file written with another byte order.
+//
+//   header (64 bytes):
+//     char     magic[8]     "SMixBin" followed by a '\0'
+//     uint32   version      format version (currently 1)
+//     uint32   byte order   0x01020304, as written by the writer
+//     uint32   kind         bindata_file::TABLE or bindata_file::SDATA
+//     uint32   columns      the number of column descriptors to follow
+//     uint32   ports        number of ports for SDATA, 0 for TABLE
+//     uint32   flags        reserved, 0
+//     double   znorm        S and C matrix normalization (SDATA only)
+//     uint64   length       total length of the file, in bytes
+//     (16 bytes reserved, 0)
+//
+//   column descriptors (64 bytes each):
+//     char     name[16]     column name, '\0' terminated
+//     uint32   type         bindata_file::REAL or bindata_file::COMPLEX
+//     uint32   (reserved, 0)
+//     uint64   rows         the number of records in the column
+//     uint64   width        values per record (1, or N*N for matrices)
+//     uint64   offset       byte offset of the column's data in the file
+//     (16 bytes reserved, 0)
+//
+//   column data: rows*width doubles (REAL) or Complex values (COMPLEX)
+//     for each column, each column a single contiguous block.
+//
+// A TABLE file holds the columns of a datafile, named "1", "2", etc.,
+// stored one after the other so the whole set can be aliased by a single
+// real_table indexed just like datafile::table(): (column, line).
+//
+// An SDATA file holds column "f" (frequencies, in SuperMix units) and
+// column "S" (one ports*ports S matrix per frequency, row by row,
+// normalized to znorm). If noise data is present, columns "fC" and "C"
+// similarly hold the noise correlation matrices.
+// ********************************************************************
+
+#ifndef BINDATA_H
+#define BINDATA_H
+
+#include "table.h"
+#include "units.h"
+
+class datafile;
+class S_interp;
+
+// ********************************************************************
+// class bindata_file: a read-only memory map of a bindata format file.
+//
+// The mapping is private, so any changes made to the data through a
+// matrix which aliases it are not written back to the file. The memory
+// is unmapped when the bindata_file is destroyed; any matrix objects
+// aliasing the data must not be used after that.
+
+class bindata_file
+{
+public:
+
+  enum { VERSION = 1 };                  // the format version written
+  enum kinds { TABLE = 1, SDATA = 2 };   // values of kind()
+  enum types { REAL = 1, COMPLEX = 2 };  // values of type()
+
+  // Map the named file into memory. Warns and leaves good() false if the
+  // file can't be opened or isn't a proper bindata file.
+  explicit bindata_file(const char * name);
+
+  ~bindata_file();
+
+  // Returns true if the file was successfully mapped.
+  bool good() const { return base != 0; }
+
+  // Return true if the named file starts with the bindata magic string.
+  // A quick test which does not check the rest of the file.
+  static bool is_bindata(const char * name);
+
+  // ----------------
+  // header information:
+
+  int version() const;
+  int kind() const;
+  int ports() const;      // number of ports (SDATA)
+  double znorm() const;   // matrix normalization impedance (SDATA)
+
+  // ----------------
+  // column information, for columns i = 1 .. columns():
+
+  int columns() const;
+  int column(const char * name) const;  // index of named column (0 if none)
+  const char * name(int i) const;
+  int type(int i) const;
+  unsigned long rows(int i) const;
+  unsigned long width(int i) const;
+
+  // pointers to the start of a column's data in the mapped memory; 0 if
+  // i is not a column of the requested type.
+  double * real_data(int i) const;
+  Complex * complex_data(int i) const;
+
+private:
+  char * base;            // start of the mapped file, 0 if not mapped
+  unsigned long length;   // length of the mapping, in bytes
+
+  bool check(const char * name);  // validate header and descriptors
+
+  bindata_file(const bindata_file &);      // no copy constructor!
+  void operator = (const bindata_file &);  // no assignment operator!
+};
+
+
+// ********************************************************************
+// class bindata_table: the columns of a TABLE bindata file, used in
+// place through a real_table alias of the mapped data. The interface
+// matches that of class datafile.
+
+class bindata_table
+{
+public:
+
+  // Map the named file. If it isn't a TABLE file, warns and the
+  // table is left empty.
+  explicit bindata_table(const char * name);
+
+  // Data retrieval, in the same order as datafile: (column#, line#)
+  double read(int col, int line) const
+    { return data.read(col, line); }
+
+  int numcolumns() const { return ncolumns; }
+  int numlines() const { return nlines; }
+
+  // The table, aliasing the mapped data (so valid only as long as this
+  // object exists).
+  const real_table * table() const { return & data; }
+
+private:
+  bindata_file file;
+  int ncolumns, nlines;
+  real_table data;
+
+  int check();  // used by the constructor; returns ncolumns
+};
+
+
+// ********************************************************************
+// Converters: write the data in text files into bindata files. Each
+// returns false (with a warning) if the data could not be written.
+
+// write the columns of a datafile as a TABLE file
+bool bindata_write(const char * name, const datafile & D);
+
+// write the S (and C, if any) interpolation points of an S_interp as
+// an SDATA file; the S_interp must have been built.
+bool bindata_write(const char * name, const S_interp & S);
+
+// read a text datafile and convert it to a TABLE file
+bool datafile_to_bindata(const char * text, const char * name);
+
+// read a Touchstone file and convert it to an SDATA file. The arguments
+// ports and f_scale are as for touchstone_read::open(). The matrices are
+// normalized to device::Z0.
+bool touchstone_to_bindata(const char * text, const char * name,
+			   int ports = 2, double f_scale = GHz);
+
+#endif /* BINDATA_H */
@@ -21,6 +21,7 @@
 #include "connection.h"
 #include "parameter.h"
 #include <stack>
+#include <vector>
 
 // **************************************************************************
 
@@ -49,7 +50,7 @@ private:
   portVector labels;
 
   /**
-   * Build the connection tree.
+   * Build the connection tree (or the sparse network, if method() is SPARSE).
    * Uses lists to create temporary class connection devices.  Since each
    * instance of class connection holds pointers to the devices it is
    * to connect, the connections form a tree.  The tips of the branches
@@ -58,12 +59,17 @@ private:
    */
   void build_tree();
 
+  /** Build the tree of connections; called by build_tree() if method()
+   *  is CONNECTIONS, or by calc() if the sparse network can't be used. */
+  void build_connections();
+
   /**
    * Base of the tree of connections.  Calling tree_base->get_data() causes
    * all of the connections to be computed by recursively calling get_data
    * up all of the branches.
    * Remember that data returned by tree_base->get_data() is not necessarily
    * in the proper order desired by the user.
+   * If method() is SPARSE, this is 0 until the tree is needed.
    */
   nport *tree_base;
 
@@ -75,6 +81,11 @@ private:
 
   /** Keep a stack of connection class instances to be freed by destructor. */
   std::stack <connection *> del_stack;
+  /** The sparse system used instead of the tree if method() is SPARSE. */
+  struct network;
+  network *net;
+  /** Build net, instead of the tree; called by build_tree(). */
+  void build_network();
 
   /**
    * Calculate this circuit's data by performing all connections, etc.
@@ -86,6 +97,9 @@ private:
   void recalc()   { calc(true); }
   void recalc_S() { calc(false); }
 
+  /** Calculate a batch of frequencies, passing it through the tree. */
+  void recalc_batch(sdata_batch &, bool);
+
 public:
 
   /**
@@ -161,6 +175,39 @@ public:
    * @param c the circuit to be copied
    */
   circuit & operator =(const circuit & c);
+  /**
+   * The method used to calculate the circuit:
+   *
+   * CONNECTIONS (the default) joins the devices one connection at a time,
+   * using class connection. The cost depends on the order in which the
+   * connections were made, and grows quickly with the number of ports
+   * left unconnected in the intermediate results.
+   *
+   * SPARSE solves for the waves leaving every device port at once. With b
+   * the outgoing waves and S, B the block-diagonal S matrix and source
+   * vector of all the devices, the connections give the system
+   * (I - S P) b = S a + B, where P exchanges the waves of each connected
+   * pair of ports and a holds the waves entering the circuit's ports.
+   * This matrix has an entry only where two ports share a device or a
+   * connection, like a nodal admittance matrix; it is factored with
+   * class sparse_lu, whose ordering and fill pattern are found once and
+   * reused at every frequency. The noise correlation matrix is found from
+   * the same factors. Working with S rather than Y keeps devices which
+   * have no admittance matrix (branches, ideal transformers, etc.).
+   * SPARSE is usually faster for circuits with many devices.
+   *
+   * The sparse factors take their pivots in a fixed order. If one is too
+   * small for an accurate result (see class sparse_lu), which can happen
+   * with active devices, that point is calculated using CONNECTIONS
+   * instead, with a warning the first time. So the methods differ only in
+   * rounding errors.
+   */
+  enum solve_method { CONNECTIONS = 0, SPARSE = 1 };
+  circuit & method(solve_method m)
+  { if(m != how) { how = m; tree_is_built = false; } return *this; }
+  solve_method method() const { return how; }
+private:
+  solve_method how;
 };
 
 // **************************************************************************
@@ -180,6 +227,12 @@ public:
  * adding a 1-port at any time makes the cascade a 1-port and
  * no further devices may be added.  At creation, cascade
  * behaves as a 2-port branch.
+ *
+ * A cascade doesn't use the general circuit code: the devices are
+ * combined one at a time, from the first added to the last, using
+ * closed-form expressions for joining two 2-ports (or a 2-port and
+ * a 1-port). The noise correlation matrix and source vector are
+ * carried along in the same way.
  */
 class cascade : public data_ptr_nport
 {
@@ -229,11 +282,17 @@ private:
   /** The last component added. */
   nport *last;
 
-  /** The actual circuit. */
-  circuit c;
+  /** The components, in the order they were added. */
+  std::vector<nport *> devs;
 
   void recalc();
   void recalc_S();
+
+  /**
+   * Calculate data by joining the components, including the noise
+   * correlation matrix only if noise is true.
+   */
+  void chain(bool noise);
 };
 
 #endif /* CIRCUIT_H */
@@ -68,10 +68,21 @@ private:
    */
   void calc_block();
 
+  /**
+   * The calculations themselves, given the device data; the calc
+   * routines above get the data and call these.
+   */
+  void inter(const sdata &, const sdata &, const data_info &, const data_info &);
+  void intra(const sdata &);
+  void block(const sdata &, const sdata &);
+
   // These call one of the above calc routines.
   void recalc();
   void recalc_S();
 
+  /** Gets batches from the devices and calls inter(), intra() or block(). */
+  void recalc_batch(sdata_batch &, bool);
+
 public:
   /** Intraconnection constructor */
   connection(nport &, int, int);
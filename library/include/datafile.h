@@ -53,6 +53,8 @@ private:
 
 public:
   // No default constructor is provided, since the file name must be specified
+  // The file may also be a binary TABLE file written by bindata_write()
+  // (see bindata.h), in which case it is read without any parsing.
   datafile(char const * const filename) ;
 
   // Copy constructor
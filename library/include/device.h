@@ -17,6 +17,7 @@
 #include "global.h"
 #include "state_tag.h"
 #include "parameter.h"
+#include <atomic>
 
 /**
  * @class device
@@ -31,6 +32,10 @@
  *
  * (2) set a unique id tag for each device created.
  *
+ * Each thread has its own copy of the global state variables, which
+ * start at their defaults in a new thread. A device should only be
+ * used by the thread which created it; see mixer_batch.h.
+ *
  * class device is an abstract class.  It will never be
  * instantiated directly.
  */
@@ -47,7 +52,7 @@ public:
    * devices have their own temperature variable which will
    * override device::T if desired.
    */
-  static parameter T;
+  static thread_local parameter T;
 
   /**
    * Global frequency.  The default is set in nport.cc.
@@ -57,7 +62,7 @@ public:
    * it may be set to shadow another parameter variable, or may
    * in turn be shadowed by another parameter.
    */
-  static parameter f;
+  static thread_local parameter f;
 
   /**
    * Global normalization impedance.  The default is set in nport.cc.
@@ -69,13 +74,13 @@ public:
    * ALL RESPONSE CALCULATIONS PERFORMED BY CIRCUIT ELEMENTS
    * (DERIVED FROM CLASS nport) MUST USE THE VALUE OF device::Z0
    */
-  static parameter Z0;
+  static thread_local parameter Z0;
 
 private:
   /**
    * Counter of total number of devices created.  Used to set device::id.
    */
-  static unsigned long devcount;
+  static std::atomic<unsigned long> devcount;
 
 protected:
   /**
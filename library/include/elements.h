@@ -80,6 +80,20 @@ protected:
    */
   void calcY(complex Y);
 
+  /**
+   * Calculate S11 == S22 and S21 == S12 given the impedance Z or the
+   * admittance Y. Used by calcZ(), calcY(), batchZ() and batchY().
+   */
+  void sZ(complex Z, complex & s11, complex & s21) const;
+  void sY(complex Y, complex & s11, complex & s21) const;
+
+  /**
+   * Like calcZ() and calcY(), but store the S matrix at the k'th
+   * frequency of batch. Called by recalc_batch() in subclasses of spimp.
+   */
+  void batchZ(sdata_batch & batch, unsigned long k, complex Z) const;
+  void batchY(sdata_batch & batch, unsigned long k, complex Y) const;
+
 public:
   /**
    * Default constructor creates sdata for 2 ports.
@@ -109,6 +123,9 @@ public:
    */
   spimp & parallel()
   { is_series = false; return *this; }
+
+  /** @return true if the device is a series impedance. */
+  bool in_series() const { return is_series; }
 };
 
 // ***************************************************************************
@@ -199,6 +216,7 @@ private:
   // The calculation is done here.
   void recalc()   { calcZ(Complex(R)); data.passive_noise(f, Temp); } 
   void recalc_S() { calcZ(Complex(R)); }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 // ***************************************************************************
@@ -257,6 +275,7 @@ public:
 private:
   // The calculation is done here.
   void recalc() { calcY((2 * Pi * f * C) * I); }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 // ***************************************************************************
@@ -315,6 +334,7 @@ public:
 private:
   // The calculation is done here.
   void recalc() { calcZ((2 * Pi * f * L) * I); }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 
@@ -461,6 +481,7 @@ private:
   }
 
   void recalc() { recalc_S(); data.passive_noise(f, Temp); }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 // ***************************************************************************
@@ -609,6 +630,7 @@ private:
   }
 
   void recalc() { recalc_S(); data.passive_noise(f, Temp); }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 // ***************************************************************************
@@ -676,6 +698,7 @@ private:
 
   /** recalc() doesn't need to do anything. */
   void recalc() { }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 // ***************************************************************************
@@ -721,6 +744,7 @@ private:
    * series_tee's are only calculated at construction.
    */
   void recalc() { }
+  void recalc_batch(sdata_batch &, bool);
 };
 
 // ***************************************************************************
@@ -821,6 +845,7 @@ private:
   // The calculation is done here.
   void recalc();
   void recalc_S();
+  void recalc_batch(sdata_batch &, bool);
 };
 
 /**
@@ -926,6 +951,7 @@ private:
   // The calculation is done here.
   void recalc();
   void recalc_S();
+  void recalc_batch(sdata_batch &, bool);
 };
 
 /**
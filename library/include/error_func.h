@@ -183,6 +183,17 @@
 // The algorithm for error_func::func_value() is described in more detail
 // in the declaration of class error_func.
 //
+// If the sweeper doesn't space its points evenly (eg, an adaptive_sweeper;
+// see adaptive_sweeper.h), then a plain average would count the densely
+// sampled parts of the range more heavily than the rest. For such a sweeper
+// (one whose weighted() is true), error_func instead averages each term
+// using the quadrature weights the sweeper provides, so the result
+// approximates the mean over the range rather than over the points. Only
+// terms whose values at each point don't depend on the other points (those
+// for which error_term::pointwise() is true) can be weighted this way; the
+// results of the others, such as FLAT or worst-case error_term_mode terms
+// and scaled_match_error_terms, are averaged over the points as usual.
+//
 //
 // THE get_func_breakdown() MEMBER FUNCTION:
 //
@@ -550,6 +561,11 @@ public:
   // sums to 0.
   virtual void reset() { }
 
+  // pointwise() should return false if get() depends on results from earlier
+  // calls since the last reset(), so that its values can't be weighted
+  // individually when averaged over a sweep. Most terms need not change it.
+  virtual bool pointwise() const { return true; }
+
   // Virtual destructor is necessary to ensure proper subclass destruction.
   virtual ~error_term() { }
 };
@@ -623,8 +639,14 @@ public:
   //            (4.3.2) call the associated sweeper_info::calc_terms(), which:
   //                    (4.3.2.1) Loop: for each term added using this sweeper: 
   //                              (4.3.2.1.1) weighted_term::get(state_tag)
-  //            (4.3.3) increment sweeper
-  //      (4.4) call the associated sweeper_info::get_error(), which:
+  //                              (4.3.2.1.2) if sweeper::weighted(), save
+  //                                          the term's increment
+  //            (4.3.3) call sweeper::measure(state_tag)
+  //            (4.3.4) increment sweeper
+  //      (4.4) if sweeper::weighted(), call sweeper_info::apply_weights(),
+  //            which replaces each pointwise term's result by the sum of
+  //            its saved increments times the sweeper's weights
+  //      (4.5) call the associated sweeper_info::get_error(), which:
   //            (4.4.1) Loop: for each term added using this sweeper: 
   //                    (4.4.1) divide result by the number of sweeper points
   //                    (4.4.2) add the result into the return value
@@ -673,7 +695,15 @@ private:
     void reset_terms(error_func::term_list &);
 
     // Method get_terms loops through sweeper_terms, calling get() for each.
-    void calc_terms(state_tag, error_func::term_list &);
+    // If save is true, each term's increment is saved in values.
+    void calc_terms(state_tag, error_func::term_list &, bool save = false);
+
+    // Method apply_weights sums the saved increments of the pointwise terms
+    // using the sweeper's weights for each point.
+    void apply_weights(const sweeper &, error_func::term_list &);
+
+    // The saved increments, values[i][k] for term i at point k.
+    std::vector< std::vector<double> > values;
 
     // Method get_error averages the terms by dividing each term's result
     // by npoints; it adds them all and returns the sum
@@ -729,6 +759,11 @@ public:
   // Compute the error for the given mode.
   double checkval(double x);
 
+  // Only the MATCH, ABOVE and BELOW modes give values independent of
+  // earlier calls.
+  bool pointwise() const
+  { return flag == MATCH || flag == ABOVE || flag == BELOW; }
+
   // Reset is called before a sweep, and clears all memory of past calculations.
   void reset()
   {
@@ -797,6 +832,9 @@ public:
   // It should not be modified or redefined in subclasses.
   double get(state_tag);
 
+  // The running sums make get() depend on earlier calls.
+  bool pointwise() const { return false; }
+
   // Virtual destructor is necessary to ensure proper subclass destruction.
   virtual ~scaled_match_error_term() { }
 
@@ -194,6 +194,18 @@
 //     before performing  error function calculations to compensate for
 //     this adjustment to the data.
 //
+//   perturbative(bool f);
+//   perturbative();     // same as perturbative(true)
+//     if f is true, get() doesn't balance the mixer at the pumped power.
+//     At such a small LO power the response is second order in the LO
+//     amplitude; it is calculated directly from the unpumped junction
+//     states found by reset(), the curvature of their IV curves and the
+//     linear embedding circuits (see mixer::I_rectified()), which needs
+//     only linear solutions at each frequency. The result is the limit of
+//     the default calculation as the pumped power goes to 0; their
+//     relative difference is proportional to the pumped power. In this
+//     mode, get() leaves the junctions unpumped. The default is false.
+//
 //
 // USAGE: iv_match
 //
@@ -246,6 +258,53 @@
 //     external parameter objects (and thusly be controlled by the
 //     optimizer). The default offsets are 0.
 //
+//
+// PARALLEL EVALUATION: fts_match and iv_match
+//
+// Each point of an FTS or IV sweep needs a harmonic balance of the mixer,
+// so a fit to a long IV curve may take minutes. The points are
+// independent, so both terms can balance all the points of their sweep at
+// once, on several threads, using a mixer_batch (mixer_batch.h). Since a
+// mixer can't be shared between threads, each thread builds its own from
+// a mixer_model. The model's own mixer should be the one given to the
+// constructor, and the parameters the optimizer varies should be the
+// model's, listed by its parameters(), so that each thread's mixer is
+// brought up to date with them before it is balanced. For example:
+//
+//   my_mixer model;   // derived from mixer_model
+//   iv_match iv_term(model.get_mixer(), model.bias, "iv.dat");
+//   iv_term.parallel(model, iv_sweep);
+//   ef.add_term(1.0, iv_term, iv_sweep);
+//   ef.vary(..., model.Rn, ...);   // listed by model.parameters()
+//
+//   parallel(mixer_model & m, sweeper & s, unsigned threads = 0);
+//     on reset(), step through the sweeper s (which must be the sweeper
+//     the term is added with) to find the bias voltages (iv_match) or LO
+//     frequencies (fts_match) of its points, and balance mixers built from
+//     m at all of them, on the given number of threads (0: as many as the
+//     hardware supports). get() then uses these results, in the order of
+//     the sweep, so error_func sums them just as it would otherwise. The
+//     operating point passed to mixer_model::set() is:
+//       iv_match:  x[1] = the bias voltage
+//       fts_match: x[1] = the LO frequency, x[2] = the LO power
+//     set() must also set anything else the sweeper controls, eg the
+//     bias voltage of an FTS sweep. The threads build their mixers on the
+//     first reset() and keep them for later ones (see
+//     mixer_batch::keep_models()), until parallel() or serial() is called
+//     again.
+//
+//   serial();
+//     go back to balancing the mixer given to the constructor at each
+//     point (the default).
+//
+// The points are split into fixed runs (see mixer_batch::runs()), so the
+// value of the error term doesn't depend on the number of threads or
+// their timing. If get() is called at a point that wasn't found by
+// reset() (eg with a sweeper which chooses its points as it goes), that
+// point is calculated with the constructor's mixer as usual. A
+// perturbative() fts_match doesn't use the parallel calculation, since
+// its points need no balance.
+//
 // ************************************************************************
  
 #ifndef ERROR_TERMS_H
@@ -257,7 +316,9 @@
 
 // The following are required for class fts_match:
 #include "mixer.h"
+#include "mixer_batch.h"
 #include "real_interp.h"
+#include <vector>
 
 
 // ************************************************************************
@@ -432,6 +493,63 @@ private:
 } ;
 
 
+// ************************************************************************
+//
+// The results of a parallel calculation at the points of a sweep, used by
+// fts_match and iv_match.
+//
+// ************************************************************************
+class mixer_sweep_results
+{
+public:
+  mixer_sweep_results() : model(0), swp(0), threads(0), next(0), b(0) { }
+  ~mixer_sweep_results() { delete b; }
+
+  // Copies share the model and sweep, but build mixers of their own.
+  mixer_sweep_results(const mixer_sweep_results & r) :
+    model(r.model), swp(r.swp), threads(r.threads), next(0), b(0) { }
+  mixer_sweep_results & operator=(const mixer_sweep_results & r)
+  {
+    if(&r != this) { use(r.model, r.swp, r.threads); x.clear(); y.clear(); next = 0; }
+    return *this;
+  }
+
+  mixer_model *model;        // builds the mixers; parallel if nonzero
+  sweeper *swp;              // the sweep
+  unsigned threads;          // the number of threads
+
+  // Set the model, sweep and threads, forgetting any mixers already built.
+  void use(mixer_model *m, sweeper *s, unsigned t)
+  { delete b; b = 0; model = m; swp = s; threads = t; }
+
+  // The mixer_batch, which keeps its mixers from one reset() to the next;
+  // cleared of any previous points.
+  mixer_batch & batch();
+
+  std::vector<double> x;     // the swept value at each point
+  std::vector<double> y;     // the result at each point
+
+  // Step through the sweep, recording the value of p at each point in x,
+  // then reset the sweep.
+  void find_points(const abstract_real_parameter & p);
+
+  // Find the result for the next point of the sweep, if it is at xv.
+  bool next_result(double xv, double & yv)
+  {
+    if(next >= x.size() || x[next] != xv) return false;
+    yv = y[next++];
+    return true;
+  }
+
+  // The number of points in each fixed run of the mixer_batch
+  static const unsigned run_length = 8;
+
+private:
+  unsigned next;             // the index of the next point
+  mixer_batch *b;            // built on first use
+};
+
+
 // ************************************************************************
 //
 // Match a simulated mixer response to a measured FTS curve.
@@ -451,8 +569,9 @@ public:
             double units=GHz,          // Units of frequency used in data file.
             double pump=10.*Nano*Watt) // Value of LO power to simulate FTS.
     :
-    measured(freq, filename, units), mix(&m), f(false), LO_power(&pow),
-    LO_freq(&freq), pumped_power(pump), dark_current(0), currents(0)
+    measured(freq, filename, units), mix(&m), f(false), perturb(false),
+    LO_power(&pow), LO_freq(&freq), pumped_power(pump), dark_current(0),
+    currents(0), dark_voltages(0)
     { }
 
   // Set a different value for the pump LO power
@@ -463,6 +582,19 @@ public:
   // compensate for a similar factor in the measued data.
   fts_match & f_correct(bool flag = true) { f = flag; return *this; }
 
+  // Set the perturbative mode flag; If true, the pumped current is
+  // calculated to second order in the LO amplitude from the unpumped
+  // state found by reset(), using mixer::I_rectified(), rather than by a
+  // harmonic balance.
+  fts_match & perturbative(bool flag = true) { perturb = flag; return *this; }
+
+  // Balance all the points of the sweeper s at once, with mixers built
+  // from m, or go back to balancing at each point (see PARALLEL
+  // EVALUATION above).
+  fts_match & parallel(mixer_model & m, sweeper & s, unsigned threads = 0)
+    { batch.use(&m, &s, threads); return *this; }
+  fts_match & serial() { batch.use(0, 0, 0); return *this; }
+
   // The measured curve is interpolated from the data read from the file
   // as a function of LO frequency. This is a public member variable, so
   // the user can access it to set special options, the interpolation
@@ -481,6 +613,7 @@ public:
 private:
   mixer *mix;   // The mixer.
   bool  f;      // If true, measured response has a freq "correction" factor.
+  bool  perturb; // If true, calculate the response without a balance.
 
   // Setting this parameter sets the LO power in the mixer.
   parameter *LO_power;
@@ -496,6 +629,12 @@ private:
 
   // Hold the mixer's junction DC currents
   Vector currents;
+
+  // The unpumped junction DC voltages, saved by reset()
+  Vector dark_voltages;
+
+  // The responses found by a parallel calculation
+  mixer_sweep_results batch;
 };
 
 
@@ -544,6 +683,16 @@ public:
   iv_match & i_offset(const abstract_real_parameter *pi)
     { I_off = pi; return *this; }
 
+  // Balance all the points of the sweeper s at once, with mixers built
+  // from m, or go back to balancing at each point (see PARALLEL
+  // EVALUATION above).
+  iv_match & parallel(mixer_model & m, sweeper & s, unsigned threads = 0)
+    { batch.use(&m, &s, threads); return *this; }
+  iv_match & serial() { batch.use(0, 0, 0); return *this; }
+
+  // If parallel, calculate the currents at all the points of the sweep.
+  void reset();
+
   // Return the measured pumped IV at the bias voltage corrected for offsets
   double get_a() { return measured(V_off + *V) - I_off; }
 
@@ -566,6 +715,9 @@ private:
 
   // Hold the mixer's junction DC currents
   Vector currents;
+
+  // The currents found by a parallel calculation
+  mixer_sweep_results batch;
 };
 
 #endif /* ERROR_TERMS_H */
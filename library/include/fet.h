@@ -68,6 +68,12 @@ private:
  * set.  For some pre-built transistors which are ready to use,
  * see the file hemt.h.
  *
+ * The equivalent circuit is normally calculated in closed form: its
+ * admittance and noise correlation matrices are built up directly from
+ * the element values, in a fixed sequence of 2x2 matrix operations,
+ * which gives the same results as calculating the circuit of elements
+ * at a small fraction of the cost. See closed_form().
+ *
  * Fets are modelled as 2-ports in a common-source config.
  * Here're the port assignments:
  *
@@ -132,12 +138,32 @@ public:
    */
   int size() { return 2; }
 
+  /**
+   * Choose whether to calculate the equivalent circuit in closed form
+   * (the default), or by calculating the circuit of elements. The circuit
+   * is always used if the series or parallel modes of the elements have
+   * been changed from those set by the constructor, or if Rds is 0.
+   *
+   * @param f true for the closed form calculation
+   */
+  fet & closed_form(bool f) { use_closed_form = f; return *this; }
+
+  /** @return true if the closed form calculation is in use. */
+  bool closed_form() const { return use_closed_form; }
+
 protected:
   /**
    * The circuit which holds the built fet.
    */
   circuit fetckt;
 
+  /**
+   * Called before each calculation. Subclasses override it to set
+   * element values which depend on the operating conditions, such as
+   * the drain temperature.
+   */
+  virtual void prepare() { }
+
 private:
   // Some connector elements used to build the circuit.
   branch b1, b2;
@@ -154,9 +180,20 @@ private:
    */
   void fet_copy(const fet & f);
 
+  /** True to use the closed form calculation. */
+  bool use_closed_form;
+
+  /**
+   * @return true if the elements are connected as the closed form
+   * calculation assumes.
+   */
+  bool closed_form_ok() const;
+
   // The calculation is done here.
-  virtual void recalc()     { data_ptr = &fetckt.get_data(); }
-  virtual void recalc_S()   { data_ptr = &fetckt.get_data_S(); }
+  virtual void recalc()     { calc(true); }
+  virtual void recalc_S()   { calc(false); }
+  void calc(bool noise);
+  void recalc_batch(sdata_batch &, bool);
 };
 
 #endif /* FET_H */
@@ -0,0 +1,58 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ********************************************************************
+// fft.h
+//
+// class fft_plan: fast Fourier transforms of complex data.
+//
+// An fft_plan holds the bit-reversal permutation and the twiddle factors
+// for transforms of a single length n, which must be a power of 2, so
+// repeated transforms of the same length don't recalculate them. The
+// transforms are performed in place on an array of n Complex values:
+//
+//   forward:  X[k] = sum(j = 0 .. n-1) x[j] exp(-2 Pi i j k / n)
+//   inverse:  x[j] = (1/n) sum(k = 0 .. n-1) X[k] exp(+2 Pi i j k / n)
+//
+// so inverse() undoes forward(). Use fft_plan::size_for() to choose a
+// length large enough for some data, which is then padded with zeroes.
+// Sequences with negative indexes (such as the Ck of class ckdata) are
+// stored "wrapped": element j < 0 goes into array position n + j.
+//
+// fft_plan objects may be copied; a const fft_plan may be used by several
+// threads at once.
+// ********************************************************************
+
+#ifndef FFT_H
+#define FFT_H
+
+#include "SIScmplx.h"
+#include <vector>
+
+class fft_plan
+{
+public:
+
+  // Prepare to transform arrays of length n, which must be a power of 2
+  // (or 0, giving a plan which does nothing).
+  explicit fft_plan(unsigned long n = 0);
+
+  // The transform length.
+  unsigned long size() const { return n; }
+
+  // The transforms, performed in place on x[0] .. x[size()-1].
+  void forward(Complex * x) const;
+  void inverse(Complex * x) const;
+
+  // The smallest power of 2 which is >= m.
+  static unsigned long size_for(unsigned long m);
+
+private:
+  unsigned long n;
+  std::vector<unsigned long> rev;   // the bit-reversal permutation
+  std::vector<Complex> w;           // w[j] = exp(-2 Pi i j / n), j < n/2
+
+  void transform(Complex * x, bool inverse) const;
+};
+
+#endif /* FFT_H */
@@ -52,8 +52,8 @@ private:
    */
   double slope;
 
-  // The calculation is done here.
-  void recalc();
+  // Sets the drain temperature before each calculation.
+  void prepare();
 };
 
 /**
@@ -89,8 +89,8 @@ private:
    */
   double slope;
 
-  // The calculation is done here.
-  void recalc();
+  // Sets the drain temperature before each calculation.
+  void prepare();
 };
 
 /**
@@ -123,8 +123,8 @@ private:
    */
   double slope;
 
-  // The calculation is done here.
-  void recalc();
+  // Sets the drain temperature before each calculation.
+  void prepare();
 };
 
 /**
@@ -163,8 +163,8 @@ private:
    */
   double slope;
 
-  // The calculation is done here.
-  void recalc();
+  // Sets the drain temperature before each calculation.
+  void prepare();
 };
 
 /**
@@ -203,8 +203,8 @@ private:
    */
   double slope;
 
-  // The calculation is done here.
-  void recalc();
+  // Sets the drain temperature before each calculation.
+  void prepare();
 };
 
 #endif /* HEMT_H */
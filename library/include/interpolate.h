@@ -186,6 +186,18 @@ public:
   const Y_type & operator[](unsigned i) const         // returns y[i] ( 0 <= i < size() )
     { return table[i].second.first->second; }         // NO BOUNDS CHECKING ON i
 
+  // The following functions provide read access to the internal values calculated by
+  // build(), so that specialized interpolators may be built from them. They are only
+  // meaningful if ready() is set. coef(i) returns Y''(x[i]) for a spline interpolation,
+  // or the slope from x[i] to x[i+1] for a linear interpolation ( 0 <= i < size()-1 ).
+
+  int type() const { return type_; }                  // LINEAR or SPLINE
+  bool is_quiet() const { return no_warn_; }          // true if not warning
+  const Y_type & coef(unsigned i) const               // NO BOUNDS CHECKING ON i
+    { return table[i].second.second->second; }
+  const Y_type & left_slope() const { return lslope; }   // extrapolation slopes
+  const Y_type & right_slope() const { return rslope; }
+
 
   // virtual destructor for proper subclass destruction
   virtual ~interpolator() { }
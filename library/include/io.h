@@ -307,4 +307,126 @@ private:
 
 };
 
+
+// ********************************************************************
+// class touchstone_stream
+//
+// Reads an entire Touchstone file at once, for large files such as the
+// output of EM simulators. It accepts the same files as touchstone_read,
+// but rather than returning one Matrix per call, it stores the matrix data
+// of all the frequency points in a single contiguous block, which may then
+// be converted and accessed in bulk.
+//
+// The file is read in large chunks which are parsed in place (using the
+// same rules as data_parser::parse(), with '!' the comment delimiter), so
+// no per-line strings or Matrix objects are created. The matrix values of
+// a frequency point need only appear in the proper order following the
+// frequency; how they are split among lines does not matter.
+//
+// Several files may be read concurrently using the static function
+// read_all().
+
+class touchstone_stream : public touchstone_base
+{
+public:
+
+  touchstone_stream();
+
+  // Read the named file, using the number of ports and default frequency
+  // scaling as described for touchstone_read::open(). Any data from a
+  // previous call is discarded. The matrix data is normalized as described
+  // for touchstone_read::value(), all points at once. Returns false if the
+  // file could not be opened or was improperly formatted; in the latter
+  // case the data for any frequency points read before the problem was
+  // found is retained.
+  bool read(const char * const name, int ports = 2, double f_scale = GHz);
+
+  // Read the named files concurrently, using up to the given number of
+  // threads (if threads == 0, as many as the hardware supports). On return,
+  // files[i] holds the data of names[i]. Returns true only if every file
+  // was read successfully.
+  static bool read_all(std::vector<touchstone_stream> & files,
+		       const std::vector<std::string> & names,
+		       int ports = 2, double f_scale = GHz, unsigned threads = 0);
+
+
+  // -------------------
+  // The matrix data:
+
+  // The type of matrix data in the file.
+  types type() const { return type_ ; }
+
+  // The number of ports, and the number of frequency points read.
+  int ports() const { return N ; }
+  unsigned long points() const { return f_.size() ; }
+
+  // The frequency of point k (0 <= k < points()), in SuperMix units.
+  double freq(unsigned long k) const { return f_[k] ; }
+
+  // The matrix of point k (0 <= k < points()). The Matrix returned is
+  // an Index_1 alias of the internal data, so it must not outlive this
+  // object or be used after a subsequent read().
+  Matrix matrix(unsigned long k)
+    { return Matrix(&m_[k*N*N], N, N, Index_1, Index_1); }
+
+  // The matrix data of all points: points() matrices of ports()*ports()
+  // elements each, stored row by row.
+  Complex * data() { return (m_.empty()) ? 0 : &m_[0] ; }
+
+  // Convert the matrices of all points to S matrices normalized to
+  // device::Z0, as touchstone_read::Svalue() does; type() becomes S.
+  touchstone_stream & to_S();
+
+
+  // -------------------
+  // The noise data (2-port files only):
+
+  bool has_noise() const { return !noise_.empty() ; }
+  unsigned long noise_points() const { return noise_.size() ; }
+
+  // The frequency and data of noise point k, as returned by
+  // touchstone_read::get_noise().
+  double noise_freq(unsigned long k) const { return nf_[k] ; }
+  const touchstone_read::noise & noise(unsigned long k) const { return noise_[k] ; }
+
+
+  // -------------------
+  // Other functions:
+
+  // Returns false if the latest call to read() failed.
+  bool good() const { return good_ ; }
+
+  // The normalizing impedance of the data in the file.
+  double z() const { return z_ ; }
+
+  // Verbosity, as for touchstone_read.
+  touchstone_stream & verbose() { verbose_ = true;  return *this; }
+  touchstone_stream & quiet()   { verbose_ = false; return *this; }
+
+private:
+
+  std::string name_;   // the name of the file read
+  int N;               // number of ports
+  bool good_;          // false if something went wrong
+  bool verbose_;       // warning behavior
+  double f_units;      // units for file frequency data
+  double z_;           // normalizing impedance of file data
+  types type_;         // the type of matrix in the file
+  Complex::io_mode mode; // the format of the matrix data
+
+  std::vector<double> f_;     // frequencies of the points
+  std::vector<Complex> m_;    // matrices of the points, N*N each
+  std::vector<double> nf_;    // frequencies of the noise points
+  std::vector<touchstone_read::noise> noise_;  // noise data
+
+  // parsing state, used during read():
+  enum { SPEC, DATA, NOISE, DONE } state;
+  std::vector<double> rec;    // values of the frequency point being read
+  std::vector<double> vals;   // values found on the current line
+  bool line(const char * b, const char * e);  // interpret a line of the file
+  bool spec(const char * b, const char * e);  // interpret the spec line
+  void store();                               // store a complete point in rec
+  void normalize();                           // normalize all points
+};
+
 #endif /* IO_H */
@@ -102,6 +102,23 @@ public:
 
   virtual int call_large_signal() const { return 0; }
 
+  // Direct detection: the second order change in the DC current when a
+  // small RMS voltage v at frequency f is added to the junction's present
+  // DC voltage, divided by |v|^2. The junction should be unpumped (all of
+  // its harmonic voltages 0) when this is called. The default version
+  // uses large_signal() with a voltage of 1e-3 of the photon voltage hf/e,
+  // and leaves the junction unpumped at its DC voltage, with LO frequency
+  // f; junction classes may override it with an exact calculation.
+  virtual double rectification(double f);
+
+
+  // The relative accuracy required of any series the junction truncates
+  // internally in large_signal() (such as the Ck of an sis junction).
+  // The mixer sets it when it chooses its number of harmonics adaptively;
+  // junctions which don't truncate anything may ignore it.
+
+  virtual void tolerance(double) { }
+
 
   // Virtual destructor
   virtual ~junction() { };
@@ -138,6 +155,26 @@ public:
   void data(const char * const I_imaginary_filename, const char * const I_real_filename);
 
 
+  // An ivcurve may also be made from the DC IV data alone, with the
+  // Kramers-Kronig transform Ikk(V) calculated from Idc(V). The DC data
+  // may come from a file, or from vectors of voltages V and currents I
+  // (so an ivcurve may be changed cheaply within a fitting loop).
+  //
+  // The transform treats Idc(V) as piecewise linear between kk_points()
+  // evenly-spaced voltages covering the DC data, and as a straight line
+  // beyond them, matching the extrapolation of Ikk(V) described below.
+  // The integrals are then exact, and are summed using an FFT. Ikk(V) is
+  // tabulated out to twice the largest voltage in the DC data.
+
+  explicit ivcurve(const char * const I_imaginary_filename);
+  void data(const char * const I_imaginary_filename);
+  void data(const std::vector<double> & V, const std::vector<double> & I);
+
+  // the number of voltage intervals used to calculate Ikk(V) (default 2048)
+  ivcurve & kk_points(unsigned long n) { kk_n = (n < 4) ? 4 : n; return *this; }
+  unsigned long kk_points() const { return kk_n; }
+
+
   // We'll implement this one later...
   //  ivcurve(char *filename);
 
@@ -165,6 +202,10 @@ private:
   bool valid;                     // Are Idc and Ikk valid?
   interpolator<double> Idc, Ikk;  // The Idc and Ikk data interpolators
   double Io, c0, c2, c4;          // Extrapolation parameters for Ikk
+  unsigned long kk_n;             // intervals used to calculate Ikk from Idc
+  void read(interpolator<double> &, const char * const);  // load a data file
+  void calc_ikk();                // fill Ikk with the K-K transform of Idc
+  void build_ikk();               // find the Ikk extrapolation and build Ikk
   double idcinterp(double v) const;  // interpolate Idc value
   double ikkinterp(double v) const;  // interpolate Ikk value
   void idcinterpslope(double, double &, double &) const;
@@ -200,23 +241,30 @@ class ckdata
 public:
   Vector Ck;  // the container of the Ck vector results
   double Tol; // the tolerance to which the Ck results are accurate
-              // following calc(): Tol == ZEROTOL, #defined in global.h 
+              // following calc(): Tol == tolerance()
 
   // constructors:
   ckdata()
-    : Ck(0,Index_S), Tol(0.0),
+    : Ck(0,Index_S), Tol(0.0), tol(ZEROTOL),
       bessel_values(0,0,Index_C,Index_C), Amj_values(0,Index_C)
   { }
   ckdata(const ckdata & old)
-    : Ck(old.Ck), Tol(old.Tol),
+    : Ck(old.Ck), Tol(old.Tol), tol(old.tol),
       bessel_values(0,0,Index_C,Index_C), Amj_values(0,Index_C)
   { }
 
   // destructor: default destructor is fine
 
-  // assignment operator: only copies Ck vector data and Tol
+  // assignment operator: only copies Ck vector data, Tol and tolerance()
   inline ckdata & operator = (const ckdata & old)
-  { (Ck = old.Ck).resize(old.Ck); Tol = old.Tol; return *this; }
+  { (Ck = old.Ck).resize(old.Ck); Tol = old.Tol; tol = old.tol; return *this; }
+
+  // the truncation tolerance used by calc(): Bessel functions smaller than
+  // this are dropped, and so are the Ck in the tails of the series whose
+  // magnitudes squared sum to less than its square. The default is
+  // ZEROTOL, #defined in global.h; a smaller value gives more Ck.
+  ckdata & tolerance(double t) { tol = (t > 0) ? t : ZEROTOL; return *this; }
+  double tolerance() const { return tol; }
 
   // access the vector data using array indexing:
   inline Complex & operator [] (const int i) { return Ck.get(i); }
@@ -229,6 +277,9 @@ public:
 
 private:
 
+  // the truncation tolerance
+  double tol;
+
   // holds results of bessel():
   real_table bessel_values;
 
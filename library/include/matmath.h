@@ -206,7 +206,8 @@
 // IminusM(U, s, V);  U = s*I - V after the call. I is the identity.
 //
 // MMdagger(U, V);     U = V * dagger(V)  after the call.
-// MAMdagger(U, V, W); U = V * W * dagger(V)
+// MAMdagger(U, V, W); U = V * W * dagger(V), for hermitian W. Only the
+//                     upper triangle of U is calculated; U may be W.
 //
 // ************************************************************************
 
@@ -281,8 +282,7 @@ Complex operator *(const    real_vector &, const complex_vector &);
  double operator *(const    real_vector &, const    real_vector &);
 inline Complex operator *(const complex_vector &u, const real_vector &x)
 { return x * u; }
-inline Complex dot(const complex_vector &u, const complex_vector &v)
-{ return conj(u) * v; }
+Complex dot(const complex_vector &u, const complex_vector &v);
 inline Complex dot(const complex_vector &u, const real_vector &x)
 { return x * conj(u); }
 inline Complex dot(const real_vector &x, const complex_vector &v)
@@ -0,0 +1,466 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ************************************************************************
+// matview.h
+// non-owning views of the rows, columns, diagonals and blocks of matrices
+//
+// ************************************************************************
+//
+//                      The Vector and Matrix Views
+//
+// row(n,U), col(n,U), A.fillrow() and the like (see matmath.h and
+// table.h) copy data into and out of freshly allocated vectors. A view
+// instead refers to elements of an existing vector or matrix in place: it
+// owns no data, so making one costs only a few words, and writing to its
+// elements writes to the elements of the matrix it views. The types are:
+//
+//   real_vector_view, complex_vector_view: a row, column or diagonal of a
+//     matrix, or a whole vector. The elements needn't be adjacent in
+//     memory.
+//
+//   real_matrix_view, complex_matrix_view: a rectangular block of a matrix
+//     (or the whole matrix).
+//
+// A view is invalidated by anything that reallocates the memory of the
+// object it views (resize(), reallocate(), or an assignment that changes
+// its size). Views of matrices address the elements through the matrix's
+// row pointers, so they follow the rows exchanged by A.rowswap().
+// The views don't carry the const-ness of the viewed object: a view of a
+// const vector or matrix must only be read.
+//
+// Making views:
+// ------------
+// (A: a real or complex matrix, or a view of one; n: int)
+//
+//  row_view(n,A);   row n of A; indexed as the columns of A (Rmode)
+//  col_view(n,A);   column n of A; indexed as the rows of A (Lmode)
+//  diag_view(A);    the diagonal of A, indexed as A; if A's two index
+//                   modes differ, the mode follows from the first index
+//  block_view(A, l1, l2, r1, r2);
+//                   rows l1..l2, columns r1..r2 of A, clipped to the
+//                   valid index ranges of A. The elements keep the
+//                   indexes they have in A, and A's index modes.
+//  block_view(A, l1, l2, r1, r2, tl, tr);
+//                   the same block, reindexed according to the index
+//                   modes tl and tr, as a matrix of the block's size
+//                   would be. A block of an even number of rows or
+//                   columns with mode Index_S runs from -n to n-1.
+//
+// A vector or matrix converts implicitly to a view of the whole object,
+// so any of the functions below taking views may be given vectors or
+// matrices instead.
+//
+// Using views:
+// -----------
+// (v, u: vector views; B, C: matrix views of the same data type;
+//  s: scalar; i, j: int)
+//
+//  v[i]; v.read(i); v.minindex(); v.maxindex(); v.mode; v.is_empty();
+//  B[i][j]; B.read(i,j); B.Lminindex(); ... B.Rmaxindex(); B.Lmode;
+//  B.Rmode; B.is_empty();
+//
+//     as for the vector and matrix classes. B[i] is a pointer to the
+//     elements of row i of B, so B[i][j] works as it does for a matrix.
+//
+//  v.sub(i,j);      the elements i..j of v, keeping their indexes
+//
+//  v = u;  B = C;   copy the elements of u into v (or C into B), element
+//                   by element, with u.read() supplying zeros where u
+//                   has no elements. The sizes and indexes of v and B
+//                   never change. u and v should not overlap, unless
+//                   they are the same.
+//  v = s;  B = s;   fill with a scalar.
+//  v += u;  v -= u;  v *= s;  v /= s;  B += C;  B -= C;  B *= s;  B /= s;
+//
+//  u * v;  dot(u,v);  norm(v);    <scalar> as for vectors
+//  B * v;           <vector>  (the rows of B times v, indexed as B's rows)
+//  B * C;           <matrix>
+//  to_vector(v);  to_matrix(B);   <vector>, <matrix> copies of the data
+//
+// Solvers:
+// -------
+//  solve(x, B, v);  solve(X, B, C);
+//     Solve B*x == v (B*X == C) and put the result directly into the
+//     view x (or X), whose index ranges must be those of B's columns (and
+//     of C's columns). Returns 1 if successful; if B is singular or the
+//     sizes don't fit, returns 0 and leaves x unchanged. B, v and C are
+//     copied into the solver's working matrix, exactly as solve(A,B) of
+//     matmath.h does it, but there are no other copies.
+//  solve(B, v);     <vector> as above, but returns the solution in a new
+//                   vector (empty if the solve fails).
+//
+// ************************************************************************
+
+#ifndef MATVIEW_H
+#define MATVIEW_H
+
+#include "matmath.h"
+
+
+template <class T, class V, class M> class matrix_view;
+
+// ************************************************************************
+// vector_view: the template for real_vector_view and complex_vector_view.
+// Element i is rows[k*rstep][col + k*cstep], where k = i - minindex().
+
+template <class T, class V, class M>
+class vector_view
+{
+public:
+  typedef T value_type;
+  const v_index_mode & mode;
+
+  // an empty view
+  vector_view()
+    : mode(internal_mode), own(0), rows(&own), rstep(0), col(0), cstep(0)
+  { empty(Index_1); }
+
+  // the whole of the vector v
+  vector_view(const V & v)
+    : mode(internal_mode), own(0), rows(&own), rstep(0), col(0), cstep(1)
+  {
+    lo = v.minindex(); hi = v.maxindex(); internal_mode = v.mode;
+    if (hi < lo) empty(v.mode);
+    else own = const_cast<T *>(&v[lo]);
+  }
+
+  vector_view(const vector_view & u)
+    : mode(internal_mode), own(u.own), rows((u.rows == &u.own) ? &own : u.rows),
+      rstep(u.rstep), col(u.col), cstep(u.cstep), lo(u.lo), hi(u.hi),
+      internal_mode(u.internal_mode)
+  { }
+
+  // the other views are built by the named constructors:
+  static vector_view row(int n, const matrix_view<T,V,M> & A)
+  {
+    vector_view v;
+    if (n < A.lmin || n > A.lmax || A.is_empty())
+      v.empty(A.Rmode);
+    else
+      v.set(A.rows + (n - A.lmin), 0, A.rmin + A.coff, 1, A.rmin, A.rmax, A.Rmode);
+    return v;
+  }
+
+  static vector_view column(int n, const matrix_view<T,V,M> & A)
+  {
+    vector_view v;
+    if (n < A.rmin || n > A.rmax || A.is_empty())
+      v.empty(A.Lmode);
+    else
+      v.set(A.rows, 1, n + A.coff, 0, A.lmin, A.lmax, A.Lmode);
+    return v;
+  }
+
+  static vector_view diagonal(const matrix_view<T,V,M> & A)
+  {
+    vector_view v;
+    int min = (A.lmin > A.rmin) ? A.lmin : A.rmin;
+    int max = (A.lmax < A.rmax) ? A.lmax : A.rmax;
+    v_index_mode t = (A.Lmode == A.Rmode) ? A.Lmode
+      : (min < 0) ? Index_S : (min == 0) ? Index_C : Index_1;
+    if (max < min || A.is_empty())
+      v.empty(t);
+    else
+      v.set(A.rows + (min - A.lmin), 1, min + A.coff, 1, min, max, t);
+    return v;
+  }
+
+  // copy data in
+  vector_view & operator = (const vector_view & u)
+  {
+    if (this == &u) return *this;
+    for (int i = lo; i <= hi; ++i) at(i) = u.read(i);
+    return *this;
+  }
+  vector_view & operator = (const T & s)
+  { for (int i = lo; i <= hi; ++i) at(i) = s; return *this; }
+
+  vector_view & operator += (const vector_view & u)
+  {
+    int i = (lo > u.lo) ? lo : u.lo, limit = (hi < u.hi) ? hi : u.hi;
+    for ( ; i <= limit; ++i) at(i) += u.at(i);
+    return *this;
+  }
+  vector_view & operator -= (const vector_view & u)
+  {
+    int i = (lo > u.lo) ? lo : u.lo, limit = (hi < u.hi) ? hi : u.hi;
+    for ( ; i <= limit; ++i) at(i) -= u.at(i);
+    return *this;
+  }
+  vector_view & operator *= (const T & s)
+  { for (int i = lo; i <= hi; ++i) at(i) *= s; return *this; }
+  vector_view & operator /= (const T & s)
+  { for (int i = lo; i <= hi; ++i) at(i) /= s; return *this; }
+
+  // the elements min..max of this view (clipped to its index range),
+  // keeping their indexes
+  vector_view sub(int min, int max) const
+  {
+    vector_view v(*this);
+    if (min < lo) min = lo;
+    if (max > hi) max = hi;
+    if (max < min) { v.empty(internal_mode); return v; }
+    v.rows += (min - lo)*rstep;  // (a view of a vector has rstep == 0)
+    v.col += (min - lo)*cstep; v.lo = min; v.hi = max;
+    return v;
+  }
+
+  // access
+  int minindex() const { return lo; }
+  int maxindex() const { return hi; }
+  int is_empty() const { return hi < lo; }
+  T & operator [] (int i) { return at(i); }
+  const T & operator [] (int i) const { return at(i); }
+  T read(int i) const { return (i < lo || i > hi) ? T(0.0) : at(i); }
+
+private:
+  T * own;                   // the data pointer, if the view is of a vector
+  T *const * rows;           // the row pointer of the first element
+  int rstep, col, cstep;     // as above
+  int lo, hi;                // the index range
+  v_index_mode internal_mode;
+
+  T & at(int i) const
+  { int k = i - lo; return rows[k*rstep][col + k*cstep]; }
+
+  void set(T *const * r, int rs, int c, int cs, int min, int max,
+	   v_index_mode t)
+  {
+    rows = r; rstep = rs; col = c; cstep = cs;
+    lo = min; hi = max; internal_mode = t;
+  }
+
+  void empty(v_index_mode t)
+  {
+    own = 0; rows = &own; rstep = col = cstep = 0;
+    lo = (t == Index_1) ? 1 : 0; hi = lo - 1; internal_mode = t;
+  }
+};
+
+
+// ************************************************************************
+// matrix_view: the template for real_matrix_view and complex_matrix_view.
+// Row i of the view is rows[i - Lminindex()] + coff.
+
+template <class T, class V, class M>
+class matrix_view
+{
+public:
+  typedef T value_type;
+  const v_index_mode & Lmode;
+  const v_index_mode & Rmode;
+
+  // an empty view
+  matrix_view()
+    : Lmode(internal_Lmode), Rmode(internal_Rmode), rows(0), coff(0)
+  { empty(Index_1, Index_1); }
+
+  // the whole of the matrix A
+  matrix_view(const M & A)
+    : Lmode(internal_Lmode), Rmode(internal_Rmode), rows(0), coff(0)
+  {
+    if (A.is_empty()) { empty(A.Lmode, A.Rmode); return; }
+    rows = const_cast<T *const *>(&A[A.Lminindex()]);
+    lmin = A.Lminindex(); lmax = A.Lmaxindex();
+    rmin = A.Rminindex(); rmax = A.Rmaxindex();
+    internal_Lmode = A.Lmode; internal_Rmode = A.Rmode;
+  }
+
+  matrix_view(const matrix_view & B)
+    : Lmode(internal_Lmode), Rmode(internal_Rmode), rows(B.rows), coff(B.coff),
+      lmin(B.lmin), lmax(B.lmax), rmin(B.rmin), rmax(B.rmax),
+      internal_Lmode(B.internal_Lmode), internal_Rmode(B.internal_Rmode)
+  { }
+
+  // the block rows l1..l2, columns r1..r2 of A, with A's indexes
+  static matrix_view block(const matrix_view & A, int l1, int l2, int r1, int r2)
+  {
+    matrix_view B(A);
+    if (l1 < A.lmin) l1 = A.lmin;
+    if (l2 > A.lmax) l2 = A.lmax;
+    if (r1 < A.rmin) r1 = A.rmin;
+    if (r2 > A.rmax) r2 = A.rmax;
+    if (l2 < l1 || r2 < r1) { B.empty(A.Lmode, A.Rmode); return B; }
+    B.rows += l1 - A.lmin;
+    B.lmin = l1; B.lmax = l2; B.rmin = r1; B.rmax = r2;
+    return B;
+  }
+
+  // the same block, reindexed
+  static matrix_view block(const matrix_view & A, int l1, int l2, int r1, int r2,
+			   v_index_mode tl, v_index_mode tr)
+  {
+    matrix_view B = block(A, l1, l2, r1, r2);
+    if (B.is_empty()) { B.empty(tl, tr); return B; }
+    int l = first(tl, B.lmax - B.lmin + 1), r = first(tr, B.rmax - B.rmin + 1);
+    B.lmax += l - B.lmin;  B.lmin = l;
+    B.coff += B.rmin - r;  B.rmax += r - B.rmin;  B.rmin = r;
+    B.internal_Lmode = tl; B.internal_Rmode = tr;
+    return B;
+  }
+
+  // copy data in
+  matrix_view & operator = (const matrix_view & B)
+  {
+    if (this == &B) return *this;
+    for (int i = lmin; i <= lmax; ++i) {
+      T * r = (*this)[i];
+      for (int j = rmin; j <= rmax; ++j) r[j] = B.read(i,j);
+    }
+    return *this;
+  }
+  matrix_view & operator = (const T & s)
+  {
+    for (int i = lmin; i <= lmax; ++i) {
+      T * r = (*this)[i];
+      for (int j = rmin; j <= rmax; ++j) r[j] = s;
+    }
+    return *this;
+  }
+
+  matrix_view & operator += (const matrix_view & B)
+  {
+    int l1 = (lmin > B.lmin) ? lmin : B.lmin, l2 = (lmax < B.lmax) ? lmax : B.lmax;
+    int r1 = (rmin > B.rmin) ? rmin : B.rmin, r2 = (rmax < B.rmax) ? rmax : B.rmax;
+    for (int i = l1; i <= l2; ++i) {
+      T * r = (*this)[i]; const T * b = B[i];
+      for (int j = r1; j <= r2; ++j) r[j] += b[j];
+    }
+    return *this;
+  }
+  matrix_view & operator -= (const matrix_view & B)
+  {
+    int l1 = (lmin > B.lmin) ? lmin : B.lmin, l2 = (lmax < B.lmax) ? lmax : B.lmax;
+    int r1 = (rmin > B.rmin) ? rmin : B.rmin, r2 = (rmax < B.rmax) ? rmax : B.rmax;
+    for (int i = l1; i <= l2; ++i) {
+      T * r = (*this)[i]; const T * b = B[i];
+      for (int j = r1; j <= r2; ++j) r[j] -= b[j];
+    }
+    return *this;
+  }
+  matrix_view & operator *= (const T & s)
+  {
+    for (int i = lmin; i <= lmax; ++i) {
+      T * r = (*this)[i];
+      for (int j = rmin; j <= rmax; ++j) r[j] *= s;
+    }
+    return *this;
+  }
+  matrix_view & operator /= (const T & s)
+  {
+    for (int i = lmin; i <= lmax; ++i) {
+      T * r = (*this)[i];
+      for (int j = rmin; j <= rmax; ++j) r[j] /= s;
+    }
+    return *this;
+  }
+
+  // access
+  int Lminindex() const { return lmin; }
+  int Lmaxindex() const { return lmax; }
+  int Rminindex() const { return rmin; }
+  int Rmaxindex() const { return rmax; }
+  int is_empty() const { return (lmax < lmin) || (rmax < rmin); }
+  T * operator [] (int i) { return rows[i - lmin] + coff; }
+  const T * operator [] (int i) const { return rows[i - lmin] + coff; }
+  T read(int i, int j) const
+  {
+    return (i < lmin || i > lmax || j < rmin || j > rmax) ?
+      T(0.0) : rows[i - lmin][j + coff];
+  }
+
+private:
+  friend class vector_view<T,V,M>;
+
+  T *const * rows;           // the row pointer of row Lminindex()
+  int coff;                  // the column index in A less that in the view
+  int lmin, lmax, rmin, rmax;
+  v_index_mode internal_Lmode, internal_Rmode;
+
+  void empty(v_index_mode tl, v_index_mode tr)
+  {
+    rows = 0; coff = 0;
+    lmin = (tl == Index_1) ? 1 : 0; lmax = lmin - 1;
+    rmin = (tr == Index_1) ? 1 : 0; rmax = rmin - 1;
+    internal_Lmode = tl; internal_Rmode = tr;
+  }
+
+  // the first index of n elements in index mode t
+  static int first(v_index_mode t, int n)
+  { return (t == Index_1) ? 1 : (t == Index_S) ? -(n/2) : 0; }
+};
+
+
+// ************************************************************************
+// The view types:
+
+typedef vector_view<double, real_vector, real_matrix>        real_vector_view;
+typedef vector_view<Complex, complex_vector, complex_matrix> complex_vector_view;
+typedef matrix_view<double, real_vector, real_matrix>        real_matrix_view;
+typedef matrix_view<Complex, complex_vector, complex_matrix> complex_matrix_view;
+
+inline real_vector_view row_view(int n, const real_matrix_view & X)
+{ return real_vector_view::row(n, X); }
+inline complex_vector_view row_view(int n, const complex_matrix_view & U)
+{ return complex_vector_view::row(n, U); }
+
+inline real_vector_view col_view(int n, const real_matrix_view & X)
+{ return real_vector_view::column(n, X); }
+inline complex_vector_view col_view(int n, const complex_matrix_view & U)
+{ return complex_vector_view::column(n, U); }
+
+inline real_vector_view diag_view(const real_matrix_view & X)
+{ return real_vector_view::diagonal(X); }
+inline complex_vector_view diag_view(const complex_matrix_view & U)
+{ return complex_vector_view::diagonal(U); }
+
+inline real_matrix_view block_view
+(const real_matrix_view & X, int l1, int l2, int r1, int r2)
+{ return real_matrix_view::block(X, l1, l2, r1, r2); }
+inline complex_matrix_view block_view
+(const complex_matrix_view & U, int l1, int l2, int r1, int r2)
+{ return complex_matrix_view::block(U, l1, l2, r1, r2); }
+
+inline real_matrix_view block_view
+(const real_matrix_view & X, int l1, int l2, int r1, int r2,
+ v_index_mode tl, v_index_mode tr)
+{ return real_matrix_view::block(X, l1, l2, r1, r2, tl, tr); }
+inline complex_matrix_view block_view
+(const complex_matrix_view & U, int l1, int l2, int r1, int r2,
+ v_index_mode tl, v_index_mode tr)
+{ return complex_matrix_view::block(U, l1, l2, r1, r2, tl, tr); }
+
+
+// ************************************************************************
+// Operations on views:
+
+double  operator *(const real_vector_view &, const real_vector_view &);
+Complex operator *(const complex_vector_view &, const complex_vector_view &);
+double  dot(const real_vector_view &, const real_vector_view &);
+Complex dot(const complex_vector_view &, const complex_vector_view &);
+double  norm(const real_vector_view &);
+double  norm(const complex_vector_view &);
+
+real_vector    operator *(const real_matrix_view &, const real_vector_view &);
+complex_vector operator *(const complex_matrix_view &, const complex_vector_view &);
+real_matrix    operator *(const real_matrix_view &, const real_matrix_view &);
+complex_matrix operator *(const complex_matrix_view &, const complex_matrix_view &);
+
+real_vector    to_vector(const real_vector_view &);
+complex_vector to_vector(const complex_vector_view &);
+real_matrix    to_matrix(const real_matrix_view &);
+complex_matrix to_matrix(const complex_matrix_view &);
+
+// Solvers:
+
+int solve(real_vector_view x, const real_matrix_view & A, const real_vector_view & b);
+int solve(complex_vector_view x, const complex_matrix_view & A, const complex_vector_view & b);
+int solve(real_matrix_view X, const real_matrix_view & A, const real_matrix_view & B);
+int solve(complex_matrix_view X, const complex_matrix_view & A, const complex_matrix_view & B);
+
+real_vector    solve(const real_matrix_view & A, const real_vector_view & b);
+complex_vector solve(const complex_matrix_view & A, const complex_vector_view & b);
+
+// ************************************************************************
+#endif  /* MATVIEW_H */
@@ -63,10 +63,13 @@ public:
   // use the same junction devices following these operations, you should call
   // auto_balance(mixer::Always) to ensure that the junctions will be balanced
   // appropriately. It is also recommended that you call initialize_mode(1) to
-  // make harmonic balance calculations more robust.
+  // make harmonic balance calculations more robust. A copy can't be used on
+  // another thread; to balance at many operating points in parallel, see
+  // mixer_batch.h.
 
   mixer(const mixer &);
   mixer & operator = (const mixer &);
+  ~mixer();
 
 
   // Flags which indicate the readiness of the mixer to perform accurate
@@ -182,8 +185,8 @@ public:
                                 // performed. Will not correct
                                 // flag_balance_inaccurate().
 
-  int balance()                 // perform a harmonic balance, determining the
-  { return balance_(); }        // operating states of all junctions.
+  int balance();                // perform a harmonic balance, determining the
+                                // operating states of all junctions.
                                 // Returns 0 if successful, 1 if a balance could
                                 // not be achieved. Will correct
                                 // flag_balance_inaccurate() if successful.
@@ -241,6 +244,89 @@ public:
   { return balance_.iterations(); }  // recent harmonic balance.
 
 
+  // For mixers with many junctions (distributed arrays, series chains), the
+  // dense Jacobian of the harmonic balance, of size 2*J*(H+1) for J junctions
+  // and H harmonics, takes too long to factor and too much memory to hold.
+  // krylov_balance(1) instead finds each Newton step with restarted GMRES,
+  // which needs only products of the Jacobian with vectors; these are formed
+  // from the junctions' admittance matrices and the circuits' S matrices
+  // without building the Jacobian. GMRES is preconditioned by the inverses
+  // of the Jacobian's diagonal blocks (one per junction), and each step is
+  // found to a relative accuracy tol, which needn't be small: the balance
+  // tolerances still decide when the balance has converged.
+
+  mixer & krylov_balance(
+    int f,                // nonzero to use GMRES; 0 (the default) to factor
+    double tol = 1.0e-3,  // relative residual of each Newton step
+    int restart = 30      // the number of GMRES iterations between restarts
+    );
+
+  int krylov_iterations()      // the total number of GMRES iterations used by
+  { return balance_.krylov_iterations(); }  // the most recent harmonic balance.
+
+
+  // The number of harmonics needed depends on the operating point: a weakly
+  // pumped junction needs only one or two, while a strongly pumped one, or
+  // one poorly shorted by its capacitance, may need many more. After
+  // adaptive_harmonics(tol), balance() chooses the number itself. Once a
+  // balance is found, the voltages at the next harmonic are predicted from
+  // the junctions' currents and self-admittances there and the RF circuit;
+  // if they are larger than tol relative to the largest LO voltage, the
+  // harmonics are increased by one and the balance repeated, starting from
+  // the previous solution, up to max_harmonics. Harmonics whose voltages
+  // have decayed below tol are then dropped again. The junctions are also
+  // asked to truncate their internal series to tol/10 (see
+  // junction::tolerance()), so an sis junction keeps only the Ck it needs:
+  // its Ck().maxindex() reports how many were kept.
+  //
+  // harmonics() reports the number chosen by the latest balance, and
+  // truncation_error() the predicted relative size of the next one. Since
+  // the port numbers of the small signal analysis depend on harmonics(),
+  // use port() to find them after each balance. auto_balance() uses the
+  // adaptive mode too, if it is set.
+
+  mixer & adaptive_harmonics(
+    double tol,               // relative accuracy of the junction voltages;
+                              // 0 (the default) turns the adaptive mode off
+    int max_harmonics = 10    // the most harmonics balance() may choose
+    );
+
+  double truncation_error() const  // the estimated truncation error of the
+  { return trunc_err; }            // latest adaptive balance (0 if not adaptive)
+
+
+  // The IF and RF circuits' responses may be remembered, so that they needn't
+  // be recalculated at every balance and small signal analysis while only the
+  // junctions, the bias circuit or the balance terminators are changing. The
+  // IF and RF circuits are each given a cache (a memo_nport; see nport.h),
+  // shared by balance() and get_data(), which keeps their responses for each
+  // frequency and value of device::T and device::Z0. An expensive RF circuit is
+  // then only calculated once per LO harmonic and sideband frequency. The bias
+  // circuit is never cached, so bias sweeps need no special care.
+  //
+  // The caches can't see what the circuits depend on: every parameter of the
+  // IF and RF circuits which may change must be declared by hand with
+  // embedding_depends_on(), including those of any sources inside them (a
+  // cached response includes the source vector). Call clear_embedding_cache()
+  // after changing anything else about them. The balance terminators, which
+  // usually hold the LO source, are not cached.
+
+  mixer & cache_embedding(unsigned long n);  // keep up to n responses of each
+                                // linear circuit (0, the default, turns the
+                                // caches off). Previous responses are forgotten.
+
+  mixer & embedding_depends_on(const abstract_real_parameter &);
+  mixer & embedding_depends_on(const abstract_complex_parameter &);
+                                // add a parameter on which the linear circuits'
+                                // responses depend. It must exist as long as the
+                                // mixer does.
+
+  mixer & clear_embedding_cache();  // forget all remembered responses
+
+  unsigned long embedding_hits() const;    // the number of responses found in
+  unsigned long embedding_misses() const;  // the caches, or calculated
+
+
   // Results of the operating state calculations. The values returned are
   // obtained by calling the junctions' I() and V() member functions.  They
   // may not be accurate if flag_state_invalid() or flag_balance_inaccurate()
@@ -256,6 +342,26 @@ public:
                                 // at harmonic m.
 
 
+  // Direct detection without a harmonic balance. For weak sources at the LO
+  // frequency (eg an FTS measurement), the change in the junctions' DC
+  // currents is second order in the source amplitudes, and can be found
+  // from the unpumped junctions with only linear solutions: the LO
+  // voltages at the junctions, the currents they rectify (see
+  // junction::rectification()), and the redistribution of those currents
+  // by the bias circuit. The result is proportional to the source power.
+
+  Vector I_rectified(const Vector & V0);  // the change in the DC junction
+                                // currents caused by the balance terminators'
+                                // sources, as they are now set, from the
+                                // unpumped state with DC junction voltages
+                                // V0 (from V_junc(0) after a balance() with
+                                // the sources off). Leaves the junctions
+                                // unpumped at V0.
+
+  Vector I_rectified()          // the same, from the present DC voltages,
+  { return I_rectified(V_junc(0)); }  // which must be unpumped.
+
+
   // The normal small signal analysis results are returned by calling get_data() for
   // a mixer object. In addition, the following function is provided to aid in Y-factor
   // determinations:
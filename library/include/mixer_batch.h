@@ -0,0 +1,235 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ************************************************************************
+// mixer_batch.h
+//
+// class mixer_model: builds a complete mixer, and sets its operating point
+// class mixer_batch: balances a mixer at many operating points at once,
+//                    using several threads
+//
+// ************************************************************************
+// Using the mixer_batch class:
+//
+// A map of a mixer's performance over a grid of operating points (bias
+// voltage, LO power, LO frequency, ...) may take thousands of harmonic
+// balances, each followed by a small signal analysis. A mixer_batch does
+// these calculations on several threads at once, and returns the results
+// in the order the operating points were given.
+//
+// A mixer can't simply be copied for each thread: a copy made by
+// mixer(const mixer &) uses the same junctions and circuits as the
+// original, and nports keep their results from one calculation to the
+// next, so they can't be shared between threads. Instead, each thread
+// needs its own mixer built from its own junctions, circuits and
+// parameters. The user describes how to build one by deriving a class
+// from mixer_model, whose build() constructs a new, independent copy of
+// the model. For example:
+//
+//   class my_mixer : public mixer_model
+//   {
+//   public:
+//     my_mixer() : iv("iv.dat", "ikk.dat") { ... set up the mixer ... }
+//     mixer_model * build() const { return new my_mixer; }
+//     mixer & get_mixer() { return mix; }
+//     void set(const real_vector & x)
+//     { bias.source_voltage = x[1]; LO_source.source_power = x[2]; mix.LO = x[3]; }
+//     void parameters(std::vector<real_parameter *> & p)
+//     { p.push_back(&Rn); p.push_back(&tuner_length); }
+//   private:
+//     ivcurve iv;
+//     parameter Rn, tuner_length;
+//     sis_device sis;
+//     circuit rf, if, dc;
+//     ...
+//     mixer mix;
+//   };
+//
+//   my_mixer model;
+//   mixer_batch batch(model);
+//   for( ... every operating point ... ) batch.add(x);
+//   batch.run();
+//   for(int k = 0; k < batch.points(); ++k)
+//     if(batch[k].status == 0) ... batch[k].data.S[1][2] ...
+//
+// build() is called once by each thread, in that thread, and must not
+// return a model which shares any device with another. The model given to
+// the mixer_batch constructor (the prototype) is only used to build the
+// others, so it is not changed by run().
+//
+// Parameters and kept models:
+//
+// A model built from scratch has the parameter values its constructor
+// gives it, but the prototype's may have been changed since, eg by an
+// optimizer. The parameters which may change are listed by parameters(),
+// in the same order in every model; at the start of each run(), every
+// built model's listed parameters are set to the values of the
+// prototype's. Anything else which changes must be set by set().
+//
+// Normally each run() starts new threads, which build new models. If
+// keep_models() is set, the threads and their models are instead kept
+// from one run() to the next, until the mixer_batch is destroyed or the
+// number of threads changes, so that a model which is slow to build (eg
+// one reading IV data files) is only built once. Each kept model is only
+// ever used by the thread which built it (see below).
+//
+// Threads and the device globals:
+//
+// device::f, device::T and device::Z0 are separate in each thread (see
+// device.h). Each thread of a run() starts with them set to the values
+// (not any shadowing) they have in the calling thread, and they are not
+// changed in the calling thread. set() may change them, eg to set the IF
+// frequency of the small signal analysis from the operating point.
+//
+// Order and warm starts:
+//
+// A harmonic balance converges fastest when started from the balanced
+// state of a nearby operating point. The points are therefore calculated
+// in "snake" order: sorted by their first element, then (among points with
+// equal first elements) by their second, and so on, with the direction of
+// each sort alternating from one group to the next, so that each point
+// differs little from the one before it. The points should be arranged so
+// that their first element changes least often, eg (LO frequency, LO
+// power, bias) for a map of bias curves.
+//
+// The ordered points are divided into one contiguous run per thread. Each
+// thread works through its run, starting each balance from the state of
+// the previous point; a thread which finishes early takes the second half
+// of the largest run remaining to another thread, and starts the first
+// point of it from a fresh initial operating state (see
+// mixer::initialize_operating_state()). Since the warm start of a point
+// depends on which thread reaches it, results may differ from one run() to
+// the next, but only within the tolerances of the harmonic balance.
+//
+// If the same results are needed from every run(), eg to give an optimizer
+// a deterministic error function, call runs(n): the ordered points are
+// then split into fixed runs of n points, each started from a fresh
+// state, and the threads take whole runs in turn, without dividing them.
+// The results then don't depend on the number of threads or their timing,
+// at the cost of a cold start every n points.
+//
+// The results:
+//
+// After run(), batch[k] holds the results for the k'th point added:
+//   status     - the return of mixer::balance() (0 if it succeeded)
+//   iterations - mixer::balance_iterations()
+//   warm       - true if the balance started from another point's state
+//   currents   - the junctions' DC currents, from mixer::I_junc(0)
+//   state      - the balanced junction states, from
+//                mixer::save_operating_state(); these may be used with
+//                mixer::initialize_operating_state() to restore the
+//                balance in a serial calculation
+//   data       - the mixer's small signal response, from get_data(), if
+//                small_signal() is true (the default) and status is 0
+//
+// ************************************************************************
+
+#ifndef MIXER_BATCH_H
+#define MIXER_BATCH_H
+
+#include "mixer.h"
+#include "vector.h"
+#include <vector>
+
+
+// ************************************************************************
+// A complete mixer, with all the devices it uses. Derive from this class
+// to describe a mixer for mixer_batch.
+
+class mixer_model
+{
+public:
+
+  // Return a new mixer_model, built from scratch, which shares no devices
+  // with this one. The mixer_batch deletes it when it is finished.
+  virtual mixer_model * build() const = 0;
+
+  // The mixer of this model
+  virtual mixer & get_mixer() = 0;
+
+  // Set the operating point. x is a point given to mixer_batch::add().
+  virtual void set(const real_vector & x) = 0;
+
+  // Add the parameters whose values may be changed after the model is
+  // built to p, in the same order in every model (default: none).
+  virtual void parameters(std::vector<real_parameter *> &) { }
+
+  virtual ~mixer_model() { }
+};
+
+
+// ************************************************************************
+
+class mixer_batch
+{
+public:
+
+  // The model used to build one mixer_model per thread; it must exist
+  // during calls to run().
+  explicit mixer_batch(mixer_model & m);
+  ~mixer_batch();
+
+  // Add an operating point; it gets the next index, starting from 0.
+  mixer_batch & add(const real_vector & x);
+
+  // The number of operating points
+  int points() const { return int(x_.size()); }
+
+  // Forget all operating points and results
+  mixer_batch & clear();
+
+  // The number of threads to use (if 0, as many as the hardware supports)
+  mixer_batch & threads(unsigned n) { threads_ = n; return *this; }
+
+  // If false, only balance at each point, without a small signal analysis
+  mixer_batch & small_signal(bool f) { small_signal_ = f; return *this; }
+
+  // If nonzero, split the ordered points into fixed runs of n points, so
+  // that the results don't depend on the threads (default 0: divide the
+  // points between the threads as they go)
+  mixer_batch & runs(unsigned n) { runs_ = n; return *this; }
+
+  // If true, keep the threads and the models they build from one run() to
+  // the next (default false: build new ones for each run())
+  mixer_batch & keep_models(bool f);
+
+  // Balance the mixer at every point. Returns the number of points which
+  // failed to balance.
+  int run();
+
+  // The results at each point
+  struct result {
+    int status;
+    int iterations;
+    bool warm;
+    Vector currents;
+    Matrix state;
+    sdata data;
+    result() : status(1), iterations(0), warm(false) { }
+  };
+
+  // The results for point k (0 <= k < points()), once run() has been called
+  const result & operator[](int k) const { return results_[k]; }
+
+private:
+  mixer_model * model_;
+  std::vector<real_vector> x_;
+  std::vector<result> results_;
+  unsigned threads_;
+  unsigned runs_;
+  bool small_signal_;
+  bool keep_;
+  std::vector<double> values_;   // the prototype's parameters, for this run
+
+  class worklist;
+  class crew;
+  crew * crew_;   // the threads; kept between runs if keep_
+  void snake(std::vector<int> & order) const;
+  void work(worklist & w, unsigned t, mixer_model & m);
+
+  // no copies: the threads belong to this batch
+  mixer_batch(const mixer_batch &);
+  mixer_batch & operator=(const mixer_batch &);
+};
+
+#endif /* MIXER_BATCH_H */
@@ -28,15 +28,28 @@ private:
     balance_not_ok_flag = (num_junctions != 0);
   }
 
-  static unsigned global_mixer_index;  // used to detect multiple mixer circuits
+  static thread_local unsigned global_mixer_index;  // used to detect multiple mixer circuits
   int max_harmonics;                   // how many harmonics
   int num_junctions;                   // how many junctions
   double LO_saved;                     // the LO freq used at last balance time
   int balance_init_flag;               // if nonzero, balance() initializes states
   int auto_balance_flag;               // if nonzero, recalc() will call balance()
   int balance_not_ok_flag;             // something changed since last balance
+  double adapt_tol;                    // adaptive harmonics tolerance; 0 if off
+  int adapt_max;                       // most harmonics in the adaptive mode
+  double trunc_err;                    // error estimate of the latest balance
 
   nport *bias_circuit, *if_circuit, *rf_circuit;   // the linear circuit objects
+
+  unsigned long embed_cap;             // capacity of the embedding caches; 0 if off
+  std::vector<const abstract_real_parameter *> embed_rdeps;    // what the
+  std::vector<const abstract_complex_parameter *> embed_cdeps; // caches depend on
+  memo_nport *if_memo, *rf_memo;       // the caches, if on; the bias circuit,
+                                       // which holds the bias sources, has none
+  void make_memos();                   // (re)build the caches for the current circuits
+  void free_memos();
+  nport & if_embed()   { return (if_memo)   ? *if_memo   : *if_circuit; }
+  nport & rf_embed()   { return (rf_memo)   ? *rf_memo   : *rf_circuit; }
   std::vector <nport *> term;          // rf_circuit port terminators for balance
   std::vector<generator> default_term; // default Z0 terminators for RF circuit
   std::vector <junction *> junc;       // the junction objects
@@ -56,8 +69,15 @@ public:
   int operator()(); // Perform a harmonic balance of the mixer, using
                     // the current operating state as a starting point.
 
-  void i_state();   // initialize the junction operating states using
-                    // the linear circuit voltages, but do not balance
+  void i_state(const char * caller);
+                    // initialize the junction operating states using
+                    // the linear circuit voltages, but do not balance;
+                    // caller names the mixer function in any warning
+
+  void rectified(const Vector & V0, Vector & dI);
+                    // the second order change dI in the junction DC
+                    // currents caused by the sources at the LO frequency,
+                    // from the unpumped state with DC voltages V0
 
   inline void changed() { must_rebuild = 1; }
                     // tell balancer that the mixer circuit has
@@ -78,6 +98,18 @@ public:
   int iterations()  // the number of iterations required by the most recent
   { return iter; }  // balance operation.
 
+  balancer & krylov(int f, double tol, int restart);
+                    // if f is nonzero, find each Newton step with GMRES
+                    // rather than by factoring the Jacobian (see below)
+
+  int krylov_iterations()  // the number of GMRES iterations used by the
+  { return kiter; }        // most recent balance operation.
+
+  double next_harmonic();
+                    // predict the junction voltages at the harmonic above
+                    // those balanced; returns the largest, relative to the
+                    // largest LO voltage (0 if the junctions are unpumped)
+
 private:
   // member functions:
   void init();       // set up balancer to start the balance
@@ -118,6 +150,22 @@ private:
   void to_rep(real_vector & rep, const Vector & state, int n);
   void fm_rep(Vector & state, const real_vector & rep, int n);
 
+  // the matrix-free linear algebra, used when krylov_flag is set; calc()
+  // then fills Yb and Dinv rather than the Jacobian:
+  void newton_step(real_vector & p);   // GMRES, overrides newton's
+  void gradient(real_vector & g);      // overrides newton's
+  void jac_blocks();                   // fill Yb and Dinv
+  void jac_times(const real_vector & x, real_vector & y);           // Jacobian*x
+  void jac_transpose_times(const real_vector & x, real_vector & y); // x*Jacobian
+  void precondition(real_vector & x);  // x = inverse(diagonal blocks)*x
+
+  int krylov_flag, krylov_restart, kiter;
+  double krylov_tol;
+  std::vector<real_matrix> Yb;         // junction admittances, as real blocks
+  std::vector<real_matrix> Dinv;       // inverses of the Jacobian diagonal blocks
+  real_vector kz;                      // workspace
+  std::vector<complex> ka, kb;         // workspace
+
 }; // class mixer::balancer
 
 friend class mixer::balancer;
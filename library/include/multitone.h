@@ -0,0 +1,180 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ********************************************************************
+// multitone.h
+//
+// class multitone: the harmonic balance of SIS junctions driven by
+//                  several incommensurate tones at once
+//
+// ********************************************************************
+// Using the multitone class:
+//
+// The mixer class balances its junctions with the LO and its harmonics
+// alone; any other signal is treated as a small perturbation. To find
+// how a mixer saturates, or the level of its intermodulation products,
+// the LO and one or more signals must be balanced together. The junction
+// voltages and currents are then sums over the mixing products of the
+// tones: for tone frequencies f1, f2, ..., the product with orders
+// n = (n1, n2, ...) has frequency n1*f1 + n2*f2 + ... . A multitone
+// keeps the products with |n_t| <= H_t for each tone t (optionally also
+// limiting the total order |n1| + |n2| + ...), and of each pair n, -n
+// only the one with positive frequency, since the voltages and currents
+// are real.
+//
+// The junction currents are found in the time domain, on a grid of the
+// N-dimensional torus of tone phases: the junction's phase factor
+// exp(-i phi) is sampled there, transformed with FFTs to get its
+// spectrum (the multitone version of the Ck of a single tone), weighted
+// by the junction's ivcurve at the photon step voltages, and transformed
+// back. The grid size follows the tone amplitudes, so the work grows as
+// the number of grid points times its logarithm, rather than with the
+// number of photon step combinations times the number of products. The
+// Jacobian of the balance equations is found exactly the same way.
+//
+// The circuits are given as for a mixer: a bias circuit and an RF
+// circuit, whose first ports connect to the junctions, in the order they
+// were added. The RF circuit's other ports are terminated with the
+// balance terminators, which should include the sources of the tones,
+// or by Z0 resistors. If an IF circuit is also given, it replaces the
+// RF circuit for the products below a given frequency. For example:
+//
+//   multitone m;
+//   m.add_tone(&LO, 3).add_tone(&RF, 1);
+//   m.add_junction(sis).set_bias(bias).set_rf(rf).set_if(ifc, 20*GHz);
+//   m.set_balance_terminator(LO_source, 2).set_balance_terminator(RF_source, 3);
+//   m.balance();
+//   Complex Vif = m.V_junc(m.product(-1, 1))[1];  // the RF - LO product
+//
+// Only sis_basic_device junctions may be used; the tone frequencies must
+// not be commensurate with each other within the orders kept, since
+// products with the same frequency are treated as independent.
+// ********************************************************************
+
+#ifndef MULTITONE_H
+#define MULTITONE_H
+
+#include "circuit.h"
+#include "sources.h"
+#include "sisdevice.h"
+#include "newton.h"
+#include <vector>
+
+class multitone : private newton
+{
+public:
+
+  multitone();
+  ~multitone();
+
+  // The tones, each given by its frequency and the maximum order H to be
+  // kept; the first tone added is tone 1, and so on. A tone frequency may
+  // shadow a parameter, so that it can be swept.
+
+  multitone & add_tone(double f, int H);
+  multitone & add_tone(const abstract_real_parameter * f, int H);
+  int tones() const { return int(tone_f.size()); }
+
+  // Limit the total order |n1| + |n2| + ... of the products kept (0, the
+  // default, sets no limit beyond the orders of the tones).
+
+  multitone & max_order(int n);
+
+  // The junctions and circuits, as for a mixer. Products with frequencies
+  // below f_if use the IF circuit, if it has been set; its ports other
+  // than the junctions' are terminated by Z0 resistors.
+
+  multitone & add_junction(sis_basic_device &);
+  int junctions() const { return int(junc.size()); }
+  multitone & set_bias(nport &);
+  multitone & set_rf(nport &);
+  multitone & set_if(nport &, double f_if);
+  multitone & set_balance_terminator(nport &, int port);
+
+  // Perform the harmonic balance, starting from the previous solution if
+  // there is one for the same products, otherwise from the voltages the
+  // circuits would put across the junctions' normal resistances and
+  // capacitances. Returns 0 if successful.
+
+  int balance();
+  multitone & initialize_operating_state();  // forget the previous solution
+  int balance_iterations() const { return iter; }
+
+  multitone & balance_parameters(  // as for the mixer class (same defaults)
+    int max_iterations,
+    double tol_1,
+    double tol_m,
+    double tol_x,
+    double alpha
+    );
+
+  // The products of the most recent balance. Product 0 is DC; products
+  // 1 .. products()-1 have positive frequencies. order(k, t) is the order
+  // of tone t (1 .. tones()) in product k. product() finds the index of
+  // the product with the given orders, or of its negative, or returns -1
+  // if it wasn't kept.
+
+  int products() const { return int(freqs.size()); }
+  double freq(int k) const { return freqs[k]; }
+  int order(int k, int t) const { return orders[k][t-1]; }
+  int product(const std::vector<int> & n) const;
+  int product(int n1, int n2 = 0, int n3 = 0) const;
+
+  // The junction RMS voltages and currents at product k (DC at k = 0),
+  // indexed from 1 in the order the junctions were added.
+
+  Vector V_junc(int k) const;
+  Vector I_junc(int k) const;
+
+  // The number of points in the time grid used by the latest balance.
+
+  unsigned long grid_points() const;
+
+  // The currents of junction j at the products, given its voltages, both
+  // as vectors indexed by product (so index 0 is DC). Uses the products
+  // of the most recent balance; doesn't change the balance.
+
+  Vector junction_currents(int j, const Vector & V);
+
+private:
+  class response;                    // the time-domain calculation for a junction
+
+  std::vector<parameter> tone_f;     // the tone frequencies
+  std::vector<int> tone_h;           // and their maximum orders
+  int max_order_;
+
+  std::vector<sis_basic_device *> junc;
+  nport *bias_circuit, *if_circuit, *rf_circuit;
+  double f_if;
+  std::vector<nport *> term;           // rf circuit port terminators
+  std::vector<generator> default_term; // default Z0 terminators
+  std::vector<generator> if_term;      // Z0 terminators for the if circuit
+  circuit rf_temp, if_temp;            // the terminated circuits
+  int must_rebuild;                    // set when the circuits have changed
+
+  // the products, and the circuits' responses at each
+  std::vector< std::vector<int> > orders;
+  std::vector<double> freqs;
+  std::vector<sdata> linear;
+  std::vector<response *> resp;        // one per junction
+
+  // the solution, one row per junction, indexed by product
+  std::vector<Vector> V_, I_;
+  int iter;
+
+  void check() const;
+  void rebuild();
+  void find_products();
+  void fill_data();
+  void initial_voltages();
+  void calc();
+  int length() const { return 2*products() - 1; }  // unknowns per junction
+  void to_rep(real_vector & x, const Vector & V, int j) const;
+  void fm_rep(Vector & V, const real_vector & x, int j) const;
+
+  // no copying
+  multitone(const multitone &);
+  multitone & operator = (const multitone &);
+};
+
+#endif /* MULTITONE_H */
@@ -33,6 +33,12 @@
 //       "xlast", and set the control variable "maxstep" to some
 //       appropriate value.
 //
+// A derived class may instead leave "Jacobian" empty, if it can find
+// products of the Jacobian with vectors some other way. It must then set
+// "matrix_free" and override newton_step() and gradient(), which solve()
+// uses for its linear algebra; newton_step() may solve its equations only
+// approximately (an inexact Newton method).
+//
 // The user of the derived class can then:
 //
 //   (3) adjust the convergence control variables "max_iter", "f_tol",
@@ -77,6 +83,14 @@ protected:
   real_matrix Jacobian ;  // Jacobian matrix at X 
   double maxstep ;        // maximum step size in X
   int    solution_flag ;  // = 1 if solution not found; = 0 if found
+  int    matrix_free ;    // nonzero if calc() doesn't fill Jacobian    (0)
+
+  // The linear algebra of each iteration, using the results of the latest
+  // calc(): newton_step() finds the Newton-Raphson step p, which solves
+  // Jacobian*p = -fval, and gradient() finds g = fval*Jacobian, the
+  // gradient of norm(fval)/2. The defaults use the matrix Jacobian.
+  virtual void newton_step(real_vector & p) ;
+  virtual void gradient(real_vector & g) ;
 
 public:
   // these member variables control the root finder algorithm
@@ -10,6 +10,7 @@
  *   @li class device
  *   @li class nport
  *   @li class alias
+ *   @li class memo_nport
  *   @li class data_ptr_nport
  *
  * @author John Ward
@@ -25,7 +26,12 @@
 #include "port.h"
 #include "state_tag.h"
 #include "parameter.h"
+#include "parameter/abstract_complex_parameter.h"
 #include "sdata.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <vector>
 
 // **************************************************************************
 
@@ -94,6 +100,18 @@ protected:
    */
   virtual void recalc_S() { recalc(); }
 
+  /**
+   * The function for calculating sdata at several frequencies at once,
+   * called by get_batch() and get_batch_S(). batch has been sized and its
+   * frequencies set; recalc_batch() should fill in S and B at each of them,
+   * and C as well if noise is true, just as recalc() or recalc_S() would
+   * with device::f set to that frequency. It may change device::f, which
+   * get_batch() restores. The default does exactly that, calling
+   * get_data() or get_data_S() at each frequency; devices override it to
+   * avoid the overhead of calculating one frequency at a time.
+   */
+  virtual void recalc_batch(sdata_batch & batch, bool noise);
+
 public:
   /**
    * The default constructor.
@@ -157,6 +175,28 @@ public:
     return data;
   }
 
+  /**
+   * Calculate the nport data at each of the frequencies freq[0..n-1],
+   * storing the results in batch, which is resized as necessary. The
+   * results are the same as setting device::f to each frequency and
+   * calling get_data(), but are calculated more efficiently by devices
+   * which implement recalc_batch(). device::f is left unchanged.
+   *
+   * @param freq the frequencies
+   * @param n the number of frequencies
+   * @param batch holds the results
+   */
+  void get_batch(const double * freq, unsigned long n, sdata_batch & batch)
+  { calc_batch(freq, n, batch, true); }
+
+  /**
+   * Like get_batch(), but calculate only the S matrix and B vector
+   * parts of the data, as get_data_S() does. The noise correlation
+   * matrices in batch should be ignored.
+   */
+  void get_batch_S(const double * freq, unsigned long n, sdata_batch & batch)
+  { calc_batch(freq, n, batch, false); }
+
   /**
    * The number of ports this device has.
    *
@@ -231,6 +271,10 @@ public:
    */
   virtual v_index_mode mode() { return data.mode(); }  // sdata indexing mode
 
+private:
+  /** Sets up batch and calls recalc_batch() for get_batch(), get_batch_S(). */
+  void calc_batch(const double * freq, unsigned long n, sdata_batch & batch,
+		  bool noise);
 };
 
 // **************************************************************************
@@ -411,6 +455,91 @@ public:
 
 // **************************************************************************
 
+/**
+ * @class memo_nport
+ *
+ * Remembers the results of another nport, so it needn't be recalculated
+ * when it returns to an operating state it was in before.
+ *
+ * An optimizer's line searches and restarts often revisit combinations of
+ * parameter values which leave a large part of a circuit unchanged. If that
+ * part is made into a subcircuit and used through a memo_nport, then its
+ * results are looked up instead of recalculated on each revisit. The
+ * results are kept for each combination of device::f, device::T,
+ * device::Z0 and the values of the parameters named with depends_on(). The
+ * most recently used capacity() results are kept, so memory use is bounded.
+ *
+ * Like state_tag, a memo_nport is not intelligent: the original device
+ * must depend on nothing which changes other than f, T, Z0 and the
+ * parameters passed to depends_on(). Use clear() after changing anything
+ * else. A memo_nport is used in circuits just like an alias.
+ *
+ * Results calculated by get_data_S() are only used for later calls of
+ * get_data_S(); get_data() recalculates them with the noise.
+ */
+class memo_nport : public data_ptr_nport
+{
+public:
+  /**
+   * @param o the device whose results are remembered
+   * @param n the most results kept (see capacity())
+   */
+  memo_nport(nport & o, unsigned long n = 64);
+
+  /** Copies have the same original, capacity and dependencies, but no results. */
+  memo_nport(const memo_nport & m);
+  memo_nport & operator=(const memo_nport & m);
+
+  /**
+   * Add a parameter whose value the original's results depend on.
+   *
+   * @param p the parameter; it must exist as long as the memo_nport does
+   */
+  memo_nport & depends_on(const abstract_real_parameter & p);
+  memo_nport & depends_on(const abstract_complex_parameter & p);
+
+  /**
+   * Set the most results to keep. Least recently used results are
+   * discarded to make room for new ones. With a capacity of 0, the
+   * memo_nport just passes on the original's results.
+   */
+  memo_nport & capacity(unsigned long n);
+  unsigned long capacity() const { return cap; }
+
+  /** Forget all of the results, eg, if the original has been changed. */
+  memo_nport & clear();
+
+  /** The number of results kept, and the counts of lookups which found one or didn't. */
+  unsigned long entries() const { return cache.size(); }
+  unsigned long hits() const { return nhits; }
+  unsigned long misses() const { return nmisses; }
+
+  int size() { return original->size(); }
+  const nport::data_info & get_data_info() { return original->get_data_info(); }
+
+private:
+  struct entry {
+    uint64_t hash;
+    std::vector<double> key;  // f, T, Z0, then the parameter values
+    bool noise;               // false if only S and B were calculated
+    sdata data;
+  };
+
+  nport *original;
+  unsigned long cap, nhits, nmisses;
+  std::vector<const abstract_real_parameter *> rdeps;
+  std::vector<const abstract_complex_parameter *> cdeps;
+  std::list<entry> cache;  // most recently used first
+  std::multimap<uint64_t, std::list<entry>::iterator> index;  // by hash
+
+  void recalc()   { lookup(true); }
+  void recalc_S() { lookup(false); }
+  void lookup(bool noise);
+  void trim();
+};
+
+// **************************************************************************
+
 /**
  * @class simple_nport
  *
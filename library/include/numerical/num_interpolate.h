@@ -68,8 +68,7 @@ interpolator<Y_type> & interpolator<Y_type>::operator =
 template < class Y_type > inline 
 interpolator<Y_type> & interpolator<Y_type>::add(const double x, const Y_type & y)
 {
-  static data_type temp;             // declared static so allocation occurs once
-  temp.first = x, temp.second = y;
+  data_type temp(x, y);  // local, so that threads may build interpolators at once
 
   // invariants on entry to and exit from add():
   //   (1) data is sorted by x values, lowest x first, all x's unique
@@ -263,9 +262,8 @@ void interpolator<Y_type>::build_spline()
   //
   // This algorithm is a highly modified form of that in Numerical Recipes.
 
-  static std::vector<double> c;    // holds the -c[i]; static avoids reallocation,
-                                   // so multiple builds are faster
-  c.empty(); c.reserve(table.size());
+  std::vector<double> c(table.size());  // holds the -c[i]; local, so that
+                                        // threads may build splines at once
 
   unsigned long i;
   unsigned long last = table.size()-1;  // the last data element
@@ -14,6 +14,9 @@
 #define ABSTRACT_REAL_PARAMETER_H
 
 #include "SIScmplx.h"
+#include <atomic>
+
+class parameter_program;
 
 /**
  * This is a abstract class to define the interface that all
@@ -35,8 +38,37 @@ public:
   /** Allow automatic typecasting from abstract_real_parameter. */
   operator double() const {return get();}
 
+  /**
+   * Add the calculation of this parameter's value to a parameter_program,
+   * returning the index of its result. The default adds a step which just
+   * calls get() each time the program is run; subclasses which depend only
+   * on other parameters describe themselves in terms of those instead.
+   *
+   * @param p the program being compiled
+   * @return the index of the result in the program
+   */
+  virtual int compile(parameter_program & p) const;
+
+  /**
+   * A count of changes to the way parameters calculate their values (as
+   * opposed to changes of the values themselves): starting or stopping
+   * shadowing, changing bounds, etc. A parameter_program is compiled
+   * again whenever this count changes. The count is shared by all
+   * threads, which may change parameters concurrently.
+   *
+   * @return the number of such changes so far
+   */
+  static unsigned long structure() { return structure_count; }
+
   // virtual functions demand a virtual destructor:
   virtual ~abstract_real_parameter() { }
+
+protected:
+  /** Subclasses call this when their structure changes. */
+  static void restructured() { ++structure_count; }
+
+private:
+  static std::atomic<unsigned long> structure_count;
 };
 
 #endif /* ABSTRACT_REAL_PARAMETER_H */
@@ -0,0 +1,160 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// **************************************************************************
+/**
+ * @file parameter_program.h
+ *
+ * class parameter_program: evaluates a set of parameters together.
+ *
+ * A parameter which shadows or scales another, or which interpolates a
+ * table using another as its x value, calculates its value by calling
+ * get() on the parameters it depends on, which may in turn call others;
+ * every call of get() walks the whole chain through virtual function
+ * calls. A parameter_program instead "compiles" the chains of a set of
+ * parameters into a flat list of steps, sorted so that each step's
+ * inputs come before it, with steps shared by several chains done only
+ * once. Running the program calculates all the values at once, and only
+ * if some value at the root of the chains (a parameter holding its value
+ * locally) has changed since the last run.
+ *
+ * The values may be read from the program, or bound to real_parameters
+ * using bind(): each run then sets the bound parameters to their values.
+ * This is the way to take parameter chains out of the element
+ * calculations: the elements' own parameters hold plain values, which are
+ * updated by running the program once when the operating state changes,
+ * rather than evaluating every chain each time an element is calculated:
+ *
+ * <pre>
+ *   parameter_program prog;
+ *   prog.bind(r1.R, scaled_R).bind(l1.L, L_interp);
+ *   ...
+ *   prog.run();   // once per change of state, before calculating
+ * </pre>
+ *
+ * The program is compiled again automatically whenever any parameter
+ * changes the way it calculates its value (see
+ * abstract_real_parameter::structure()). All the parameters used must
+ * exist as long as the program does. Parameters whose values the program
+ * can't trace (function_real_parameter, real_interp tables, and any
+ * other subclass without its own compile()) are recalculated on every run.
+ *
+ * The compiled steps hold the addresses of the parameters' values. Since
+ * device::T, device::f and device::Z0 are thread_local, a program using
+ * them is bound to the copies belonging to the thread which compiled it:
+ * run it only in that thread, and give each worker thread a program of
+ * its own.
+ *
+ * The results are the same as calling get() on each parameter.
+ */
+// **************************************************************************
+
+#ifndef PARAMETER_PROGRAM_H
+#define PARAMETER_PROGRAM_H
+
+#include "parameter/abstract_real_parameter.h"
+#include "parameter/real_parameter.h"
+#include <vector>
+#include <map>
+
+class parameter_program
+{
+public:
+
+  parameter_program();
+
+  /**
+   * Add a parameter to be calculated.
+   *
+   * @param p the parameter
+   * @return the index of its value, for operator[]
+   */
+  int add(const abstract_real_parameter & p);
+
+  /**
+   * Add a parameter to be calculated, setting target to its value each
+   * time the program calculates.
+   *
+   * @param target the parameter to receive the value (its shadowing stops)
+   * @param p the parameter to calculate
+   */
+  parameter_program & bind(real_parameter & target, const abstract_real_parameter & p);
+
+  /**
+   * Calculate the values, if anything they depend on has changed.
+   *
+   * @return true if the values were recalculated
+   */
+  bool run();
+
+  /**
+   * The value of the i'th parameter added, as of the last run().
+   *
+   * @param i an index returned by add()
+   */
+  double operator[](int i) const { return val[outs[i]]; }
+
+  /** The number of steps in the compiled program (compiling if needed). */
+  int steps();
+
+  /** Forget all of the parameters. */
+  parameter_program & clear();
+
+
+  // The functions used by abstract_real_parameter::compile() to add steps;
+  // each returns the index of the step's result.
+
+  /** Compile the calculation of p, or find it if already compiled. */
+  int node(const abstract_real_parameter & p);
+
+  /** A value held in a variable. */
+  int leaf(const double & v);
+
+  /** A constant value. */
+  int constant(double v);
+
+  /** A value limited by bounds. */
+  int limit(int a, bool use_min, double min, bool use_max, double max);
+
+  /** A value times a constant factor. */
+  int scale(double s, int a);
+
+  /** f(obj, x), with x the value of step a; done on every run. */
+  int apply(double (*f)(const void * obj, double x), const void * obj, int a);
+
+  /** A value found by calling p.get(); done on every run. */
+  int call(const abstract_real_parameter & p);
+
+private:
+  enum op { LEAF, CONST, LIMIT, SCALE, APPLY, CALL };
+  struct step {
+    op code;
+    int a;                    // the input step
+    bool use_min, use_max;
+    double x, y;              // constant, scale factor, or bounds
+    const double * v;         // LEAF
+    double (*f)(const void *, double);  // APPLY
+    const void * obj;         // APPLY, CALL
+  };
+
+  std::vector<const abstract_real_parameter *> roots;   // in order of add()
+  std::vector<real_parameter *> targets;                // 0 if not bound
+
+  // the compiled program
+  bool compiled;
+  unsigned long structure;             // abstract_real_parameter::structure() when compiled
+  std::vector<step> prog;
+  std::vector<int> outs;               // the results of the roots
+  std::vector<int> leaves;             // the LEAF steps
+  bool always;                         // true if some step must be done every run
+  std::map<const abstract_real_parameter *, int> done;  // -1 while being compiled
+
+  // the results
+  bool valid;
+  std::vector<double> val;
+
+  int push(const step & s);
+  void compile();
+};
+
+#endif /* PARAMETER_PROGRAM_H */
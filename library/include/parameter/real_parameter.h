@@ -85,7 +85,7 @@ public:
    * @param v the new value for this parameter
    */
   real_parameter & set(double v)
-  { shadowed = 0; value = limit(v); return *this; }
+  { if(shadowed) restructured(); shadowed = 0; value = limit(v); return *this; }
 
   /**
    * Set this parameter to shadow another parameter. Bounds checking, if
@@ -112,10 +112,10 @@ public:
   real_parameter & set_max(double m);
 
   /** Turn of the min if desired. */
-  real_parameter & no_min() { use_min = false; min = 0.0; return *this; }
+  real_parameter & no_min() { restructured(); use_min = false; min = 0.0; return *this; }
 
   /** Turn of the max if desired. */
-  real_parameter & no_max() { use_max = false; max = 0.0; return *this; }
+  real_parameter & no_max() { restructured(); use_max = false; max = 0.0; return *this; }
 
   /** @return the minimum bound, or 0.0 if bound limiting not active */
   double get_min() const { return min; }
@@ -160,6 +160,14 @@ public:
    */
   real_parameter& operator =(const abstract_real_parameter * p);
 
+  /**
+   * Add this parameter's calculation to a parameter_program.
+   *
+   * @param p the program being compiled
+   * @return the index of the result in the program
+   */
+  int compile(parameter_program & p) const;
+
 private:
   /** Keep the value here if we aren't shadowing another parameter instance. */
   double value;
@@ -59,6 +59,14 @@ public:
    * @return the value of this parameter
    */
   double get() const;
+
+  /**
+   * Add this parameter's calculation to a parameter_program.
+   *
+   * @param p the program being compiled
+   * @return the index of the result in the program
+   */
+  int compile(parameter_program & p) const;
 };
 
 #endif /* SCALED_REAL_PARAMETER_H */
@@ -10,8 +10,8 @@
 #ifndef RADIALSTUB_H
 #define RADIALSTUB_H
 
-#include "circuit.h"
 #include "trlines.h"
+#include <vector>
 
 /**************************************************************\
 *                                                              *
@@ -28,8 +28,13 @@
 * The program will throw a fatal error if the radial stub      *
 * isn't larger than the transmission line feeding it.          *
 *                                                              *
+* The slices and the input line are calculated together using  *
+* microstrip::Kprop_Zchar(), then combined by multiplying      *
+* their chain (ABCD) matrices. The number of slices may be     *
+* changed using sections(); the default is 15.                 *
+*                                                              *
 \**************************************************************/
-class radial_stub: public data_ptr_nport
+class radial_stub: public nport
 {
 public:
   // Radius of stub in standard units
@@ -62,6 +67,10 @@ public:
   radial_stub & top_strip(surfimp & s);       /* top strip surface impedance */
   radial_stub & ground_plane(surfimp & s);   /* ground plane surface impedance */
 
+  // Set or get the number of annular slices (at least 1).
+  radial_stub & sections(int n);
+  int sections() const { return nsections; }
+
   // Radial stubs are 2 port devices.
   int size() { return 2; }
   
@@ -69,14 +78,17 @@ public:
   virtual ~radial_stub() { }
 
 private:
-  // Keep the circuit here.
-  circuit rs;
-
   // Number of sections used to simulate the stub.
   int nsections;
 
-  // Microstrip sections used to build the stub.
-  microstrip sec[16];
+  // The microstrip holding the materials, used to calculate all of the
+  // sections at once.
+  microstrip line;
+
+  // Section widths and lengths (the input line is section 0), and the
+  // propagation constants and characteristic impedances of the sections.
+  std::vector<double> w, len;
+  std::vector<Complex> kprop, zchar;
 
   // Pointers to dielectric objects
   dielectric *sub;
@@ -0,0 +1,160 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ********************************************************************
+// rational_nport.h
+//
+// class rational_nport: an nport whose S matrix is a rational function of
+// frequency, fitted to sampled S matrix data by vector fitting.
+//
+// An sdata_interp (see sdata_interp.h) interpolates its data between the
+// sample frequencies, with splines which may wander between points and
+// which know nothing of the physics. A rational_nport instead fits a
+// pole-residue model to the samples:
+//
+//   S(f) = D + Sum[k] R[k] / (s - p[k]),   s = j*2*Pi*f
+//
+// where the poles p[k] are common to all the elements of the matrix, and
+// the residue matrices R[k] and the constant matrix D are fitted to the
+// samples by least squares. The poles are found by the "vector fitting"
+// iteration of Gustavsen and Semlyen, starting from poles spread over the
+// band; unstable poles are reflected into the left half plane, so the
+// model is always stable. Poles come in complex conjugate pairs (or are
+// real), so the model has real impulse response. A lumped network with
+// m reactive elements is fitted exactly by m poles; distributed elements
+// need more, about 2 poles for each wavelength of line within the band.
+//
+// Once fitted, evaluating the model is a short sum over the poles, which
+// is much faster than recalculating a complicated circuit, and smooth
+// between the samples. This makes a rational_nport a good way to freeze a
+// subcircuit whose parameters aren't changing, eg the embedding circuit
+// of a mixer which is evaluated at every LO harmonic and IF sideband.
+//
+// Usage:
+//
+//   rational_nport fit(2);
+//   sweeper band;
+//   band.sweep(device::f, 1.0, 20.0, 0.25, GHz);
+//   fit.sample(my_circuit, band);     // or fit.touchstone("file.s2p")
+//   fit.fit(12);                      // with 12 poles
+//   if(fit.fit_error() > 1e-3) ...    // try more poles
+//   fit.enforce_passivity();          // if the data is from a passive device
+//
+// The noise of a rational_nport is the passive noise of its S matrix at
+// device::T, so the model should only be used for passive devices if
+// noise is needed. The model is normalized to the value of device::Z0 at
+// the time the first sample was added; it is renormalized to device::Z0
+// when calculated, as for sdata_interp.
+//
+// ********************************************************************
+
+#ifndef RATIONAL_NPORT_H
+#define RATIONAL_NPORT_H
+
+#include "nport.h"
+#include "sweeper.h"
+#include "sdata_interp.h"
+#include "parameter/abstract_real_parameter.h"
+#include <vector>
+
+class rational_nport : public nport
+{
+public:
+
+  // Construct with the number of ports and the parameter giving the
+  // frequency at which the model is evaluated.
+  explicit
+  rational_nport(int ports = 2, const abstract_real_parameter & f = device::f);
+
+  // Change the frequency parameter
+  rational_nport & parameter(const abstract_real_parameter & f) { pf = &f; return *this; }
+
+  // -------------------
+  // Add samples of the S matrix to be fitted. Returns false if there was a
+  // problem. fit() must be called again to include new samples.
+
+  // Add one sample. Zn is the normalization impedance of S, which will be
+  // renormalized if necessary; Zn is ignored if not positive.
+  rational_nport & add_S(double f, const Matrix & S, double Zn = device::Z0);
+  rational_nport & add_S(double f, const sdata & Sd);  // uses sdata's normalization
+
+  // Read the samples from a Touchstone-formatted file. Uses the frequency
+  // scale factor if none is given in the file's spec line.
+  bool touchstone(const char * name, double f_scale = GHz);
+
+  // Sample the S matrix of an nport at each point of a sweep. The sweeper
+  // should sweep the frequency parameter of this rational_nport.
+  bool sample(nport & np, sweeper & swp);
+
+  // The number of samples
+  int samples() const { return int(freqs.size()); }
+
+  // Forget all samples and the model
+  rational_nport & clear();
+
+  // -------------------
+  // Fit the model to the samples, using the given number of poles (if
+  // odd, one of them is real). iterations gives the most times the poles
+  // are relocated. Returns false if no model could be found.
+  bool fit(int poles, int iterations = 20);
+
+  // The number of poles in the model (0 if none)
+  int poles() const { return int(p.size()); }
+
+  // The pole k (0 <= k < poles()), in units of radians/sec; conjugate
+  // pairs are adjacent.
+  Complex pole(int k) const { return p[k]*w0; }
+
+  // The rms error of the model's S matrix elements at the samples.
+  double fit_error() const { return rms; }
+
+  // The largest singular value of the model's S matrix found at a dense
+  // grid of frequencies from 0 to the highest sample frequency. A passive
+  // model must not exceed 1. (The model is not constrained by the samples
+  // above the highest sample frequency, so it should not be used there.)
+  double passivity() const;
+
+  // Ensure that passivity() <= 1, by scaling the whole model down if
+  // necessary. This is only appropriate for a model of a passive device
+  // whose fit has small errors.
+  rational_nport & enforce_passivity();
+
+  // -------------------
+  // Evaluation
+
+  // true if a model has been fitted
+  bool ready() const { return fitted; }
+
+  // The model's S matrix at frequency f, normalized to Znorm()
+  Matrix response(double f) const;
+
+  // The normalization impedance of the model
+  double Znorm() const { return Zn_; }
+
+  const data_info & get_data_info() { info.active = false; return info; }
+
+private:
+  const abstract_real_parameter * pf;
+
+  // the samples, normalized to Zn_
+  double Zn_;
+  std::vector<double> freqs;
+  std::vector<Complex> Ssamples;   // N*N elements for each sample, row major
+
+  // the model, in terms of s/w0
+  double w0;                       // the frequency scale, radians/sec
+  std::vector<Complex> p;          // the poles
+  std::vector<Complex> R;          // N*N residues for each pole
+  std::vector<double> D;           // N*N constant terms
+  bool fitted;
+  double rms;
+  mutable std::vector<double> g_re, g_im;   // evaluate()'s 1/(s - p)
+
+  // write the model's S matrix at frequency f into S (N x N, Index_1)
+  void evaluate(double f, Matrix & S) const;
+
+  void recalc_S();
+  void recalc();
+};
+
+#endif /* RATIONAL_NPORT_H */
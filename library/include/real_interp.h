@@ -145,7 +145,7 @@ public:
   // parameter():
 
   real_interp & parameter(const abstract_real_parameter &xp)
-    { xparam = &xp ; return *this ; }
+    { xparam = &xp ; restructured() ; return *this ; }
 
 
   // file():
@@ -196,11 +196,18 @@ public:
   // get() implements the abstract interface declaration in the abstract_real_parameter
   // base class from which real_interp is derived.
 
+  // compile() lets a parameter_program find the x value itself, then
+  // interpolate; the interpolation is done each time the program is run,
+  // since the table may have changed.
+
+  int compile(parameter_program & p) const ;
+
 
 private:
   const abstract_real_parameter *xparam ;  // this parameter gives the x value
   phase_type phase ;
   double phase_adjust(double phase) const; // bring phase into -Pi, Pi range
+  static double at(const void * r, double x) ; // y(x), for parameter_program
   void construct(const real_matrix &rt, int xrow, int yrow) ;
 
 };
@@ -17,6 +17,7 @@
 
 #include "global.h"
 #include "device.h"
+#include <vector>
 
 class sdata ;
 class zdata ;
@@ -330,6 +331,92 @@ public:
 
 };
 
+// **************************************************************************
+
+/**
+ * @class sdata_batch
+ *
+ * sdata_batch holds the sdata of a device at a number of frequencies,
+ * as calculated by nport::get_batch(). The data are stored as a
+ * structure of arrays: each element of S, C and B has its own
+ * contiguous array of values, one for each frequency, so loops over
+ * frequency run through consecutive memory. Ports are indexed from 1,
+ * as in an sdata with the default Index_1 mode; the frequencies are
+ * indexed from 0:
+ * <pre>
+ *    b.freq(k)      // the k'th frequency
+ *    b.S(i,j)[k]    // S[i][j] at the k'th frequency
+ *    b.C(i,j)[k]    // C[i][j] at the k'th frequency
+ *    b.B(i)[k]      // B[i] at the k'th frequency
+ * </pre>
+ *
+ * A single normalizing impedance applies at all frequencies.
+ */
+class sdata_batch
+{
+public:
+  /** Construct an empty batch. */
+  sdata_batch() : z_norm(0.0), n(0), m(0) { }
+
+  /**
+   * Change the number of ports and frequencies. All data are set to 0.
+   *
+   * @param ports the number of ports
+   * @param points the number of frequencies
+   */
+  sdata_batch & resize(int ports, unsigned long points);
+
+  /** @return the number of ports */
+  int size() const { return n; }
+
+  /** @return the number of frequencies */
+  unsigned long points() const { return m; }
+
+  /** @return the k'th frequency */
+  double freq(unsigned long k) const { return f[k]; }
+
+  /** @return the array of frequencies */
+  double * freq() { return f.data(); }
+  const double * freq() const { return f.data(); }
+
+  /** @return the array of values of the element of S, C or B */
+  Complex * S(int i, int j) { return s.data() + ((i-1)*n + j-1)*m; }
+  Complex * C(int i, int j) { return c.data() + ((i-1)*n + j-1)*m; }
+  Complex * B(int i)        { return b.data() + (i-1)*m; }
+  const Complex * S(int i, int j) const { return s.data() + ((i-1)*n + j-1)*m; }
+  const Complex * C(int i, int j) const { return c.data() + ((i-1)*n + j-1)*m; }
+  const Complex * B(int i) const        { return b.data() + (i-1)*m; }
+
+  /** Get and set the normalization impedance. */
+  double get_znorm() const { return z_norm; }
+  sdata_batch & set_znorm(double z) { z_norm = z; return *this; }
+
+  /**
+   * Copy the data at the k'th frequency into sd, which is resized if
+   * necessary.
+   */
+  void get(unsigned long k, sdata & sd) const;
+
+  /**
+   * Store sd as the data at the k'th frequency. sd must have size()
+   * ports; its normalization impedance becomes that of the batch.
+   */
+  void set(unsigned long k, const sdata & sd);
+
+  /**
+   * Calculate the noise matrix at the k'th frequency for a passive
+   * element, as sdata::passive_noise() does.
+   */
+  sdata_batch & passive_noise(unsigned long k, double temp);
+
+private:
+  double z_norm;
+  int n;                       // ports
+  unsigned long m;             // frequencies
+  std::vector<double> f;
+  std::vector<Complex> s, c, b;
+};
+
 // **************************************************************************
 //
 // function compute_passive_noise
@@ -20,6 +20,54 @@
 #include "nport.h"
 #include "parameter/abstract_real_parameter.h"
 
+// ********************************************************************
+// class matrix_table_interp: a fast evaluator for a built interpolator<Matrix>
+//
+// interpolator<Matrix> keeps each point's Matrix (and its Y'' or slope
+// Matrix) as separate objects, and evaluates an interpolation using
+// whole-Matrix arithmetic with its temporaries. A matrix_table_interp
+// copies the points and coefficients of a built interpolator<Matrix> of
+// square, Index_1 matrices into a single contiguous array, with all the
+// values for a point (its N*N matrix elements followed by their N*N
+// coefficients) stored together, so an interpolation needs only a few
+// scalar weights and then a single pass over the entries of a segment. The
+// result is written directly into an existing Matrix, with no allocation.
+//
+// The results are those of the interpolator it was built from, including
+// the extrapolation behavior (and warnings). It is not updated if that
+// interpolator changes; call build() again.
+
+class matrix_table_interp
+{
+public:
+
+  matrix_table_interp() : N(0), type_(0), no_warn_(false) { }
+
+  // Copy the data of the interpolator, which must be ready() and hold
+  // square matrices of at least 1 x 1, Index_1. Otherwise the object is
+  // left empty, so that ready() is false.
+  matrix_table_interp & build(const interpolator<Matrix> & I);
+
+  // Forget any data.
+  matrix_table_interp & clear() { N = 0; x_.clear(); y_.clear(); return *this; }
+
+  bool ready() const { return N > 0; }
+  int size() const { return N; }      // the matrix dimension
+
+  // Write the interpolated value at x into M, which must be N x N (or
+  // larger), Index_1.
+  void operator()(double x, Matrix & M) const;
+
+private:
+  int N;                      // matrices are N x N
+  int type_;                  // interpolator<Matrix>::LINEAR or SPLINE
+  bool no_warn_;              // don't warn if extrapolating
+  std::vector<double> x_;     // the x values of the points
+  std::vector<Complex> y_;    // for each point: N*N Y, then N*N Y'' (or slope)
+  std::vector<Complex> ls_, rs_;  // the extrapolation slopes
+};
+
+
 // ********************************************************************
 // class S_interp: interpolate S and C matrix data; not an nport device
 
@@ -28,7 +76,7 @@ class S_interp
 public:
 
   explicit
-  S_interp(int ports = 2) : N(ports), Znorm_(0.0), noise_(false) { }
+  S_interp(int ports = 2) : N(ports), Znorm_(0.0), noise_(false), fast_(false) { }
 
 
   // ------------------------------------------------
@@ -42,6 +90,16 @@ public:
   // and noise data is available in the touchstone file.
   bool touchstone(const char * name, double f_scale = GHz);
 
+  // Load S (and C, if present) matrix data from the named SDATA bindata file
+  // (see bindata.h), replacing any data already added, and rebuild the
+  // interpolators. The matrices are read from the mapped file with no
+  // parsing or renormalization; Znorm() becomes the normalization given in
+  // the file. The interpolators keep their own copies of the points, so the
+  // file is no longer needed once binary() returns. Returns false, leaving
+  // the data unchanged, if the file could not be read or has the wrong
+  // number of ports.
+  bool binary(const char * name);
+
   // The function add_S() adds a single S matrix point to the S interpolator.
   // S must have the correct number of ports in order for it to be added.
   // Warns if S is improper. User must later call build() to have the
@@ -58,7 +116,7 @@ public:
   // incorporate the matrices added using add_S() and add_C() into the interpolation.
   // (Note that touchstone() automatically builds the interpolations, so you need not call
   // this function if the data comes from a call to touchstone())
-  S_interp & build() { if(Znorm_ != 0.0) {s.build(); if(noise_) c.build();} return *this; }
+  S_interp & build();
 
 
   // ------------------------------------------------
@@ -66,32 +124,38 @@ public:
 
   // interpolate S matrix.
   Matrix S(double f) const
-    { return s(f); }
+    { if(!fast_) return s(f); Matrix M(N); fs(f, M); return M; }
 
   // interpolate noise correlation (C) matrix. If no noise interpolation is available,
   // returns all zeroes.
   Matrix C(double f) const
-    { return (noise_) ? c(f) : Matrix(N); }
+    { if(!noise_) return Matrix(N); if(!fast_) return c(f); Matrix M(N); fc(f, M); return M; }
 
   // fill Sd.S and Sd.C, set Sd normalization to Znorm(). If no noise interpolation is
   // available, leaves Sd.C unmodified. Returns true if noise interpolation
-  // performed, false if only S matrix interpolated.
-  bool fill(sdata & Sd, double f) const
-    { Sd.S = s(f); if(noise_) Sd.C = c(f); Sd.set_znorm(Znorm_); return noise_; } 
+  // performed, false if only S matrix interpolated. If Sd has N ports with
+  // Index_1 indexing, the interpolated values are written directly into Sd.S
+  // and Sd.C, with no allocation.
+  bool fill(sdata & Sd, double f) const;
 
 
   // ------------------------------------------------
   // manage and manipulate the interpolations
 
   // Clear out all data and start over; number of ports unchanged
-  S_interp & clear() { Znorm_ = 0.0; noise_ = false; s.clear(); c.clear(); return *this; }
+  S_interp & clear()
+    { Znorm_ = 0.0; noise_ = fast_ = false; s.clear(); c.clear(); return *this; }
 
   // Clear out only noise data
-  S_interp & clear_noise() { noise_ = false; c.clear(); return *this; }
+  S_interp & clear_noise() { noise_ = false; c.clear(); fc.clear(); return *this; }
 
-  // Directly access the interpolators to set special options, etc.
-  interpolator<Matrix> & S_interpolator() { return s; }
-  interpolator<Matrix> & C_interpolator() { return c; }
+  // Directly access the interpolators to set special options, etc. The
+  // interpolations are then performed by the interpolators themselves
+  // (which is slower) until build() is next called.
+  interpolator<Matrix> & S_interpolator() { fast_ = false; return s; }
+  interpolator<Matrix> & C_interpolator() { fast_ = false; return c; }
+  const interpolator<Matrix> & S_interpolator() const { return s; }
+  const interpolator<Matrix> & C_interpolator() const { return c; }
 
 
   // ------------------------------------------------
@@ -116,7 +180,10 @@ private:
   int N;          // number of ports
   double Znorm_;  // normalization impedance
   bool noise_;    // interpolating noise values
+  bool fast_;     // fs and fc are current with s and c
   interpolator<Matrix> s, c;
+  matrix_table_interp fs, fc;  // fast evaluators built from s and c
+  void build_fast();
 };
 
 
@@ -161,6 +228,13 @@ public:
   bool touchstone(const char * name, double f_scale = GHz)
     { return S.touchstone(name, f_scale); }
 
+  // Load S (and, if available, C) matrix data from an SDATA bindata file
+  // (see bindata.h), replacing any data already loaded; see S_interp::binary().
+  // Returns false if the file could not be read or has the wrong number of
+  // ports.
+  bool binary(const char * name)
+    { return S.binary(name); }
+
   // Copy the provided interpolator into the object's internal interpolator.
   // The argument must have the correct number of ports.
   bool copy(const S_interp & source);
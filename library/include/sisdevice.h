@@ -19,6 +19,7 @@
 #include "global.h"
 #include "junction.h"
 #include "parameter.h"
+#include "fft.h"
 
 
 // ********************************************************************
@@ -73,6 +74,14 @@ public:
     ;
 
 
+  // The direct detection response, exactly, from the ivcurve: the second
+  // order change in the DC current when a small RMS voltage v at frequency
+  // f is added to the DC voltage, divided by |v|^2. The junction should be
+  // unpumped; this doesn't change its state.
+
+  double rectification(double f);
+
+
   // This function returns a flag which is nonzero if large_signal() has
   // never been called, or has not been called since one of the junction
   // parameters below has been changed.
@@ -80,10 +89,41 @@ public:
   int call_large_signal() const;
 
 
+  // The truncation tolerance of the Ck (see ckdata::tolerance() in
+  // junction.h); changing it requires a new call to large_signal().
+
+  void tolerance(double tol);
+  double tolerance() const { return C.tolerance(); }
+
+
+  // The method used by small_signal() and noise() to perform their sums
+  // over the photon steps k, which are correlations of the Ck with tables
+  // of the dc IV curve:
+  //
+  //   DIRECT    sums the terms for each matrix element separately. This
+  //             was the only method in earlier releases.
+  //   TOEPLITZ  groups the terms by the diagonal of the matrix, so each
+  //             product Ck*conj(Ck+d) is calculated only once; the sums are
+  //             then tight loops over contiguous arrays. There are
+  //             specialized versions for 1 to 4 harmonics.
+  //   FFT       calculates each row of the matrix at once using FFT-based
+  //             correlations; the work grows only linearly with the number
+  //             of harmonics, rather than quadratically.
+  //   AUTO      (the default) uses TOEPLITZ or FFT, whichever should be
+  //             faster for the number of harmonics and Ck.
+  //
+  // The methods differ only in rounding errors.
+
+  enum sum_method { DIRECT = 0, TOEPLITZ = 1, FFT = 2, AUTO = 3 };
+  sis_basic_device & method(sum_method m) { method_ = m; return *this; }
+  sum_method method() const { return method_; }
+
+
   // The characteristics of this junction.
 
   sis_basic_device & set_iv(const ivcurve & iv)
   { piv = &iv; iv_data_ok = 0; return *this; }
+  const ivcurve * get_iv() const { return piv; }
 
   parameter Vn, Rn;  // the normalizing voltage and resistance used in the ivcurve
 
@@ -112,6 +152,13 @@ private:
     I_pVIF, I_mVIF;
   Matrix Y, H;                   // filled by small_signal() and noise()
   double LO_freq, IF_freq;       // the values used to calculate I_VLO, etc.
+  sum_method method_;            // the method used for the Ck sums
+  fft_plan plan;                 // used by the FFT method
+
+  // calculate G[m][n] = sum(k) Ck*conj(Ck+m-n)*(W1[k+m] + W2[k-n]) using the
+  // TOEPLITZ or FFT method; the W arrays are indexed from -(C.Ck.maxindex()+h).
+  template <class T>
+  void ck_sums(const std::vector<T> & W1, const std::vector<T> & W2, int h, Matrix & G);
 };
 
 typedef sis_basic_device sis_device;
@@ -0,0 +1,89 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ********************************************************************
+// sparse_lu.h
+//
+// class sparse_lu: LU factorization of sparse complex matrices.
+//
+// A sparse_lu is used in three steps:
+//
+//   analyze()  takes the positions of the nonzero entries of an n x n
+//              matrix (the diagonal is always included). It chooses an
+//              elimination order which keeps the factors sparse (minimum
+//              degree) and finds the positions of all entries of the
+//              factors. This work depends only on the positions, so it is
+//              done once for a matrix whose values change.
+//   clear(), value()
+//              zero the values, then set them; value() takes an index
+//              returned by position(), so no searching is done.
+//   factor()   calculates the factors for the current values.
+//
+// solve() and solve_transpose() then solve A x = b or A^T x = b in place,
+// using the most recent factor(). The pivots are taken from the diagonal,
+// in the chosen order, without row exchanges, so a nonsingular matrix can
+// still meet a small or zero pivot. (In the matrix of a connected network,
+// see class circuit, the diagonal entry of a port connected to another
+// port of its own device is 1 - S[a][b], which vanishes if S[a][b] == 1.)
+// factor() returns false if any pivot is smaller than pivot_threshold
+// times the largest entry of its row, before or after elimination; the
+// solution is then unreliable and should be found some other way. A pivot
+// smaller than Tiny (global.h) is replaced by Tiny, as class connection
+// does, so an ill-conditioned matrix gives large results, not a crash.
+//
+// All indexes are 0-based.
+// ********************************************************************
+
+#ifndef SPARSE_LU_H
+#define SPARSE_LU_H
+
+#include "SIScmplx.h"
+#include <vector>
+#include <utility>
+
+class sparse_lu
+{
+public:
+
+  sparse_lu() : n(0) { }
+
+  // Choose the elimination order and find the pattern of the factors of
+  // an n x n matrix with nonzero entries at the (row, column) positions
+  // in entries. Repeated positions are allowed.
+  void analyze(int n, const std::vector< std::pair<int,int> > & entries);
+
+  // The matrix size, and the number of entries stored in the factors.
+  int size() const { return n; }
+  unsigned long entries() const { return val.size(); }
+
+  // The index of the entry at (row i, column j), for use with value().
+  // Returns -1 if that entry is not in the pattern.
+  int position(int i, int j) const;
+
+  // Set all values to zero; then refer to them using value().
+  void clear();
+  Complex & value(int pos) { return val[pos]; }
+
+  // Factor the matrix, replacing the values with those of the factors.
+  // Returns false if some pivot was too small for a stable solution.
+  bool factor();
+
+  // The smallest acceptable pivot, relative to the entries of its row.
+  static const double pivot_threshold;
+
+  // Solve A x = b or A^T x = b, with b in x on entry.
+  void solve(Complex * x) const;
+  void solve_transpose(Complex * x) const;
+
+private:
+  int n;
+  std::vector<int> perm;       // perm[k] is the row/column eliminated k'th
+  std::vector<int> iperm;      // the inverse of perm
+  std::vector<int> start;      // row k of the factors is start[k] .. start[k+1]-1
+  std::vector<int> col;        // the (permuted) columns, ascending in each row
+  std::vector<int> diag;       // the index of the diagonal entry of each row
+  std::vector<Complex> val;    // the values: L below diag (unit diag), U from diag
+  mutable std::vector<Complex> work;
+};
+
+#endif /* SPARSE_LU_H */
@@ -97,7 +97,9 @@ private:
   unsigned long tag;
 
   // This counter keeps incrementing every time get_tag() is called.
-  static unsigned long current_state;
+  // Each thread has its own, so tags are only unique within a thread;
+  // devices must not be shared between threads (see mixer_batch.h).
+  static thread_local unsigned long current_state;
 
 };
 
@@ -30,11 +30,14 @@
 #include "global.h"
 #include "units.h"
 #include "matmath.h"
+#include "matview.h"
 #include "error.h"
 #include "io.h"
 #include "datafile.h"
+#include "bindata.h"
 #include "parameter.h"
 #include "parameter/complex_parameter.h"
+#include "parameter/parameter_program.h"
 #include "sdata.h"
 #include "real_interp.h"
 #include "complex_interp.h"
@@ -57,6 +60,7 @@
 #include "radial_stub.h"
 #include "antenna.h"
 #include "sdata_interp.h"
+#include "rational_nport.h"
 #include "via.h"
 #include "deembed.h"
 
@@ -69,9 +73,12 @@
 #include "junction.h"
 #include "sisdevice.h"
 #include "mixer.h"
+#include "mixer_batch.h"
+#include "multitone.h"
 
 // Optimizer stuff
 #include "sweeper.h"
+#include "adaptive_sweeper.h"
 #include "optimizer.h"
 #include "error_terms.h"
 #include "error_func.h"
@@ -83,12 +83,26 @@
 //  
 //   my_sweeper s;
 //
+//
+// Measurements and weights:
+//
+// A sweeper may also choose its points according to results calculated at
+// the points it has already visited (see adaptive_sweeper.h). For such
+// sweepers, class error_func calls measure() with the state_tag it used to
+// calculate its error terms at each point, so that the sweeper's own
+// calculations can share the results. Points which are not evenly spaced
+// also need different weights in an average over the sweep; if weighted()
+// is true, then once the sweep is finished weight(k) gives the weight of
+// the k'th point visited since reset(). The weights add up to npoints().
+// For the plain sweeper, measure() does nothing and every weight is 1.
+//
 // ************************************************************************
                                                                           
 #ifndef SWEEPER_H
 #define SWEEPER_H
 
 #include "parameter/real_parameter.h"
+#include "state_tag.h"
 #include <vector>        // STL vector template class
 #include <list>          // STL linked list template class
 #include "vector.h"      // SuperMix numerical vector classes
@@ -156,7 +170,7 @@ public:
 
   // This gives the number of points in the grid over with this sweeper
   // sweeps. Always returns at least 1, even if no sweeps defined.
-  int npoints() { return num_values; }
+  virtual int npoints() { return num_values; }
 
   // This static function gives the max allowed number of points in the sweep.
   // The max may be be changed by using the form with an argument
@@ -168,18 +182,27 @@ public:
 
   // reset() - start parameter values at the beginning. Always call this
   // function first when you start a sweep of the parameters.
-  void reset() ;
+  virtual void reset() ;
 
   // increment operators -- go to next set of parameter values
   // in the sweep
-  sweeper & operator ++(int);
+  virtual sweeper & operator ++(int);
   sweeper & operator ++() {return((*this)++);}
 
   // finished() goes true when a call to ++ wraps all parameter values
   // back to their starting values; it is reset to false by a call to
   // reset(). Calls to ++ when finished() is true generate a warning
   // message and leave the parameter values unchanged.
-  bool finished() {return alldone;}
+  virtual bool finished() {return alldone;}
+
+  // measure() is called by error_func at each point of the sweep, with
+  // the state_tag used for the calculations at that point. weighted()
+  // is true if the points of a finished sweep should be averaged using
+  // weight(k) for the k'th point (k = 0, ..., npoints()-1) rather than
+  // equally. See the notes above.
+  virtual void measure(state_tag) { }
+  virtual bool weighted() const { return false; }
+  virtual double weight(int) const { return 1.0; }
 
   // Derive a class from sweeper and define a useful version of this
   // function there if you need to perform some additional set up tasks
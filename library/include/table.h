@@ -336,6 +336,20 @@
 // real_matrix A(D);     Construct a real_matrix which is a copy of the
 //                       data matrix in the datafile class object D.
 //
+// *_matrix A(p,n,m,tl,tr); Construct a matrix which aliases a preexisting
+//                       block of memory starting at pointer p (a double *
+//                       for a real_matrix, a Complex * for a complex_matrix),
+//                       rather than allocating its own. The block must hold
+//                       all of the data elements of a matrix constructed
+//                       with A(n,m,tl,tr), laid out row after row. No data
+//                       is copied or initialized, and the block is not
+//                       deleted when A is destroyed, so it must outlive A.
+//                       If A is later reallocated (eg: by reallocate() or
+//                       by operator =), A gets its own memory and no
+//                       longer aliases the block. This constructor allows
+//                       data already in memory, such as a memory-mapped
+//                       file (see bindata.h), to be used as a matrix.
+//
 // To reallocate the memory or change the indexing modes of an existing
 // matrix object, the resize and reallocate member functions are
 // provided. When a matrix is reallocated, it copies the maximum amount of
@@ -662,6 +676,12 @@ public:
       Lmode(internal_Lmode), Rmode(internal_Rmode)
   { construct(n, m, tl, tr); constfill(0.0); }
 
+  real_matrix(double *const p, const int n, const int m,
+	     const v_index_mode tl, const v_index_mode tr)
+    : Lsize(internal_Lsize), Rsize(internal_Rsize), 
+      Lmode(internal_Lmode), Rmode(internal_Rmode)
+  { construct(n, m, tl, tr, p); }
+
   real_matrix(const real_matrix & B);
   real_matrix(const real_vector & v);
   real_matrix(const datafile & D);
@@ -834,7 +854,8 @@ private:
   // these functions are called by other member functions:
   void construct(const int n, const int m,
 		 const v_index_mode tl,
-		 const v_index_mode tr);  //allocate memory
+		 const v_index_mode tr,
+		 double *const block = 0);  //allocate memory, or alias block
   void constfill(const double f); // fill with a constant value
 
 };  // class real_matrix 
@@ -883,6 +904,12 @@ public:
       Lmode(internal_Lmode), Rmode(internal_Rmode)
   { construct(n, m, tl, tr); constfill(0.0); }
 
+  complex_matrix(Complex *const p, const int n, const int m,
+	     const v_index_mode tl, const v_index_mode tr)
+    : Lsize(internal_Lsize), Rsize(internal_Rsize), 
+      Lmode(internal_Lmode), Rmode(internal_Rmode)
+  { construct(n, m, tl, tr, p); }
+
   complex_matrix(const complex_matrix & B);
   complex_matrix(const real_matrix & B);
   complex_matrix(const real_vector & v);
@@ -1078,7 +1105,8 @@ private:
   // these functions are called by other member functions:
   void construct(const int n, const int m,
 		 const v_index_mode tl,
-		 const v_index_mode tr);  //allocate memory
+		 const v_index_mode tr,
+		 Complex *const block = 0);  //allocate memory, or alias block
   void constfill(const Complex f); // fill with a constant value
 
 };  // class complex_matrix 
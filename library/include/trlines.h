@@ -149,6 +149,18 @@
 //    complex Zser(f,T);  // series impedance at freq f and Temp T
 //    complex Ypar(f,T);  // parallel admittance at freq f and Temp T
 //
+// Several lines which differ only in their widths (such as the sections
+// of a tapered line or a radial_stub) may be calculated together using:
+//
+//    Kprop_Zchar(n, w, f, T, k, z);
+//
+// which sets k[i] and z[i] to the propagation constant and characteristic
+// impedance of a line of width w[i], i = 0..n-1, with the materials and
+// substrate thickness of this microstrip; its own width is ignored. The
+// dielectric constants and surface impedances are found only once for all
+// n lines, and the width-dependent parts of the calculation are saved, so
+// they are repeated only if the widths, thicknesses or dielectrics change.
+//
 // Attempting to calculate the electrical characteristics of a microstrip
 // with unphysical or uninitialized properties will result in a fatal
 // error, with one exception: if the length of the strip is 0, then its
@@ -366,6 +378,7 @@
 #include "parameter.h"
 #include "parameter/complex_parameter.h"
 #include "nport.h"
+#include <vector>
 
 
 // ************************************************************************
@@ -445,6 +458,14 @@ protected:
   // will always be the result, regardless of beta, zchar, znorm.
   void calc(Complex beta, Complex zchar, double length, double znorm) ;
 
+  // The same, but storing the S matrix at the k'th frequency of a batch.
+  // It should be called by recalc_batch() in subclasses of trl_base.
+  void calc(sdata_batch & batch, unsigned long k,
+	    Complex beta, Complex zchar, double length, double znorm) const ;
+
+  // Calculate S11 == S22 and S12 == S21 for either version of calc().
+  static void line_S(Complex beta, Complex zchar, double length, double znorm,
+		     Complex & s11, Complex & s12) ;
 
 };
 
@@ -493,6 +514,11 @@ public:
   // Return series impedance and shunt admittance
   Complex Zser(double freq, double T);
   Complex Ypar(double freq, double T);
+
+  // Return propagation constants and characteristic impedances for n
+  // lines of widths w[0..n-1] (see the notes above)
+  void Kprop_Zchar(int n, const double * w, double freq, double T,
+		   Complex * kprop, Complex * zc);
   
   // microstrips are "active" noise sources if not at device::T
   const nport::data_info & get_data_info()
@@ -515,12 +541,20 @@ protected:
   // This function manages the recalculation of the microstrip
   void update(double freq, double Temp);
 
+  // Called by update() and Kprop_Zchar() to set all of i_param except the
+  // width, calling mstrip1() and mstrip2() as needed. Returns the number of
+  // the first of mstrip3() .. mstrip5() which must then be called (6 if
+  // none need be).
+  int set_params(double freq, double Temp);
+
   // These functions perform the numerical calculations and are called
   // by update().
   void mstrip1();  // calculate members of m1
   void mstrip2();  // calculate members of m2
   void mstrip3();  // calculate members of m3 and m4
-  void mstrip4();  // calculate members of m4
+  void mstrip4();  // calculate members of m4 and m4f
+  void mstrip4f(); // calculate members of m4f (called by mstrip4())
+  void mstrip4w(); // calculate members of m4 (called by mstrip4())
   void mstrip5();  // calculate zchar, beta, Zs and Yp
 
   // make sure to call update() before trusting these
@@ -542,6 +576,8 @@ protected:
   void recalc()
     { recalc_S(); data.passive_noise(device::f,Temp); }
 
+  void recalc_batch(sdata_batch &, bool);
+
   // input parameters to calculations 
   struct { double  h, w, t1, esub, tdsub, eup, tdup, freq;
            Complex Esubc, Eupc, Ztop, Zground; }
@@ -556,12 +592,24 @@ protected:
   m2;
 
   // m3 affected by m1, m2, and top width
-  struct { double u, ee0, p1a, p3a, g1; }
+  struct m3_data { double u, ee0, p1a, p3a, g1; }
   m3;
 
   // output results from mstrip3() and mstrip4() calculations
   struct { double Z0, epeff, tandel, g2strip, g2ground; }
   m4;
+
+  // the parts of the mstrip4() calculations which don't depend on width
+  struct { double fn, p1f, p3f; }
+  m4f;
+
+  // incremented whenever mstrip1() or mstrip2() is called by set_params()
+  unsigned long geometry;
+
+  // the mstrip3() results for the widths used by Kprop_Zchar()
+  struct width_data { double w; m3_data m3; double g2strip, g2ground; };
+  std::vector<width_data> widths;
+  unsigned long widths_geometry;  // value of geometry when widths was filled
 } ;
 
 inline Complex microstrip::Zser(double freq, double T)
@@ -665,6 +713,8 @@ private:
   void recalc()
     { recalc_S(); data.C = 0.0; }  // noiseless
 
+  void recalc_batch(sdata_batch &, bool);
+
 } ;
 
 inline Complex cpw::Kprop(double freq, double T)
@@ -744,6 +794,8 @@ private:
       
   void recalc()
     { recalc_S(); data.C = 0.0; }  // noiseless
+
+  void recalc_batch(sdata_batch &, bool);
 };
 
 inline Complex r_waveguide::Kprop(double freq, double T)
@@ -820,6 +872,8 @@ private:
   void recalc()
     { recalc_S(); data.passive_noise(device::f,Temp); }
 
+  void recalc_batch(sdata_batch &, bool);
+
 };
 
 #endif  // TRLINES_H
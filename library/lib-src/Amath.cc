@@ -26,26 +26,12 @@ void Ascale( Complex dest[], double s, int len )
   while (d != dest) *(--d) *= s;
 }
 
-void Ascale( Complex dest[], Complex s, int len )
-{
-  /*register*/ Complex * d = dest + len;
-  while (d != dest) *(--d) *= s;
-}
-
 void Ascale( double dest[], double s, int len )
 {
   /*register*/ double * d = dest + len;
   while (d != dest) *(--d) *= s;
 }
 
-void Aadd( Complex *dest, const Complex *source, int len )
-{
-  /*register*/ Complex * d = dest + len;
-  /*register*/ const Complex * s = source + len;
-
-  while (d != dest) *(--d) += *(--s);
-}
-
 void Aadd( double *dest, const double *source, int len )
 {
   /*register*/ double * d = dest + len;
@@ -62,14 +48,6 @@ void Aadd( Complex *dest, const double *source, int len )
   while (d != dest) *(--d) += *(--s);
 }
 
-void Asub( Complex *dest, const Complex *source, int len )
-{
-  /*register*/ Complex * d = dest + len;
-  /*register*/ const Complex * s = source + len;
-
-  while (d != dest) *(--d) -= *(--s);
-}
-
 void Asub( double *dest, const double *source, int len )
 {
   /*register*/ double * d = dest + len;
@@ -86,14 +64,6 @@ void Asub( Complex *dest, const double *source, int len )
   while (d != dest) *(--d) -= *(--s);
 }
 
-void Ascalesub( Complex *dest, const Complex *source, Complex scale, int len )
-{
-  /*register*/ Complex * d = dest + len;
-  /*register*/ const Complex * s = source + len;
-
-  while (d != dest) *(--d) -= ((*(--s)) * scale);
-}
-
 void Ascalesub( double *dest, const double *source, double scale, int len )
 {
   /*register*/ double * d = dest + len;
@@ -103,16 +73,6 @@ void Ascalesub( double *dest, const double *source, double scale, int len )
   while (d != dest) *(--d) -= ((*(--s)) * rs);
 }
 
-Complex Adot( const Complex *a1, const Complex *a2, int len )
-{
-  /*register*/ const Complex * ra1 = a1 + len;
-  /*register*/ const Complex * ra2 = a2 + len;
-  Complex sum(0.0);
-
-  while (ra1 != a1) sum += (conj(*(--ra1)) * (*(--ra2)));
-  return sum;
-}
-
 double Adot( const double *a1, const double *a2, int len )
 {
   /*register*/ const double * ra1 = a1 + len;
@@ -160,3 +120,529 @@ void Aapply( double a[], double (* f)(const double &), int len)
 }
 
 
+// ********************************************************************
+// The Complex array kernels
+//
+// A Complex is a pair of doubles (real, imaginary), so an array of
+// Complex is an array of interleaved doubles, which the x86 vector units
+// handle directly: one Complex per SSE2 register, two per AVX2 register
+// and four per AVX-512 register. A set of kernels for each is compiled
+// here using the target attribute, and the widest set the processor
+// supports is chosen at run time, on first use.
+//
+// Products and quotients are formed with exactly the operations of the
+// Complex operators of SIScmplx.h, and without fused multiply-adds, so
+// all but the dot products give the same results as the scalar loops,
+// bit for bit. The dot products keep a partial sum in each vector lane,
+// so they may differ from the scalar sums in the last bits.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AMATH_SIMD
+#include <immintrin.h>
+// the scalar kernels finish the tails of the vector kernels; they mustn't
+// be inlined there, where they would be compiled for the wider target,
+// and the AVX kernels clear the upper halves of the registers before
+// calling them, to avoid the penalty of mixing AVX with SSE instructions
+#define AMATH_SCALAR static __attribute__((noinline))
+#else
+#define AMATH_SCALAR static
+#endif
+
+#include <cstring>
+
+struct complex_kernels {
+  const char * name;
+  void (*add)(Complex *, const Complex *, int);
+  void (*sub)(Complex *, const Complex *, int);
+  void (*mul)(Complex *, const Complex *, int);
+  void (*div)(Complex *, const Complex *, int);
+  void (*scale)(Complex *, Complex, int);
+  void (*scalesub)(Complex *, const Complex *, Complex, int);
+  Complex (*dot)(const Complex *, const Complex *, int, int);  // last: conjugate?
+};
+
+// --------------------------------------------------------------------
+// scalar kernels
+
+AMATH_SCALAR void scalar_add( Complex *dest, const Complex *source, int len )
+{
+  /*register*/ Complex * d = dest + len;
+  /*register*/ const Complex * s = source + len;
+
+  while (d != dest) *(--d) += *(--s);
+}
+
+AMATH_SCALAR void scalar_sub( Complex *dest, const Complex *source, int len )
+{
+  /*register*/ Complex * d = dest + len;
+  /*register*/ const Complex * s = source + len;
+
+  while (d != dest) *(--d) -= *(--s);
+}
+
+AMATH_SCALAR void scalar_mul( Complex *dest, const Complex *source, int len )
+{
+  /*register*/ Complex * d = dest + len;
+  /*register*/ const Complex * s = source + len;
+
+  while (d != dest) *(--d) *= *(--s);
+}
+
+AMATH_SCALAR void scalar_div( Complex *dest, const Complex *source, int len )
+{
+  /*register*/ Complex * d = dest + len;
+  /*register*/ const Complex * s = source + len;
+
+  while (d != dest) { --d; *d = *d / *(--s); }
+}
+
+AMATH_SCALAR void scalar_scale( Complex dest[], Complex s, int len )
+{
+  /*register*/ Complex * d = dest + len;
+  while (d != dest) *(--d) *= s;
+}
+
+AMATH_SCALAR void scalar_scalesub( Complex *dest, const Complex *source, Complex scale, int len )
+{
+  /*register*/ Complex * d = dest + len;
+  /*register*/ const Complex * s = source + len;
+
+  while (d != dest) *(--d) -= ((*(--s)) * scale);
+}
+
+AMATH_SCALAR Complex scalar_dot( const Complex *a1, const Complex *a2, int len, int conjugate )
+{
+  /*register*/ const Complex * ra1 = a1 + len;
+  /*register*/ const Complex * ra2 = a2 + len;
+  Complex sum(0.0);
+
+  if (conjugate)
+    while (ra1 != a1) sum += (conj(*(--ra1)) * (*(--ra2)));
+  else
+    while (ra1 != a1) sum += ((*(--ra1)) * (*(--ra2)));
+  return sum;
+}
+
+static const complex_kernels scalar_kernels = {
+  "scalar", scalar_add, scalar_sub, scalar_mul, scalar_div,
+  scalar_scale, scalar_scalesub, scalar_dot
+};
+
+// combine the partial sums of the vector dot products, adding in the
+// sums over the tail elements: p[] accumulated a*b lane by lane, q[] a
+// times b with its real and imaginary parts swapped; n is their length
+static Complex dot_sum( const double *p, const double *q, int n,
+			const Complex *a1, const Complex *a2, int len, int conjugate )
+{
+  double p0 = 0.0, p1 = 0.0, q0 = 0.0, q1 = 0.0;
+  for (int i = 0; i < n; i += 2) {
+    p0 += p[i]; p1 += p[i+1]; q0 += q[i]; q1 += q[i+1];
+  }
+  for (int i = 0; i < len; ++i) {
+    p0 += a1[i].real * a2[i].real;       p1 += a1[i].imaginary * a2[i].imaginary;
+    q0 += a1[i].real * a2[i].imaginary;  q1 += a1[i].imaginary * a2[i].real;
+  }
+  return conjugate ? Complex(p0 + p1, q0 - q1) : Complex(p0 - p1, q0 + q1);
+}
+
+#ifdef AMATH_SIMD
+
+// --------------------------------------------------------------------
+// SSE2: one Complex per register
+
+#define AMATH_TARGET __attribute__((target("sse2")))
+
+AMATH_TARGET static inline __m128d sse2_cmul( __m128d a, __m128d b )
+{
+  // (ar*br - ai*bi, ai*br + ar*bi)
+  __m128d t1 = _mm_mul_pd(a, _mm_unpacklo_pd(b, b));
+  __m128d t2 = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(b, b));
+  return _mm_add_pd(t1, _mm_xor_pd(t2, _mm_set_pd(0.0, -0.0)));
+}
+
+AMATH_TARGET static void sse2_add( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  for (int i = 0; i < len; ++i, d += 2, s += 2)
+    _mm_storeu_pd(d, _mm_add_pd(_mm_loadu_pd(d), _mm_loadu_pd(s)));
+}
+
+AMATH_TARGET static void sse2_sub( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  for (int i = 0; i < len; ++i, d += 2, s += 2)
+    _mm_storeu_pd(d, _mm_sub_pd(_mm_loadu_pd(d), _mm_loadu_pd(s)));
+}
+
+AMATH_TARGET static void sse2_mul( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  for (int i = 0; i < len; ++i, d += 2, s += 2)
+    _mm_storeu_pd(d, sse2_cmul(_mm_loadu_pd(d), _mm_loadu_pd(s)));
+}
+
+AMATH_TARGET static void sse2_div( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  const __m128d conj = _mm_set_pd(-0.0, 0.0);
+  for (int i = 0; i < len; ++i, d += 2, s += 2) {
+    __m128d b = _mm_loadu_pd(s);
+    __m128d sq = _mm_mul_pd(b, b);
+    __m128d den = _mm_add_pd(sq, _mm_shuffle_pd(sq, sq, 1));
+    _mm_storeu_pd(d, _mm_div_pd(sse2_cmul(_mm_loadu_pd(d), _mm_xor_pd(b, conj)), den));
+  }
+}
+
+AMATH_TARGET static void sse2_scale( Complex dest[], Complex s, int len )
+{
+  double * d = &dest->real;
+  const __m128d f = _mm_set_pd(s.imaginary, s.real);
+  for (int i = 0; i < len; ++i, d += 2)
+    _mm_storeu_pd(d, sse2_cmul(_mm_loadu_pd(d), f));
+}
+
+AMATH_TARGET static void sse2_scalesub( Complex *dest, const Complex *source, Complex scale, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  const __m128d f = _mm_set_pd(scale.imaginary, scale.real);
+  for (int i = 0; i < len; ++i, d += 2, s += 2)
+    _mm_storeu_pd(d, _mm_sub_pd(_mm_loadu_pd(d), sse2_cmul(_mm_loadu_pd(s), f)));
+}
+
+AMATH_TARGET static Complex sse2_dot( const Complex *a1, const Complex *a2, int len, int conjugate )
+{
+  const double * x = &a1->real; const double * y = &a2->real;
+  __m128d p0 = _mm_setzero_pd(), p1 = p0, q0 = p0, q1 = p0;
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, x += 4, y += 4) {
+    __m128d a = _mm_loadu_pd(x), b = _mm_loadu_pd(y);
+    __m128d c = _mm_loadu_pd(x+2), e = _mm_loadu_pd(y+2);
+    p0 = _mm_add_pd(p0, _mm_mul_pd(a, b));
+    q0 = _mm_add_pd(q0, _mm_mul_pd(a, _mm_shuffle_pd(b, b, 1)));
+    p1 = _mm_add_pd(p1, _mm_mul_pd(c, e));
+    q1 = _mm_add_pd(q1, _mm_mul_pd(c, _mm_shuffle_pd(e, e, 1)));
+  }
+  double p[2], q[2];
+  _mm_storeu_pd(p, _mm_add_pd(p0, p1));
+  _mm_storeu_pd(q, _mm_add_pd(q0, q1));
+  return dot_sum(p, q, 2, a1 + i, a2 + i, len - i, conjugate);
+}
+
+#undef AMATH_TARGET
+
+static const complex_kernels sse2_kernels = {
+  "sse2", sse2_add, sse2_sub, sse2_mul, sse2_div,
+  sse2_scale, sse2_scalesub, sse2_dot
+};
+
+// --------------------------------------------------------------------
+// AVX2: two Complex per register
+
+#define AMATH_TARGET __attribute__((target("avx2")))
+
+AMATH_TARGET static inline __m256d avx2_cmul( __m256d a, __m256d b )
+{
+  __m256d t1 = _mm256_mul_pd(a, _mm256_movedup_pd(b));
+  __m256d t2 = _mm256_mul_pd(_mm256_permute_pd(a, 0x5), _mm256_permute_pd(b, 0xF));
+  return _mm256_addsub_pd(t1, t2);
+}
+
+AMATH_TARGET static void avx2_add( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, d += 4, s += 4)
+    _mm256_storeu_pd(d, _mm256_add_pd(_mm256_loadu_pd(d), _mm256_loadu_pd(s)));
+  _mm256_zeroupper();
+  scalar_add(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx2_sub( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, d += 4, s += 4)
+    _mm256_storeu_pd(d, _mm256_sub_pd(_mm256_loadu_pd(d), _mm256_loadu_pd(s)));
+  _mm256_zeroupper();
+  scalar_sub(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx2_mul( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, d += 4, s += 4)
+    _mm256_storeu_pd(d, avx2_cmul(_mm256_loadu_pd(d), _mm256_loadu_pd(s)));
+  _mm256_zeroupper();
+  scalar_mul(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx2_div( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  const __m256d conj = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, d += 4, s += 4) {
+    __m256d b = _mm256_loadu_pd(s);
+    __m256d sq = _mm256_mul_pd(b, b);
+    __m256d den = _mm256_add_pd(sq, _mm256_permute_pd(sq, 0x5));
+    _mm256_storeu_pd(d, _mm256_div_pd(avx2_cmul(_mm256_loadu_pd(d), _mm256_xor_pd(b, conj)), den));
+  }
+  _mm256_zeroupper();
+  scalar_div(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx2_scale( Complex dest[], Complex s, int len )
+{
+  double * d = &dest->real;
+  const __m256d f = _mm256_set_pd(s.imaginary, s.real, s.imaginary, s.real);
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, d += 4)
+    _mm256_storeu_pd(d, avx2_cmul(_mm256_loadu_pd(d), f));
+  _mm256_zeroupper();
+  scalar_scale(dest + i, s, len - i);
+}
+
+AMATH_TARGET static void avx2_scalesub( Complex *dest, const Complex *source, Complex scale, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  const __m256d f = _mm256_set_pd(scale.imaginary, scale.real, scale.imaginary, scale.real);
+  int i = 0;
+  for ( ; i + 2 <= len; i += 2, d += 4, s += 4)
+    _mm256_storeu_pd(d, _mm256_sub_pd(_mm256_loadu_pd(d), avx2_cmul(_mm256_loadu_pd(s), f)));
+  _mm256_zeroupper();
+  scalar_scalesub(dest + i, source + i, scale, len - i);
+}
+
+AMATH_TARGET static Complex avx2_dot( const Complex *a1, const Complex *a2, int len, int conjugate )
+{
+  const double * x = &a1->real; const double * y = &a2->real;
+  __m256d p0 = _mm256_setzero_pd(), p1 = p0, q0 = p0, q1 = p0;
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, x += 8, y += 8) {
+    __m256d a = _mm256_loadu_pd(x), b = _mm256_loadu_pd(y);
+    __m256d c = _mm256_loadu_pd(x+4), e = _mm256_loadu_pd(y+4);
+    p0 = _mm256_add_pd(p0, _mm256_mul_pd(a, b));
+    q0 = _mm256_add_pd(q0, _mm256_mul_pd(a, _mm256_permute_pd(b, 0x5)));
+    p1 = _mm256_add_pd(p1, _mm256_mul_pd(c, e));
+    q1 = _mm256_add_pd(q1, _mm256_mul_pd(c, _mm256_permute_pd(e, 0x5)));
+  }
+  double p[4], q[4];
+  _mm256_storeu_pd(p, _mm256_add_pd(p0, p1));
+  _mm256_storeu_pd(q, _mm256_add_pd(q0, q1));
+  return dot_sum(p, q, 4, a1 + i, a2 + i, len - i, conjugate);
+}
+
+#undef AMATH_TARGET
+
+static const complex_kernels avx2_kernels = {
+  "avx2", avx2_add, avx2_sub, avx2_mul, avx2_div,
+  avx2_scale, avx2_scalesub, avx2_dot
+};
+
+// --------------------------------------------------------------------
+// AVX-512: four Complex per register
+
+// (AVX-512 implies FMA, so the contraction of products and sums into
+// fused multiply-adds must be turned off explicitly)
+#define AMATH_TARGET __attribute__((target("avx512f"), optimize("fp-contract=off")))
+
+AMATH_TARGET static inline __m512d avx512_cmul( __m512d a, __m512d b )
+{
+  __m512d t1 = _mm512_mul_pd(a, _mm512_movedup_pd(b));
+  __m512d t2 = _mm512_mul_pd(_mm512_permute_pd(a, 0x55), _mm512_permute_pd(b, 0xFF));
+  // subtract in the real lanes, add in the imaginary ones:
+  return _mm512_mask_sub_pd(_mm512_add_pd(t1, t2), 0x55, t1, t2);
+}
+
+AMATH_TARGET static void avx512_add( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, d += 8, s += 8)
+    _mm512_storeu_pd(d, _mm512_add_pd(_mm512_loadu_pd(d), _mm512_loadu_pd(s)));
+  _mm256_zeroupper();
+  scalar_add(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx512_sub( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, d += 8, s += 8)
+    _mm512_storeu_pd(d, _mm512_sub_pd(_mm512_loadu_pd(d), _mm512_loadu_pd(s)));
+  _mm256_zeroupper();
+  scalar_sub(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx512_mul( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, d += 8, s += 8)
+    _mm512_storeu_pd(d, avx512_cmul(_mm512_loadu_pd(d), _mm512_loadu_pd(s)));
+  _mm256_zeroupper();
+  scalar_mul(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx512_div( Complex *dest, const Complex *source, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  const __m512i conj = _mm512_castpd_si512(
+    _mm512_set_pd(-0.0, 0.0, -0.0, 0.0, -0.0, 0.0, -0.0, 0.0));
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, d += 8, s += 8) {
+    __m512d b = _mm512_loadu_pd(s);
+    __m512d sq = _mm512_mul_pd(b, b);
+    __m512d den = _mm512_add_pd(sq, _mm512_permute_pd(sq, 0x55));
+    __m512d bc = _mm512_castsi512_pd(_mm512_xor_epi64(_mm512_castpd_si512(b), conj));
+    _mm512_storeu_pd(d, _mm512_div_pd(avx512_cmul(_mm512_loadu_pd(d), bc), den));
+  }
+  _mm256_zeroupper();
+  scalar_div(dest + i, source + i, len - i);
+}
+
+AMATH_TARGET static void avx512_scale( Complex dest[], Complex s, int len )
+{
+  double * d = &dest->real;
+  const __m512d f = _mm512_set_pd(s.imaginary, s.real, s.imaginary, s.real,
+				  s.imaginary, s.real, s.imaginary, s.real);
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, d += 8)
+    _mm512_storeu_pd(d, avx512_cmul(_mm512_loadu_pd(d), f));
+  _mm256_zeroupper();
+  scalar_scale(dest + i, s, len - i);
+}
+
+AMATH_TARGET static void avx512_scalesub( Complex *dest, const Complex *source, Complex scale, int len )
+{
+  double * d = &dest->real; const double * s = &source->real;
+  const __m512d f = _mm512_set_pd(scale.imaginary, scale.real, scale.imaginary, scale.real,
+				  scale.imaginary, scale.real, scale.imaginary, scale.real);
+  int i = 0;
+  for ( ; i + 4 <= len; i += 4, d += 8, s += 8)
+    _mm512_storeu_pd(d, _mm512_sub_pd(_mm512_loadu_pd(d), avx512_cmul(_mm512_loadu_pd(s), f)));
+  _mm256_zeroupper();
+  scalar_scalesub(dest + i, source + i, scale, len - i);
+}
+
+AMATH_TARGET static Complex avx512_dot( const Complex *a1, const Complex *a2, int len, int conjugate )
+{
+  const double * x = &a1->real; const double * y = &a2->real;
+  __m512d p0 = _mm512_setzero_pd(), p1 = p0, q0 = p0, q1 = p0;
+  int i = 0;
+  for ( ; i + 8 <= len; i += 8, x += 16, y += 16) {
+    __m512d a = _mm512_loadu_pd(x), b = _mm512_loadu_pd(y);
+    __m512d c = _mm512_loadu_pd(x+8), e = _mm512_loadu_pd(y+8);
+    p0 = _mm512_add_pd(p0, _mm512_mul_pd(a, b));
+    q0 = _mm512_add_pd(q0, _mm512_mul_pd(a, _mm512_permute_pd(b, 0x55)));
+    p1 = _mm512_add_pd(p1, _mm512_mul_pd(c, e));
+    q1 = _mm512_add_pd(q1, _mm512_mul_pd(c, _mm512_permute_pd(e, 0x55)));
+  }
+  double p[8], q[8];
+  _mm512_storeu_pd(p, _mm512_add_pd(p0, p1));
+  _mm512_storeu_pd(q, _mm512_add_pd(q0, q1));
+  return dot_sum(p, q, 8, a1 + i, a2 + i, len - i, conjugate);
+}
+
+#undef AMATH_TARGET
+
+static const complex_kernels avx512_kernels = {
+  "avx512", avx512_add, avx512_sub, avx512_mul, avx512_div,
+  avx512_scale, avx512_scalesub, avx512_dot
+};
+
+#endif /* AMATH_SIMD */
+
+// --------------------------------------------------------------------
+// dispatch
+
+// is the kernel set k usable on this processor?
+static int supported( const complex_kernels * k )
+{
+  if (k == &scalar_kernels) return 1;
+#ifdef AMATH_SIMD
+  __builtin_cpu_init();
+  if (k == &sse2_kernels)   return __builtin_cpu_supports("sse2");
+  if (k == &avx2_kernels)   return __builtin_cpu_supports("avx2");
+  if (k == &avx512_kernels) return __builtin_cpu_supports("avx512f");
+#endif
+  return 0;
+}
+
+// all the kernel sets, the widest first
+static const complex_kernels * const all_kernels[] = {
+#ifdef AMATH_SIMD
+  &avx512_kernels, &avx2_kernels, &sse2_kernels,
+#endif
+  &scalar_kernels
+};
+
+static const complex_kernels * best_kernels()
+{
+  for (unsigned i = 0; i < sizeof(all_kernels)/sizeof(all_kernels[0]); ++i)
+    if (supported(all_kernels[i])) return all_kernels[i];
+  return &scalar_kernels;
+}
+
+static const complex_kernels * & kernels()
+{
+  static const complex_kernels * k = best_kernels();
+  return k;
+}
+
+const char * Asimd()
+{
+  return kernels()->name;
+}
+
+int Asimd( const char * name )
+{
+  for (unsigned i = 0; i < sizeof(all_kernels)/sizeof(all_kernels[0]); ++i)
+    if (std::strcmp(name, all_kernels[i]->name) == 0) {
+      if ( ! supported(all_kernels[i])) return 0;
+      kernels() = all_kernels[i];
+      return 1;
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------
+// the Complex array routines which use the kernels
+
+void Aadd( Complex *dest, const Complex *source, int len )
+{ kernels()->add(dest, source, len); }
+
+void Asub( Complex *dest, const Complex *source, int len )
+{ kernels()->sub(dest, source, len); }
+
+void Amul( Complex *dest, const Complex *source, int len )
+{ kernels()->mul(dest, source, len); }
+
+void Adiv( Complex *dest, const Complex *source, int len )
+{ kernels()->div(dest, source, len); }
+
+void Ascale( Complex dest[], Complex s, int len )
+{ kernels()->scale(dest, s, len); }
+
+void Ascalesub( Complex *dest, const Complex *source, Complex scale, int len )
+{ kernels()->scalesub(dest, source, scale, len); }
+
+void Aaxpy( Complex *dest, const Complex *source, Complex scale, int len )
+{ kernels()->scalesub(dest, source, -scale, len); }
+
+// Short dot products, such as those over the ports of a circuit in the
+// noise calculations, gain nothing from the partial sums of the vector
+// kernels, so they keep the summation order of the scalar loop.
+
+Complex Adot( const Complex *a1, const Complex *a2, int len )
+{
+  return (len < Adot_simd_min) ? scalar_dot(a1, a2, len, 1)
+    : kernels()->dot(a1, a2, len, 1);
+}
+
+Complex Adotu( const Complex *a1, const Complex *a2, int len )
+{
+  return (len < Adot_simd_min) ? scalar_dot(a1, a2, len, 0)
+    : kernels()->dot(a1, a2, len, 0);
+}
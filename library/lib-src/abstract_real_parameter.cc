@@ -5,6 +5,12 @@
 // abstract_real_parameter.cc
 
 #include "parameter/abstract_real_parameter.h"
+#include "parameter/parameter_program.h"
+
+std::atomic<unsigned long> abstract_real_parameter::structure_count(0);
+
+int abstract_real_parameter::compile(parameter_program & p) const
+{ return p.call(*this); }
 
 //  double operator +(const abstract_real_parameter& p1, const abstract_real_parameter& p2)
 //  {
@@ -0,0 +1,202 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// adaptive_sweeper.cc
+
+#include "adaptive_sweeper.h"
+#include "error.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+adaptive_sweeper::adaptive_sweeper() :
+  rpr(0), startv(0.0), stopv(0.0), initial(1), max_n(200), min_h(0.0),
+  visited(0), current(0.0), measured(false), done(true)
+{ }
+
+void adaptive_sweeper::sweep(real_parameter & rp, double start, double stop, int n)
+{
+  if(start > stop) swap(start, stop);
+  if(start == stop)
+    n = 1;
+  else if(n < 2) {
+    error::warning("adaptive_sweeper::sweep(): need at least 2 initial points; using 2.");
+    n = 2;
+  }
+  rpr = &rp;
+  startv = start;
+  stopv = stop;
+  initial = n;
+  min_h = 1.0e-6*(stop - start);
+  done = true;
+}
+
+adaptive_sweeper &
+adaptive_sweeper::monitor(sweep_monitor & m, double abs_tol, double rel_tol)
+{
+  if(abs_tol < 0.0 || rel_tol < 0.0 || (abs_tol == 0.0 && rel_tol == 0.0))
+    error::warning("adaptive_sweeper::monitor(): tolerances should be >= 0,"
+		   " and not both 0.");
+  watched w = { &m, fabs(abs_tol), fabs(rel_tol) };
+  monitors.push_back(w);
+  return *this;
+}
+
+adaptive_sweeper & adaptive_sweeper::point_limit(int n)
+{
+  if(n < initial) {
+    error::warning("adaptive_sweeper::point_limit(): limit is less than the"
+		   " number of initial points.");
+  }
+  max_n = n;
+  return *this;
+}
+
+void adaptive_sweeper::go(double x)
+{
+  current = x;
+  measured = false;
+  if(rpr) *rpr = x;
+  // sets the initialized parameters, then calls setup():
+  sweeper::reset();
+}
+
+void adaptive_sweeper::reset()
+{
+  xs.clear();
+  order.clear();
+  ys.clear();
+  weights.clear();
+  visited = 1;
+  done = false;
+  if(!rpr)
+    error::warning("adaptive_sweeper::reset(): no parameter to sweep.");
+  go(startv);
+}
+
+void adaptive_sweeper::measure(state_tag tag)
+{
+  if(done || measured) return;
+  measured = true;
+
+  vector<double> y(monitors.size());
+  for(unsigned m = 0; m < monitors.size(); ++m)
+    y[m] = monitors[m].m->get(tag);
+
+  int j = upper_bound(xs.begin(), xs.end(), current) - xs.begin();
+  xs.insert(xs.begin() + j, current);
+  order.insert(order.begin() + j, visited - 1);
+  ys.insert(ys.begin() + j, y);
+}
+
+adaptive_sweeper & adaptive_sweeper::operator ++(int)
+{
+  if(done) {
+    error::warning("cannot increment adaptive_sweeper object -- the sweep is finished");
+    return *this;
+  }
+  if(!measured) measure(state_tag::get_tag());
+
+  double x;
+  if(next(x)) {
+    ++visited;
+    go(x);
+  }
+  else {
+    set_weights();
+    done = true;
+  }
+  return *this;
+}
+
+bool adaptive_sweeper::next(double & x) const
+{
+  // first the starting grid
+  if(visited < initial) {
+    x = startv + visited*(stopv - startv)/(initial - 1);
+    return true;
+  }
+  if(visited >= max_n || monitors.empty()) return false;
+
+  // the tolerances
+  const int n = xs.size();
+  vector<double> tol(monitors.size());
+  for(unsigned m = 0; m < monitors.size(); ++m) {
+    double scale = 0.0;
+    for(int i = 0; i < n; ++i) scale = max(scale, fabs(ys[i][m]));
+    tol[m] = monitors[m].abs_tol + monitors[m].rel_tol*scale;
+  }
+
+  // then divide the interval with the worst error
+  int worst = -1;
+  double e = 1.0;
+  double h = max(min_h, 1.0e-9*(stopv - startv));
+  for(int j = 0; j + 1 < n; ++j) {
+    if(xs[j+1] - xs[j] < 2*h) continue;
+    double ej = interval_error(j, tol);
+    if(ej > e) { e = ej; worst = j; }
+  }
+  if(worst < 0) return false;
+  x = 0.5*(xs[worst] + xs[worst+1]);
+  return true;
+}
+
+// The error of linear interpolation over an interval of width h is about
+// h*h*|f''|/8; f'' is estimated from the divided differences of the
+// points on each side.
+double adaptive_sweeper::interval_error(int j, const vector<double> & tol) const
+{
+  const int n = xs.size();
+  const double h = xs[j+1] - xs[j];
+  double worst = 0.0;
+
+  for(unsigned m = 0; m < monitors.size(); ++m) {
+    double d2 = 0.0;
+    for(int i = max(0, j-1); i <= j && i + 2 < n; ++i) {
+      double s0 = (ys[i+1][m] - ys[i][m])/(xs[i+1] - xs[i]);
+      double s1 = (ys[i+2][m] - ys[i+1][m])/(xs[i+2] - xs[i+1]);
+      d2 = max(d2, fabs(2.0*(s1 - s0)/(xs[i+2] - xs[i])));
+    }
+    double e = d2*h*h/8.0;
+    if(e == 0.0) continue;
+    if(tol[m] <= 0.0) return HUGE_VAL;
+    worst = max(worst, e/tol[m]);
+  }
+  return worst;
+}
+
+// trapezoid rule weights, normalized to add up to the number of points
+void adaptive_sweeper::set_weights()
+{
+  const int n = xs.size();
+  weights.assign(n, 1.0);
+  if(n < 2 || stopv == startv) return;
+  const double norm = n/(2.0*(xs[n-1] - xs[0]));
+  for(int j = 0; j < n; ++j) {
+    double lo = (j > 0) ? xs[j-1] : xs[j];
+    double hi = (j < n-1) ? xs[j+1] : xs[j];
+    weights[order[j]] = (hi - lo)*norm;
+  }
+}
+
+double adaptive_sweeper::weight(int k) const
+{
+  if(!done || k < 0 || k >= int(weights.size())) {
+    error::warning("adaptive_sweeper::weight(): no such point in a finished sweep.");
+    return 1.0;
+  }
+  return weights[k];
+}
+
+double adaptive_sweeper::point(int k) const
+{
+  if(k < 0 || k >= int(order.size())) {
+    error::warning("adaptive_sweeper::point(): no such point.");
+    return 0.0;
+  }
+  for(unsigned j = 0; j < order.size(); ++j)
+    if(order[j] == k) return xs[j];
+  return 0.0;
+}
@@ -52,20 +52,22 @@ const sdata & mixer::analyzer::operator()()
 
 	  // avoid the following index dereferences inside the inner loops
 	  complex & Sr = S(n1,n2,h1,h2);
-	  complex & Cr = C(n1,n2,h1,h2);
 	  complex * X_n1_h1 = Xrow(n1,h1);
 	  complex * X_n2_h2 = Xrow(n2,h2);
 	  complex * Y_n1_h1 = Yrow(n1,h1);
 	  complex * Y_n2_h2 = Yrow(n2,h2);
 	  
 	  Sr = (h1==h2)? S11(n1,n2,h2) : 0.0;
-	  Cr = (h1==h2)? C11(n1,n2,h2) : 0.0;
+	  for (m = m_low; m <= m_high; ++m)
+	    Sr += Y_n1_h1[Ycol(m,h2)]*S21(m,n2,h2);  // that's it for the S matrix!
+
+	  // C is hermitian, so only its upper triangle is calculated:
+	  if (mix.port(n1,h1) > mix.port(n2,h2)) continue;
+	  complex Cr = (h1==h2)? C11(n1,n2,h2) : 0.0;
 
 	  for (m = m_low; m <= m_high; ++m) {
 	    complex Ytemp = Y_n1_h1[Ycol(m,h2)];  // Y(n1,m,h1,h2)
 
-	    Sr += Ytemp*S21(m,n2,h2);  // that's it for the S matrix!
-
 	    Cr += Ytemp*C21(m,n2,h2) + conj(Y_n2_h2[Ycol(m,h1)]*C21(m,n1,h1));
 	    for (h = h_low; h <= h_high; ++h) {
 
@@ -87,6 +89,8 @@ const sdata & mixer::analyzer::operator()()
 
 	    }// h
 	  }  // m
+	  C(n2,n1,h2,h1) = conj(Cr);
+	  C(n1,n2,h1,h2) = Cr;
 	}    // n2
       }      // n1
     }        // h2
@@ -151,11 +155,11 @@ void mixer::analyzer::rebuild()
     for (n = 0; n < num_ports; ++n) {
       // connect terminators to external RF ports
       int p = nj + n + 1;
-      temp.connect(*(mix.rf_circuit), p, 
+      temp.connect(mix.rf_embed(), p, 
 		   ((mix.term[p-1])? *(mix.term[p-1]) : mix.default_term[n]), 1);
     }
     for (n = 1; n <= nj; ++n)
-      temp.add_port(*(mix.rf_circuit), n); // ports to connect to junctions
+      temp.add_port(mix.rf_embed(), n); // ports to connect to junctions
   }
 
   // size the result sdata, and T_, X_, Y_
@@ -186,12 +190,12 @@ void mixer::analyzer::fill_data()
   const sdata * ps;
 
   // the IF circuit:
-  ps = & mix.if_circuit->get_data();
+  ps = & mix.if_embed().get_data();
   linear_p[0].S.copy(ps->S);
   linear_p[0].C.copy(ps->C);
 
   // the RF circuit:
-  nport * rf = (terminate_flag) ? & temp : mix.rf_circuit;
+  nport * rf = (terminate_flag) ? & temp : & mix.rf_embed();
   double fp = LO + IF_saved;  // harmonic = 1  (USB freq)
   double fm = LO - IF_saved;  // harmonic = -1 (LSB freq)
   for (int h = 1; h <= h_high; ++h, fp += LO, fm += LO) {
@@ -5,10 +5,12 @@
 // balance.cc
 
 #include "mixer.h"
+#include "matview.h"
 #include "units.h"
 #include "error.h"
 #include "sources.h"
 #include <cmath>
+#include <string>
 
 using namespace std;
 
@@ -21,7 +23,11 @@ mixer::balancer::balancer(mixer & m) :
   ival(0,Index_C),
   iter(0),
   pY(0),
-  linear(0)
+  linear(0),
+  krylov_flag(0),
+  krylov_restart(30),
+  kiter(0),
+  krylov_tol(1.0e-3)
 { max_iter = 100; }
 
 
@@ -50,14 +56,14 @@ int mixer::balancer::operator()()
 
   Matrix Vsave; mix.save_operating_state(Vsave);  // in case of failure
 
-  if (mix.balance_init_flag) i_state();
+  if (mix.balance_init_flag) i_state("mixer::balance()");
 
   init();
   solve();
 
   if (no_solution()&& !mix.balance_init_flag) {
     // solver failed, try again from a basic operating state:
-    i_state();
+    i_state("mixer::balance()");
     init();
     solve();
   }
@@ -74,7 +80,7 @@ int mixer::balancer::operator()()
 }
 
 
-void mixer::balancer::i_state()
+void mixer::balancer::i_state(const char * caller)
 {
   // if there are no junctions, no work need be done
   if (mix.num_junctions == 0) return;
@@ -87,18 +93,25 @@ void mixer::balancer::i_state()
   fill_data();
   
   // Build an array of state voltages (rows:junctions; columns:harmonics).
-  // we call the global solve() (in matmath.h), not newton::solve():
+  // we call the global solve() (in matview.h), not newton::solve(); it
+  // writes each harmonic's voltages straight into their column of Vs:
   Matrix Vs(mix.num_junctions, mix.max_harmonics + 1, Index_1, Index_C);
   Matrix I = identity_matrix(mix.num_junctions, Index_1);
   
-  Vs.fillcol(0, ::solve((I - linear[0].S), linear[0].B));  // DC voltages
-
-  for(int n = 1; n <= mix.max_harmonics; ++n)
-    Vs.fillcol(n, ::solve((I - linear[n].S), linear[n].B));
-
-  // Finally call each junction's large_signal() code:
+  // (harmonic 0 gives the DC voltages); if I - S is singular at some
+  // harmonic, its voltages are left at 0. That is a solution when the
+  // harmonic has no sources, so only warn if it has some:
+  for(int n = 0; n <= mix.max_harmonics; ++n)
+    if ( ! ::solve(col_view(n, Vs), I - linear[n].S, linear[n].B)
+	 && max_norm(linear[n].B) != 0.0)
+      error::warning("Singular embedding circuit in " + std::string(caller) +
+		     "; starting with zero junction voltages at harmonic " + std::to_string(n));
+
+  // Finally call each junction's large_signal() code, passing it its row
+  // of Vs through an alias vector:
   for(int n = 0; n < mix.num_junctions; ++n)
-    mix.junc[n]->large_signal(row(n+1,Vs), mix.LO_saved, mix.max_harmonics);
+    mix.junc[n]->large_signal(Vector(Vs[n+1], mix.max_harmonics + 1, Index_C),
+			      mix.LO_saved, mix.max_harmonics);
 }
 
 
@@ -116,6 +129,16 @@ mixer::balancer & mixer::balancer::parameters
 }
 
 
+mixer::balancer & mixer::balancer::krylov(int f, double tol, int restart)
+{
+  krylov_flag = (f != 0);
+  krylov_tol = (tol > 0) ? tol : 1.0e-3;
+  krylov_restart = (restart > 0) ? restart : 1;
+  changed();   // the Jacobian storage changes
+  return *this;
+}
+
+
 // ********************************************************************
 // balancer private helper functions (matrix element access):
 
@@ -270,6 +293,7 @@ void mixer::balancer::init()
   // now set the maximum allowable step size and reset iteration count
   maxstep = 10;
   iter = 0;
+  kiter = 0;
 
 } // mixer::balancer::init()
 
@@ -305,7 +329,13 @@ void mixer::balancer::rebuild()
     xlast.reallocate(rep.length,Index_C);
     fval.reallocate(rep.length,Index_C);
     ival.reallocate(rep.length, Index_C);
-    Jacobian.reallocate(rep.length, rep.length, Index_C, Index_C);
+    matrix_free = krylov_flag;
+    if (matrix_free) {
+      Jacobian.reallocate(0, 0, Index_C, Index_C);
+      kz.reallocate(rep.length, Index_C);
+    }
+    else
+      Jacobian.reallocate(rep.length, rep.length, Index_C, Index_C);
     pY.resize(mix.num_junctions);
     linear.resize(mix.max_harmonics + 1);
     int num_ports = mix.rf_circuit->size() - mix.num_junctions;
@@ -315,11 +345,11 @@ void mixer::balancer::rebuild()
     temp = circuit();  // clear out old construction
     for (n = 0; n < num_ports; ++n) {
       int p = mix.num_junctions + n + 1;
-      temp.connect(*(mix.rf_circuit), p, 
+      temp.connect(mix.rf_embed(), p, 
 		   ((mix.term[p-1])? *(mix.term[p-1]) : mix.default_term[n]), 1);
     }
     for (n = 1; n <= mix.num_junctions; ++n)
-      temp.add_port(*(mix.rf_circuit), n);
+      temp.add_port(mix.rf_embed(), n);
 
     must_rebuild = 0;
   } // if(must_rebuild)
@@ -407,6 +437,12 @@ void mixer::balancer::calc()
   // finished: fval = f(V) = I + V + S(I - V) - B
 
 
+  // in the matrix-free mode, the Jacobian is only needed in pieces:
+  if (krylov_flag) {
+    jac_blocks();
+    return;
+  }
+
   // use the admittance matrices and sdata objects to calculate Jacobian:
 
   int n2, m2;  // two more loop indices
@@ -453,3 +489,379 @@ void mixer::balancer::calc()
     Jacobian[index_i][index_i] = 1;
 
 } // mixer::balancer::calc()
+
+
+// ********************************************************************
+// The matrix-free linear algebra. The Jacobian filled by calc() is
+//
+//   A = P*((1 + S)*Yb + (1 - S)) + E
+//
+// where Yb is block diagonal, with a real 2(H+1) x 2(H+1) block for each
+// junction holding the derivatives of its currents (the YpY, YmY and Yom
+// terms of calc()); S acts on the complex voltages of all the junctions
+// at each harmonic, as complex multiplication; P discards the imaginary
+// parts of the DC rows, and E puts 1's on their diagonal. So A*x takes
+// work proportional to J*(H+1)^2 for the blocks, plus J^2 per harmonic
+// for S, and the transpose is found the same way using the adjoint of S.
+
+// jac_blocks(): fill Yb from the junction admittance matrices, then the
+// inverses of the diagonal blocks of A, which precondition GMRES
+
+void mixer::balancer::jac_blocks()
+{
+  const int nj = mix.num_junctions, H = mix.max_harmonics, L = 2*(H+1);
+  Yb.resize(nj);
+  Dinv.resize(nj);
+  real_matrix D(L, L, Index_C, Index_C);
+
+  for (int n = 0; n < nj; ++n) {
+    const Matrix & Y = *(pY[n]);
+    real_matrix & B = Yb[n];
+    B.reallocate(L, L, Index_C, Index_C);
+    for (int m = 0; m <= H; ++m)
+      for (int m2 = 0; m2 <= H; ++m2) {
+	complex P, Q;
+	if (m == 0) P = Q = Yom(m2, Y);
+	else { P = YpY(m, m2, Y); Q = YmY(m, m2, Y); }
+	B[2*m][2*m2]     = P.real;  B[2*m][2*m2+1]   = -Q.imaginary;
+	B[2*m+1][2*m2]   = P.imaginary; B[2*m+1][2*m2+1] = Q.real;
+      }
+
+    // D = (1 + S(n,n))*B + (1 - S(n,n)), except for the DC imaginary row
+    for (int m = 0; m <= H; ++m) {
+      complex sp = 1.0 + S(n,n,m), sm = 1.0 - S(n,n,m);
+      for (int l = 0; l < L; ++l) {
+	double br = B[2*m][l], bi = B[2*m+1][l];
+	D[2*m][l]   = sp.real*br - sp.imaginary*bi;
+	D[2*m+1][l] = sp.imaginary*br + sp.real*bi;
+      }
+      D[2*m][2*m]     += sm.real;  D[2*m][2*m+1]   -= sm.imaginary;
+      D[2*m+1][2*m]   += sm.imaginary; D[2*m+1][2*m+1] += sm.real;
+    }
+    for (int l = 0; l < L; ++l) D[1][l] = (l == 1);
+
+    Dinv[n] = inverse(D);
+  }
+}
+
+
+// jac_times(): y = A*x
+
+void mixer::balancer::jac_times(const real_vector & x, real_vector & y)
+{
+  const int nj = mix.num_junctions, H = mix.max_harmonics, L = 2*(H+1);
+
+  // kz = Yb*x, junction by junction
+  for (int n = 0; n < nj; ++n) {
+    const real_matrix & B = Yb[n];
+    for (int l = 0; l < L; ++l) {
+      double sum = 0;
+      for (int l2 = 0; l2 < L; ++l2)
+	sum += B.read(l, l2) * x.read(index(n, l2/2) + (l2 % 2)*rep.imag_inc);
+      kz[index(n, l/2) + (l % 2)*rep.imag_inc] = sum;
+    }
+  }
+
+  // then y = P*(kz + x + S*(kz - x)) + E*x
+  ka.resize(nj); kb.resize(nj);
+  for (int m = 0; m <= H; ++m) {
+    for (int n = 0; n < nj; ++n) {
+      int r = index(n, m), i = r + rep.imag_inc;
+      ka[n] = complex(kz[r] + x.read(r), kz[i] + x.read(i));
+      kb[n] = complex(kz[r] - x.read(r), kz[i] - x.read(i));
+    }
+    for (int n = 0; n < nj; ++n) {
+      const complex * Sr = linear[m].S[n+1];
+      complex sum = ka[n];
+      for (int n2 = 0; n2 < nj; ++n2) sum += Sr[n2+1] * kb[n2];
+      int r = index(n, m), i = r + rep.imag_inc;
+      y[r] = sum.real;
+      y[i] = (m == 0) ? x.read(i) : sum.imaginary;
+    }
+  }
+}
+
+
+// jac_transpose_times(): y = x*A, ie: y = transpose(A)*x
+
+void mixer::balancer::jac_transpose_times(const real_vector & x, real_vector & y)
+{
+  const int nj = mix.num_junctions, H = mix.max_harmonics, L = 2*(H+1);
+
+  // with u = P*x: kz = (1 + S)^H*u, y = (1 - S)^H*u
+  ka.resize(nj); kb.resize(nj);
+  for (int m = 0; m <= H; ++m) {
+    for (int n = 0; n < nj; ++n) {
+      int r = index(n, m), i = r + rep.imag_inc;
+      ka[n] = complex(x.read(r), (m == 0) ? 0.0 : x.read(i));
+    }
+    for (int n = 0; n < nj; ++n) {
+      complex sum = 0;
+      for (int n2 = 0; n2 < nj; ++n2)
+	sum += conj(linear[m].S.read(n2+1, n+1)) * ka[n2];
+      int r = index(n, m), i = r + rep.imag_inc;
+      kz[r] = ka[n].real + sum.real;  kz[i] = ka[n].imaginary + sum.imaginary;
+      y[r]  = ka[n].real - sum.real;  y[i]  = ka[n].imaginary - sum.imaginary;
+    }
+  }
+
+  // then add transpose(Yb)*kz and transpose(E)*x
+  for (int n = 0; n < nj; ++n) {
+    const real_matrix & B = Yb[n];
+    for (int l2 = 0; l2 < L; ++l2) {
+      double sum = 0;
+      for (int l = 0; l < L; ++l)
+	sum += B.read(l, l2) * kz[index(n, l/2) + (l % 2)*rep.imag_inc];
+      y[index(n, l2/2) + (l2 % 2)*rep.imag_inc] += sum;
+    }
+    int i = index(n, 0) + rep.imag_inc;
+    y[i] += x.read(i);
+  }
+}
+
+
+// precondition(): apply the inverse diagonal blocks to x
+
+void mixer::balancer::precondition(real_vector & x)
+{
+  const int nj = mix.num_junctions, L = 2*(mix.max_harmonics+1);
+  std::vector<double> u(L);
+  for (int n = 0; n < nj; ++n) {
+    for (int l = 0; l < L; ++l)
+      u[l] = x[index(n, l/2) + (l % 2)*rep.imag_inc];
+    const real_matrix & Di = Dinv[n];
+    for (int l = 0; l < L; ++l) {
+      double sum = 0;
+      for (int l2 = 0; l2 < L; ++l2) sum += Di.read(l, l2) * u[l2];
+      x[index(n, l/2) + (l % 2)*rep.imag_inc] = sum;
+    }
+  }
+}
+
+
+void mixer::balancer::gradient(real_vector & g)
+{
+  if (krylov_flag) jac_transpose_times(fval, g);
+  else newton::gradient(g);
+}
+
+
+// newton_step(): solve A*p = -fval with right preconditioned, restarted
+// GMRES, to a relative residual of krylov_tol (or an absolute residual
+// well below f_tol). If GMRES doesn't get there in 10 restarts, returns
+// its best p, which is still a useful search direction for newton.
+
+void mixer::balancer::newton_step(real_vector & p)
+{
+  if (!krylov_flag) {
+    newton::newton_step(p);
+    return;
+  }
+
+  const int N = rep.length;
+  const int M = (krylov_restart < N) ? krylov_restart : N;
+  double target = krylov_tol * sqrt(norm(fval));
+  if (target < 0.01 * f_tol) target = 0.01 * f_tol;
+
+  p.reallocate(N, Index_C).fill(0.0);
+  std::vector<real_vector> V(M+1, real_vector(N, Index_C));
+  real_table Hm(M+1, M, Index_C, Index_C);
+  std::vector<double> c(M), s(M), g(M+1), y(M);
+  real_vector w(N, Index_C);
+
+  // the residual r = -fval - A*p starts as -fval
+  V[0] = -fval;
+
+  for (int restarts = 0; restarts < 10; ++restarts) {
+    double beta = sqrt(norm(V[0]));
+    if (beta <= target) break;
+    V[0] /= beta;
+    g.assign(M+1, 0.0);
+    g[0] = beta;
+
+    int k = 0;
+    while (k < M) {
+      // the next Krylov vector, orthogonalized (modified Gram-Schmidt)
+      w = V[k];
+      precondition(w);
+      jac_times(w, V[k+1]);
+      for (int i = 0; i <= k; ++i) {
+	double h = dot(V[k+1], V[i]);
+	Hm[i][k] = h;
+	for (int j = 0; j < N; ++j) V[k+1][j] -= h * V[i][j];
+      }
+      double h = sqrt(norm(V[k+1]));
+      Hm[k+1][k] = h;
+      if (h != 0) V[k+1] /= h;
+
+      // reduce the Hessenberg matrix with Givens rotations
+      for (int i = 0; i < k; ++i) {
+	double t = c[i]*Hm[i][k] + s[i]*Hm[i+1][k];
+	Hm[i+1][k] = -s[i]*Hm[i][k] + c[i]*Hm[i+1][k];
+	Hm[i][k] = t;
+      }
+      double d = hypot(Hm[k][k], Hm[k+1][k]);
+      c[k] = (d != 0) ? Hm[k][k]/d : 1.0;
+      s[k] = (d != 0) ? Hm[k+1][k]/d : 0.0;
+      Hm[k][k] = d; Hm[k+1][k] = 0;
+      g[k+1] = -s[k]*g[k];
+      g[k] *= c[k];
+
+      ++k; ++kiter;
+      if (fabs(g[k]) <= target || h == 0) break;
+    }
+
+    // p += inverse(D)*(V*y), with y from the triangular system
+    for (int i = k-1; i >= 0; --i) {
+      double t = g[i];
+      for (int j = i+1; j < k; ++j) t -= Hm[i][j]*y[j];
+      y[i] = (Hm[i][i] != 0) ? t/Hm[i][i] : 0.0;
+    }
+    w.fill(0.0);
+    for (int i = 0; i < k; ++i)
+      for (int j = 0; j < N; ++j) w[j] += y[i] * V[i][j];
+    precondition(w);
+    p += w;
+
+    if (fabs(g[k]) <= target) break;
+
+    // restart from the true residual
+    jac_times(p, w);
+    V[0] = -fval - w;
+  }
+}
+
+
+// ********************************************************************
+// rectified(): the second order direct detection response. With junction
+// currents I scaled to voltages (Z0*I), each harmonic of the balance obeys
+// (1 + S)*I + (1 - S)*V = B. The unpumped junctions are linear at the LO
+// frequency, with admittances Y1, so the LO voltages V1 solve
+// ((1 + S)*Y1 + (1 - S))*V1 = B. Each junction rectifies a DC current
+// r*|V1|^2, which then changes the DC voltages through the bias circuit;
+// linearizing the DC balance about the unpumped state, with the junction
+// DC conductances G:
+//   ((1 + S)*G + (1 - S))*dV = -(1 + S)*Ir,  and  dI = Ir + G*dV
+
+void mixer::balancer::rectified(const Vector & V0, Vector & dI)
+{
+  const int nj = mix.num_junctions;
+  dI.reallocate(nj, Index_1).fill(0.0);
+  if (nj == 0) return;
+
+  if (mix.flag_mixer_incomplete())
+    error::fatal("Must correctly add all elements before\
+ calling mixer::I_rectified().");
+  if (mix.LO <= 0)
+    error::fatal("Must have a positive LO frequency during\
+ mixer::I_rectified().");
+
+  mix.LO_saved = mix.LO;
+  rebuild();
+
+  // the linear circuits at DC and at the LO frequency
+  parameter IF_saved = device::f;
+  device::f = 0;
+  sdata dc(mix.bias_circuit->get_data_S());
+  device::f = mix.LO_saved;
+  sdata lo(temp.get_data_S());
+  device::f = IF_saved;
+  lo.B *= 2 * sqrt(device::Z0);   // convert sdata::B units to voltages
+
+  // the unpumped junctions: DC conductances, LO admittances, and rectification
+  Vector G(nj, Index_1), Y1(nj, Index_1), r(nj, Index_1);
+  Vector V(mix.max_harmonics + 1, Index_C);
+  for (int n = 0; n < nj; ++n) {
+    junction & j = *mix.junc[n];
+    V.fill(0.0);
+    V[0] = V0.read(n+1).real;
+    j.large_signal(V, mix.LO_saved, mix.max_harmonics);
+    r[n+1] = device::Z0 * j.rectification(mix.LO_saved);
+    j.large_signal(V, mix.LO_saved, mix.max_harmonics);  // in case it was changed
+    const Matrix & Y = j.small_signal(0, mix.max_harmonics);
+    G[n+1] = device::Z0 * Y.read(0,0).real;
+    Y1[n+1] = device::Z0 * Y.read(1,1);
+  }
+
+  // the LO voltages and the rectified currents
+  Matrix A(nj, nj, Index_1);
+  for (int i = 1; i <= nj; ++i)
+    for (int k = 1; k <= nj; ++k)
+      A[i][k] = (Delta(i,k) + lo.S.read(i,k)) * Y1[k] + Delta(i,k) - lo.S.read(i,k);
+  Vector V1(::solve(A, lo.B));
+  if (V1.maxindex() < 1)
+    error::fatal("Singular LO circuit in mixer::I_rectified().");
+  Vector Ir(nj, Index_1);
+  for (int i = 1; i <= nj; ++i)
+    Ir[i] = r[i] * norm(V1[i]);
+
+  // redistribution by the bias circuit
+  Vector b(nj, Index_1);
+  b.fill(0.0);
+  for (int i = 1; i <= nj; ++i) {
+    for (int k = 1; k <= nj; ++k) {
+      A[i][k] = (Delta(i,k) + dc.S.read(i,k)) * G[k] + Delta(i,k) - dc.S.read(i,k);
+      b[i] -= (Delta(i,k) + dc.S.read(i,k)) * Ir[k];
+    }
+  }
+  Vector dV(::solve(A, b));
+  if (dV.maxindex() < 1)
+    error::fatal("Singular bias circuit in mixer::I_rectified().");
+  for (int i = 1; i <= nj; ++i)
+    dI[i] = (Ir[i] + G[i] * dV[i]).real / device::Z0;
+}
+
+
+// ********************************************************************
+// next_harmonic(): the truncation error estimate for adaptive harmonics.
+// At harmonic H+1, just above those balanced, each junction carries the
+// current I its present voltages generate there, and responds to a small
+// voltage there with its self-admittance Y; the voltages the terminated RF
+// circuit then puts across the junctions solve
+//   ((1 + S)*Y + (1 - S))*V = B - (1 + S)*I
+// The junction states are left as they were.
+
+double mixer::balancer::next_harmonic()
+{
+  const int nj = mix.num_junctions, H = mix.max_harmonics;
+  if (nj == 0) return 0.0;
+  rebuild();
+
+  parameter IF_saved = device::f;
+  device::f = (H + 1) * mix.LO_saved;
+  sdata s(temp.get_data_S());
+  device::f = IF_saved;
+  s.B *= 2 * sqrt(device::Z0);   // convert sdata::B units to voltages
+
+  Vector I(nj, Index_1), Y(nj, Index_1);
+  Vector V(H + 2, Index_C);
+  double scale = 0.0;
+  for (int n = 0; n < nj; ++n) {
+    junction & j = *mix.junc[n];
+    Vector Vs(j.V());
+    V.fill(0.0);
+    for (int m = 0; m <= H; ++m) V[m] = Vs.read(m);
+    scale = max(scale, abs(V[1]));
+    I[n+1] = device::Z0 * j.large_signal(V, mix.LO_saved, H + 1).read(H + 1);
+    Y[n+1] = device::Z0 * j.small_signal(0, H + 1).read(H + 1, H + 1);
+    j.large_signal(Vs, mix.LO_saved, H);   // restore the balanced state
+  }
+  if (scale == 0.0) return 0.0;
+
+  Matrix A(nj, nj, Index_1);
+  Vector b(s.B);
+  for (int i = 1; i <= nj; ++i)
+    for (int k = 1; k <= nj; ++k) {
+      complex P = Delta(i,k) + s.S.read(i,k);
+      A[i][k] = P * Y[k] + Delta(i,k) - s.S.read(i,k);
+      b[i] -= P * I[k];
+    }
+  Vector Vn(::solve(A, b));
+  if (Vn.maxindex() < 1)
+    error::fatal("Singular RF circuit in mixer::balance().");
+
+  double v = 0.0;
+  for (int i = 1; i <= nj; ++i)
+    v = max(v, abs(Vn[i]));
+  return v / scale;
+}
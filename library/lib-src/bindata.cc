@@ -0,0 +1,368 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// bindata.cc
+
+#include "bindata.h"
+#include "datafile.h"
+#include "sdata_interp.h"
+#include "error.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// ********************************************************************
+// the on-disk structures; see bindata.h for a description
+
+namespace {
+
+  const char magic[8] = { 'S','M','i','x','B','i','n','\0' };
+  const uint32_t byte_order = 0x01020304;
+
+  struct header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t order;
+    uint32_t kind;
+    uint32_t columns;
+    uint32_t ports;
+    uint32_t flags;
+    double   znorm;
+    uint64_t length;
+    char     reserved[16];
+  };
+
+  struct descriptor {
+    char     name[16];
+    uint32_t type;
+    uint32_t reserved1;
+    uint64_t rows;
+    uint64_t width;
+    uint64_t offset;
+    char     reserved2[16];
+  };
+
+  // the size in bytes of a single value of a column type
+  inline uint64_t value_size(uint32_t type)
+  { return (type == bindata_file::COMPLEX) ? sizeof(Complex) : sizeof(double); }
+
+  // the column descriptors follow the header
+  inline descriptor * descriptors(char * base)
+  { return reinterpret_cast<descriptor *>(base + sizeof(header)); }
+
+} // namespace
+
+
+// ********************************************************************
+// bindata_file
+
+bindata_file::bindata_file(const char * name) : base(0), length(0)
+{
+  int fd = open(name, O_RDONLY);
+  if (fd < 0) {
+    error::warning("Couldn't open bindata file: ", name);
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(header))) {
+    close(fd);
+    error::warning("Not a bindata file: ", name);
+    return;
+  }
+
+  // a private, writable mapping; matrices aliasing the data may then
+  // modify it without changing the file.
+  length = st.st_size;
+  void * p = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping remains valid
+  if (p == MAP_FAILED) {
+    length = 0;
+    error::warning("Couldn't map bindata file into memory: ", name);
+    return;
+  }
+  base = static_cast<char *>(p);
+
+  if (!check(name)) {
+    munmap(base, length);
+    base = 0; length = 0;
+  }
+}
+
+bindata_file::~bindata_file()
+{
+  if (base) munmap(base, length);
+}
+
+bool bindata_file::check(const char * name)
+{
+  const header & h = *reinterpret_cast<header *>(base);
+
+  if (memcmp(h.magic, magic, sizeof(magic)) != 0) {
+    error::warning("Not a bindata file: ", name);
+    return false;
+  }
+  if (h.order != byte_order) {
+    error::warning("bindata file was written with a different byte order: ", name);
+    return false;
+  }
+  if (h.version > unsigned(VERSION)) {
+    error::warning("bindata file has an unknown format version: ", name);
+    return false;
+  }
+  if (h.length != length ||
+      sizeof(header) + uint64_t(h.columns) * sizeof(descriptor) > length) {
+    error::warning("bindata file is truncated or corrupted: ", name);
+    return false;
+  }
+
+  // each column's data must lie within the file, aligned for doubles
+  descriptor * d = descriptors(base);
+  for (unsigned i = 0; i < h.columns; ++i) {
+    uint64_t n = d[i].rows * d[i].width * value_size(d[i].type);
+    if ((d[i].type != REAL && d[i].type != COMPLEX) ||
+	d[i].offset % sizeof(double) != 0 ||
+	d[i].offset > length || n > length - d[i].offset) {
+      error::warning("bindata file has an improper column descriptor: ", name);
+      return false;
+    }
+    d[i].name[sizeof(d[i].name) - 1] = '\0';  // just in case
+  }
+  return true;
+}
+
+bool bindata_file::is_bindata(const char * name)
+{
+  char buf[sizeof(magic)];
+  ifstream in(name, ios::in | ios::binary);
+  return in.read(buf, sizeof(buf)) && memcmp(buf, magic, sizeof(magic)) == 0;
+}
+
+int bindata_file::version() const
+{ return (base) ? reinterpret_cast<header *>(base)->version : 0; }
+
+int bindata_file::kind() const
+{ return (base) ? reinterpret_cast<header *>(base)->kind : 0; }
+
+int bindata_file::ports() const
+{ return (base) ? reinterpret_cast<header *>(base)->ports : 0; }
+
+double bindata_file::znorm() const
+{ return (base) ? reinterpret_cast<header *>(base)->znorm : 0.0; }
+
+int bindata_file::columns() const
+{ return (base) ? reinterpret_cast<header *>(base)->columns : 0; }
+
+int bindata_file::column(const char * name) const
+{
+  for (int i = 1; i <= columns(); ++i)
+    if (strcmp(descriptors(base)[i-1].name, name) == 0) return i;
+  return 0;
+}
+
+const char * bindata_file::name(int i) const
+{ return (i >= 1 && i <= columns()) ? descriptors(base)[i-1].name : ""; }
+
+int bindata_file::type(int i) const
+{ return (i >= 1 && i <= columns()) ? descriptors(base)[i-1].type : 0; }
+
+unsigned long bindata_file::rows(int i) const
+{ return (i >= 1 && i <= columns()) ? descriptors(base)[i-1].rows : 0; }
+
+unsigned long bindata_file::width(int i) const
+{ return (i >= 1 && i <= columns()) ? descriptors(base)[i-1].width : 0; }
+
+double * bindata_file::real_data(int i) const
+{
+  if (type(i) != REAL) return 0;
+  return reinterpret_cast<double *>(base + descriptors(base)[i-1].offset);
+}
+
+Complex * bindata_file::complex_data(int i) const
+{
+  if (type(i) != COMPLEX) return 0;
+  return reinterpret_cast<Complex *>(base + descriptors(base)[i-1].offset);
+}
+
+
+// ********************************************************************
+// bindata_table
+
+bindata_table::bindata_table(const char * name) :
+  file(name), ncolumns(check()), nlines((ncolumns) ? int(file.rows(1)) : 0),
+  data((ncolumns) ? file.real_data(1) : 0, ncolumns, nlines, Index_1, Index_1)
+{ }
+
+// check() is called during construction, after file has been mapped; it
+// returns the number of columns in the table, or 0 if the file isn't a
+// properly arranged TABLE file.
+
+int bindata_table::check()
+{
+  if (!file.good()) return 0;
+  if (file.kind() != bindata_file::TABLE) {
+    error::warning("bindata file does not contain a table.");
+    return 0;
+  }
+
+  int n = file.columns();
+  unsigned long lines = (n > 0) ? file.rows(1) : 0;
+  for (int i = 1; i <= n; ++i) {
+    // the columns must be REAL, the same length, and contiguous
+    if (file.type(i) != bindata_file::REAL || file.rows(i) != lines ||
+	file.width(i) != 1 || file.real_data(i) != file.real_data(1) + (i-1)*lines) {
+      error::warning("bindata file table columns are improperly arranged.");
+      return 0;
+    }
+  }
+  return n;
+}
+
+
+// ********************************************************************
+// writing bindata files
+
+namespace {
+
+  // a column to be written
+  struct column_data {
+    string name;
+    uint32_t type;
+    uint64_t rows, width;
+    vector<double> values;   // complex values stored as real, imaginary pairs
+  };
+
+  // write the header, descriptors, and data for the columns. The data of
+  // the columns are written one after the other with no padding.
+  bool write(const char * name, uint32_t kind, uint32_t ports, double znorm,
+	     const vector<column_data> & cols)
+  {
+    header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = bindata_file::VERSION;
+    h.order = byte_order;
+    h.kind = kind;
+    h.columns = uint32_t(cols.size());
+    h.ports = ports;
+    h.znorm = znorm;
+
+    vector<descriptor> d(cols.size());
+    uint64_t offset = sizeof(header) + cols.size() * sizeof(descriptor);
+    for (unsigned i = 0; i < cols.size(); ++i) {
+      memset(&d[i], 0, sizeof(descriptor));
+      strncpy(d[i].name, cols[i].name.c_str(), sizeof(d[i].name) - 1);
+      d[i].type = cols[i].type;
+      d[i].rows = cols[i].rows;
+      d[i].width = cols[i].width;
+      d[i].offset = offset;
+      offset += cols[i].values.size() * sizeof(double);
+    }
+    h.length = offset;
+
+    ofstream out(name, ios::out | ios::binary | ios::trunc);
+    if (!out) {
+      error::warning("Couldn't open bindata file for writing: ", name);
+      return false;
+    }
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    if (!d.empty())
+      out.write(reinterpret_cast<const char *>(&d[0]), d.size() * sizeof(descriptor));
+    for (unsigned i = 0; i < cols.size(); ++i)
+      if (!cols[i].values.empty())
+	out.write(reinterpret_cast<const char *>(&cols[i].values[0]),
+		  cols[i].values.size() * sizeof(double));
+    if (!out) {
+      error::warning("Error writing bindata file: ", name);
+      return false;
+    }
+    return true;
+  }
+
+  // fill a pair of columns (frequencies and matrices) from an interpolator
+  void fill(column_data & f, column_data & M, const interpolator<Matrix> & I, int N)
+  {
+    f.type = bindata_file::REAL;    f.rows = I.size(); f.width = 1;
+    M.type = bindata_file::COMPLEX; M.rows = I.size(); M.width = N*N;
+    f.values.reserve(f.rows);
+    M.values.reserve(2 * M.rows * M.width);
+    for (unsigned k = 0; k < I.size(); ++k) {
+      f.values.push_back(I.x(k));
+      const Matrix & A = I[k];
+      for (int i = 1; i <= N; ++i)
+	for (int j = 1; j <= N; ++j) {
+	  Complex z = A.read(i,j);
+	  M.values.push_back(z.real);
+	  M.values.push_back(z.imaginary);
+	}
+    }
+  }
+
+} // namespace
+
+
+bool bindata_write(const char * name, const datafile & D)
+{
+  int n = D.numcolumns(), lines = D.numlines();
+  vector<column_data> cols(n);
+  for (int c = 1; c <= n; ++c) {
+    column_data & C = cols[c-1];
+    char b[16]; snprintf(b, sizeof(b), "%d", c);
+    C.name = b;
+    C.type = bindata_file::REAL;
+    C.rows = lines;
+    C.width = 1;
+    C.values.resize(lines);
+    for (int l = 1; l <= lines; ++l)
+      C.values[l-1] = D.read(c, l);
+  }
+  return write(name, bindata_file::TABLE, 0, 0.0, cols);
+}
+
+
+bool bindata_write(const char * name, const S_interp & S)
+{
+  if (!S.ready()) {
+    error::warning("Can't write bindata file from an S_interp which isn't built: ", name);
+    return false;
+  }
+
+  int N = S.ports();
+  vector<column_data> cols(S.has_noise() ? 4 : 2);
+  cols[0].name = "f";
+  cols[1].name = "S";
+  fill(cols[0], cols[1], S.S_interpolator(), N);
+  if (S.has_noise()) {
+    cols[2].name = "fC";
+    cols[3].name = "C";
+    fill(cols[2], cols[3], S.C_interpolator(), N);
+  }
+  return write(name, bindata_file::SDATA, N, S.Znorm(), cols);
+}
+
+
+bool datafile_to_bindata(const char * text, const char * name)
+{
+  datafile D(text);
+  if (D.numcolumns() == 0) return false;
+  return bindata_write(name, D);
+}
+
+
+bool touchstone_to_bindata(const char * text, const char * name,
+			   int ports, double f_scale)
+{
+  S_interp S(ports);
+  if (!S.touchstone(text, f_scale)) return false;
+  return bindata_write(name, S);
+}
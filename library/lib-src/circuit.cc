@@ -6,18 +6,61 @@
 
 #include "circuit.h"
 #include "error.h"
+#include "sparse_lu.h"
+#include <algorithm>
+#include <map>
 
 using namespace std;
 
 
+//**************************************************************
+// the sparse network, used if method() == SPARSE
+//
+// The ports of all the devices are numbered together, 0 .. N-1, those of
+// device i starting at first[i]. With b the N waves leaving the device
+// ports, the connections give W b = S[:,ext] a + B, where W = I - S P.
+// Row p of W has -S[p][r] in the column of the port connected to r, for
+// each connected port r of the device p belongs to. Then with
+// R = E W^-1 (E picking out the external ports), the circuit has
+//
+//   S' = R S[:,ext],   B' = R B,   C' = R C R+
+//
+// and R is found one row at a time, by solving W^T y = e.
+
+struct circuit::network
+{
+  std::vector<nport *> devs;   // the devices
+  std::vector<int> first;      // the first port of each device; first.back() == N
+  std::vector<int> partner;    // the port connected to each port, or -1
+  std::vector<int> ext;        // the external ports, in label order
+  sparse_lu W;
+  std::vector<int> pos;        // where each -S[p][r] goes in W, device by device
+  std::vector<int> diag;       // where each diagonal 1 goes in W
+  std::vector<Complex> R;      // ext.size() rows of N
+  std::vector<const sdata *> d;
+  std::vector<sdata> renorm;   // copies of device data at Z0, if needed
+  bool warned;                 // of falling back to the connection tree
+
+  network() : warned(false) { }
+
+  // the combined noise and source status of the devices
+  void status(nport::data_info & info);
+
+  // calculate data at the current device::f and device::T; returns false,
+  // leaving data unchanged, if the factors of W were unreliable
+  bool solve(sdata & data, bool noise);
+};
+
+
 //**************************************************************
 // construction, assignment, and destruction
 
-circuit::circuit() : nport(0), tree_is_built(false), Temp(&T)
+circuit::circuit() : nport(0), tree_base(0), tree_is_built(false), net(0), Temp(&T), how(CONNECTIONS)
 { }
 
 
-circuit::circuit(const circuit & c) : nport(c), tree_is_built(false), Temp(c.Temp)
+circuit::circuit(const circuit & c)
+  : nport(c), tree_base(0), tree_is_built(false), net(0), Temp(c.Temp), how(c.how)
 {
   devset = c.devset;
   constack = c.constack;
@@ -34,6 +77,7 @@ circuit & circuit::operator=(const circuit & c)
     devset = c.devset;
     constack = c.constack;
     labels = c.labels;
+    how = c.how;
     tree_is_built = false;
   }
   return *this;
@@ -47,6 +91,7 @@ circuit::~circuit()
     delete del_stack.top();
     del_stack.pop();
   }
+  delete net;
 }
 
 
@@ -126,6 +171,18 @@ int circuit::add_port(nport & dev, int index)
 
 
 void circuit::build_tree()
+{
+  if(how == SPARSE) {
+    build_network();
+    tree_base = 0;   // built by calc() if it is needed
+  }
+  else
+    build_connections();
+  tree_is_built = true;
+}
+
+
+void circuit::build_connections()
 {
   nportSet devset_copy(devset);
   portStack constack_copy(constack);
@@ -234,8 +291,189 @@ void circuit::build_tree()
     tmp1 = tmp3;
   }
   tree_base = tmp1;
+}
 
-  tree_is_built = true;
+
+void circuit::build_network()
+{
+  nportSet devset_copy(devset);
+  portStack constack_copy(constack);
+
+  if(!net) net = new network;
+  network & n = *net;
+
+  // number the ports
+  n.devs.clear();
+  n.first.assign(1, 0);
+  std::map<unsigned long, int> index;
+  while(devset_copy.len() > 0) {
+    nport *dev = devset_copy.pop();
+    index[dev->id] = n.devs.size();
+    n.devs.push_back(dev);
+    n.first.push_back(n.first.back() + dev->size());
+  }
+  const int N = n.first.back();
+  if(N == 0)
+    error::fatal("No devices left after making connections in circuit::build_network!");
+
+  // the connections, then the external ports
+  n.partner.assign(N, -1);
+  int connected = 0;
+  while(!constack_copy.isEmpty()) {
+    portArray p = constack_copy.pop();
+    int p1 = n.first[index[p.get(1).id]] + p.get(1).index - 1;
+    int p2 = n.first[index[p.get(2).id]] + p.get(2).index - 1;
+    n.partner[p1] = p2;
+    n.partner[p2] = p1;
+    connected += 2;
+  }
+  n.ext.resize(labels.len());
+  for(int i = 1; i <= labels.len(); ++i)
+    n.ext[i-1] = n.first[index[labels.get(i).id]] + labels.get(i).index - 1;
+
+  if(N - connected != labels.len())
+    error::fatal("circuit::recalc(): Number of ports left after connecting circuit does"
+		 " not equal the number of ports specified with circuit::add_port.");
+
+  // the pattern of W
+  std::vector< std::pair<int,int> > entries;
+  for(unsigned i = 0; i < n.devs.size(); ++i)
+    for(int p = n.first[i]; p < n.first[i+1]; ++p)
+      for(int r = n.first[i]; r < n.first[i+1]; ++r)
+	if(n.partner[r] >= 0) entries.push_back(std::make_pair(p, n.partner[r]));
+  n.W.analyze(N, entries);
+
+  n.pos.resize(entries.size());
+  for(unsigned long e = 0; e < entries.size(); ++e)
+    n.pos[e] = n.W.position(entries[e].first, entries[e].second);
+  n.diag.resize(N);
+  for(int p = 0; p < N; ++p)
+    n.diag[p] = n.W.position(p, p);
+
+  n.R.resize(n.ext.size() * N);
+  n.d.resize(n.devs.size());
+  n.renorm.resize(n.devs.size());
+}
+
+
+void circuit::network::status(nport::data_info & info)
+{
+  info.noise = info.active = info.source = false;
+  for(unsigned i = 0; i < devs.size(); ++i) {
+    const nport::data_info & di = devs[i]->get_data_info();
+    info.noise  |= di.noise;
+    info.active |= di.active;
+    info.source |= di.source;
+  }
+}
+
+
+bool circuit::network::solve(sdata & data, bool noise)
+{
+  const int nd = devs.size();
+  const int N = first.back();
+  const int m = ext.size();
+
+  // get the device data; the noise matrices are needed only if some
+  // device is active (otherwise the passive noise formula is used)
+  nport::data_info info;
+  status(info);
+  const bool full = noise && info.noise && info.active;
+  for(int i = 0; i < nd; ++i) {
+    const sdata & di = (full) ? devs[i]->get_data() : devs[i]->get_data_S();
+    d[i] = &di;
+    if(di.get_znorm() != device::Z0 && di.get_znorm() != 0.0) {
+      renorm[i] = sdata(di, device::Z0);
+      d[i] = &renorm[i];
+    }
+  }
+
+  // fill in and factor W
+  W.clear();
+  for(int p = 0; p < N; ++p) W.value(diag[p]) = 1.0;
+  int e = 0;
+  for(int i = 0; i < nd; ++i) {
+    Complex const *const *s = & d[i]->S[0];
+    const int ni = first[i+1] - first[i];
+    for(int a = 1; a <= ni; ++a)
+      for(int b = 1; b <= ni; ++b)
+	if(partner[first[i] + b - 1] >= 0) W.value(pos[e++]) -= s[a][b];
+  }
+  if(!W.factor()) return false;
+
+  // the rows of R
+  for(int x = 0; x < m; ++x) {
+    Complex *r = &R[x*N];
+    std::fill(r, r + N, Complex(0.0));
+    r[ext[x]] = 1.0;
+    W.solve_transpose(r);
+  }
+
+  // which device each external port belongs to
+  std::vector<int> owner(m);
+  for(int y = 0; y < m; ++y)
+    owner[y] = std::upper_bound(first.begin(), first.end(), ext[y]) - first.begin() - 1;
+
+  data.resize(m);
+  data.set_znorm(device::Z0);
+  for(int x = 1; x <= m; ++x) {
+    const Complex *r = &R[(x-1)*N];
+
+    // S' = R S[:,ext]
+    for(int y = 1; y <= m; ++y) {
+      const int i = owner[y-1], f = first[i], ni = first[i+1] - f;
+      const int b = ext[y-1] - f + 1;
+      Complex const *const *s = & d[i]->S[0];
+      Complex sum = 0.0;
+      for(int a = 1; a <= ni; ++a) sum += r[f + a - 1] * s[a][b];
+      data.S[x][y] = sum;
+    }
+
+    // B' = R B
+    Complex sum = 0.0;
+    for(int i = 0; i < nd; ++i) {
+      const Complex *bi = & d[i]->B[1];
+      for(int p = first[i]; p < first[i+1]; ++p) sum += r[p] * bi[p - first[i]];
+    }
+    data.B[x] = sum;
+  }
+
+  // C' = R C R+, a device at a time
+  if(!noise) return true;
+  if(!info.noise) {
+    data.C = 0.0;
+  }
+  else if(!info.active) {
+    data.passive_noise(device::f, device::T);
+  }
+  else {
+    data.C = 0.0;
+    std::vector<Complex> rc;
+    for(int i = 0; i < nd; ++i) {
+      if(!devs[i]->get_data_info().noise) continue;
+      const int f = first[i], ni = first[i+1] - f;
+      Complex const *const *c = & d[i]->C[0];
+
+      // rc = R[:,device i] C
+      rc.resize(m * ni);
+      for(int x = 0; x < m; ++x) {
+	const Complex *r = &R[x*N + f];
+	for(int b = 1; b <= ni; ++b) {
+	  Complex sum = 0.0;
+	  for(int a = 1; a <= ni; ++a) sum += r[a-1] * c[a][b];
+	  rc[x*ni + b-1] = sum;
+	}
+      }
+      for(int x = 1; x <= m; ++x)
+	for(int y = 1; y <= m; ++y) {
+	  const Complex *r = &R[(y-1)*N + f];
+	  Complex sum = 0.0;
+	  for(int b = 0; b < ni; ++b) sum += rc[(x-1)*ni + b] * conj(r[b]);
+	  data.C[x][y] += sum;
+	}
+    }
+  }
+  return true;
 }
 
 
@@ -253,7 +491,10 @@ const nport::data_info & circuit::get_data_info()
   device::T = Temp;  // if Temp shadows T, this does nothing
 
   // get the info and adjust results based on temperature
-  info = tree_base->get_data_info();
+  if(how == SPARSE)
+    net->status(info);
+  else
+    info = tree_base->get_data_info();
   if(info.noise && Temp != old_T) info.active = true;
 
   // Restore device::T and return info
@@ -266,6 +507,21 @@ void circuit::calc(bool noise)
 {
   if(!tree_is_built) build_tree();
 
+  if(how == SPARSE) {
+    parameter old_T(device::T);
+    device::T = Temp;
+    bool ok = net->solve(data, noise);
+    device::T = old_T;
+    if(ok) return;
+
+    // a pivot was too small; use the connection tree for this point
+    if(!net->warned)
+      error::warning("circuit: unstable pivot in the SPARSE method;"
+		     " using CONNECTIONS where it occurs.");
+    net->warned = true;
+    if(!tree_base) build_connections();
+  }
+
   // Verify that the number of ports left equals the size of the labels vector.
   if(tree_base->size() != labels.len())
     error::fatal("circuit::recalc(): Number of ports left after connecting circuit does"
@@ -305,6 +561,70 @@ void circuit::calc(bool noise)
 }
 
 
+void circuit::recalc_batch(sdata_batch & b, bool noise)
+{
+  if(!tree_is_built) build_tree();
+
+  if(how == SPARSE) {
+    // the analysis of the network is shared by all the points
+    parameter old_f(device::f);
+    for(unsigned long k = 0; k < b.points(); ++k) {
+      device::f = b.freq(k);
+      calc(noise);
+      b.set(k, data);
+    }
+    device::f = old_f;
+    return;
+  }
+
+  if(tree_base->size() != labels.len())
+    error::fatal("circuit::recalc_batch(): Number of ports left after connecting circuit does"
+		 " not equal the number of ports specified with circuit::add_port.");
+
+  // save the current device::T and set to local Temp
+  parameter old_T(device::T);
+  device::T = Temp;
+
+  sdata_batch unsorted;
+  if(noise)
+    tree_base->get_batch(b.freq(), b.points(), unsorted);
+  else
+    tree_base->get_batch_S(b.freq(), b.points(), unsorted);
+
+  // sort the values into b, using the specified port assignments; each
+  // element is a whole array of values
+  const int n = b.size();
+  const unsigned long m = b.points();
+  std::vector<int> index(n+1);
+  for(int i=1; i<=n; i++)
+    index[i] = tree_base->get_port(labels.get(i));
+  for(int i=1; i<=n; i++)
+  {
+    for(int j=1; j<=n; j++)
+    {
+      std::copy(unsorted.S(index[i], index[j]), unsorted.S(index[i], index[j]) + m, b.S(i,j));
+      if(noise)
+	std::copy(unsorted.C(index[i], index[j]), unsorted.C(index[i], index[j]) + m, b.C(i,j));
+    }
+    std::copy(unsorted.B(index[i]), unsorted.B(index[i]) + m, b.B(i));
+  }
+
+  // now adjust normalizing impedance, if necessary:
+  b.set_znorm(unsorted.get_znorm());
+  if(b.get_znorm() != 0.0 && b.get_znorm() != device::Z0) {
+    sdata d;
+    for(unsigned long k = 0; k < m; ++k) {
+      b.get(k, d);
+      d.change_norm(device::Z0);
+      b.set(k, d);
+    }
+  }
+
+  // Restore device::T
+  device::T = old_T;
+}
+
+
 //**************************************************************
 
 cascade::cascade() : data_ptr_nport(), Temp(&T), last(0)
@@ -318,99 +638,164 @@ cascade::cascade() : data_ptr_nport(), Temp(&T), last(0)
 
 void cascade::recalc()
 {
-  if (last) {
-    data.resize(last->size());
-    c.Temp = Temp;
-    data_ptr = &c.get_data();
-  }
+  if (last) chain(true);
 }
 
 
 void cascade::recalc_S()
 {
-  if (last) {
-    data.resize(last->size());
-    c.Temp = Temp;
-    data_ptr = &c.get_data_S();
-  }
+  if (last) chain(false);
 }
 
 
 const nport::data_info & cascade::get_data_info()
 {
   if (last) {
-    c.Temp = Temp;
-    return c.get_data_info();
+    // just as in class circuit, the components see device::T == Temp
+    parameter old_T(device::T);
+    device::T = Temp;
+    info.noise = info.active = info.source = false;
+    for (unsigned i = 0; i < devs.size(); ++i) {
+      const data_info & d = devs[i]->get_data_info();
+      info.noise  |= d.noise;
+      info.active |= d.active;
+      info.source |= d.source;
+    }
+    if (info.noise && Temp != old_T) info.active = true;
+    device::T = old_T;
   }
-  else
-    return info;
+  return info;
 }
 
 
 cascade & cascade::add(nport & n)
 {
-  if (last) {
-    // not the first device added
-    if (last->size() == 1)
-      error::fatal("Can't add to a 1-port cascade.");
+  if (last && last->size() == 1)
+    error::fatal("Can't add to a 1-port cascade.");
+  if (n.size() != 1 && n.size() != 2)
+    error::fatal("Device added to cascade must have 1 or 2 ports");
 
-    switch (n.size()) {
+  devs.push_back(&n);
+  last = &n;
+  return *this;
+}
 
-    case 1: {
-      c.pop_port();
-      c.connect(*last, 2, n, 1);
-      last = &n;
-      break;
-    }
 
-    case 2: {
-      c.pop_port();
-      c.connect(*last, 2, n, 1);
-      c.add_port(n, 2);
-      last = &n;
-      break;
-    }
+//**************************************************************
+// cascade::chain() joins the components in order. With the accumulated
+// 2-port "a" and the next component "t", port 2 of a connected to port 1
+// of t, the result is (the same as in connection::calc_inter()):
+//
+//   S11 = a11 + a12 t11 a21 D     S12 = a12 t12 D
+//   S21 = t21 a21 D               S22 = t22 + t21 a22 t12 D
+//
+// with D = 1/(1 - a22 t11). The output noise waves and sources are:
+//
+//   P * (those of a) + Q * (those of t),   P = | 1  a12 D t11 |
+//                                              | 0    t21 D   |
+//
+//                                          Q = |  a12 D    0 |
+//                                              | t21 D a22 1 |
+//
+// so the noise correlation matrix is P Ca P~ + Q Ct Q~. If t is a 1-port
+// only the first rows apply.
 
-    default: {
-      // improper size for n
-      error::fatal("Device added to cascade must have 1 or 2 ports");
-      break;
+void cascade::chain(bool noise)
+{
+  // just as in class circuit, the components see device::T == Temp
+  parameter old_T(device::T);
+  device::T = Temp;
+
+  // If no component is active, the result is passive too, so its noise
+  // is calculated at the end. Otherwise we need the noise of every one.
+  bool active = false;
+  for (unsigned i = 0; i < devs.size(); ++i)
+    active |= devs[i]->get_data_info().active;
+  bool full = noise && active;
+
+  // the accumulated result
+  complex s11, s12, s21, s22, c11, c12, c21, c22, b1, b2;
+  bool has_noise = false;
+  int size = 2;
+
+  for (unsigned i = 0; i < devs.size(); ++i) {
+    nport & d = *devs[i];
+    const data_info di = d.get_data_info();
+    const sdata & dref = (full) ? d.get_data() : d.get_data_S();
+    sdata * pd = 0;  // used only if renormalization needed
+    if (dref.get_znorm() != device::Z0 && dref.get_znorm() != 0.0)
+      pd = new sdata(dref, device::Z0);
+    const sdata & t = (pd) ? *pd : dref;
+    has_noise |= di.noise;
+
+    // the values of t, with zeroes for a noiseless or sourceless device
+    complex t11 = t.S[1][1], t12, t21, t22;
+    complex u11, u12, u21, u22, bt1, bt2;
+    if (full && di.noise) u11 = t.C[1][1];
+    if (di.source) bt1 = t.B[1];
+    if (d.size() == 2) {
+      t12 = t.S[1][2]; t21 = t.S[2][1]; t22 = t.S[2][2];
+      if (full && di.noise) {
+	u12 = t.C[1][2]; u21 = t.C[2][1]; u22 = t.C[2][2];
+      }
+      if (di.source) bt2 = t.B[2];
     }
-
-    } //switch
-
-  }
-  else {
-    // first device added
-
-    switch (n.size()) {
-
-    case 1: {
-      c.add_port(n, 1);
-      last = &n;
-      break;
+    delete pd;
+
+    if (i == 0) {
+      // the first component
+      s11 = t11; s12 = t12; s21 = t21; s22 = t22;
+      c11 = u11; c12 = u12; c21 = u21; c22 = u22;
+      b1 = bt1; b2 = bt2;
+      size = d.size();
+      continue;
     }
 
-    case 2: {
-      c.add_port(n, 1);
-      c.add_port(n, 2);
-      last = &n;
-      break;
+    complex D = 1.0 - s22*t11;
+    if (zabs(D) < Tiny) D = Tiny;
+    D = 1.0/D;
+    complex p = s12*D*t11, q = t21*D;   // the elements of P and Q
+    complex r = s12*D, w = t21*D*s22;
+
+    if (full) {
+      complex n11 = c11 + p*c21 + (c12 + p*c22)*zconj(p) + zmagsq(r)*u11;
+      complex n12 = (c12 + p*c22)*zconj(q) + r*(u11*zconj(w) + u12);
+      complex n21 = q*(c21 + c22*zconj(p)) + (w*u11 + u21)*zconj(r);
+      complex n22 = zmagsq(q)*c22 + zmagsq(w)*u11 + w*u12 + u21*zconj(w) + u22;
+      c11 = n11; c12 = n12; c21 = n21; c22 = n22;
     }
 
-    default: {
-      // improper size for n
-      error::fatal("Device added to cascade must have 1 or 2 ports");
-      break;
-    }
+    complex n1 = b1 + p*b2 + r*bt1;
+    b2 = q*b2 + w*bt1 + bt2;
+    b1 = n1;
 
-    } //switch
+    complex n11 = s11 + p*s21;   // a11 + a12 t11 a21 D
+    s12 = r*t12;
+    s21 = q*s21;
+    s22 = t22 + w*t12;
+    s11 = n11;
 
+    size = d.size();
   }
 
-  return *this;
-}
-
-
-
+  data.resize(size);
+  data.set_znorm(device::Z0);
+  data.S[1][1] = s11; data.B[1] = b1;
+  if (full) data.C[1][1] = c11;
+  if (size == 2) {
+    data.S[1][2] = s12; data.S[2][1] = s21; data.S[2][2] = s22;
+    data.B[2] = b2;
+    if (full) {
+      data.C[1][2] = c12; data.C[2][1] = c21; data.C[2][2] = c22;
+    }
+  }
+  if (noise && !full) {
+    if (has_noise)
+      data.passive_noise(device::f, device::T);
+    else
+      data.C = 0.0;
+  }
+  data_ptr = &data;
 
+  device::T = old_T;
+}
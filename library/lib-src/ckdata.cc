@@ -24,13 +24,33 @@ using namespace std;
 // Its size is set by find_max_bessel_n()
 
 // find_max_bessel_n() will calculate the proper size of bessel_values so
-// that all functions with values bigger than ZEROTOL are returned.
+// that all functions with values bigger than tol are returned.
 // The argument x must be nonnegative; returns: bessel_values.Rmaxindex()
+//
+// For tol == ZEROTOL it uses fits to the orders; otherwise it uses the
+// Debye asymptotic form of Jn(x) for n > x, which is slightly larger than
+// |Jn(x)|:
+//   ln Jn(x) ~= sqrt(n*n - x*x) - n*acosh(n/x) - ln(2*Pi*sqrt(n*n - x*x))/2
+
+static int debye_bessel_n(const double x, const double tol)
+{
+  if ( x < tol ) return 0;
+  double lt = log(tol);
+  int n = int(x) + 1;
+  for ( ; ; ++n ) {
+    double s = sqrt(double(n)*n - x*x);
+    if ( s - n*acosh(n/x) - 0.5*log(2*Pi*s) < lt ) break;
+  }
+  return n;
+}
 
 int ckdata::find_max_bessel_n(const double x)
 {
-  int nmax;  // the maximum order of |Jn(x)| > ZEROTOL
-  if ( x < ZEROTOL ) {       // for x near zero, J1(x) ~= x/2.0
+  int nmax;  // the maximum order of |Jn(x)| > tol
+  if ( tol != ZEROTOL ) {
+    nmax = debye_bessel_n(x, tol);
+  }
+  else if ( x < ZEROTOL ) {       // for x near zero, J1(x) ~= x/2.0
     nmax = 0;
   }
   else if ( x < 2*sqrt(ZEROTOL) ) { // in this range, J2(x)~=x*x/8.0
@@ -171,15 +191,15 @@ int ckdata::fillA(const Complex a)    // a is the complex version of alpha, ie:
 // The public variable Ck is a symmetrically-indexed vector which holds the SIS
 // junction large-signal convolution constants (Ck) for +/- values of k.  The
 // public variable Tol is approximately the magnitude of the smallest nonzero
-// value in Ck.  It is equal to the #define'd value ZEROTOL in global.h, which
-// is used by calc() to limit the depth of its calculations, saving time and
-// memory.
+// value in Ck.  It is equal to tolerance(), by default the #define'd value
+// ZEROTOL in global.h, which is used by calc() to limit the depth of its
+// calculations, saving time and memory.
 
 // calc() generates the large-signal harmonic voltage convolution
 // constants Ck, given a vector of voltages at each harmonic, the
 // Local Oscillator frequency, and the gap voltage of the SIS junction.
 // Both fLO and VGap must be > 0.0, or calc() will empty Ck.
-// calc() also sets Tol to the value of ZEROTOL.
+// calc() also sets Tol to the value of tolerance().
 // See FR notebook, pg 65 for derivations of index limits used in calc().
 
 // this is a helper fcn for calc(); definition follows calc()
@@ -191,7 +211,7 @@ ckdata & ckdata::calc(
 		      )
 {
   const int INITSIZE = 20;   // for temporary table alloc
-  static Matrix C(2, INITSIZE, Index_C, Index_S);  // will hold intermediate results
+  static thread_local Matrix C(2, INITSIZE, Index_C, Index_S);  // will hold intermediate results
   C.fillall(0.0);
   int curr = 0;   // will be either 0 or 1: picks a row of C
   int cmax, pmax; // like individual Rmaxindex() for current and previous C result
@@ -231,8 +251,8 @@ ckdata & ckdata::calc(
   }
   
   // C[curr] has the results
-  Ck = row(curr, C).shrink(ZEROTOL);  //this will reallocate Ck to be big enough
-  Tol = ZEROTOL;
+  Ck = row(curr, C).shrink(tol);  //this will reallocate Ck to be big enough
+  Tol = tol;
   return *this;
 }
 
@@ -43,15 +43,20 @@ connection::connection(nport & d, int p1, int p2)
  
 void connection::calc_intra()
 {
-  // We will access raw data since it's faster.
-  /*register*/ int k = port1;
-  /*register*/ int l = port2;
-
   // Get the data from the device
   info = dev1.get_data_info();
   const sdata& devdata = (info.noise && info.active && calc_noise) ?
     dev1.get_data() : dev1.get_data_S();
 
+  intra(devdata);
+}
+
+void connection::intra(const sdata & devdata)
+{
+  // We will access raw data since it's faster.
+  /*register*/ int k = port1;
+  /*register*/ int l = port2;
+
   int devdatasize = devdata.size();
   data.set_znorm(devdata.get_znorm());
 
@@ -114,8 +119,8 @@ void connection::calc_intra()
 	complex sik = si[k];
 	complex tmp1 = sil*slk + sll*sik;
 	complex tmp2 = sik*skl + skk*sil;
-	b = 1;
-	for(j=1; j<=devdatasize; ++j) if(j != k && j != l) {
+	b = a;  // only the upper triangle; C is hermitian
+	for(j=i; j<=devdatasize; ++j) if(j != k && j != l) {
 	  complex tmp3 = zconj(s[j][l]*slk+sll*s[j][k]);
 	  complex tmp4 = zconj(s[j][k]*skl+skk*s[j][l]);
 	  x = tmp1 * (ck[l]* tmp4 + ck[k]* tmp3);
@@ -124,6 +129,7 @@ void connection::calc_intra()
 	  x += ci[j];
 	  x += (cl[j]* tmp2 + ck[j]* tmp1) * denom;
 	  x += (ci[l]* tmp4 + ci[k]* tmp3) * zconj(denom);
+	  data.C[b][a] = zconj(x);
 	  data.C[a][b] = x;
 	  ++b;
 	}
@@ -202,12 +208,6 @@ connection::connection(nport& d1, int p1, nport& d2, int p2)
 
 void connection::calc_inter()
 {
-
-  // We will access raw data since it's faster.
-  /*register*/ int k = port1;
-  /*register*/ int l = port2;
-  sdata *pd1 = 0, *pd2 = 0;   // we'll use these only if renormalization needed
-
   // Get the data from dev1 and dev2
   const data_info & info1 = dev1.get_data_info();
   const data_info & info2 = dev2.get_data_info();
@@ -216,6 +216,17 @@ void connection::calc_inter()
   const sdata& d2ref =  (calc_noise && (info1.active || info2.active)) ?
     dev2.get_data() : dev2.get_data_S();
 
+  inter(d1ref, d2ref, info1, info2);
+}
+
+void connection::inter(const sdata & d1ref, const sdata & d2ref,
+		       const data_info & info1, const data_info & info2)
+{
+  // We will access raw data since it's faster.
+  /*register*/ int k = port1;
+  /*register*/ int l = port2;
+  sdata *pd1 = 0, *pd2 = 0;   // we'll use these only if renormalization needed
+
   // set up normalizing impedance and the references data1 and data2
   data.set_znorm(device::Z0);
   if(d1ref.get_znorm() != device::Z0 && d1ref.get_znorm() != 0.0)
@@ -319,13 +330,14 @@ void connection::calc_inter()
       a = 1;
       for(i=1; i<=data1size; ++i) if(i != k)
 	{
-	  b = 1;
-	  for(j=1; j<=data1size; ++j) if(j != k)
+	  b = a;  // only the upper triangle; C is hermitian
+	  for(j=i; j<=data1size; ++j) if(j != k)
 	    {
 	      x = c[i][j] + c[i][k]*zconj(s[j][k]*tll*denom);
 	      x += c[k][j]*s[i][k]*tll*denom;
 	      x += (ull + zmagsq(tll)* ckk) *
 		s[i][k]*zconj(s[j][k])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
@@ -335,20 +347,21 @@ void connection::calc_inter()
       a = data1size;
       for(i=1; i<=data2size; ++i) if(i != l)
 	{
-	  b = data1size;
-	  for(j=1; j<=data2size; ++j) if(j != l)
+	  b = a;
+	  for(j=i; j<=data2size; ++j) if(j != l)
 	    {
 	      x = u[i][j] + u[i][l]*zconj(t[j][l]*skk*denom);
 	      x += u[l][j]*t[i][l]*skk*denom;
 	      x += (ckk + zmagsq(skk)* ull) *
 		t[i][l]*zconj(t[j][l])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
 	  ++a;
 	}
       
-      a = 1;
+      a = 1;  // the off-diagonal blocks are each other's dagger
       for(i=1; i<=data1size; ++i) if(i != k)
 	{
 	  b = data1size;
@@ -358,22 +371,7 @@ void connection::calc_inter()
 	      x += u[l][j]*s[i][k]*denom;
 	      x += (tll*ckk + zconj(skk)*ull) *
 		s[i][k]*zconj(t[j][l])*denom1;
-	      data.C[a][b] = x;
-	      ++b;
-	    }
-	  ++a;
-	}
-      
-      a = data1size;
-      for(i=1; i<=data2size; ++i) if(i != l)
-	{
-	  b = 1;
-	  for(j=1; j<=data1size; ++j) if(j != k)
-	    {
-	      x = u[i][l]*zconj(s[j][k]*denom);
-	      x += c[k][j]*t[i][l]*denom;
-	      x += (skk*ull + zconj(tll)*ckk) *
-		t[i][l]*zconj(s[j][k])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
@@ -390,12 +388,13 @@ void connection::calc_inter()
       a = 1;
       for(i=1; i<=data1size; ++i) if(i != k)
 	{
-	  b = 1;
-	  for(j=1; j<=data1size; ++j) if(j != k)
+	  b = a;  // only the upper triangle; C is hermitian
+	  for(j=i; j<=data1size; ++j) if(j != k)
 	    {
 	      x = c[i][j] + c[i][k]*zconj(s[j][k]*tll*denom);
 	      x += c[k][j]*s[i][k]*tll*denom;
 	      x += zmagsq(tll)*ckk*s[i][k]*zconj(s[j][k])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
@@ -405,16 +404,18 @@ void connection::calc_inter()
       a = data1size;
       for(i=1; i<=data2size; ++i) if(i != l)
 	{
-	  b = data1size;
-	  for(j=1; j<=data2size; ++j) if(j != l)
+	  b = a;
+	  for(j=i; j<=data2size; ++j) if(j != l)
 	    {
-	      data.C[a][b] = ckk*t[i][l]*zconj(t[j][l])*denom1;
+	      x = ckk*t[i][l]*zconj(t[j][l])*denom1;
+	      data.C[b][a] = zconj(x);
+	      data.C[a][b] = x;
 	      ++b;
 	    }
 	  ++a;
 	}
       
-      a = 1;
+      a = 1;  // the off-diagonal blocks are each other's dagger
       for(i=1; i<=data1size; ++i) if(i != k)
 	{
 	  b = data1size;
@@ -422,20 +423,7 @@ void connection::calc_inter()
 	    {
 	      x = c[i][k]*zconj(t[j][l]*denom);
 	      x += tll*ckk*s[i][k]*zconj(t[j][l])*denom1;
-	      data.C[a][b] = x;
-	      ++b;
-	    }
-	  ++a;
-	}
-      
-      a = data1size;
-      for(i=1; i<=data2size; ++i) if(i != l)
-	{
-	  b = 1;
-	  for(j=1; j<=data1size; ++j) if(j != k)
-	    {
-	      x = c[k][j]*t[i][l]*denom;
-	      x += zconj(tll)*ckk*t[i][l]*zconj(s[j][k])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
@@ -452,10 +440,12 @@ void connection::calc_inter()
       a = 1;
       for(i=1; i<=data1size; ++i) if(i != k)
 	{
-	  b = 1;
-	  for(j=1; j<=data1size; ++j) if(j != k)
+	  b = a;  // only the upper triangle; C is hermitian
+	  for(j=i; j<=data1size; ++j) if(j != k)
 	    {
-	      data.C[a][b] = ull*s[i][k]*zconj(s[j][k])*denom1;
+	      x = ull*s[i][k]*zconj(s[j][k])*denom1;
+	      data.C[b][a] = zconj(x);
+	      data.C[a][b] = x;
 	      ++b;
 	    }
 	  ++a;
@@ -464,19 +454,20 @@ void connection::calc_inter()
       a = data1size;
       for(i=1; i<=data2size; ++i) if(i != l)
 	{
-	  b = data1size;
-	  for(j=1; j<=data2size; ++j) if(j != l)
+	  b = a;
+	  for(j=i; j<=data2size; ++j) if(j != l)
 	    {
 	      x = u[i][j] + u[i][l]*zconj(t[j][l]*skk*denom);
 	      x += u[l][j]*t[i][l]*skk*denom;
 	      x += zmagsq(skk)*ull*t[i][l]*zconj(t[j][l])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
 	  ++a;
 	}
       
-      a = 1;
+      a = 1;  // the off-diagonal blocks are each other's dagger
       for(i=1; i<=data1size; ++i) if(i != k)
 	{
 	  b = data1size;
@@ -484,20 +475,7 @@ void connection::calc_inter()
 	    {
 	      x = u[l][j]*s[i][k]*denom;
 	      x += zconj(skk)*ull*s[i][k]*zconj(t[j][l])*denom1;
-	      data.C[a][b] = x;
-	      ++b;
-	    }
-	  ++a;
-	}
-      
-      a = data1size;
-      for(i=1; i<=data2size; ++i) if(i != l)
-	{
-	  b = 1;
-	  for(j=1; j<=data1size; ++j) if(j != k)
-	    {
-	      x = u[i][l]*zconj(s[j][k]*denom);
-	      x += skk*ull*t[i][l]*zconj(s[j][k])*denom1;
+	      data.C[b][a] = zconj(x);
 	      data.C[a][b] = x;
 	      ++b;
 	    }
@@ -605,12 +583,17 @@ connection::connection(nport & d1, nport & d2)
 
 void connection::calc_block()
 {
-  sdata *pd1 = 0, *pd2 = 0;   // we'll use these only if renormalization needed
-
   // Get the data from the devices to be joined.
   const sdata& d1ref = (calc_noise) ? dev1.get_data() : dev1.get_data_S();
   const sdata& d2ref = (calc_noise) ? dev2.get_data() : dev2.get_data_S();
 
+  block(d1ref, d2ref);
+}
+
+void connection::block(const sdata & d1ref, const sdata & d2ref)
+{
+  sdata *pd1 = 0, *pd2 = 0;   // we'll use these only if renormalization needed
+
   // set up normalizing impedance and the references data1 and data2
   data.set_znorm(device::Z0);
   if(d1ref.get_znorm() != device::Z0 && d1ref.get_znorm() != 0.0)
@@ -748,3 +731,66 @@ void connection::recalc_S()
   }
 }
 
+
+//**************************************************************
+// batches: the devices calculate their batches, then the
+// connection is made at each frequency as above
+
+void connection::recalc_batch(sdata_batch & b, bool noise)
+{
+  calc_noise = noise;
+  const double * f = b.freq();
+  const unsigned long n = b.points();
+  sdata_batch b1, b2;
+  sdata d1, d2;
+
+  switch(connection_type)
+  {
+    case INTER: {
+      data_info info1 = dev1.get_data_info();
+      data_info info2 = dev2.get_data_info();
+      if(calc_noise && (info1.active || info2.active)) {
+	dev1.get_batch(f, n, b1); dev2.get_batch(f, n, b2);
+      }
+      else {
+	dev1.get_batch_S(f, n, b1); dev2.get_batch_S(f, n, b2);
+      }
+      for(unsigned long k = 0; k < n; ++k) {
+	device::f = f[k];
+	b1.get(k, d1); b2.get(k, d2);
+	inter(d1, d2, info1, info2);
+	b.set(k, data);
+      }
+      break;
+    }
+    case INTRA:
+      info = dev1.get_data_info();
+      if(info.noise && info.active && calc_noise)
+	dev1.get_batch(f, n, b1);
+      else
+	dev1.get_batch_S(f, n, b1);
+      for(unsigned long k = 0; k < n; ++k) {
+	device::f = f[k];
+	b1.get(k, d1);
+	intra(d1);
+	b.set(k, data);
+      }
+      break;
+    case BLOCK:
+      if(calc_noise) {
+	dev1.get_batch(f, n, b1); dev2.get_batch(f, n, b2);
+      }
+      else {
+	dev1.get_batch_S(f, n, b1); dev2.get_batch_S(f, n, b2);
+      }
+      for(unsigned long k = 0; k < n; ++k) {
+	device::f = f[k];
+	b1.get(k, d1); b2.get(k, d2);
+	block(d1, d2);
+	b.set(k, data);
+      }
+      break;
+    default:
+      error::fatal("Unknown connection type in connection::recalc_batch()");
+  }
+}
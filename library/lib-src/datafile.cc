@@ -5,6 +5,7 @@
 // datafile.cc
 
 #include "datafile.h"
+#include "bindata.h"
 #include "error.h"
 #include <cstdio>             // for snprintf()
 #include <cstdlib>            // for strtod()
@@ -48,6 +49,15 @@ static void skipnonwhite(char * & c)
 datafile::datafile(char const * const filename) : 
   ncolumns(0), nlines(0), data(0)
 {
+  if(bindata_file::is_bindata(filename)) {
+    // a binary TABLE file (see bindata.h); no parsing is needed
+    bindata_table b(filename);
+    ncolumns = b.numcolumns();
+    nlines = b.numlines();
+    data = *b.table();
+    return;
+  }
+
   ifstream infile(filename) ;
   if(!infile) {   // couldn't open the file
     char errmsg[msglen] ;
@@ -13,56 +13,147 @@ using namespace std;
 void spimp::calcZ(complex Z)
 {
   data.set_znorm(device::Z0);   // added 12/29/97
+  complex s11, s21;
+  sZ(Z, s11, s21);
+  data.S[1][1] = data.S[2][2] = s11;
+  data.S[2][1] = data.S[1][2] = s21;
+}
 
+void spimp::calcY(complex Y)
+{
+  data.set_znorm(device::Z0);
+  complex s11, s21;
+  sY(Y, s11, s21);
+  data.S[1][1] = data.S[2][2] = s11;
+  data.S[2][1] = data.S[1][2] = s21;
+}
+
+void spimp::sZ(complex Z, complex & s11, complex & s21) const
+{
   if(is_series) {
     if (Z != 0.0) {
       complex zo = 2 * device::Z0;  // common coefficient      
-      data.S[1][1] = data.S[2][2] = Z/(zo + Z);
-      data.S[2][1] = data.S[1][2] = zo/(zo + Z);
+      s11 = Z/(zo + Z);
+      s21 = zo/(zo + Z);
     }
     else /* Z == 0.0 */ {
-      data.S[1][1] = data.S[2][2] = 0.0;
-      data.S[2][1] = data.S[1][2] = 1.0;
+      s11 = 0.0;
+      s21 = 1.0;
     }
   }
   else /* parallel */ {
     if (Z != 0.0) {
       complex z = 2 * Z;  // common coefficient
-      data.S[1][1] = data.S[2][2] = -device::Z0/(z + device::Z0);
-      data.S[2][1] = data.S[1][2] = z/(z + device::Z0);
+      s11 = -device::Z0/(z + device::Z0);
+      s21 = z/(z + device::Z0);
     }
     else /* Z == 0.0 */ {
-      data.S[1][1] = data.S[2][2] = -1.0;
-      data.S[2][1] = data.S[1][2] = 0.0;
+      s11 = -1.0;
+      s21 = 0.0;
     }
   }
 }
 
-void spimp::calcY(complex Y)
+void spimp::sY(complex Y, complex & s11, complex & s21) const
 {
-  data.set_znorm(device::Z0);
-
   if(is_series) {
     if (Y != 0.0) {
       complex zoy = 2 * device::Z0 * Y;  // common coefficient      
-      data.S[1][1] = data.S[2][2] = 1/(1 + zoy);
-      data.S[2][1] = data.S[1][2] = zoy/(1 + zoy);
+      s11 = 1/(1 + zoy);
+      s21 = zoy/(1 + zoy);
     }
     else /* Y == 0.0 */ {
-      data.S[1][1] = data.S[2][2] = 1.0;
-      data.S[2][1] = data.S[1][2] = 0.0;
+      s11 = 1.0;
+      s21 = 0.0;
     }
   }
   else /* parallel */ {
     if (Y != 0.0) {
       complex zoy = device::Z0 * Y;  // common coefficient      
-      data.S[1][1] = data.S[2][2] = -zoy/(2 + zoy);
-      data.S[2][1] = data.S[1][2] = 2/(2 + zoy);
+      s11 = -zoy/(2 + zoy);
+      s21 = 2/(2 + zoy);
     }
     else /* Y == 0.0 */ {
-      data.S[1][1] = data.S[2][2] = 0.0;
-      data.S[2][1] = data.S[1][2] = 1.0;
+      s11 = 0.0;
+      s21 = 1.0;
+    }
+  }
+}
+
+void spimp::batchZ(sdata_batch & b, unsigned long k, complex Z) const
+{
+  b.set_znorm(device::Z0);
+  complex s11, s21;
+  sZ(Z, s11, s21);
+  b.S(1,1)[k] = b.S(2,2)[k] = s11;
+  b.S(2,1)[k] = b.S(1,2)[k] = s21;
+}
+
+void spimp::batchY(sdata_batch & b, unsigned long k, complex Y) const
+{
+  b.set_znorm(device::Z0);
+  complex s11, s21;
+  sY(Y, s11, s21);
+  b.S(1,1)[k] = b.S(2,2)[k] = s11;
+  b.S(2,1)[k] = b.S(1,2)[k] = s21;
+}
+
+// **************************************************************
+// the recalc_batch() functions of the spimp elements repeat the
+// calculations of their recalc() functions at each frequency
+
+void resistor::recalc_batch(sdata_batch & b, bool noise)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    batchZ(b, k, Complex(R));
+    if(noise) b.passive_noise(k, Temp);
+  }
+}
+
+void capacitor::recalc_batch(sdata_batch & b, bool)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    batchY(b, k, (2 * Pi * f * C) * I);
+  }
+}
+
+void inductor::recalc_batch(sdata_batch & b, bool)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    batchZ(b, k, (2 * Pi * f * L) * I);
+  }
+}
+
+void series_RLC::recalc_batch(sdata_batch & b, bool noise)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    if (C==0.0)
+      batchY(b, k, 0.0);
+    else
+    {
+      double omega = 2*Pi*f;
+      batchZ(b, k, Complex(R, omega*L - 1/(omega*C)));
     }
+    if(noise) b.passive_noise(k, Temp);
+  }
+}
+
+void parallel_RLC::recalc_batch(sdata_batch & b, bool noise)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    if (R==0.0 || L==0.0)
+      batchZ(b, k, 0.0);
+    else
+    {
+      double omega = 2*Pi*f;
+      batchY(b, k, Complex(1/R, omega*C - 1/(omega*L)));
+    }
+    if(noise) b.passive_noise(k, Temp);
   }
 }
 
@@ -101,6 +192,11 @@ void branch::calc()
   // Assume that data.C is already a zero matrix.
 }
 
+void branch::recalc_batch(sdata_batch & b, bool)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) b.set(k, data);
+}
+
 // **************************************************************
 
 series_tee::series_tee() : nport(3)
@@ -123,6 +219,11 @@ series_tee::series_tee() : nport(3)
   info.noise = info.active = info.source = false;
 }
 
+void series_tee::recalc_batch(sdata_batch & b, bool)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) b.set(k, data);
+}
+
 // **************************************************************
 
 void zterm::recalc()
@@ -137,6 +238,16 @@ void zterm::recalc_S()
   data.S[1][1] = (Z == 0.0) ? -1.0 : (Z - double(device::Z0))/(Z + double(device::Z0));
 }
 
+void zterm::recalc_batch(sdata_batch & b, bool noise)
+{
+  b.set_znorm(device::Z0);
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    b.S(1,1)[k] = (Z == 0.0) ? -1.0 : (Z - double(device::Z0))/(Z + double(device::Z0));
+    if(noise) b.passive_noise(k, Temp);
+  }
+}
+
 // **************************************************************
 
 void yterm::recalc()
@@ -152,3 +263,14 @@ void yterm::recalc_S()
   data.S[1][1] = (y == 0.0) ? 1.0 : (1 - y)/(1 + y);
 }
 
+void yterm::recalc_batch(sdata_batch & b, bool noise)
+{
+  b.set_znorm(device::Z0);
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    f = b.freq(k);
+    complex y = double(device::Z0) * Y;
+    b.S(1,1)[k] = (y == 0.0) ? 1.0 : (1 - y)/(1 + y);
+    if(noise) b.passive_noise(k, Temp);
+  }
+}
+
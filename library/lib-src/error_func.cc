@@ -60,12 +60,15 @@ double error_func::func_value()
     errors.reset_terms(terms);
 
     // now loop over this sweeper's parameter range
+    bool weighted = swp.weighted();
     for(; !swp.finished(); swp++) {
       tag = state_tag::get_tag();
-      errors.calc_terms(tag, terms) ;
+      errors.calc_terms(tag, terms, weighted) ;
+      swp.measure(tag);
     }
 
     // average the values of the terms
+    if(weighted) errors.apply_weights(swp, terms);
     retval += errors.get_error(swp.npoints(), terms);
   }
   return retval ;
@@ -77,13 +80,31 @@ void error_func::sweeper_info::reset_terms(error_func::term_list & terms)
   // Loop through the error terms, calling their reset methods.
   for(error_func::term_index_list_index i = 0; i < sweeper_terms.size(); i++)
     terms[sweeper_terms[i]].reset();
+  values.assign(sweeper_terms.size(), std::vector<double>());
 }
 
-void error_func::sweeper_info::calc_terms(state_tag t, error_func::term_list & terms)
+void error_func::sweeper_info::calc_terms(state_tag t, error_func::term_list & terms,
+					  bool save)
 {
   // Loop through the error terms, calling their get methods.
-  for(error_func::term_index_list_index i = 0; i < sweeper_terms.size(); i++)
+  for(error_func::term_index_list_index i = 0; i < sweeper_terms.size(); i++) {
+    double old = terms[sweeper_terms[i]].result;
     terms[sweeper_terms[i]].get(t);
+    if(save) values[i].push_back(terms[sweeper_terms[i]].result - old);
+  }
+}
+
+void error_func::sweeper_info::apply_weights(const sweeper & swp,
+					     error_func::term_list & terms)
+{
+  for(error_func::term_index_list_index i = 0; i < sweeper_terms.size(); i++) {
+    weighted_term & t = terms[sweeper_terms[i]];
+    if(!t.et->pointwise()) continue;
+    double sum = 0.0;
+    for(unsigned k = 0; k < values[i].size(); ++k)
+      sum += swp.weight(k) * values[i][k];
+    t.result = sum;
+  }
 }
 
 double error_func::sweeper_info::get_error(int n, error_func::term_list & terms)
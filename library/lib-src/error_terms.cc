@@ -126,6 +126,38 @@ double two_match::get(state_tag tag)
 }
 
 
+// The total of the junction DC currents
+static double total_current(const Vector & currents)
+{
+  double c = 0.0;
+  for(int i = currents.minindex(); i <= currents.maxindex(); i++)
+    c += currents.read(i).real;
+  return c;
+}
+
+
+void mixer_sweep_results::find_points(const abstract_real_parameter & p)
+{
+  x.clear();
+  y.clear();
+  next = 0;
+  for(swp->reset(); !swp->finished(); (*swp)++)
+    x.push_back(p);
+  swp->reset();
+}
+
+
+mixer_batch & mixer_sweep_results::batch()
+{
+  if(b == 0) {
+    b = new mixer_batch(*model);
+    b->keep_models(true).runs(run_length).small_signal(false);
+  }
+  b->threads(threads).clear();
+  return *b;
+}
+
+
 void fts_match::reset()
 {
   // We must call scaled_match_error_term::zero() in reset()
@@ -146,32 +178,69 @@ void fts_match::reset()
   dark_current = 0.0;
   for(int i=min; i<=max; i++) dark_current += currents[i].real;
 
+  // The perturbative calculation starts from the unpumped state
+  dark_voltages = mix->V_junc(0);
+
   // Make sure we leave the mixer the way we found it.
   *LO_power = old_LO_power;
+
+  if (!batch.model || perturb) return;
+
+  // Balance at every LO frequency of the sweep, and once more with the LO
+  // off for these mixers' own dark current
+  batch.find_points(*LO_freq);
+  int n = batch.x.size();
+  if (n == 0) return;
+  mixer_batch & b = batch.batch();
+  real_vector x(2);
+  for(int k = 0; k < n; k++) {
+    x[1] = batch.x[k];
+    x[2] = pumped_power;
+    b.add(x);
+  }
+  x[1] = batch.x[0];
+  x[2] = 0.0;
+  b.add(x);
+  b.run();
+
+  double dark = total_current(b[n].currents);
+  batch.y.resize(n);
+  for(int k = 0; k < n; k++)
+    batch.y[k] = total_current(b[k].currents) - dark;
 }
 
 double fts_match::get_b(state_tag)
 {
-  // Store initial LO power so that we can reset it before exit.
-  // We use a parameter in case the LO power parameter shadows another
-  parameter old_LO_power(*LO_power);
-
-  // Calculate the pumped current...
-  *LO_power = pumped_power;
-  mix->balance();
-
-  // Sum all junction DC currents into the variable response
-  currents = mix->I_junc(0);  // vector of DC bias currents
-  int min = currents.minindex();
-  int max = currents.maxindex();
-  double response = 0.0;
-  for(int i=min; i<=max; i++) response += currents[i].real;
-
-  // Make sure we leave the mixer the way we found it.
-  *LO_power = old_LO_power;
-
-  // response holds the pumped current; subtract off dark current
-  response -= dark_current;
+  double response;
+  if (batch.model && !perturb && batch.next_result(*LO_freq, response)) {
+    // response was found by reset()
+  }
+  else {
+    // Store initial LO power so that we can reset it before exit.
+    // We use a parameter in case the LO power parameter shadows another
+    parameter old_LO_power(*LO_power);
+
+    // Calculate the pumped current, or just its change...
+    *LO_power = pumped_power;
+    if (perturb)
+      currents = mix->I_rectified(dark_voltages);
+    else {
+      mix->balance();
+      currents = mix->I_junc(0);  // vector of DC bias currents
+    }
+
+    // Sum all junction DC currents into the variable response
+    int min = currents.minindex();
+    int max = currents.maxindex();
+    response = 0.0;
+    for(int i=min; i<=max; i++) response += currents[i].real;
+
+    // Make sure we leave the mixer the way we found it.
+    *LO_power = old_LO_power;
+
+    // response holds the pumped current; subtract off dark current
+    if (!perturb) response -= dark_current;
+  }
 
   // If the measured FTS data includes a freq correction factor,
   // adjust response to include it as well.
@@ -181,8 +250,30 @@ double fts_match::get_b(state_tag)
 }
 
 
+void iv_match::reset()
+{
+  if (!batch.model) return;
+
+  // Balance at every bias voltage of the sweep
+  batch.find_points(*V);
+  mixer_batch & b = batch.batch();
+  real_vector x(1);
+  for(unsigned k = 0; k < batch.x.size(); k++) {
+    x[1] = batch.x[k];
+    b.add(x);
+  }
+  b.run();
+
+  batch.y.resize(b.points());
+  for(int k = 0; k < b.points(); k++)
+    batch.y[k] = total_current(b[k].currents);
+}
+
 double iv_match::get_b()
 {
+  double found;
+  if (batch.model && batch.next_result(*V, found)) return found;
+
   mix->balance();
 
   // Sum all junction DC currents into the variable c
@@ -10,6 +10,164 @@
 
 using namespace std;
 
+// **************************************************************************
+// The closed form calculation of the fet equivalent circuit.
+//
+// The intrinsic fet, with Cgd, Rgs + Cgs, the transconductance and Rds ||
+// Cds, is written down directly as an admittance matrix (relative to the
+// intrinsic source), along with its current noise correlation matrix from
+// the thermal noise of Rgs and Rds. The common source lead (Rs + Ls), the
+// shunt pad capacitances (Cpg, Cpd) and the series gate and drain
+// elements (Rg + Lg, Rd + Ld) are then added in turn, each by a 2x2
+// matrix operation on the admittance and noise matrices, and the result
+// is converted to the S and C matrices, as sdata(const ydata &) does.
+//
+// An impedance Z in series with the port currents I changes the port
+// voltages by Z*I + e, where e is its noise voltage, so:
+//   Y' = (1 + Y*Z)^-1 * Y,  CY' = (1 + Y*Z)^-1 * (CY + Y*<e e+>*Y+) * (...)+
+// Noise is in temperature units, so that a resistor R at temperature T
+// has <|e|^2> = 4*d*R, d as in sdata::passive_noise(); the final C is
+// then scaled by Z0/4.
+
+namespace {
+
+  struct m2 { Complex a, b, c, d; };   // [[a, b], [c, d]]
+
+  inline m2 mul(const m2 & x, const m2 & y)
+  {
+    m2 r = { x.a*y.a + x.b*y.c, x.a*y.b + x.b*y.d,
+	     x.c*y.a + x.d*y.c, x.c*y.b + x.d*y.d };
+    return r;
+  }
+
+  inline m2 inverse(const m2 & x)
+  {
+    Complex det = x.a*x.d - x.b*x.c;
+    m2 r = { x.d/det, -x.b/det, -x.c/det, x.a/det };
+    return r;
+  }
+
+  // x * y * dagger(x), for hermitian y
+  inline m2 congruent(const m2 & x, const m2 & y)
+  {
+    m2 xy = mul(x, y);
+    m2 r = { xy.a*conj(x.a) + xy.b*conj(x.b), xy.a*conj(x.c) + xy.b*conj(x.d),
+	     xy.c*conj(x.a) + xy.d*conj(x.b), xy.c*conj(x.c) + xy.d*conj(x.d) };
+    return r;
+  }
+
+  // the noise "temperature" of a resistor, as in sdata::passive_noise()
+  inline double noise_d(double f, double T)
+  {
+    if(T < 0.0) T = -T;
+    if(T < Tiny) T = Tiny;
+    if(f < 0.0) f = -f;
+    double h = 0.5 * hPlanck * f / BoltzK;
+    return (f == 0.0) ? T : h / tanh(h / T);
+  }
+
+  // the element values, read once for a calculation
+  struct fet_values
+  {
+    double Lg, Ld, Ls, Rg, Rd, Rs, Rgs, Rds;
+    double Cpg, Cpd, Cgs, Cds, Cgd, G, Tau;
+    double Tg, Td, Ts, Tgs, Tds;   // resistor temperatures
+  };
+
+  void evaluate(const fet_values & v, double f, double z0, bool noise,
+		m2 & S, m2 & C)
+  {
+    const Complex jw = Complex(0.0, 2*Pi*f);
+
+    // the intrinsic fet
+    Complex yb  = jw*v.Cgs / (1.0 + jw*v.Cgs*v.Rgs);     // Rgs + Cgs branch
+    Complex gm  = v.G * exp(-jw*v.Tau) / (1.0 + jw*v.Rgs*v.Cgs);
+    Complex ygd = jw*v.Cgd;
+    m2 Y = { yb + ygd, -ygd, gm - ygd, ygd + 1.0/v.Rds + jw*v.Cds };
+    m2 CY = { 0.0, 0.0, 0.0, 0.0 };
+    double dgs = 0.0, ds = 0.0, dg = 0.0, dd = 0.0;
+    if(noise) {
+      // usually most of the resistors are at the same temperature
+      dgs = noise_d(f, v.Tgs);
+      ds = (v.Ts == v.Tgs) ? dgs : noise_d(f, v.Ts);
+      dg = (v.Tg == v.Tgs) ? dgs : noise_d(f, v.Tg);
+      dd = (v.Td == v.Tgs) ? dgs : noise_d(f, v.Td);
+      double dds = (v.Tds == v.Tgs) ? dgs : noise_d(f, v.Tds);
+
+      // Rgs's noise voltage drives both the gate and the drain currents
+      double egs = 4 * dgs * v.Rgs;
+      CY.a = egs * norm(yb);
+      CY.b = egs * yb * conj(gm);
+      CY.c = conj(CY.b);
+      CY.d = egs * norm(gm) + 4 * dds / v.Rds;
+    }
+
+    // the source lead is in series with both ports
+    {
+      Complex zs = v.Rs + jw*v.Ls;
+      Complex y1 = Y.a + Y.b, y2 = Y.c + Y.d;
+      m2 M = { 1.0 + zs*y1, zs*y1, zs*y2, 1.0 + zs*y2 };
+      M = inverse(M);
+      Y = mul(M, Y);
+      if(noise) {
+	double es = 4 * ds * v.Rs;
+	CY.a += es * norm(y1);
+	CY.b += es * y1 * conj(y2);
+	CY.c = conj(CY.b);
+	CY.d += es * norm(y2);
+	CY = congruent(M, CY);
+      }
+    }
+
+    // the pad capacitances
+    Y.a += jw*v.Cpg;
+    Y.d += jw*v.Cpd;
+
+    // the gate and drain series elements
+    {
+      Complex zg = v.Rg + jw*v.Lg, zd = v.Rd + jw*v.Ld;
+      m2 N = { 1.0 + Y.a*zg, Y.b*zd, Y.c*zg, 1.0 + Y.d*zd };
+      N = inverse(N);
+      if(noise) {
+	double eg = 4 * dg * v.Rg;
+	double ed = 4 * dd * v.Rd;
+	CY.a += eg * norm(Y.a) + ed * norm(Y.b);
+	CY.b += eg * Y.a * conj(Y.c) + ed * Y.b * conj(Y.d);
+	CY.c = conj(CY.b);
+	CY.d += eg * norm(Y.c) + ed * norm(Y.d);
+	CY = congruent(N, CY);
+      }
+      Y = mul(N, Y);
+    }
+
+    // convert to S and C
+    const double g0 = 1.0/z0;
+    m2 P = { g0 + Y.a, Y.b, Y.c, g0 + Y.d };
+    m2 Q = { g0 - Y.a, -Y.b, -Y.c, g0 - Y.d };
+    S = mul(inverse(P), Q);
+    if(noise) {
+      m2 IS = { 1.0 + S.a, S.b, S.c, 1.0 + S.d };
+      C = congruent(IS, CY);
+      C.a *= 0.25*z0; C.b *= 0.25*z0; C.c *= 0.25*z0; C.d *= 0.25*z0;
+    }
+  }
+
+  fet_values values_of(const fet & q)
+  {
+    fet_values v;
+    v.Lg = q.Lg.L;  v.Ld = q.Ld.L;  v.Ls = q.Ls.L;
+    v.Rg = q.Rg.R;  v.Rd = q.Rd.R;  v.Rs = q.Rs.R;
+    v.Rgs = q.Rgs.R;  v.Rds = q.Rds.R;
+    v.Cpg = q.Cpg.C;  v.Cpd = q.Cpd.C;  v.Cgs = q.Cgs.C;
+    v.Cds = q.Cds.C;  v.Cgd = q.Cgd.C;
+    v.G = q.Gm.G;  v.Tau = q.Gm.Tau;
+    v.Tg = q.Rg.Temp;  v.Td = q.Rd.Temp;  v.Ts = q.Rs.Temp;
+    v.Tgs = q.Rgs.Temp;  v.Tds = q.Rds.Temp;
+    return v;
+  }
+
+} // namespace
+
 void transconductance::recalc()
 {
   // Set normalization impedance. added 12/29/97
@@ -26,12 +184,12 @@ void transconductance::recalc()
   // Leave source vector at its default value, all zeroes.
 }
 
-fet::fet() : data_ptr_nport()
+fet::fet() : data_ptr_nport(), use_closed_form(true)
 {
   construct();
 }
 
-fet::fet(const fet & f) : data_ptr_nport()
+fet::fet(const fet & f) : data_ptr_nport(), use_closed_form(true)
 {
   construct();
   fet_copy(f);
@@ -119,4 +277,56 @@ void fet::fet_copy(const fet & f)
   Ld = f.Ld;
   Cpg = f.Cpg;
   Cpd = f.Cpd;
+  use_closed_form = f.use_closed_form;
+}
+
+bool fet::closed_form_ok() const
+{
+  return Lg.in_series() && Rg.in_series() && !Cpg.in_series()
+    && !Cgs.in_series() && Rgs.in_series() && Cgd.in_series()
+    && !Rds.in_series() && !Cds.in_series() && !Rs.in_series()
+    && !Ls.in_series() && !Cpd.in_series() && Rd.in_series()
+    && Ld.in_series() && Rds.R > 0.0;
+}
+
+void fet::calc(bool noise)
+{
+  prepare();
+  if(!use_closed_form || !closed_form_ok()) {
+    data_ptr = (noise) ? &fetckt.get_data() : &fetckt.get_data_S();
+    return;
+  }
+
+  m2 S, C;
+  evaluate(values_of(*this), device::f, device::Z0, noise, S, C);
+  if(data.size() != 2) data.resize(2);
+  data.set_znorm(device::Z0);
+  data.S[1][1] = S.a; data.S[1][2] = S.b;
+  data.S[2][1] = S.c; data.S[2][2] = S.d;
+  if(noise) {
+    data.C[1][1] = C.a; data.C[1][2] = C.b;
+    data.C[2][1] = C.c; data.C[2][2] = C.d;
+  }
+  data_ptr = &data;
+}
+
+void fet::recalc_batch(sdata_batch & b, bool noise)
+{
+  prepare();
+  if(!use_closed_form || !closed_form_ok()) {
+    nport::recalc_batch(b, noise);
+    return;
+  }
+
+  const fet_values v = values_of(*this);
+  const double z0 = device::Z0;
+  b.set_znorm(z0);
+  Complex *s11 = b.S(1,1), *s12 = b.S(1,2), *s21 = b.S(2,1), *s22 = b.S(2,2);
+  Complex *c11 = b.C(1,1), *c12 = b.C(1,2), *c21 = b.C(2,1), *c22 = b.C(2,2);
+  m2 S, C;
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    evaluate(v, b.freq(k), z0, noise, S, C);
+    s11[k] = S.a; s12[k] = S.b; s21[k] = S.c; s22[k] = S.d;
+    if(noise) { c11[k] = C.a; c12[k] = C.b; c21[k] = C.c; c22[k] = C.d; }
+  }
 }
@@ -0,0 +1,79 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// fft.cc
+
+#include "fft.h"
+#include "error.h"
+#include "global.h"
+#include <cmath>
+
+using namespace std;
+
+fft_plan::fft_plan(unsigned long size) : n(size)
+{
+  if (n & (n - 1))
+    error::fatal("fft_plan: transform length must be a power of 2.");
+  if (n < 2) return;
+
+  // the bit-reversal permutation
+  unsigned bits = 0;
+  while ((1UL << bits) < n) ++bits;
+  rev.resize(n);
+  for (unsigned long i = 0; i < n; ++i) {
+    unsigned long r = 0;
+    for (unsigned b = 0; b < bits; ++b)
+      if (i & (1UL << b)) r |= 1UL << (bits - 1 - b);
+    rev[i] = r;
+  }
+
+  // the twiddle factors, each calculated directly for accuracy
+  w.resize(n/2);
+  for (unsigned long j = 0; j < n/2; ++j) {
+    double a = -2*Pi*double(j)/double(n);
+    w[j] = Complex(cos(a), sin(a));
+  }
+}
+
+
+unsigned long fft_plan::size_for(unsigned long m)
+{
+  unsigned long s = 1;
+  while (s < m) s <<= 1;
+  return s;
+}
+
+
+void fft_plan::forward(Complex * x) const
+{ transform(x, false); }
+
+
+void fft_plan::inverse(Complex * x) const
+{
+  transform(x, true);
+  double s = 1.0/double(n);
+  for (unsigned long i = 0; i < n; ++i) x[i] *= s;
+}
+
+
+// iterative radix-2 decimation in time
+void fft_plan::transform(Complex * x, bool inverse) const
+{
+  if (n < 2) return;
+
+  for (unsigned long i = 0; i < n; ++i)
+    if (i < rev[i]) { Complex t = x[i]; x[i] = x[rev[i]]; x[rev[i]] = t; }
+
+  for (unsigned long len = 2; len <= n; len <<= 1) {
+    unsigned long half = len >> 1, step = n / len;
+    for (unsigned long i = 0; i < n; i += len)
+      for (unsigned long j = 0; j < half; ++j) {
+	Complex t = w[j*step];
+	if (inverse) t.imaginary = -t.imaginary;
+	t *= x[i+j+half];
+	x[i+j+half] = x[i+j] - t;
+	x[i+j] += t;
+      }
+  }
+}
@@ -29,15 +29,13 @@ fhx13x::fhx13x() : fet()
   slope = (td_297k - td_min) / (292.0 * Kelvin);
 }
 
-void fhx13x::recalc()
+void fhx13x::prepare()
 {
   // Set the drain resistor temperature.
   if(T<=5.0*Kelvin)
     Rds.Temp = td_min;
   else
     Rds.Temp = td_min + (T - 5.0*Kelvin)*slope;
-
-  data_ptr = &fetckt.get_data();
 }
 
 fhr02x::fhr02x() : fet()
@@ -63,15 +61,13 @@ fhr02x::fhr02x() : fet()
   slope = (td_297k - td_min) / (292.0 * Kelvin);
 }
 
-void fhr02x::recalc()
+void fhr02x::prepare()
 {
   // Set the drain resistor temperature.
   if(T<=5.0*Kelvin)
     Rds.Temp = td_min;
   else
     Rds.Temp = td_min + (T - 5.0*Kelvin)*slope;
-
-  data_ptr = &fetckt.get_data();
 }
 
 kukje::kukje() : fet()
@@ -97,15 +93,13 @@ kukje::kukje() : fet()
   slope = (td_297k - td_min) / (292.0 * Kelvin);
 }
 
-void kukje::recalc()
+void kukje::prepare()
 {
   // Set the drain resistor temperature.
   if(T<=5.0*Kelvin)
     Rds.Temp = td_min;
   else
     Rds.Temp = td_min + (T - 5.0*Kelvin)*slope;
-
-  data_ptr = &fetckt.get_data();
 }
 
 jpltrw160::jpltrw160() : fet()
@@ -138,15 +132,13 @@ void jpltrw160::remove_bond_wires()
   Ld.L = 0.015 * nHenry;
 }
 
-void jpltrw160::recalc()
+void jpltrw160::prepare()
 {
   // Set the drain resistor temperature.
   if(T<=12.5*Kelvin)
     Rds.Temp = td_min;
   else
     Rds.Temp = td_min + (T - 5.0*Kelvin)*slope;
-
-  data_ptr = &fetckt.get_data();
 }
 
 jpltrw300::jpltrw300() : fet()
@@ -179,13 +171,11 @@ void jpltrw300::remove_bond_wires()
   Ld.L = 0.015 * nHenry;
 }
 
-void jpltrw300::recalc()
+void jpltrw300::prepare()
 {
   // Set the drain resistor temperature.
   if(T<=12.5*Kelvin)
     Rds.Temp = td_min;
   else
     Rds.Temp = td_min + (T - 5.0*Kelvin)*slope;
-
-  data_ptr = &fetckt.get_data();
 }
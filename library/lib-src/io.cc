@@ -11,6 +11,9 @@
 #include <cctype>             // for isspace()
 #include <cstring>            // for strchr()
 #include <cstdlib>            // for strtod()
+#include <cmath>
+#include <charconv>           // for from_chars()
+#include <thread>
 
 using namespace std;
 
@@ -627,3 +630,433 @@ int touchstone_read::ports(const char * const name)
 		 "determined in file", name);
   return 0;
 }
+
+
+// ********************************************************************
+// touchstone_stream:
+
+namespace {
+
+  // Find the doubles in the null-terminated line [b,e), using the rules of
+  // data_parser::parse() with '!' as the only comment delimiter. Uses
+  // from_chars(), which is much faster than strtod(); strtod() is still
+  // used for the forms from_chars() doesn't accept (a leading '+', hex
+  // values) and for values out of range, so the results are the same.
+  void parse_line(const char * c, const char * e, std::vector<double> & v)
+  {
+    v.clear();
+    while (c < e) {
+      skipwhite(c);
+      if (*c == '\0' || *c == '!') break;
+
+      double value;
+      const char * next = c;
+      if (*c != '+') {
+	from_chars_result r = from_chars(c, e, value);
+	next = r.ptr;
+	if (r.ec == errc::result_out_of_range || *next == 'x' || *next == 'X')
+	  next = c;  // let strtod() have a try
+	else if (r.ec != errc())
+	  next = c;
+      }
+      if (next == c) {
+	char * n;
+	value = strtod(c, & n);
+	next = n;
+      }
+      if (next == c) {
+	// then it's not a double, so skip it
+	skipnonwhite(c);
+	continue;
+      }
+      v.push_back(value);
+      c = next;
+    }
+  }
+
+  // Complex value from a pair of doubles, as Complex::dtoz() does, but
+  // using the supplied format rather than the global Complex::in_mode().
+  inline Complex to_complex(double a, double b, Complex::io_mode mode)
+  {
+    switch (mode) {
+    default:
+    case Complex::cartesian:
+      return Complex(a, b);
+    case Complex::db:
+      a = pow(10.0, a/20.0);
+      // fall through
+    case Complex::degree:
+      b *= Degree;
+      // fall through
+    case Complex::polar:
+      return (b == 0.0) ? Complex(a) : polar(a, b);
+    }
+  }
+
+  // Solve A X = B for X, where A and B are N x N matrices stored row by
+  // row; X replaces B, and A is destroyed. Gaussian elimination with
+  // partial pivoting. Returns false if A is singular.
+  bool solve_in_place(int N, Complex * A, Complex * B)
+  {
+    for (int k = 0; k < N; ++k) {
+      // find the pivot
+      int p = k;
+      double big = zmagsq(A[k*N+k]);
+      for (int i = k+1; i < N; ++i)
+	if (zmagsq(A[i*N+k]) > big) { big = zmagsq(A[i*N+k]); p = i; }
+      if (big == 0.0) return false;
+      if (p != k)
+	for (int j = 0; j < N; ++j) {
+	  swap(A[k*N+j], A[p*N+j]);
+	  swap(B[k*N+j], B[p*N+j]);
+	}
+
+      // eliminate below the pivot
+      Complex d = 1.0/A[k*N+k];
+      for (int i = k+1; i < N; ++i) {
+	Complex m = A[i*N+k] * d;
+	if (m == 0.0) continue;
+	for (int j = k+1; j < N; ++j) A[i*N+j] -= m * A[k*N+j];
+	for (int j = 0; j < N; ++j)   B[i*N+j] -= m * B[k*N+j];
+      }
+    }
+
+    // back substitution
+    for (int i = N-1; i >= 0; --i) {
+      Complex d = 1.0/A[i*N+i];
+      for (int j = 0; j < N; ++j) {
+	Complex x = B[i*N+j];
+	for (int k = i+1; k < N; ++k) x -= A[i*N+k] * B[k*N+j];
+	B[i*N+j] = x * d;
+      }
+    }
+    return true;
+  }
+
+  // For every N x N matrix M in [m, m + n*N*N), replace M with the solution
+  // X to (a I + b M) X = (c I + d M). Workspace is reused for all points.
+  bool solve_all(int N, Complex * m, unsigned long n,
+		 double a, double b, double c, double d)
+  {
+    int NN = N*N;
+    vector<Complex> A(NN), B(NN);
+    bool ok = true;
+    for (unsigned long k = 0; k < n; ++k, m += NN) {
+      for (int i = 0; i < NN; ++i) { A[i] = b*m[i]; B[i] = d*m[i]; }
+      for (int i = 0; i < N; ++i)  { A[i*N+i] += a; B[i*N+i] += c; }
+      if (solve_in_place(N, &A[0], &B[0]))
+	for (int i = 0; i < NN; ++i) m[i] = B[i];
+      else
+	ok = false;
+    }
+    return ok;
+  }
+
+} // namespace
+
+
+touchstone_stream::touchstone_stream()
+  : N(0), good_(false), verbose_(true),
+    f_units(GHz), z_(50*Ohm), type_(S), mode(Complex::degree), state(SPEC)
+{ }
+
+
+bool touchstone_stream::read(const char * const str, int ports, double f_scale)
+{
+  // reset everything
+  N = 0; good_ = false; f_units = GHz; z_ = 50*Ohm;
+  type_ = S; mode = Complex::degree; state = SPEC;
+  f_.clear(); m_.clear(); nf_.clear(); noise_.clear(); rec.clear();
+  name_ = str;
+
+  if(f_scale > 0.0)
+    f_units = f_scale;
+  else
+    if(verbose_)
+      error::warning("touchstone_stream::read(): improper frequency scaling argument. Using GHz.");
+
+  if(ports <= 0) {
+    if(verbose_)
+      error::warning("touchstone_stream::read(): must call with ports > 0");
+    return false;
+  }
+
+  ifstream s(str, ios::in | ios::binary);
+  if(!s) {
+    if(verbose_)
+      error::warning("touchstone_stream::read(): could not open" , name_);
+    return false;
+  }
+  N = ports;
+  good_ = true;
+
+  // Reserve space for the points, assuming each number in the file takes
+  // about 12 characters.
+  s.seekg(0, ios::end);
+  unsigned long size = (unsigned long)(s.tellg());
+  s.seekg(0, ios::beg);
+  unsigned long guess = size / (12 * (1 + 2*N*N)) + 1;
+  f_.reserve(guess);
+  m_.reserve(guess * N*N);
+  rec.reserve(1 + 2*N*N);
+
+  // Read the file in large chunks. Complete lines in a chunk are parsed in
+  // place; a partial line at the end of a chunk is moved to the start of
+  // the buffer to be completed by the next chunk.
+  const unsigned long chunk = 1 << 20;
+  vector<char> buf(chunk + 1);
+  unsigned long held = 0;    // characters of a partial line in buf
+  bool ok = true;
+
+  while(ok && state != DONE) {
+    if(held == buf.size() - 1) buf.resize(2*buf.size());  // a very long line
+    s.read(&buf[held], buf.size() - 1 - held);
+    unsigned long end = held + s.gcount();
+    bool last = !s;
+
+    char * b = &buf[0];
+    char * e = b + end;
+    while(ok && state != DONE) {
+      char * nl = static_cast<char *>(memchr(b, '\n', e - b));
+      if(nl == 0) break;
+      *nl = '\0';
+      ok = line(b, nl);
+      b = nl + 1;
+    }
+
+    held = e - b;
+    if(last) {
+      // the final line may not have a newline
+      if(ok && held > 0 && state != DONE) { *e = '\0'; ok = line(b, e); }
+      break;
+    }
+    memmove(&buf[0], b, held);
+  }
+
+  if(ok && s.bad()) {
+    if(verbose_)
+      error::warning("touchstone_stream::read(): something failed while reading", name_);
+    ok = false;
+  }
+
+  // anything left over is an incomplete record
+  if(ok && !rec.empty()) {
+    if(verbose_)
+      error::warning("touchstone_stream::read(): incomplete data at end of file", name_);
+    ok = false;
+  }
+
+  if(ok && state == SPEC) {
+    if(verbose_)
+      error::warning("touchstone_stream::read(): found no data in file", name_ );
+    ok = false;
+  }
+
+  normalize();
+  good_ = ok;
+  return ok;
+}
+
+
+bool touchstone_stream::line(const char * b, const char * e)
+{
+  parse_line(b, e, vals);
+
+  if(state == SPEC) {
+    // Looking for the specification line or the first data
+    const char * c = b;
+    skipwhite(c);
+    if(c[0] == '#' && (c[1] == '\0' || isspace(c[1]))) {
+      state = DATA;
+      return spec(b, e);
+    }
+    if(vals.empty()) return true;
+    state = DATA;
+  }
+
+  for(unsigned i = 0; i < vals.size() && state != DONE; ++i) {
+
+    if(rec.empty() && state == DATA) {
+      // the start of a new frequency point; is it noise data?
+      double f = vals[i]*f_units;
+      if(!f_.empty() && f <= f_.back()) {
+	if(N != 2) { state = DONE; break; }
+	state = NOISE;
+	rec.push_back(vals[i]);
+	continue;
+      }
+      if(f < 0.0) {
+	if(verbose_) {
+	  error::warning("touchstone_stream::read(): negative frequency in file", name_);
+	  error::stream() << "Data line:" << endl << b << endl;
+	}
+	return false;
+      }
+    }
+
+    // a frequency point has 1 + 2*N*N values, a noise point 5
+    rec.push_back(vals[i]);
+    if(rec.size() == ((state == NOISE) ? 5u : 1u + 2*N*N)) {
+      store();
+      rec.clear();
+    }
+  }
+  return true;
+}
+
+
+bool touchstone_stream::spec(const char * b, const char * e)
+{
+  // The line should be like: "# [GHZ/MHZ/KHZ/HZ] [S/Y/Z] [MA/DB/RI] [R n]".
+  vector<string> token;
+  for(const char * c = b; c < e; ) {
+    skipwhite(c);
+    const char * next = c;
+    skipnonwhite(next);
+    if(next == c) break;
+    string t(c, next-c);
+    up(t);
+    token.push_back(t);
+    c = next;
+  }
+
+  unsigned i = 1;
+  if(i < token.size()) {
+    if     (token[i] == "GHZ") { f_units = GHz; ++i; }
+    else if(token[i] == "MHZ") { f_units = MHz; ++i; }
+    else if(token[i] == "KHZ") { f_units = Kilo*Hertz; ++i; }
+    else if(token[i] == "HZ")  { f_units = Hertz; ++i; }
+  }
+  if(i < token.size()) {
+    if     (token[i] == "S") { type_ = S; ++i; }
+    else if(token[i] == "Y") { type_ = Y; ++i; }
+    else if(token[i] == "Z") { type_ = Z; ++i; }
+  }
+  if(i < token.size()) {
+    if     (token[i] == "MA") { mode = Complex::degree; ++i; }
+    else if(token[i] == "DB") { mode = Complex::db; ++i; }
+    else if(token[i] == "RI") { mode = Complex::cartesian; ++i; }
+  }
+  if(i < token.size() && token[i] == "R" && vals.size() == 1) {
+    z_ = vals[0]*Ohm;
+    if(z_ > 0.0)
+      i += 2;  // skip over impedance entry only if it is proper
+    else
+      z_ = 50*Ohm;
+  }
+
+  if(i < token.size()) {
+    if(verbose_)
+      error::warning("touchstone_stream::read(): spec line has unrecognized syntax in", name_);
+    return false;
+  }
+  return true;
+}
+
+
+void touchstone_stream::store()
+{
+  if(state == NOISE) {
+    touchstone_read::noise ND;
+    nf_.push_back(rec[0]*f_units);
+    ND.Fmin = rec[1];
+    ND.Reff = rec[4]*z_;
+    ND.Gopt = to_complex(rec[2], rec[3], Complex::degree);
+    double r = (z_ - device::Z0)/(z_ + device::Z0);
+    ND.Gopt = (r + ND.Gopt)/(1 + r*ND.Gopt);
+    noise_.push_back(ND);
+    return;
+  }
+
+  f_.push_back(rec[0]*f_units);
+  unsigned long k = m_.size();
+  m_.resize(k + N*N);
+  Complex * M = &m_[k];
+  const double * v = &rec[1];
+
+  if(N <= 2)
+    // the 1 and 2-port matrices are listed column by column
+    for(int j = 0; j < N; ++j)
+      for(int i = 0; i < N; ++i, v += 2)
+	M[i*N+j] = to_complex(v[0], v[1], mode);
+  else
+    for(int i = 0; i < N*N; ++i, v += 2)
+      M[i] = to_complex(v[0], v[1], mode);
+}
+
+
+void touchstone_stream::normalize()
+{
+  if(m_.empty()) return;
+  Complex * p = &m_[0];
+  unsigned long n = m_.size();
+
+  switch(type_) {
+
+  case Z:
+    for(unsigned long k = 0; k < n; ++k) p[k] *= z_;
+    break;
+
+  case Y:
+    for(unsigned long k = 0; k < n; ++k) p[k] *= 1/z_;
+    break;
+
+  default:
+  case S:
+    if(z_ != device::Z0) {
+      // (I + rT) S = (rI + T)
+      double r = (z_ - device::Z0)/(z_ + device::Z0);
+      if(!solve_all(N, p, points(), 1.0, r, r, 1.0) && verbose_)
+	error::warning("touchstone_stream::read(): singular matrix renormalizing data in", name_);
+    }
+    break;
+  }
+}
+
+
+touchstone_stream & touchstone_stream::to_S()
+{
+  if(type_ != S && !m_.empty()) {
+    bool ok;
+    if(type_ == Z)
+      // (Z0 I + Z) S = (Z - Z0 I)
+      ok = solve_all(N, &m_[0], points(), device::Z0, 1.0, -device::Z0, 1.0);
+    else
+      // (I/Z0 + Y) S = (I/Z0 - Y)
+      ok = solve_all(N, &m_[0], points(), 1/device::Z0, 1.0, 1/device::Z0, -1.0);
+    if(!ok && verbose_)
+      error::warning("touchstone_stream::to_S(): singular matrix converting data in", name_);
+  }
+  type_ = S;
+  return *this;
+}
+
+
+bool touchstone_stream::read_all(std::vector<touchstone_stream> & files,
+				 const std::vector<std::string> & names,
+				 int ports, double f_scale, unsigned threads)
+{
+  unsigned long n = names.size();
+  files.resize(n);
+  if(n == 0) return true;
+  if(threads == 0) threads = thread::hardware_concurrency();
+  if(threads == 0) threads = 1;
+  if(threads > n) threads = n;
+
+  // each thread reads every threads'th file; each file's result goes to
+  // its own slot, so no locking is needed.
+  vector<char> ok(n, 0);
+  vector<thread> workers;
+  for(unsigned t = 1; t < threads; ++t)
+    workers.push_back(thread([&, t]() {
+	  for(unsigned long i = t; i < n; i += threads)
+	    ok[i] = files[i].read(names[i].c_str(), ports, f_scale);
+	}));
+  for(unsigned long i = 0; i < n; i += threads)
+    ok[i] = files[i].read(names[i].c_str(), ports, f_scale);
+  for(unsigned t = 0; t < workers.size(); ++t) workers[t].join();
+
+  for(unsigned long i = 0; i < n; ++i)
+    if(!ok[i]) return false;
+  return true;
+}
@@ -8,8 +8,10 @@
 #include "datafile.h"
 #include "junction.h"
 #include "error.h"
+#include "fft.h"
 #include <cmath>
 #include <cstdio>             // for snprintf()
+#include <vector>
 
 using namespace std;
 
@@ -19,12 +21,17 @@ static const int msglen = 2000 ;
 
 // Constructors:
 
-ivcurve::ivcurve() : valid(false)
+ivcurve::ivcurve() : valid(false), kk_n(2048)
 { }
 
 ivcurve::ivcurve(const char * const Idc_filename, const char * const Ikk_filename)
+  : valid(false), kk_n(2048)
 { data(Idc_filename, Ikk_filename); }
 
+ivcurve::ivcurve(const char * const Idc_filename)
+  : valid(false), kk_n(2048)
+{ data(Idc_filename); }
+
 /* Will add this one later...
 ivcurve::ivcurve(char *filename)
 {
@@ -36,17 +43,51 @@ ivcurve::ivcurve(char *filename)
 
 void ivcurve::data(const char * const Idc_filename, const char * const Ikk_filename)
 {
-  datafile Idc_data(Idc_filename), Ikk_data(Ikk_filename);
-  real_table const * pdata;
-  int i, max, ix, iy;
+  valid = false;
+  read(Idc, Idc_filename);
+  read(Ikk, Ikk_filename);
+  build_ikk();
+}
+
+void ivcurve::data(const char * const Idc_filename)
+{
+  valid = false;
+  read(Idc, Idc_filename);
+  calc_ikk();
+  build_ikk();
+}
+
+// initialize from DC IV data in memory:
+
+void ivcurve::data(const std::vector<double> & V, const std::vector<double> & I)
+{
+  valid = false;
+  if(V.size() != I.size())
+    error::fatal("ivcurve::data(): the voltage and current vectors differ in size.");
+  if(V.size() < 4)
+    error::fatal("ivcurve::data(): not enough IV data.");
 
-  // set up interpolators
   Idc.clear().no_extrapolation_warning(1).type(interpolator<double>::SPLINE);
-  Ikk.clear().no_extrapolation_warning(1).type(interpolator<double>::SPLINE);
+  for(unsigned i = 0; i < V.size(); ++i)
+    Idc.add(V[i], I[i]);
+  Idc.build();
+  calc_ikk();
+  build_ikk();
+}
+
+
+// load a data file into an interpolator:
 
-  // load in Idc data:
+void ivcurve::read(interpolator<double> & interp, const char * const filename)
+{
+  datafile file_data(filename);
+  real_table const * pdata;
+  int i, max, ix, iy;
+
+  // set up interpolator
+  interp.clear().no_extrapolation_warning(1).type(interpolator<double>::SPLINE);
 
-  pdata = Idc_data.table();
+  pdata = file_data.table();
   ix = pdata->Lminindex();    // index to get voltage variable
   iy = pdata->Lmaxindex();    // index to get current variable
   i  = pdata->Rminindex();    // start of data
@@ -54,11 +95,11 @@ void ivcurve::data(const char * const Idc_filename, const char * const Ikk_filen
 
   // Now do some data validity checks:
   if(iy - ix != 1) {
-    // Then improper number of columns in Idc data file
+    // Then improper number of columns in data file
     char errmsg[msglen];
     snprintf(errmsg, msglen,
 	     "Couldn't read correct data from file: %s",
-	     Idc_filename);
+	     filename);
     error::fatal(errmsg);
   }
   if(max - i < 3) {
@@ -66,47 +107,130 @@ void ivcurve::data(const char * const Idc_filename, const char * const Ikk_filen
     char errmsg[msglen];
     snprintf(errmsg, msglen,
 	     "Not enough IV data in file: %s",
-	     Idc_filename);
+	     filename);
     error::fatal(errmsg);
   }
 
   while (i <= max) {
-    Idc.add((*pdata)[ix][i],(*pdata)[iy][i]);
+    interp.add((*pdata)[ix][i],(*pdata)[iy][i]);
     ++i;
   }
-  Idc.build();
+  interp.build();  // for Ikk, this build is only useful to allow access to the sorted data
+}
 
-  // load in Ikk data:
 
-  pdata = Ikk_data.table();
-  ix = pdata->Lminindex();    // index to get voltage variable
-  iy = pdata->Lmaxindex();    // index to get current variable
-  i  = pdata->Rminindex();    // start of data
-  max = pdata->Rmaxindex();   // end of data
+// --------------------------------------------------------------------
+// Calculating Ikk from Idc
+//
+// The transform is (see examples/ivcurve/makeikk.cc):
+//
+//   Ikk(x) = (1/Pi) * Integral(0->Infinity)(Idc(v)*(1/(v-x)+1/(v+x)-2/v)*d(v))
+//
+// a Cauchy principal value. Beyond the DC data, Idc(v) = M*v + B; the term
+// M*v has a transform of 0, so we transform r(v) = Idc(v) - M*v instead,
+// which is B for v > vmax. Extending r(v) as an odd function of v, and
+// writing the integral as an integral over all v of r(v)/(v-x), minus the
+// same at x = 0:
+//
+//   * For |v| < vmax, r(v) is taken to be linear between the points of
+//     an even grid v = j*dv, j = -N .. N, so it is a sum of "hat"
+//     functions r(j*dv)*h(v/dv - j), h(t) = max(1-|t|, 0). The integral
+//     of each hat at x = i*dv is kk_kernel(j-i), so the integrals are a
+//     discrete convolution, which we do with an FFT.
+//
+//   * The half hats at j = +/-N and the constant tails r(v) = +/-B for
+//     |v| > vmax are integrated analytically by kk_ends(); the log
+//     singularities of the two at x = vmax cancel.
 
-  // Now do Ikk data validity checks:
-  if(iy - ix != 1) {
-    // Then improper number of columns in Idc data file
-    char errmsg[msglen];
-    snprintf(errmsg, msglen,
-	     "Couldn't read correct data from file: %s",
-	     Ikk_filename);
-    error::fatal(errmsg);
-  }
-  if(max - i < 3) {
-    // Then not enough data to deal with
-    char errmsg[msglen];
-    snprintf(errmsg, msglen,
-	     "Not enough IV data in file: %s",
-	     Ikk_filename);
-    error::fatal(errmsg);
+namespace {
+
+// x*log|x|, with the limit 0 at x == 0
+inline double xlogx(double x)
+{ return (x == 0.0) ? 0.0 : x*log(fabs(x)); }
+
+// the principal value of Integral(-1..1)((1-|t|)/(t+m) dt)
+double kk_kernel(long m)
+{
+  double x = double(m);
+  if (m >= 20 || m <= -20) {
+    // the exact form below suffers from cancellation, so use its series
+    double y = 1/(x*x);
+    return (1 + y*(1.0/6 + y*(1.0/15 + y*(1.0/28 + y/45))))/x;
   }
+  return xlogx(x+1) + xlogx(x-1) - 2*xlogx(x);
+}
 
-  while (i <= max) {
-    Ikk.add((*pdata)[ix][i],(*pdata)[iy][i]);
-    ++i;
+// the integrals over |v| > vmax - dv at x = i*dv, for B = 1, vmax = N*dv
+double kk_ends(long i, long N)
+{
+  // The upper end: the half hat Integral(-1..0)((1+t)/(t+m) dt), with
+  // m = N-i, and the integral of the tail for v > vmax, including the
+  // -2/v term, -log|1-(x/vmax)^2|:
+  double m = double(N - i);
+  double r = 1 - log(double(N + i)) + 2*log(double(N));
+  if (fabs(m) >= 2)
+    r += (m - 1)*log1p(-1/m) - log(fabs(m));
+  else
+    r += xlogx(m - 1) - xlogx(m);
+
+  // The lower end: r = -1 times the half hat Integral(0..1)((1-t)/(t+m) dt),
+  // with m = -N-i. The tail for v < -vmax was included above.
+  m = double(-N - i);
+  return r - ((m + 1)*log1p(1/m) - 1);
+}
+
+} // namespace
+
+void ivcurve::calc_ikk()
+{
+  long N = long(kk_n);
+  double vmax = Idc.x(Idc.size()-1);  // largest voltage in the Idc table
+  double dv = vmax/N;
+
+  // Idc(v) = M*v + B beyond vmax
+  double M, B;
+  Idc.val_prime(vmax, B, M);
+  B -= M*vmax;
+
+  // We need the results for i = 0 .. 2N, so the convolutions involve
+  // kk_kernel(u) for u = -3N .. N; for wrapping, negative indexes go into
+  // the top of the FFT arrays.
+  fft_plan plan(fft_plan::size_for(4*N));
+  long L = long(plan.size());
+  vector<Complex> r(L, 0.0), g(L, 0.0);
+  for (long j = 1; j < N; ++j) {
+    double rj = Idc(j*dv) - M*(j*dv);
+    r[j] = rj;
+    r[L-j] = -rj;
   }
-  Ikk.build();  // this build is only useful to allow access to the sorted data
+  // sum(j) r[j]*kk_kernel(j-i) is the convolution of r and g[u] = kk_kernel(-u)
+  for (long u = -N; u <= 3*N; ++u)
+    g[(u < 0) ? L+u : u] = kk_kernel(-u);
+
+  plan.forward(&r[0]);
+  plan.forward(&g[0]);
+  for (long k = 0; k < L; ++k) r[k] *= g[k];
+  plan.inverse(&r[0]);
+
+  // Ikk is smooth beyond vmax, so it is tabulated more sparsely there; this
+  // also keeps the fit of the extrapolation parameters in build_ikk() well
+  // conditioned, since it uses the final 3 points.
+  Ikk.clear().no_extrapolation_warning(1).type(interpolator<double>::SPLINE);
+  double I0 = r[0].real + B*kk_ends(0, N);
+  long step = 1;
+  for (long i = 0; i <= 2*N; i += step) {
+    Ikk.add(i*dv, (r[i].real + B*kk_ends(i, N) - I0)/Pi);
+    if (i == N && N >= 16) step = N/16;
+  }
+  Ikk.build();  // so build_ikk() can access the sorted data
+}
+
+
+// find the Ikk extrapolation parameters and finish building Ikk:
+
+void ivcurve::build_ikk()
+{
+  int i;
 
   // before completing the build of the Ikk interpolator, we need to provide endpoint
   // slopes, since the endpoint conditions don't have vanishing Ikk''(V).
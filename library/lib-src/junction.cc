@@ -0,0 +1,31 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// junction.cc
+
+#include "junction.h"
+#include "units.h"
+#include "error.h"
+
+// --------------------------------------------------------------------
+// The default direct detection response: the change in the DC current
+// caused by a small voltage at frequency f. The DC current is an even
+// function of the voltage amplitude, so the error of this estimate is of
+// relative order 1e-6.
+
+double junction::rectification(double f)
+{
+  if (f <= 0.0)
+    error::fatal("Invalid frequency in call to junction::rectification().");
+
+  Vector V0(1, Index_C);   // the unpumped state
+  V0[0] = V().read(0);
+  Vector V1(2, Index_C);
+  V1[0] = V0[0];
+  V1[1] = 1.0e-3 * f / VoltToFreq;
+
+  double I1 = large_signal(V1, f, 1).read(0).real;
+  double I0 = large_signal(V0, f, 0).read(0).real;
+  return (I1 - I0) / norm(V1[1]);
+}
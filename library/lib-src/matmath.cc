@@ -6,7 +6,9 @@
 // 5/8/09: commented out unused ResultModeMin()
 
 #include "matmath.h"
+#include "matview.h"
 #include "Amath.h"
+#include <vector>
 
 // ************************************************************************
 // Helper functions:
@@ -43,7 +45,7 @@ inline int ResultIndexMin(const int i1, const int i2)
 // ************************************************************************
 // Vector and Matrix norms:
 
-static double norm_accumulator;  // static, so confined to this file
+static thread_local double norm_accumulator;  // static, so confined to this file
 
 static inline void norm_add(double x)
 { norm_accumulator += x*x; }
@@ -196,16 +198,32 @@ complex_vector operator -(const complex_vector & x, const complex_vector & y)
   return ans;
 }
 
+// long products use the SIMD kernels of Amath.h; short ones keep the
+// ascending sum they have always had (Adot and Adotu sum descending)
 Complex operator *(const complex_vector & x, const complex_vector & y)
 {
+  int     i = max(x.minindex(), y.minindex());
+  int limit = min(x.maxindex(), y.maxindex());
+  if (limit - i + 1 >= Adot_simd_min)
+    return Adotu(&x[i], &y[i], limit - i + 1);
   Complex sum = 0;
-  /*register*/ int     i = max(x.minindex(), y.minindex());
-  /*register*/ int limit = min(x.maxindex(), y.maxindex());
   for ( ; i <= limit; ++i)
     sum += (x[i] * y[i]);
   return sum;
 }
 
+Complex dot(const complex_vector & x, const complex_vector & y)
+{
+  int     i = max(x.minindex(), y.minindex());
+  int limit = min(x.maxindex(), y.maxindex());
+  if (limit - i + 1 >= Adot_simd_min)
+    return Adot(&x[i], &y[i], limit - i + 1);
+  Complex sum = 0;
+  for ( ; i <= limit; ++i)
+    sum += (conj(x[i]) * y[i]);
+  return sum;
+}
+
 complex_vector operator +(const real_vector & x, const complex_vector & y)
 {
   // determine answer mode and size, then define it:
@@ -291,9 +309,15 @@ complex_vector scalemult(const complex_vector & x, const complex_vector & y)
   if (mode == Index_C) ++size;  // need to fix size for Index_C only
   complex_vector ans(size,mode);   // construction initializes to all 0's
 
-  // now calculate answer:
+  // now calculate answer, using the array routine where x and y overlap:
+  int lo = max(x.minindex(), y.minindex());
+  int hi = min(x.maxindex(), y.maxindex());
   for(int i = ans.minindex(); i <= ans.maxindex(); ++i)
-    ans[i] = x.read(i)*y.read(i);
+    if (i < lo || i > hi) ans[i] = x.read(i)*y.read(i);
+  if (lo <= hi) {
+    Acopy(&ans[lo], &x[lo], hi - lo + 1);
+    Amul(&ans[lo], &y[lo], hi - lo + 1);
+  }
   return ans;
 }
 
@@ -305,9 +329,15 @@ complex_vector scalediv(const complex_vector & x, const complex_vector & y)
   if (mode == Index_C) ++size;  // need to fix size for Index_C only
   complex_vector ans(size,mode);   // construction initializes to all 0's
 
-  // now calculate answer:
+  // now calculate answer, using the array routine where x and y overlap:
+  int lo = max(x.minindex(), y.minindex());
+  int hi = min(x.maxindex(), y.maxindex());
   for(int i = ans.minindex(); i <= ans.maxindex(); ++i)
-    ans[i] = x.read(i)/y.read(i);
+    if (i < lo || i > hi) ans[i] = x.read(i)/y.read(i);
+  if (lo <= hi) {
+    Acopy(&ans[lo], &x[lo], hi - lo + 1);
+    Adiv(&ans[lo], &y[lo], hi - lo + 1);
+  }
   return ans;
 }
 
@@ -1282,6 +1312,78 @@ static void copyresult(complex_matrix & X, const complex_matrix & C)
     Acopy(X[i+XLmin]+XRmin, C[i]+n, m);
 }
 
+// ************************************************************************
+// Solvers with view arguments (see matview.h):
+
+// The same elimination as solve(A,B) above, but A and B are copied into
+// the augmented matrix C straight from the views, and the solution goes
+// straight from C into X. M is the matrix type of C.
+template <class M, class MV>
+static int view_solve(MV & X, const MV & A, const MV & B)
+{
+  int n = A.Rmaxindex() - A.Rminindex() + 1;  // the column length of X
+  int m = B.Rmaxindex() - B.Rminindex() + 1;  // the row length of X
+
+  if ((A.Lmaxindex() - A.Lminindex() + 1 != n)||(n <= 0)||(m <= 0)
+      ||(B.Lminindex() != A.Lminindex())||(B.Lmaxindex() != A.Lmaxindex())
+      ||(X.Lminindex() != A.Rminindex())||(X.Lmaxindex() != A.Rmaxindex())
+      ||(X.Rminindex() != B.Rminindex())||(X.Rmaxindex() != B.Rmaxindex()))
+    return 0;
+
+  M C(n, n+m, Index_C, Index_C);
+  int Lmin = A.Lminindex(), ARmin = A.Rminindex(), BRmin = B.Rminindex();
+  for (int i = 0; i < n; ++i) {
+    Acopy(C[i],   A[i+Lmin]+ARmin, n);
+    Acopy(C[i]+n, B[i+Lmin]+BRmin, m);
+  }
+  scale(C);
+  if ( ! triangle(C)) return 0;
+  backsub(C);
+
+  int XLmin = X.Lminindex(), XRmin = X.Rminindex();
+  for (int i = 0; i < n; ++i)
+    Acopy(X[i+XLmin]+XRmin, C[i]+n, m);
+  return 1;
+}
+
+// The same for a single RHS vector, whose elements needn't be adjacent.
+template <class M, class MV, class VV>
+static int view_solve(VV & x, const MV & A, const VV & b)
+{
+  int n = A.Rmaxindex() - A.Rminindex() + 1;
+
+  if ((A.Lmaxindex() - A.Lminindex() + 1 != n)||(n <= 0)
+      ||(b.minindex() != A.Lminindex())||(b.maxindex() != A.Lmaxindex())
+      ||(x.minindex() != A.Rminindex())||(x.maxindex() != A.Rmaxindex()))
+    return 0;
+
+  M C(n, n+1, Index_C, Index_C);
+  int Lmin = A.Lminindex(), Rmin = A.Rminindex();
+  for (int i = 0; i < n; ++i) {
+    Acopy(C[i], A[i+Lmin]+Rmin, n);
+    C[i][n] = b[i+Lmin];
+  }
+  scale(C);
+  if ( ! triangle(C)) return 0;
+  backsub(C);
+
+  for (int i = 0; i < n; ++i)
+    x[i+Rmin] = C[i][n];
+  return 1;
+}
+
+int solve(real_vector_view x, const real_matrix_view & A, const real_vector_view & b)
+{ return view_solve<real_matrix>(x, A, b); }
+
+int solve(complex_vector_view x, const complex_matrix_view & A, const complex_vector_view & b)
+{ return view_solve<complex_matrix>(x, A, b); }
+
+int solve(real_matrix_view X, const real_matrix_view & A, const real_matrix_view & B)
+{ return view_solve<real_matrix>(X, A, B); }
+
+int solve(complex_matrix_view X, const complex_matrix_view & A, const complex_matrix_view & B)
+{ return view_solve<complex_matrix>(X, A, B); }
+
 // ************************************************************************
 // Special Fast Square Matrix Operations:
 
@@ -1326,21 +1428,33 @@ void MMdagger(Matrix & U, const Matrix & V)
   }
 }
   
+// MAMdagger() first forms T = V * W, then only the upper triangle of
+// U = T * dagger(V), filling the lower triangle with its conjugates; W is
+// assumed hermitian, as all noise correlation matrices are, so U is too.
+// Since W is only read while forming T, U may be the same matrix as W.
+
 void MAMdagger(Matrix & U, const Matrix & V, const Matrix & W)
 {
-  int i, j, k;
   int min = V.Lminindex(), max = V.Lmaxindex();
   int len = max - min + 1; len = (len < 0) ? 0 : len;   // length of a row
-  const complex *pVi, *pVj;
-  complex sum;
-  for (i = min; i <= max; ++i) {
-    pVi = & V[i][min];
-    for (j = min; j <= max; ++j) {
-      pVj = (& V[j][min]) - 1;
-      sum = 0.0;
-      for (k = min; k <= max; ++k)
-	sum += (*(++pVj))*Adot(pVi, &W[k][min], len);
-      U[j][i] = sum;
+  std::vector<complex> T(len*len, complex(0.0));
+
+  for (int i = 0; i < len; ++i) {
+    const complex * pVi = & V[i+min][min];
+    complex * pTi = & T[i*len];
+    for (int l = 0; l < len; ++l) {
+      complex v = pVi[l];
+      if (v == 0.0) continue;  // V is often sparse
+      const complex * pWl = & W[l+min][min];
+      for (int k = 0; k < len; ++k)
+	pTi[k] += v*pWl[k];
     }
   }
+
+  for (int i = 0; i < len; ++i) {
+    const complex * pTi = & T[i*len];
+    U[i+min][i+min] = Adot(& V[i+min][min], pTi, len).real;
+    for (int j = i + 1; j < len; ++j)
+      U[j+min][i+min] = conj( U[i+min][j+min] = Adot(& V[j+min][min], pTi, len) );
+  }
 }
@@ -0,0 +1,186 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// matview.cc
+// the operations on vector and matrix views; the solvers are in matmath.cc
+
+#include "matview.h"
+
+static inline int max(int i1, int i2) { return (i1 > i2) ? i1 : i2; }
+static inline int min(int i1, int i2) { return (i1 < i2) ? i1 : i2; }
+
+// a zero vector or matrix whose index ranges include those given
+template <class V>
+static V sized(int min, int max, v_index_mode t)
+{
+  V v(0, t);
+  if (max >= min) v.resize((t == Index_S && -min > max) ? -min : max);
+  v.fill(0.0);
+  return v;
+}
+
+template <class M>
+static M sized(int lmin, int lmax, int rmin, int rmax,
+	       v_index_mode tl, v_index_mode tr)
+{
+  M A(0, 0, tl, tr);
+  if (lmax >= lmin && rmax >= rmin)
+    A.resize((tl == Index_S && -lmin > lmax) ? -lmin : lmax,
+	     (tr == Index_S && -rmin > rmax) ? -rmin : rmax);
+  A.fill(0.0);
+  return A;
+}
+
+
+// ************************************************************************
+// vector products and norms
+
+template <class T, class VV>
+static T product(const VV & x, const VV & y)
+{
+  T sum = 0.0;
+  int i = max(x.minindex(), y.minindex());
+  int limit = min(x.maxindex(), y.maxindex());
+  for ( ; i <= limit; ++i)
+    sum += x[i] * y[i];
+  return sum;
+}
+
+double operator *(const real_vector_view & x, const real_vector_view & y)
+{ return product<double>(x, y); }
+
+Complex operator *(const complex_vector_view & x, const complex_vector_view & y)
+{ return product<Complex>(x, y); }
+
+double dot(const real_vector_view & x, const real_vector_view & y)
+{ return product<double>(x, y); }
+
+Complex dot(const complex_vector_view & x, const complex_vector_view & y)
+{
+  Complex sum = 0.0;
+  int i = max(x.minindex(), y.minindex());
+  int limit = min(x.maxindex(), y.maxindex());
+  for ( ; i <= limit; ++i)
+    sum += conj(x[i]) * y[i];
+  return sum;
+}
+
+double norm(const real_vector_view & x)
+{ return product<double>(x, x); }
+
+double norm(const complex_vector_view & x)
+{
+  double sum = 0.0;
+  for (int i = x.minindex(); i <= x.maxindex(); ++i)
+    sum += norm(x[i]);
+  return sum;
+}
+
+
+// ************************************************************************
+// matrix products
+
+template <class V, class MV, class VV>
+static V mvproduct(const MV & A, const VV & x)
+{
+  V y = sized<V>(A.Lminindex(), A.Lmaxindex(), A.Lmode);
+  int jmin = max(A.Rminindex(), x.minindex());
+  int jmax = min(A.Rmaxindex(), x.maxindex());
+  for (int i = A.Lminindex(); i <= A.Lmaxindex(); ++i) {
+    const typename MV::value_type * a = A[i];
+    typename MV::value_type sum = 0.0;
+    for (int j = jmin; j <= jmax; ++j)
+      sum += a[j] * x[j];
+    y[i] = sum;
+  }
+  return y;
+}
+
+real_vector operator *(const real_matrix_view & A, const real_vector_view & x)
+{ return mvproduct<real_vector>(A, x); }
+
+complex_vector operator *(const complex_matrix_view & A, const complex_vector_view & x)
+{ return mvproduct<complex_vector>(A, x); }
+
+template <class M, class MV>
+static M mmproduct(const MV & A, const MV & B)
+{
+  M C = sized<M>(A.Lminindex(), A.Lmaxindex(), B.Rminindex(), B.Rmaxindex(),
+		 A.Lmode, B.Rmode);
+  int kmin = max(A.Rminindex(), B.Lminindex());
+  int kmax = min(A.Rmaxindex(), B.Lmaxindex());
+  for (int i = A.Lminindex(); i <= A.Lmaxindex(); ++i) {
+    // accumulate row i of C as a sum of the rows of B
+    typename MV::value_type * c = C[i];
+    const typename MV::value_type * a = A[i];
+    for (int k = kmin; k <= kmax; ++k) {
+      if (a[k] == 0.0) continue;
+      const typename MV::value_type * b = B[k];
+      for (int j = B.Rminindex(); j <= B.Rmaxindex(); ++j)
+	c[j] += a[k] * b[j];
+    }
+  }
+  return C;
+}
+
+real_matrix operator *(const real_matrix_view & A, const real_matrix_view & B)
+{ return mmproduct<real_matrix>(A, B); }
+
+complex_matrix operator *(const complex_matrix_view & A, const complex_matrix_view & B)
+{ return mmproduct<complex_matrix>(A, B); }
+
+
+// ************************************************************************
+// copies
+
+template <class V, class VV>
+static V vcopy(const VV & x)
+{
+  V y = sized<V>(x.minindex(), x.maxindex(), x.mode);
+  for (int i = x.minindex(); i <= x.maxindex(); ++i)
+    y[i] = x[i];
+  return y;
+}
+
+real_vector to_vector(const real_vector_view & x)
+{ return vcopy<real_vector>(x); }
+
+complex_vector to_vector(const complex_vector_view & x)
+{ return vcopy<complex_vector>(x); }
+
+template <class M, class MV>
+static M mcopy(const MV & A)
+{
+  M B = sized<M>(A.Lminindex(), A.Lmaxindex(), A.Rminindex(), A.Rmaxindex(),
+		 A.Lmode, A.Rmode);
+  for (int i = A.Lminindex(); i <= A.Lmaxindex(); ++i)
+    for (int j = A.Rminindex(); j <= A.Rmaxindex(); ++j)
+      B[i][j] = A[i][j];
+  return B;
+}
+
+real_matrix to_matrix(const real_matrix_view & A)
+{ return mcopy<real_matrix>(A); }
+
+complex_matrix to_matrix(const complex_matrix_view & A)
+{ return mcopy<complex_matrix>(A); }
+
+
+// ************************************************************************
+// solvers returning a new vector
+
+real_vector solve(const real_matrix_view & A, const real_vector_view & b)
+{
+  real_vector x = sized<real_vector>(A.Rminindex(), A.Rmaxindex(), A.Rmode);
+  if ( ! solve(real_vector_view(x).sub(A.Rminindex(), A.Rmaxindex()), A, b))
+    x.reallocate(0);
+  return x;
+}
+
+complex_vector solve(const complex_matrix_view & A, const complex_vector_view & b)
+{
+  complex_vector x = sized<complex_vector>(A.Rminindex(), A.Rmaxindex(), A.Rmode);
+  if ( ! solve(complex_vector_view(x).sub(A.Rminindex(), A.Rmaxindex()), A, b))
+    x.reallocate(0);
+  return x;
+}
@@ -18,7 +18,7 @@ inline int Abs(const int n) { return (n < 0)? -n : n; }
 
 // class mixer: =======================================================
 
-unsigned mixer::global_mixer_index = 0;
+thread_local unsigned mixer::global_mixer_index = 0;
 
 // ********************************************************************
 // constructors and operator =
@@ -30,7 +30,9 @@ unsigned mixer::global_mixer_index = 0;
 mixer::mixer() :
   max_harmonics(1), num_junctions(0), LO_saved(0.0),
   balance_init_flag(0), auto_balance_flag(0), balance_not_ok_flag(0),
+  adapt_tol(0.0), adapt_max(10), trunc_err(0.0),
   bias_circuit(0), if_circuit(0), rf_circuit(0),
+  embed_cap(0), if_memo(0), rf_memo(0),
   term(0), default_term(0),
   junc(0),
   balance_(*this), ssignal_(*this), tsignal_(*this)
@@ -50,9 +52,12 @@ mixer::mixer(const mixer & m) :
   balance_init_flag(m.balance_init_flag),
   auto_balance_flag(m.auto_balance_flag),
   balance_not_ok_flag((num_junctions != 0)),
+  adapt_tol(m.adapt_tol), adapt_max(m.adapt_max), trunc_err(0.0),
   bias_circuit(m.bias_circuit),
   if_circuit(m.if_circuit),
   rf_circuit(m.rf_circuit),
+  embed_cap(m.embed_cap), embed_rdeps(m.embed_rdeps), embed_cdeps(m.embed_cdeps),
+  if_memo(0), rf_memo(0),
   term(m.term), default_term(m.default_term),
   junc(m.junc),
   balance_(*this), ssignal_(*this), tsignal_(*this)
@@ -61,6 +66,12 @@ mixer::mixer(const mixer & m) :
   LO.set_min(0.0);
   ssignal_.terminate_rf(0); // this object does a normal analysis
   tsignal_.terminate_rf(1); // this object does a terminated rf_circuit analysis
+  make_memos();
+}
+
+mixer::~mixer()
+{
+  free_memos();
 }
 
 mixer & mixer::operator = (const mixer & m)
@@ -74,12 +85,18 @@ mixer & mixer::operator = (const mixer & m)
   LO_saved = m.LO_saved;
   balance_init_flag = m.balance_init_flag;
   auto_balance_flag = m.auto_balance_flag;
+  adapt_tol = m.adapt_tol;
+  adapt_max = m.adapt_max;
   bias_circuit = m.bias_circuit;
   if_circuit = m.if_circuit;
   rf_circuit = m.rf_circuit;
   term = m.term;
   default_term = m.default_term;
   junc = m.junc;
+  embed_cap = m.embed_cap;
+  embed_rdeps = m.embed_rdeps;
+  embed_cdeps = m.embed_cdeps;
+  make_memos();
   changed();
 
   return *this;
@@ -128,6 +145,7 @@ mixer & mixer::void_junctions()
 mixer & mixer::set_bias(nport & c)
 {
   bias_circuit = &c;
+  make_memos();
   changed();
   return *this;
 }
@@ -135,6 +153,7 @@ mixer & mixer::set_bias(nport & c)
 mixer & mixer::set_if(nport & c)
 {
   if_circuit = &c;
+  make_memos();
   changed();
   return *this;
 }
@@ -144,10 +163,88 @@ mixer & mixer::set_rf(nport & c)
   rf_circuit = &c;
   term.resize(0); term.resize(c.size());  // clear out previous terminators
   default_term.resize(c.size());
+  make_memos();
   changed();
   return *this;
 }
 
+
+// ********************************************************************
+// the embedding caches
+
+void mixer::free_memos()
+{
+  delete if_memo; delete rf_memo;
+  if_memo = rf_memo = 0;
+}
+
+void mixer::make_memos()
+{
+  free_memos();
+  if (embed_cap == 0) return;
+
+  // (the bias circuit isn't cached: its response is a single DC calculation,
+  // and holds the bias source voltages, which the caches wouldn't notice change)
+  if (if_circuit) if_memo = new memo_nport(*if_circuit, embed_cap);
+  if (rf_circuit) rf_memo = new memo_nport(*rf_circuit, embed_cap);
+
+  memo_nport * memos[2] = { if_memo, rf_memo };
+  for (int i = 0; i < 2; ++i) {
+    if (memos[i] == 0) continue;
+    for (unsigned k = 0; k < embed_rdeps.size(); ++k)
+      memos[i]->depends_on(*embed_rdeps[k]);
+    for (unsigned k = 0; k < embed_cdeps.size(); ++k)
+      memos[i]->depends_on(*embed_cdeps[k]);
+  }
+}
+
+mixer & mixer::cache_embedding(unsigned long n)
+{
+  embed_cap = n;
+  make_memos();
+  int flag = balance_not_ok_flag;  // save flag
+  changed();                       // the balancer must rebuild with the caches,
+  balance_not_ok_flag = flag;      // but the previous balance is still valid
+  return *this;
+}
+
+mixer & mixer::embedding_depends_on(const abstract_real_parameter & p)
+{
+  embed_rdeps.push_back(&p);
+  if (if_memo)   if_memo->depends_on(p);
+  if (rf_memo)   rf_memo->depends_on(p);
+  return *this;
+}
+
+mixer & mixer::embedding_depends_on(const abstract_complex_parameter & p)
+{
+  embed_cdeps.push_back(&p);
+  if (if_memo)   if_memo->depends_on(p);
+  if (rf_memo)   rf_memo->depends_on(p);
+  return *this;
+}
+
+mixer & mixer::clear_embedding_cache()
+{
+  if (if_memo)   if_memo->clear();
+  if (rf_memo)   rf_memo->clear();
+  return *this;
+}
+
+unsigned long mixer::embedding_hits() const
+{
+  return ((if_memo) ? if_memo->hits() : 0)
+    + ((rf_memo) ? rf_memo->hits() : 0);
+}
+
+unsigned long mixer::embedding_misses() const
+{
+  return ((if_memo) ? if_memo->misses() : 0)
+    + ((rf_memo) ? rf_memo->misses() : 0);
+}
+
+// ********************************************************************
+
 mixer & mixer::set_balance_terminator(nport & c, int p)
 {
   if ((rf_circuit == 0) || (rf_circuit->size() < p) || (p < 1))
@@ -350,7 +447,7 @@ mixer & mixer::initialize_operating_state()
  mixer::initialize_operating_state().");
 
   // call the routine to perform the initialization:
-  balance_.i_state();
+  balance_.i_state("mixer::initialize_operating_state()");
 
   // this wasn't a full balance, so:
   balance_not_ok_flag = 1;
@@ -394,6 +491,72 @@ void mixer::auto_state()  // a private function
 mixer & mixer::balance_parameters(int m, double t_1, double t_m, double t_x, double a)
 { balance_.parameters(m,t_1,t_m,t_x,a); return *this; }
 
+mixer & mixer::krylov_balance(int f, double tol, int restart)
+{ balance_.krylov(f,tol,restart); return *this; }
+
+mixer & mixer::adaptive_harmonics(double tol, int max_h)
+{
+  if (max_h < 1)
+    error::fatal("Number of harmonics in a mixer must be a positive integer.");
+  adapt_tol = (tol > 0) ? tol : 0.0;
+  adapt_max = max_h;
+  trunc_err = 0.0;
+  if (adapt_tol == 0.0)   // the junctions go back to their usual truncation
+    for (int n = 0; n < num_junctions; ++n) junc[n]->tolerance(ZEROTOL);
+  return *this;
+}
+
+
+// ********************************************************************
+// balance(): with adaptive harmonics, balance with the current number of
+// harmonics, then add harmonics until the next one is predicted to be
+// small enough, and finally drop any harmonics which have decayed away
+
+int mixer::balance()
+{
+  if (adapt_tol == 0.0 || num_junctions == 0) return balance_();
+
+  for (int n = 0; n < num_junctions; ++n) junc[n]->tolerance(0.1*adapt_tol);
+
+  if (balance_()) return 1;
+  double err = balance_.next_harmonic();
+  while (err > adapt_tol && max_harmonics < adapt_max) {
+    harmonics(max_harmonics + 1);
+    if (balance_()) return 1;
+    err = balance_.next_harmonic();
+  }
+
+  // the smallest number of harmonics above which all the voltages are
+  // below the tolerance
+  double scale = 0.0;
+  for (int n = 0; n < num_junctions; ++n)
+    scale = max(scale, abs(junc[n]->V().read(1)));
+  int h = max_harmonics;
+  for ( ; h > 1; --h) {
+    double v = 0.0;
+    for (int n = 0; n < num_junctions; ++n)
+      v = max(v, abs(junc[n]->V().read(h)));
+    if (v > adapt_tol*scale) break;
+  }
+
+  if (h < max_harmonics) {
+    int h_old = max_harmonics;
+    harmonics(h);
+    double err_h = (balance_()) ? 2*adapt_tol : balance_.next_harmonic();
+    if (err_h <= adapt_tol || err_h <= err)
+      err = err_h;
+    else {
+      // the smaller balance wasn't accurate enough after all
+      harmonics(h_old);
+      if (balance_()) return 1;
+      err = balance_.next_harmonic();
+    }
+  }
+
+  trunc_err = err;
+  return 0;
+}
+
 
 // ********************************************************************
 // return operating state data
@@ -422,6 +585,15 @@ Vector mixer::V_junc(int m)
   return result;
 }
 
+Vector mixer::I_rectified(const Vector & V0)
+{
+  if (V0.minindex() != 1 || V0.maxindex() != num_junctions)
+    error::fatal("Wrong size of DC voltage vector in mixer::I_rectified().");
+  Vector result;
+  balance_.rectified(V0, result);
+  return result;
+}
+
 // ********************************************************************
 // small signal response calculations
 
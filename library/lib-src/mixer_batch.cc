@@ -0,0 +1,300 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// mixer_batch.cc
+
+#include "mixer_batch.h"
+#include "error.h"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+// ************************************************************************
+// The snake ordering of the points
+
+namespace {
+
+  // element j of x, counting from its first element; 0 if x is too short
+  double element(const real_vector & x, int j)
+  {
+    int i = x.minindex() + j;
+    return (i <= x.maxindex()) ? x.read(i) : 0.0;
+  }
+
+  struct by_element
+  {
+    const vector<real_vector> * x;
+    int j;
+    bool down;
+    bool operator()(int a, int b) const
+    {
+      double xa = element((*x)[a], j), xb = element((*x)[b], j);
+      return down ? (xb < xa) : (xa < xb);
+    }
+  };
+
+  // sort the points [b, e) by element j, then each group of points with
+  // the same element j by the following elements, alternating directions
+  void snake(vector<int>::iterator b, vector<int>::iterator e,
+	     const vector<real_vector> & x, int j, int dims, bool down)
+  {
+    if(j >= dims || e - b < 2) return;
+    by_element c = { &x, j, down };
+    stable_sort(b, e, c);
+
+    bool d = false;
+    while(b != e) {
+      vector<int>::iterator g = b + 1;
+      while(g != e && element(x[*g], j) == element(x[*b], j)) ++g;
+      snake(b, g, x, j + 1, dims, d);
+      d = !d;
+      b = g;
+    }
+  }
+
+} // namespace
+
+void mixer_batch::snake(vector<int> & order) const
+{
+  int dims = 0;
+  order.resize(x_.size());
+  for(unsigned k = 0; k < x_.size(); ++k) {
+    order[k] = k;
+    dims = max(dims, x_[k].maxindex() - x_[k].minindex() + 1);
+  }
+  ::snake(order.begin(), order.end(), x_, 0, dims, false);
+}
+
+
+// ************************************************************************
+// The work of each thread: a contiguous run of the ordered points. A
+// thread which has finished its own run takes the back half of the
+// largest remaining one. With fixed runs, a thread which has finished its
+// run takes the next one which hasn't been started.
+
+class mixer_batch::worklist
+{
+public:
+  worklist(const vector<int> & order, unsigned threads, unsigned runs) :
+    order_(order), begin_(threads), end_(threads), fresh_(threads, true),
+    runs_(runs), next_run_(0)
+  {
+    const int n = order.size();
+    for(unsigned t = 0; t < threads; ++t) {
+      begin_[t] = (runs) ? 0 : t*n/threads;
+      end_[t] = (runs) ? 0 : (t+1)*n/threads;
+    }
+  }
+
+  // Get the next point k for thread t; follows is true if k comes right
+  // after thread t's previous point. Returns false if there are none left.
+  bool next(unsigned t, int & k, bool & follows)
+  {
+    lock_guard<mutex> hold(lock_);
+    if(runs_ && begin_[t] >= end_[t]) {
+      const int n = order_.size();
+      if(next_run_ >= n) return false;
+      begin_[t] = next_run_;
+      end_[t] = next_run_ = min(n, next_run_ + int(runs_));
+      fresh_[t] = true;
+    }
+    else if(begin_[t] >= end_[t]) {
+      unsigned v = 0;
+      for(unsigned u = 1; u < begin_.size(); ++u)
+	if(end_[u] - begin_[u] > end_[v] - begin_[v]) v = u;
+      int left = end_[v] - begin_[v];
+      if(left <= 0) return false;
+      end_[t] = end_[v];
+      begin_[t] = end_[v] = end_[v] - (left + 1)/2;
+      fresh_[t] = true;
+    }
+    k = order_[begin_[t]++];
+    follows = !fresh_[t];
+    fresh_[t] = false;
+    return true;
+  }
+
+private:
+  mutex lock_;
+  const vector<int> & order_;
+  vector<int> begin_, end_;
+  vector<bool> fresh_;   // true if a thread's next point starts a new run
+  unsigned runs_;        // the length of the fixed runs, if nonzero
+  int next_run_;         // the start of the next fixed run
+};
+
+
+// ************************************************************************
+// The threads. Each builds its model on its first run, in that thread (so
+// that the model's devices shadow its own device::T, f and Z0), and then
+// waits for the next run until the crew is destroyed.
+
+class mixer_batch::crew
+{
+public:
+  crew(mixer_batch & b, unsigned threads) :
+    b_(b), job_(0), busy_(0), quit_(false), w_(0)
+  {
+    for(unsigned t = 0; t < threads; ++t)
+      threads_.push_back(thread(&crew::serve, this, t));
+  }
+
+  ~crew()
+  {
+    {
+      lock_guard<mutex> hold(lock_);
+      quit_ = true;
+    }
+    start_.notify_all();
+    for(unsigned t = 0; t < threads_.size(); ++t) threads_[t].join();
+  }
+
+  unsigned size() const { return threads_.size(); }
+
+  // Work through w on every thread, returning when all have finished.
+  void run(worklist & w, double f, double T, double Z0)
+  {
+    unique_lock<mutex> hold(lock_);
+    w_ = &w; f_ = f; T_ = T; Z0_ = Z0;
+    busy_ = threads_.size();
+    ++job_;
+    start_.notify_all();
+    finish_.wait(hold, [this]{ return busy_ == 0; });
+  }
+
+private:
+  void serve(unsigned t)
+  {
+    mixer_model * m = 0;
+    unsigned done = 0;
+    for(;;) {
+      {
+	unique_lock<mutex> hold(lock_);
+	start_.wait(hold, [&]{ return quit_ || job_ != done; });
+	if(quit_) break;
+	done = job_;
+      }
+      device::f = f_;
+      device::T = T_;
+      device::Z0 = Z0_;
+      if(m == 0) {
+	m = b_.model_->build();
+	m->get_mixer().initialize_mode(0);  // so balance() starts from the previous point
+      }
+      b_.work(*w_, t, *m);
+      {
+	lock_guard<mutex> hold(lock_);
+	if(--busy_ == 0) finish_.notify_all();
+      }
+    }
+    delete m;
+  }
+
+  mixer_batch & b_;
+  vector<thread> threads_;
+  mutex lock_;
+  condition_variable start_, finish_;
+  unsigned job_;        // counts the runs
+  unsigned busy_;       // the threads still working on this run
+  bool quit_;
+  worklist * w_;        // this run's work, and the device globals
+  double f_, T_, Z0_;   // of the calling thread
+};
+
+
+// ************************************************************************
+
+mixer_batch::mixer_batch(mixer_model & m) :
+  model_(&m), threads_(0), runs_(0), small_signal_(true), keep_(false), crew_(0)
+{ }
+
+mixer_batch::~mixer_batch()
+{
+  delete crew_;
+}
+
+mixer_batch & mixer_batch::keep_models(bool f)
+{
+  keep_ = f;
+  if(!keep_) { delete crew_; crew_ = 0; }
+  return *this;
+}
+
+mixer_batch & mixer_batch::add(const real_vector & x)
+{
+  x_.push_back(x);
+  return *this;
+}
+
+mixer_batch & mixer_batch::clear()
+{
+  x_.clear();
+  results_.clear();
+  return *this;
+}
+
+void mixer_batch::work(worklist & w, unsigned t, mixer_model & m)
+{
+  // bring the parameters up to date with the prototype's
+  vector<real_parameter *> p;
+  m.parameters(p);
+  if(p.size() != values_.size())
+    error::fatal("mixer_batch: mixer_model::parameters() lists different numbers of parameters.");
+  for(unsigned i = 0; i < p.size(); ++i)
+    *p[i] = values_[i];
+
+  mixer & mix = m.get_mixer();
+  int k;
+  bool follows;
+  while(w.next(t, k, follows)) {
+    result & r = results_[k];
+    m.set(x_[k]);
+    if(!follows) mix.initialize_operating_state();
+    r.status = mix.balance();
+    r.iterations = mix.balance_iterations();
+    r.warm = follows;
+    r.currents = mix.I_junc(0);
+    mix.save_operating_state(r.state);
+    if(small_signal_ && r.status == 0) r.data = mix.get_data();
+  }
+}
+
+int mixer_batch::run()
+{
+  const int n = points();
+  results_.assign(n, result());
+  if(n == 0) return 0;
+
+  unsigned threads = threads_;
+  if(threads == 0) threads = thread::hardware_concurrency();
+  if(threads == 0) threads = 1;
+  if(threads > unsigned(n)) threads = n;
+
+  vector<int> order;
+  snake(order);
+  worklist w(order, threads, runs_);
+
+  // the prototype's parameter values, read here rather than by the threads
+  vector<real_parameter *> p;
+  model_->parameters(p);
+  values_.resize(p.size());
+  for(unsigned i = 0; i < p.size(); ++i)
+    values_[i] = p[i]->get();
+
+  // each point's result goes to its own slot, so only the worklist
+  // needs locking
+  if(crew_ && crew_->size() != threads) { delete crew_; crew_ = 0; }
+  if(!crew_) crew_ = new crew(*this, threads);
+  crew_->run(w, device::f, device::T, device::Z0);
+  if(!keep_) { delete crew_; crew_ = 0; }
+
+  int failed = 0;
+  for(int k = 0; k < n; ++k)
+    if(results_[k].status != 0) ++failed;
+  return failed;
+}
@@ -24,7 +24,7 @@ montecarlo::montecarlo(abstract_error_func & aef, minimizer & method) :
 
 void montecarlo::randomize()
 {
-  static real_vector x, y;     // only allocate once
+  static thread_local real_vector x, y;     // only allocate once
   x = erf.get_min_parms();     // x gets sized here
   y = erf.get_max_parms();     // y gets sized here
 
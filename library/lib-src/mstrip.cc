@@ -185,18 +185,35 @@ void microstrip::mstrip3()
 // mstrip4():
 // Calculations which are directly affected by the frequency in addition to
 // the other parameters. Call after calling mstrip3(). Sets remaining
-// members of m4:
+// members of m4. The work is split between mstrip4f(), which doesn't use
+// the width, and mstrip4w(), so Kprop_Zchar() can share mstrip4f().
 // ------------------------------------------------------------------------
 void microstrip::mstrip4()
+{
+  mstrip4f();
+  mstrip4w();
+}
+
+void microstrip::mstrip4f()
+{
+  // the normalized frequency and the width-independent factors of KJ's
+  // p1 and p3 (see below):
+  const double & fn = m4f.fn = i_param.freq*i_param.h/(GHz*Milli*Meter);
+  m4f.p1f = 0.6315 + 0.525*pow(1+0.0157*fn, -20.);
+  m4f.p3f = 1.- exp(-pow(fn/38.7, 4.97));
+}
+
+void microstrip::mstrip4w()
 {
   // KJ:
   // --
   // Frequency dispersion correction to m3.ee0 gives the lossless effective
   // dielectric constant due to the geometry and dielectrics used.
-  // We finish the calculations started in mstrip2() and mstrip3()...
-  double fn = i_param.freq*i_param.h/(GHz*Milli*Meter);
-  double p1 = m3.p1a + m3.u*(0.6315 + 0.525*pow(1+0.0157*fn, -20.));
-  double p3 = m3.p3a*(1.- exp(-pow(fn/38.7, 4.97)));
+  // We finish the calculations started in mstrip2(), mstrip3() and
+  // mstrip4f()...
+  const double & fn = m4f.fn;
+  double p1 = m3.p1a + m3.u*m4f.p1f;
+  double p3 = m3.p3a*m4f.p3f;
   double pf = p1*m2.p2*pow((0.1844 + p3*m2.p4)*fn, 1.5763);
   m4.epeff = (m3.ee0 + pf*m2.erel)/(1. + pf);
 
@@ -0,0 +1,671 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+// ********************************************************************
+// multitone.cc
+//
+// The multitone harmonic balance. See multitone.h
+// ********************************************************************
+
+#include "multitone.h"
+#include "error.h"
+#include "fft.h"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+  const Complex J(0.0, 1.0);
+
+  // A complex FFT over a grid with n[0] x n[1] x ... points, each a
+  // power of 2, stored with the first index varying fastest. Indexes
+  // are wrapped as for fft_plan: index k < 0 is stored at n + k.
+
+  class torus_fft
+  {
+  public:
+    torus_fft() : total(0) { }
+
+    void resize(const vector<unsigned long> & sizes)
+    {
+      n = sizes;
+      plans.clear(); stride.clear();
+      total = 1;
+      for (unsigned t = 0; t < n.size(); ++t) {
+	stride.push_back(total);
+	plans.push_back(fft_plan(n[t]));
+	total *= n[t];
+      }
+    }
+
+    const vector<unsigned long> & sizes() const { return n; }
+    unsigned long size() const { return total; }
+
+    // the grid position of the point with (signed) indexes k
+    unsigned long index(const vector<int> & k) const
+    {
+      unsigned long i = 0;
+      for (unsigned t = 0; t < n.size(); ++t)
+	i += stride[t] * ((k[t] < 0) ? n[t] + k[t] : k[t]);
+      return i;
+    }
+
+    // the transforms, as defined for fft_plan in each dimension
+    void forward(Complex * x) { transform(x, false); }
+    void inverse(Complex * x) { transform(x, true); }
+
+  private:
+    vector<unsigned long> n, stride;
+    vector<fft_plan> plans;
+    vector<Complex> line;
+    unsigned long total;
+
+    void transform(Complex * x, bool inv)
+    {
+      for (unsigned t = 0; t < n.size(); ++t) {
+	unsigned long N = n[t], s = stride[t];
+	if (N == 1) continue;
+	const fft_plan & p = plans[t];
+	if (s == 1) {
+	  for (unsigned long b = 0; b < total; b += N)
+	    if (inv) p.inverse(x + b); else p.forward(x + b);
+	  continue;
+	}
+	line.resize(N);
+	for (unsigned long outer = 0; outer < total; outer += s*N)
+	  for (unsigned long b = outer; b < outer + s; ++b) {
+	    for (unsigned long j = 0; j < N; ++j) line[j] = x[b + j*s];
+	    if (inv) p.inverse(&line[0]); else p.forward(&line[0]);
+	    for (unsigned long j = 0; j < N; ++j) x[b + j*s] = line[j];
+	  }
+      }
+    }
+  };
+
+} // namespace
+
+
+// ********************************************************************
+// multitone::response
+//
+// For a junction with voltage V0 + sum(k) Re(sqrt(2) V_k exp(i n_k.theta))
+// on the torus of tone phases theta, the phase factor is W = exp(-i phi),
+// with phi(theta) = sum(k) Re(c_k exp(i n_k.theta)) and
+// c_k = sqrt(2) V_k VoltToFreq / (i f_k). If W = sum(m) W_m exp(i m.theta),
+// then the (normalized) quasiparticle current is
+//
+//   I(theta) = Im{ conj(W) U },  U = sum(m) W_m j(V0 - f_m/VoltToFreq) exp(i m.theta)
+//
+// where j(V) = Ikk(V) + i Idc(V) from the ivcurve, and f_m = m.f; this is
+// the usual convolution of the Ck with the IV curve. W, its spectrum,
+// and U are kept from currents() for derivative(), which perturbs them.
+
+class multitone::response
+{
+public:
+  response() : V0_table(numeric_limits<double>::quiet_NaN()) { }
+
+  // fill I (indexed by product) with the junction currents for voltages V
+  void currents(const sis_basic_device & d, const multitone & m,
+		const Vector & V, Vector & I);
+
+  // fill dI with the change in the currents when the voltage at product
+  // k changes by dv (which is real if k == 0), at the voltages of the
+  // latest call to currents()
+  void derivative(int k, Complex dv, Vector & dI);
+
+  unsigned long grid_points() const { return fft.size(); }
+
+private:
+  torus_fft fft;
+  const multitone * m;
+  double Vn, Rn, C;                 // the junction parameters
+  vector<unsigned long> pos, neg;   // the grid positions of products n and -n
+  vector<Complex> W, Wf, U;         // W, its (unnormalized) spectrum, and U
+  vector<Complex> jt, jpt;          // j and dj/dV at each spectrum position
+  vector<Complex> a, b;             // workspace
+  double V0_table, Vn_table;        // the DC voltage and Vn used for jt and jpt
+  vector<double> f_table;           // and the tone frequencies
+
+  void fill_tables(const ivcurve & iv, double V0);
+  void transform_currents(vector<Complex> & x, Vector & I);
+};
+
+
+// find the grid size needed for the voltages V, and resize if necessary;
+// then fill the tables and do the transforms for the currents
+
+void multitone::response::currents(const sis_basic_device & d, const multitone & mt,
+				   const Vector & V, Vector & I)
+{
+  m = &mt;
+  Vn = d.Vn; Rn = d.Rn; C = d.Cap;
+  if (d.get_iv() == 0)
+    error::fatal("Uninitialized sis iv curve reference in multitone.");
+  if (Vn <= 0 || Rn <= 0 || C < 0)
+    error::fatal("Bad or uninitialized sis junction parameters in multitone.");
+
+  int T = m->tones(), P = m->products();
+
+  // W's spectrum extends in the direction of tone t to about span[t], the
+  // sum of the phase amplitudes |c_k| weighted by the orders of tone t; the
+  // grid must hold it, plus the H_t harmonics of the currents, without
+  // aliasing. The margin makes the neglected Bessel function terms tiny.
+  vector<double> span(T, 0.0);
+  for (int k = 1; k < P; ++k) {
+    double c = RmsToPeak * VoltToFreq * abs(V.read(k)) / m->freqs[k];
+    for (int t = 0; t < T; ++t) span[t] += c * abs(m->orders[k][t]);
+  }
+  vector<unsigned long> N(T);
+  for (int t = 0; t < T; ++t) {
+    unsigned long K = (unsigned long)ceil(span[t] + 4*cbrt(span[t]) + 8);
+    N[t] = fft_plan::size_for(2*K + m->tone_h[t] + 1);
+  }
+
+  if (N != fft.sizes() || int(pos.size()) != P) {
+    fft.resize(N);
+    pos.resize(P); neg.resize(P);
+    vector<int> n(T);
+    for (int k = 0; k < P; ++k) {
+      pos[k] = fft.index(m->orders[k]);
+      for (int t = 0; t < T; ++t) n[t] = -m->orders[k][t];
+      neg[k] = fft.index(n);
+    }
+    V0_table = numeric_limits<double>::quiet_NaN();
+  }
+  unsigned long G = fft.size();
+
+  // phi on the grid, from its spectrum
+  a.assign(G, 0.0);
+  for (int k = 1; k < P; ++k) {
+    Complex c = RmsToPeak * VoltToFreq * V.read(k) / (J * m->freqs[k]);
+    a[pos[k]] += 0.5 * c;
+    a[neg[k]] += 0.5 * conj(c);
+  }
+  fft.inverse(&a[0]);
+
+  W.resize(G);
+  for (unsigned long g = 0; g < G; ++g) {
+    double phi = G * a[g].real;
+    W[g] = Complex(cos(phi), -sin(phi));
+  }
+  Wf = W;
+  fft.forward(&Wf[0]);
+
+  fill_tables(*d.get_iv(), V.read(0).real);
+
+  // U, then the currents
+  U.resize(G);
+  for (unsigned long g = 0; g < G; ++g) U[g] = Wf[g] * jt[g];
+  fft.inverse(&U[0]);
+
+  for (unsigned long g = 0; g < G; ++g) a[g] = (conj(W[g]) * U[g]).imaginary;
+  transform_currents(a, I);
+
+  // capacitor currents
+  for (int k = 1; k < P; ++k)
+    I[k] += J * (2*Pi * m->freqs[k] * C) * V.read(k);
+}
+
+
+// j and dj/dV at the photon step voltage of each spectrum position,
+// normalized to Vn, if V0 or the tone frequencies have changed
+
+void multitone::response::fill_tables(const ivcurve & iv, double V0)
+{
+  int T = m->tones();
+  vector<double> f(T);
+  for (int t = 0; t < T; ++t) f[t] = m->tone_f[t];
+  if (V0 == V0_table && Vn == Vn_table && f == f_table)
+    return;
+  V0_table = V0; Vn_table = Vn; f_table = f;
+
+  unsigned long G = fft.size();
+  jt.resize(G); jpt.resize(G);
+  const vector<unsigned long> & N = fft.sizes();
+  vector<unsigned long> i(T, 0);   // the grid indexes of point g
+  double v0 = V0/Vn, scale = 1.0/(Vn * VoltToFreq);
+  for (unsigned long g = 0; g < G; ++g) {
+    double fm = 0.0;
+    for (int t = 0; t < T; ++t)
+      fm += f[t] * ((i[t] < N[t]/2) ? double(i[t]) : double(i[t]) - double(N[t]));
+    complex y, yp;
+    iv.Iprime(v0 - fm*scale, y, yp);
+    jt[g] = y; jpt[g] = yp;
+    for (int t = 0; t < T && ++i[t] == N[t]; ++t) i[t] = 0;
+  }
+}
+
+
+// transform currents x on the grid into currents at the products, in Amps
+
+void multitone::response::transform_currents(vector<Complex> & x, Vector & I)
+{
+  fft.forward(&x[0]);
+  int P = m->products();
+  double scale = Vn / Rn / fft.size();
+  I.reallocate(P, Index_C);
+  I[0] = x[0].real * scale;
+  for (int k = 1; k < P; ++k)
+    I[k] = RmsToPeak * scale * x[pos[k]];
+}
+
+
+void multitone::response::derivative(int k, Complex dv, Vector & dI)
+{
+  unsigned long G = fft.size();
+  b.resize(G);
+
+  if (k == 0) {
+    // only the tables depend on V0
+    for (unsigned long g = 0; g < G; ++g) b[g] = Wf[g] * jpt[g];
+    fft.inverse(&b[0]);
+    double s = dv.real / Vn;
+    for (unsigned long g = 0; g < G; ++g) a[g] = s * (conj(W[g]) * b[g]).imaginary;
+    transform_currents(a, dI);
+    return;
+  }
+
+  // the change in phi, then in W and its spectrum, then in U
+  a.assign(G, 0.0);
+  Complex c = RmsToPeak * VoltToFreq * dv / (J * m->freqs[k]);
+  a[pos[k]] += 0.5 * c;
+  a[neg[k]] += 0.5 * conj(c);
+  fft.inverse(&a[0]);
+  for (unsigned long g = 0; g < G; ++g) a[g] = (-J * (G * a[g].real)) * W[g];
+
+  b = a;
+  fft.forward(&b[0]);
+  for (unsigned long g = 0; g < G; ++g) b[g] *= jt[g];
+  fft.inverse(&b[0]);
+
+  for (unsigned long g = 0; g < G; ++g)
+    a[g] = (conj(a[g]) * U[g] + conj(W[g]) * b[g]).imaginary;
+  transform_currents(a, dI);
+
+  dI[k] += J * (2*Pi * m->freqs[k] * C) * dv;
+}
+
+
+// ********************************************************************
+// multitone
+
+multitone::multitone() :
+  max_order_(0),
+  bias_circuit(0), if_circuit(0), rf_circuit(0), f_if(0.0),
+  must_rebuild(1), iter(0)
+{ }
+
+multitone::~multitone()
+{
+  for (unsigned j = 0; j < resp.size(); ++j) delete resp[j];
+}
+
+multitone & multitone::add_tone(double f, int H)
+{
+  tone_f.push_back(parameter(f));
+  tone_h.push_back(H);
+  return initialize_operating_state();
+}
+
+multitone & multitone::add_tone(const abstract_real_parameter * f, int H)
+{
+  tone_f.push_back(parameter(f));
+  tone_h.push_back(H);
+  return initialize_operating_state();
+}
+
+multitone & multitone::max_order(int n)
+{
+  max_order_ = (n < 0) ? 0 : n;
+  return initialize_operating_state();
+}
+
+multitone & multitone::add_junction(sis_basic_device & d)
+{
+  junc.push_back(&d);
+  resp.push_back(new response);
+  must_rebuild = 1;
+  return initialize_operating_state();
+}
+
+multitone & multitone::set_bias(nport & c)
+{
+  bias_circuit = &c;
+  return *this;
+}
+
+multitone & multitone::set_rf(nport & c)
+{
+  rf_circuit = &c;
+  term.assign(c.size(), (nport *)0);
+  default_term.resize(c.size());
+  must_rebuild = 1;
+  return *this;
+}
+
+multitone & multitone::set_if(nport & c, double f)
+{
+  if_circuit = &c;
+  if_term.resize(c.size());
+  f_if = f;
+  must_rebuild = 1;
+  return *this;
+}
+
+multitone & multitone::set_balance_terminator(nport & c, int p)
+{
+  if ((rf_circuit == 0) || (rf_circuit->size() < p) || (p < 1))
+    error::warning("Ignoring attempt to set a terminator to an invalid port"
+		   " in multitone.");
+  else if (c.size() != 1)
+    error::fatal("Multitone balance terminators must be 1-ports.");
+  else
+    term[p-1] = &c;
+  must_rebuild = 1;
+  return *this;
+}
+
+multitone & multitone::initialize_operating_state()
+{
+  V_.clear(); I_.clear();
+  return *this;
+}
+
+multitone & multitone::balance_parameters(int m, double tf, double tm, double tx, double a)
+{
+  max_iter = m; f_tol = tf; F_tol = tm; dx_tol = tx; rate_factor = a;
+  return *this;
+}
+
+void multitone::check() const
+{
+  int nj = junctions();
+  if (tones() == 0 || nj == 0 || bias_circuit == 0 || rf_circuit == 0)
+    error::fatal("A multitone needs tones, junctions, and bias and RF circuits.");
+  if (bias_circuit->size() != nj || rf_circuit->size() < nj
+      || (if_circuit && if_circuit->size() < nj))
+    error::fatal("The multitone circuits don't have ports for all its junctions.");
+}
+
+
+// build the terminated RF and IF circuits, as mixer::balancer does
+
+void multitone::rebuild()
+{
+  if (!must_rebuild) return;
+  int nj = junctions();
+
+  rf_temp = circuit();
+  for (int p = nj + 1; p <= rf_circuit->size(); ++p)
+    rf_temp.connect(*rf_circuit, p, (term[p-1]) ? *term[p-1] : default_term[p-1], 1);
+  for (int p = 1; p <= nj; ++p)
+    rf_temp.add_port(*rf_circuit, p);
+
+  if (if_circuit) {
+    if_temp = circuit();
+    for (int p = nj + 1; p <= if_circuit->size(); ++p)
+      if_temp.connect(*if_circuit, p, if_term[p-1], 1);
+    for (int p = 1; p <= nj; ++p)
+      if_temp.add_port(*if_circuit, p);
+  }
+  must_rebuild = 0;
+}
+
+
+// list the products: DC, then one of each pair n, -n of nonzero orders,
+// in a fixed sequence (so a product's index doesn't depend on the tone
+// frequencies), taking whichever has the positive frequency
+
+void multitone::find_products()
+{
+  int T = tones();
+  for (int t = 0; t < T; ++t)
+    if (tone_f[t] <= 0.0 || tone_h[t] < 1)
+      error::fatal("Multitone tones must have positive frequencies and orders.");
+  orders.assign(1, vector<int>(T, 0));
+  freqs.assign(1, 0.0);
+
+  vector<int> n(T);
+  for (int t = 0; t < T; ++t) n[t] = -tone_h[t];
+  for (;;) {
+    int first = 0, total = 0;
+    double f = 0.0;
+    for (int t = 0; t < T; ++t) {
+      if (first == 0) first = n[t];
+      total += abs(n[t]);
+      f += n[t] * tone_f[t];
+    }
+    if (first > 0 && (max_order_ == 0 || total <= max_order_)) {
+      if (f == 0.0)
+	error::fatal("A multitone mixing product has zero frequency.");
+      orders.push_back(n);
+      freqs.push_back(fabs(f));
+      if (f < 0.0)
+	for (int t = 0; t < T; ++t) orders.back()[t] = -n[t];
+    }
+    int t = T - 1;
+    for (; t >= 0 && n[t] == tone_h[t]; --t) n[t] = -tone_h[t];
+    if (t < 0) break;
+    ++n[t];
+  }
+}
+
+int multitone::product(const vector<int> & n) const
+{
+  int T = tones();
+  for (int k = 0; k < products(); ++k) {
+    bool same = true, negative = true;
+    for (int t = 0; t < T; ++t) {
+      int nt = (t < int(n.size())) ? n[t] : 0;
+      same = same && orders[k][t] == nt;
+      negative = negative && orders[k][t] == -nt;
+    }
+    if (same || negative) return k;
+  }
+  return -1;
+}
+
+int multitone::product(int n1, int n2, int n3) const
+{
+  vector<int> n(3);
+  n[0] = n1; n[1] = n2; n[2] = n3;
+  return product(n);
+}
+
+
+// the bias circuit at DC and the terminated RF (or IF) circuit at each
+// product; the sdata::B vectors are converted to voltages
+
+void multitone::fill_data()
+{
+  parameter f_saved = device::f;
+  double B_factor = 2 * sqrt(device::Z0);
+  linear.resize(products());
+
+  for (int k = 0; k < products(); ++k) {
+    device::f = freqs[k];
+    nport * c = bias_circuit;
+    if (k > 0) c = (if_circuit && freqs[k] < f_if) ? &if_temp : &rf_temp;
+    const sdata & s = c->get_data_S();
+    linear[k].S = s.S;
+    linear[k].B = s.B;
+    linear[k].B *= B_factor;
+  }
+  device::f = f_saved;
+}
+
+
+// the starting voltages: the junctions replaced by their normal
+// resistances and capacitances, solving (1+S)Z0 I + (1-S)V = B
+
+void multitone::initial_voltages()
+{
+  int nj = junctions(), P = products();
+  V_.assign(nj, Vector(P, Index_C));
+  I_.assign(nj, Vector(P, Index_C));
+  Matrix one = identity_matrix(nj, Index_1), Y(nj, nj, Index_1);
+  for (int k = 0; k < P; ++k) {
+    Y.fill(0.0);
+    for (int j = 1; j <= nj; ++j)
+      Y[j][j] = device::Z0 * (1.0/junc[j-1]->Rn + J * 2*Pi * freqs[k] * junc[j-1]->Cap);
+    Vector V = ::solve((one + linear[k].S) * Y + one - linear[k].S, linear[k].B);
+    for (int j = 0; j < nj; ++j)
+      V_[j][k] = (k == 0) ? Complex(V[j+1].real) : V[j+1];
+  }
+}
+
+
+// move voltages to and from the newton representation: for each junction
+// the DC voltage, then the real and imaginary parts of the others
+
+void multitone::to_rep(real_vector & x, const Vector & V, int j) const
+{
+  int base = j * length();
+  x[base] = V.read(0).real;
+  for (int k = 1; k < products(); ++k) {
+    x[base + 2*k - 1] = V.read(k).real;
+    x[base + 2*k] = V.read(k).imaginary;
+  }
+}
+
+void multitone::fm_rep(Vector & V, const real_vector & x, int j) const
+{
+  int base = j * length();
+  V.reallocate(products(), Index_C);
+  V[0] = x.read(base);
+  for (int k = 1; k < products(); ++k)
+    V[k] = Complex(x.read(base + 2*k - 1), x.read(base + 2*k));
+}
+
+
+int multitone::balance()
+{
+  check();
+  rebuild();
+
+  vector< vector<int> > old_orders(orders);
+  find_products();
+  fill_data();
+
+  int nj = junctions(), P = products(), L = length();
+
+  // start from the previous solution if it has the same products, some of
+  // which may have changed sign
+  bool warm = (int(V_.size()) == nj && old_orders.size() == orders.size());
+  for (int k = 1; warm && k < P; ++k) {
+    vector<int> n(old_orders[k]);
+    if (n == orders[k]) continue;
+    for (int t = 0; t < tones(); ++t) n[t] = -n[t];
+    if (n != orders[k]) warm = false;
+    else
+      for (int j = 0; j < nj; ++j) V_[j][k] = conj(V_[j][k]);
+  }
+  if (!warm) initial_voltages();
+
+  xlast.reallocate(nj * L, Index_C);
+  fval.reallocate(nj * L, Index_C);
+  Jacobian.reallocate(nj * L, nj * L, Index_C, Index_C);
+  for (int j = 0; j < nj; ++j) to_rep(xlast, V_[j], j);
+
+  maxstep = 10;
+  iter = 0;
+  solve();
+  if (no_solution() && warm) {
+    initial_voltages();
+    for (int j = 0; j < nj; ++j) to_rep(xlast, V_[j], j);
+    solve();
+  }
+
+  // keep the state of the final voltages
+  for (int j = 0; j < nj; ++j) {
+    fm_rep(V_[j], xlast, j);
+    resp[j]->currents(*junc[j], *this, V_[j], I_[j]);
+  }
+  return no_solution();
+}
+
+
+// the balance errors (1+S)Z0 I + (1-S)V - B, and their derivatives
+
+void multitone::calc()
+{
+  ++iter;
+  int nj = junctions(), P = products(), L = length();
+  double Z0 = device::Z0;
+
+  for (int j = 0; j < nj; ++j) {
+    fm_rep(V_[j], xlast, j);
+    resp[j]->currents(*junc[j], *this, V_[j], I_[j]);
+  }
+
+  for (int i = 0; i < nj; ++i)
+    for (int k = 0; k < P; ++k) {
+      const Matrix & S = linear[k].S;
+      Complex e = Z0 * I_[i][k] + V_[i][k] - linear[k].B[i+1];
+      for (int j = 0; j < nj; ++j)
+	e += S.read(i+1, j+1) * (Z0 * I_[j][k] - V_[j][k]);
+      int r = i*L + ((k == 0) ? 0 : 2*k - 1);
+      fval[r] = e.real;
+      if (k > 0) fval[r+1] = e.imaginary;
+    }
+
+  // each column is a change in one voltage of junction j, changing only
+  // the currents of that junction
+  Vector dI;
+  for (int j = 0; j < nj; ++j)
+    for (int c = 0; c < L; ++c) {
+      int kc = (c + 1)/2;
+      Complex dv = (c == 0 || c % 2 == 1) ? Complex(1.0) : J;
+      resp[j]->derivative(kc, dv, dI);
+      for (int i = 0; i < nj; ++i)
+	for (int k = 0; k < P; ++k) {
+	  Complex s = linear[k].S.read(i+1, j+1);
+	  Complex d = s * Z0 * dI[k];
+	  if (i == j) d += Z0 * dI[k];
+	  if (k == kc) d += (double(i == j) - s) * dv;
+	  int r = i*L + ((k == 0) ? 0 : 2*k - 1);
+	  Jacobian[r][j*L + c] = d.real;
+	  if (k > 0) Jacobian[r+1][j*L + c] = d.imaginary;
+	}
+    }
+}
+
+
+Vector multitone::V_junc(int k) const
+{
+  Vector V(junctions(), Index_1);
+  if (k < 0 || k >= products() || int(V_.size()) != junctions())
+    error::fatal("Invalid product or unbalanced multitone in V_junc().");
+  for (int j = 0; j < junctions(); ++j) V[j+1] = V_[j].read(k);
+  return V;
+}
+
+Vector multitone::I_junc(int k) const
+{
+  Vector I(junctions(), Index_1);
+  if (k < 0 || k >= products() || int(I_.size()) != junctions())
+    error::fatal("Invalid product or unbalanced multitone in I_junc().");
+  for (int j = 0; j < junctions(); ++j) I[j+1] = I_[j].read(k);
+  return I;
+}
+
+unsigned long multitone::grid_points() const
+{
+  unsigned long n = 0;
+  for (unsigned j = 0; j < resp.size(); ++j)
+    if (resp[j]->grid_points() > n) n = resp[j]->grid_points();
+  return n;
+}
+
+Vector multitone::junction_currents(int j, const Vector & V)
+{
+  if (j < 1 || j > junctions())
+    error::fatal("Invalid junction index in multitone::junction_currents().");
+  if (products() == 0) find_products();
+  Vector I;
+  resp[j-1]->currents(*junc[j-1], *this, V, I);
+  return I;
+}
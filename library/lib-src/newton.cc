@@ -35,6 +35,7 @@ namespace newton_helper	 {
 // the root finder and seeds drand48()
 
 newton::newton() :
+  matrix_free(0),
   max_iter(100),
   f_tol(1.e-6),  
   F_tol(1.e-8),
@@ -43,6 +44,16 @@ newton::newton() :
 { srand48(time(0)); }
 
 
+// ************************************************************************
+// the default linear algebra, using the Jacobian matrix
+
+void newton::newton_step(real_vector & p)
+{ p = ::solve(Jacobian, -fval) ; }   // matmath's solve()
+
+void newton::gradient(real_vector & g)
+{ g = fval * Jacobian ; }
+
+
 
 // ************************************************************************
 // solve(): the main solver routine
@@ -73,14 +84,14 @@ void newton::solve()
 		   " newton::solve()") ;
     return ;
   }
-  if(Jacobian.Rminindex() != ixmin || 
-     Jacobian.Rmaxindex() != ixmax) {
+  if(!matrix_free && (Jacobian.Rminindex() != ixmin || 
+		       Jacobian.Rmaxindex() != ixmax)) {
     error::warning("Right index of Jacobian does not match xlast in"
 		   " newton::solve()") ;
     return ;
   }
-    if(Jacobian.Lminindex() != ifmin || 
-     Jacobian.Lmaxindex() != ifmax) {
+    if(!matrix_free && (Jacobian.Lminindex() != ifmin || 
+			Jacobian.Lmaxindex() != ifmax)) {
     error::warning("Left index of Jacobian does not match fval in"
 		   " newton::solve()") ;
     return ;
@@ -118,13 +129,13 @@ void newton::solve()
 
   for(int its = 1; its <= max_iter; ++its) {
 
-    gradf = fval * Jacobian ;  // gradf = 1/2 gradient(fval*fval)
+    gradient(gradf) ;          // gradf = 1/2 gradient(fval*fval)
     xold = x ;
     fold = f ;
 
     // ---------------------------------------------------------------------
-    // Calculate ordinary Newton-Raphson step (using matmath's solve() here)
-    p = ::solve(Jacobian, -fval) ;
+    // Calculate ordinary Newton-Raphson step
+    newton_step(p) ;
 
     // check if Jacobian was singular
     if(p.maxindex()-p.minindex() != ixnum-1) {
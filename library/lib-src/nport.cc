@@ -10,12 +10,12 @@
 
 using namespace std;
 
-unsigned long state_tag::current_state = 1;
-unsigned long device::devcount = 0;
+thread_local unsigned long state_tag::current_state = 1;
+std::atomic<unsigned long> device::devcount(0);
 
-parameter device::T  = 300 * Kelvin;
-parameter device::Z0 = 50 * Ohm;
-parameter device::f  = 0.0;
+thread_local parameter device::T  = 300 * Kelvin;
+thread_local parameter device::Z0 = 50 * Ohm;
+thread_local parameter device::f  = 0.0;
 
 // **************************************************************
 
@@ -80,6 +80,28 @@ complex nport::B(int i)
   return dptr->B.read(i);
 }
 
+void nport::calc_batch(const double * freq, unsigned long n, sdata_batch & batch,
+		       bool noise)
+{
+  batch.resize(size(), n);
+  for(unsigned long k = 0; k < n; ++k) batch.freq()[k] = freq[k];
+
+  parameter old_f(device::f);
+  recalc_batch(batch, noise);
+  device::f = old_f;
+
+  // data may no longer hold the results for the last state
+  last_state.reset();
+}
+
+void nport::recalc_batch(sdata_batch & batch, bool noise)
+{
+  for(unsigned long k = 0; k < batch.points(); ++k) {
+    device::f = batch.freq(k);
+    batch.set(k, noise ? get_data() : get_data_S());
+  }
+}
+
 // **************************************************************
 
 alias & alias::operator=(nport & n)
@@ -92,3 +114,119 @@ alias & alias::operator=(nport & n)
   }
   return *this;
 }
+
+// **************************************************************
+
+memo_nport::memo_nport(nport & o, unsigned long n)
+  : data_ptr_nport(), original(&o), cap(n), nhits(0), nmisses(0)
+{ }
+
+memo_nport::memo_nport(const memo_nport & m)
+  : data_ptr_nport(), original(m.original), cap(m.cap), nhits(0), nmisses(0),
+    rdeps(m.rdeps), cdeps(m.cdeps)
+{ }
+
+memo_nport & memo_nport::operator=(const memo_nport & m)
+{
+  if(this != &m)
+  {
+    original = m.original;
+    cap = m.cap;
+    rdeps = m.rdeps;
+    cdeps = m.cdeps;
+    clear();
+  }
+  return *this;
+}
+
+memo_nport & memo_nport::depends_on(const abstract_real_parameter & p)
+{ rdeps.push_back(&p); return clear(); }
+
+memo_nport & memo_nport::depends_on(const abstract_complex_parameter & p)
+{ cdeps.push_back(&p); return clear(); }
+
+memo_nport & memo_nport::capacity(unsigned long n)
+{ cap = n; trim(); return *this; }
+
+memo_nport & memo_nport::clear()
+{
+  cache.clear();
+  index.clear();
+  nhits = nmisses = 0;
+  data_ptr = &data;
+  return *this;
+}
+
+// discard the least recently used results until no more than cap are left
+void memo_nport::trim()
+{
+  while(cache.size() > cap)
+  {
+    std::list<entry>::iterator last = --cache.end();
+    typedef std::multimap<uint64_t, std::list<entry>::iterator>::iterator it;
+    std::pair<it, it> r = index.equal_range(last->hash);
+    for(it i = r.first; i != r.second; ++i)
+      if(i->second == last) { index.erase(i); break; }
+    if(data_ptr == &last->data) data_ptr = &data;
+    cache.erase(last);
+  }
+}
+
+void memo_nport::lookup(bool noise)
+{
+  if(cap == 0) {
+    data_ptr = (noise) ? &original->get_data() : &original->get_data_S();
+    return;
+  }
+
+  // the key, and its FNV-1a hash
+  std::vector<double> key;
+  key.reserve(3 + rdeps.size() + 2*cdeps.size());
+  key.push_back(device::f);
+  key.push_back(device::T);
+  key.push_back(device::Z0);
+  for(unsigned i = 0; i < rdeps.size(); ++i)
+    key.push_back(rdeps[i]->get());
+  for(unsigned i = 0; i < cdeps.size(); ++i) {
+    Complex z = cdeps[i]->get();
+    key.push_back(z.real);
+    key.push_back(z.imaginary);
+  }
+  uint64_t h = UINT64_C(14695981039346656037);
+  for(unsigned i = 0; i < key.size(); ++i) {
+    double v = (key[i] == 0.0) ? 0.0 : key[i];  // so -0 matches +0
+    const unsigned char *b = reinterpret_cast<const unsigned char *>(&v);
+    for(unsigned j = 0; j < sizeof(double); ++j) { h ^= b[j]; h *= UINT64_C(1099511628211); }
+  }
+
+  // look for it
+  typedef std::multimap<uint64_t, std::list<entry>::iterator>::iterator it;
+  std::pair<it, it> r = index.equal_range(h);
+  for(it i = r.first; i != r.second; ++i)
+  {
+    std::list<entry>::iterator e = i->second;
+    if(e->key != key) continue;
+    if(noise && !e->noise) {
+      // only S was calculated before; now we need the noise too
+      e->data = original->get_data();
+      e->noise = true;
+      ++nmisses;
+    }
+    else ++nhits;
+    cache.splice(cache.begin(), cache, e);
+    data_ptr = &e->data;
+    return;
+  }
+
+  // not found: calculate and remember it
+  ++nmisses;
+  cache.push_front(entry());
+  entry & e = cache.front();
+  e.hash = h;
+  e.key.swap(key);
+  e.noise = noise;
+  e.data = (noise) ? original->get_data() : original->get_data_S();
+  index.insert(std::make_pair(h, cache.begin()));
+  data_ptr = &e.data;
+  trim();
+}
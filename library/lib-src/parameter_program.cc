@@ -0,0 +1,175 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// parameter_program.cc
+
+#include "parameter/parameter_program.h"
+#include "error.h"
+
+using namespace std;
+
+parameter_program::parameter_program()
+  : compiled(false), structure(0), always(false), valid(false)
+{ }
+
+
+int parameter_program::add(const abstract_real_parameter & p)
+{
+  roots.push_back(&p);
+  targets.push_back(0);
+  compiled = valid = false;
+  return roots.size() - 1;
+}
+
+
+parameter_program &
+parameter_program::bind(real_parameter & target, const abstract_real_parameter & p)
+{
+  add(p);
+  targets.back() = &target;
+  return *this;
+}
+
+
+parameter_program & parameter_program::clear()
+{
+  roots.clear();
+  targets.clear();
+  compiled = valid = false;
+  return *this;
+}
+
+
+int parameter_program::steps()
+{
+  if(!compiled || structure != abstract_real_parameter::structure()) compile();
+  return prog.size();
+}
+
+
+void parameter_program::compile()
+{
+  prog.clear();
+  leaves.clear();
+  done.clear();
+  always = false;
+  structure = abstract_real_parameter::structure();
+
+  outs.resize(roots.size());
+  for(unsigned i = 0; i < roots.size(); ++i)
+    outs[i] = node(*roots[i]);
+
+  val.assign(prog.size(), 0.0);
+  done.clear();
+  compiled = true;
+  valid = false;
+}
+
+
+bool parameter_program::run()
+{
+  if(!compiled || structure != abstract_real_parameter::structure()) compile();
+
+  // anything to do?
+  bool changed = !valid || always;
+  for(unsigned i = 0; !changed && i < leaves.size(); ++i)
+    changed = (*prog[leaves[i]].v != val[leaves[i]]);
+  if(!changed) return false;
+
+  const int n = prog.size();
+  for(int i = 0; i < n; ++i) {
+    const step & s = prog[i];
+    switch(s.code) {
+    case LEAF:  val[i] = *s.v; break;
+    case CONST: val[i] = s.x; break;
+    case LIMIT: {
+      double x = val[s.a];
+      x = (s.use_min && x < s.x) ? s.x : x;
+      val[i] = (s.use_max && x > s.y) ? s.y : x;
+      break;
+    }
+    case SCALE: val[i] = s.x * val[s.a]; break;
+    case APPLY: val[i] = s.f(s.obj, val[s.a]); break;
+    case CALL:  val[i] = static_cast<const abstract_real_parameter *>(s.obj)->get(); break;
+    }
+  }
+  valid = true;
+
+  // (a target which was a shadow becomes local, so the next run will
+  // compile again, in case other parameters shadow the target)
+  for(unsigned i = 0; i < targets.size(); ++i)
+    if(targets[i]) targets[i]->set(val[outs[i]]);
+
+  return true;
+}
+
+
+int parameter_program::node(const abstract_real_parameter & p)
+{
+  map<const abstract_real_parameter *, int>::iterator i = done.find(&p);
+  if(i != done.end()) {
+    if(i->second >= 0) return i->second;
+    // as real_parameter::get() does:
+    error::warning("parameter_program: Terminating infinite"
+		   " shadowing loop, using zero.");
+    return constant(0.0);
+  }
+  done[&p] = -1;
+  int r = p.compile(*this);
+  done[&p] = r;
+  return r;
+}
+
+
+int parameter_program::push(const step & s)
+{
+  prog.push_back(s);
+  return prog.size() - 1;
+}
+
+
+int parameter_program::leaf(const double & v)
+{
+  step s = { LEAF, -1, false, false, 0.0, 0.0, &v, 0, 0 };
+  leaves.push_back(prog.size());
+  return push(s);
+}
+
+
+int parameter_program::constant(double v)
+{
+  step s = { CONST, -1, false, false, v, 0.0, 0, 0, 0 };
+  return push(s);
+}
+
+
+int parameter_program::limit(int a, bool use_min, double min, bool use_max, double max)
+{
+  if(!use_min && !use_max) return a;
+  step s = { LIMIT, a, use_min, use_max, min, max, 0, 0, 0 };
+  return push(s);
+}
+
+
+int parameter_program::scale(double f, int a)
+{
+  step s = { SCALE, a, false, false, f, 0.0, 0, 0, 0 };
+  return push(s);
+}
+
+
+int parameter_program::apply(double (*f)(const void *, double), const void * obj, int a)
+{
+  step s = { APPLY, a, false, false, 0.0, 0.0, 0, f, obj };
+  always = true;
+  return push(s);
+}
+
+
+int parameter_program::call(const abstract_real_parameter & p)
+{
+  step s = { CALL, -1, false, false, 0.0, 0.0, 0, 0, &p };
+  always = true;
+  return push(s);
+}
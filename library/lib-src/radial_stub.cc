@@ -10,63 +10,53 @@
 
 using namespace std;
 
-radial_stub::radial_stub() : data_ptr_nport()
+radial_stub::radial_stub() : nport(2), sub(0), super(0), top(0), ground(0)
 {
   info.source = false;
   // Unless a separate temperature parameter gets added, stubs are passive
   info.active = false;
-  nsections = 15;
-
-  for(int i=0; i<=nsections; i++)
-    sec[i].sub_thick = &sub_thick;
+  line.sub_thick = &sub_thick;
+  sections(15);
+}
 
-  sec[0].width = &width;
-  sec[0].length = &length;
+radial_stub & radial_stub::sections(int n)
+{
+  nsections = (n < 1) ? 1 : n;
 
-  for(int i=0; i<nsections; i++)
-    rs.connect(sec[i], 2, sec[i+1], 1);
+  // section 0 is the input line
+  w.resize(nsections+1);
+  len.resize(nsections+1);
+  kprop.resize(nsections+1);
+  zchar.resize(nsections+1);
 
-  rs.add_port(sec[0], 1);
-  rs.add_port(sec[nsections], 2);
+  return *this;
 }
 
 radial_stub & radial_stub::substrate(dielectric & d)
 {
   sub = &d;
-
-  for(int i=0; i<=nsections; i++)
-    sec[i].substrate(*sub);
-
+  line.substrate(*sub);
   return *this;
 }
 
 radial_stub & radial_stub::superstrate(dielectric & d)
 {
   super = &d;
-
-  for(int i=0; i<=nsections; i++)
-    sec[i].superstrate(*super);
-
+  line.superstrate(*super);
   return *this;
 }
 
 radial_stub & radial_stub::top_strip(surfimp & s)
 {
   top = &s;
-
-  for(int i=0; i<=nsections; i++)
-    sec[i].top_strip(*top);
-
+  line.top_strip(*top);
   return *this;
 }
 
 radial_stub & radial_stub::ground_plane(surfimp & s)
 {
   ground = &s;
-
-  for(int i=0; i<=nsections; i++)
-    sec[i].ground_plane(*ground);
-
+  line.ground_plane(*ground);
   return *this;
 }
 
@@ -91,38 +81,59 @@ void radial_stub::recalc(bool noise)
 
   sect_len = (radius - r0) / nsections;
  
-  // Set the width and length of the annular slices.
-  // sec[0] should already be set, because its parameters are shadowing.
+  // Set the width and length of the input line and the annular slices.
+  // An input line of length 0 has no effect, so it isn't calculated.
+  int first = (length == 0.0) ? 1 : 0;
+  w[0] = width;
+  len[0] = length;
   for(int i=1; i<=nsections; i++)
   {
-    sec[i].length = sect_len;
-    sec[i].width = angle * (r0 + ((i-0.5) * sect_len));
+    len[i] = sect_len;
+    w[i] = angle * (r0 + ((i-0.5) * sect_len));
+  }
+
+  line.Kprop_Zchar(nsections+1-first, &w[first], device::f, device::T,
+		   &kprop[first], &zchar[first]);
+
+  // Multiply the chain matrices of the sections. For a line of length l,
+  // propagation constant k and characteristic impedance z:
+  //
+  //        cosh(k*l)    z*sinh(k*l)
+  //   T =
+  //       sinh(k*l)/z    cosh(k*l)
+  //
+  Complex A(1.0), B(0.0), C(0.0), D(1.0);
+  for(int i=first; i<=nsections; i++)
+  {
+    Complex e  = exp(-kprop[i]*len[i]);
+    Complex ch = 0.5*(1.0/e + e), sh = 0.5*(1.0/e - e);
+    Complex b  = zchar[i]*sh, c = sh/zchar[i];
+    Complex t;
+    t = A*b + B*ch; A = A*ch + B*c; B = t;
+    t = C*b + D*ch; C = C*ch + D*c; D = t;
   }
 
-  // Now that the microstrips are set, have the circuit calculate itself.
-  data_ptr = (noise) ? &rs.get_data() : &rs.get_data_S();
-
-  // // Print out microstrip sizes for debugging.
-  // double area = 0.0;
-  // cout << "width = " << width/Micron << endl;
-  // cout << "angle = " << angle << endl;
-  // cout << "r0 = " << r0/Micron << endl;
-  // for(int i=0; i <= nsections; i++)
-  // {
-  //   cout << "Section " << i << ": " << sec[i].width/Micron
-  //        << " microns wide X " << sec[i].length/Micron
-  //        << " microns long." << endl;
-  //   area += (sec[i].width/Micron) * (sec[i].length/Micron);
-  // }
-  // cout << "Total area = " << area << " microns^2." << endl;
+  // Convert the result to an S matrix. Since the sections are reciprocal,
+  // A*D - B*C == 1.
+  double z = device::Z0;
+  B /= z; C *= z;
+  Complex denom = A + B + C + D;
+  data.set_znorm(z);
+  data.S[1][1] = (A + B - C - D)/denom;
+  data.S[2][2] = (D + B - C - A)/denom;
+  data.S[1][2] = data.S[2][1] = 2.0/denom;
+
+  if(noise) data.passive_noise(device::f, device::T);
 }
 
-radial_stub::radial_stub(const radial_stub & r) : data_ptr_nport(r)
+radial_stub::radial_stub(const radial_stub & r)
+  : nport(r), sub(0), super(0), top(0), ground(0)
 {
   info.source = false;
   // Unless a separate temperature parameter gets added, stubs are passive
   info.active = false;
-  nsections = r.nsections;
+  line.sub_thick = &sub_thick;
+  sections(r.nsections);
 
   radius = r.radius;
   angle = r.angle;
@@ -138,18 +149,6 @@ radial_stub::radial_stub(const radial_stub & r) : data_ptr_nport(r)
     top_strip(*r.top);
   if(r.ground != 0)
     ground_plane(*r.ground);
-  
-  for(int i=0; i<=nsections; i++)
-    sec[i].sub_thick = &sub_thick;
-
-  sec[0].width = &width;
-  sec[0].length = &length;
-
-  for(int i=0; i<nsections; i++)
-    rs.connect(sec[i], 2, sec[i+1], 1);
-
-  rs.add_port(sec[0], 1);
-  rs.add_port(sec[nsections], 2);
 }
 
 radial_stub & radial_stub::operator=(const radial_stub & r)
@@ -157,6 +156,8 @@ radial_stub & radial_stub::operator=(const radial_stub & r)
   // Beware of self assignment: r = r
   if(this != &r)
   {
+    sections(r.nsections);
+
     radius = r.radius;
     angle = r.angle;
     length = r.length;
@@ -0,0 +1,575 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// rational_nport.cc
+
+#include "rational_nport.h"
+#include "io.h"
+#include "error.h"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+using namespace std;
+
+// ********************************************************************
+// numerical helpers
+
+namespace {
+
+// The eigenvalues of the n x n complex matrix a (row major), found by
+// reduction to Hessenberg form followed by shifted QR iterations. Returns
+// false if the iterations failed to converge.
+bool eigenvalues(vector<Complex> a, int n, vector<Complex> & ev)
+{
+  ev.assign(n, Complex(0.0));
+  if(n == 0) return true;
+
+  // Householder reduction to upper Hessenberg form
+  vector<Complex> v(n);
+  for(int k = 0; k < n-2; ++k) {
+    double xn = 0.0;
+    for(int i = k+1; i < n; ++i) xn += norm(a[i*n+k]);
+    xn = sqrt(xn);
+    if(xn == 0.0) continue;
+    Complex x0 = a[(k+1)*n+k];
+    Complex phase = (abs(x0) > 0.0) ? x0/abs(x0) : Complex(1.0);
+    int m = n-k-1;
+    for(int i = 0; i < m; ++i) v[i] = a[(k+1+i)*n+k];
+    v[0] += phase*xn;
+    double vn = 0.0;
+    for(int i = 0; i < m; ++i) vn += norm(v[i]);
+    if(vn == 0.0) continue;
+    for(int j = 0; j < n; ++j) {           // a = (I - 2vv'/v'v) a
+      Complex s = 0.0;
+      for(int i = 0; i < m; ++i) s += conj(v[i])*a[(k+1+i)*n+j];
+      s *= 2.0/vn;
+      for(int i = 0; i < m; ++i) a[(k+1+i)*n+j] -= v[i]*s;
+    }
+    for(int i = 0; i < n; ++i) {           // a = a (I - 2vv'/v'v)
+      Complex s = 0.0;
+      for(int l = 0; l < m; ++l) s += a[i*n+k+1+l]*v[l];
+      s *= 2.0/vn;
+      for(int l = 0; l < m; ++l) a[i*n+k+1+l] -= s*conj(v[l]);
+    }
+  }
+
+  // shifted QR iterations, deflating as eigenvalues are found
+  double scale = 0.0;
+  for(int i = 0; i < n*n; ++i) scale = max(scale, abs(a[i]));
+  if(scale == 0.0) return true;
+  vector<double> c(n);
+  vector<Complex> s(n);
+  int hi = n-1, iter = 0;
+  while(hi >= 0) {
+    int l = hi;
+    for(; l > 0; --l) {
+      double d = abs(a[(l-1)*n+l-1]) + abs(a[l*n+l]);
+      if(d == 0.0) d = scale;
+      if(abs(a[l*n+l-1]) <= DBL_EPSILON*d) { a[l*n+l-1] = 0.0; break; }
+    }
+    if(l == hi) { ev[hi] = a[hi*n+hi]; --hi; iter = 0; continue; }
+    if(++iter > 50*n) return false;
+
+    // the Wilkinson shift, with an occasional exceptional shift
+    Complex A = a[(hi-1)*n+hi-1], B = a[(hi-1)*n+hi];
+    Complex C = a[hi*n+hi-1], D = a[hi*n+hi];
+    Complex mu;
+    if(iter % 11 == 10)
+      mu = D + abs(C);
+    else {
+      Complex h = 0.5*(A + D), disc = sqrt(0.25*(A - D)*(A - D) + B*C);
+      Complex m1 = h + disc, m2 = h - disc;
+      mu = (abs(m1 - D) < abs(m2 - D)) ? m1 : m2;
+    }
+
+    // one QR step on rows and columns l..hi, using Givens rotations
+    for(int k = l; k <= hi; ++k) a[k*n+k] -= mu;
+    for(int k = l; k < hi; ++k) {
+      Complex x = a[k*n+k], y = a[(k+1)*n+k];
+      double r = sqrt(norm(x) + norm(y));
+      if(r == 0.0) { c[k] = 1.0; s[k] = 0.0; continue; }
+      if(abs(x) == 0.0) { c[k] = 0.0; s[k] = 1.0; }
+      else { c[k] = abs(x)/r; s[k] = (x/abs(x))*conj(y)/r; }
+      for(int j = k; j <= hi; ++j) {
+	Complex t1 = a[k*n+j], t2 = a[(k+1)*n+j];
+	a[k*n+j]     = c[k]*t1 + s[k]*t2;
+	a[(k+1)*n+j] = -conj(s[k])*t1 + c[k]*t2;
+      }
+    }
+    for(int k = l; k < hi; ++k) {
+      int top = min(k+2, hi);
+      for(int i = l; i <= top; ++i) {
+	Complex t1 = a[i*n+k], t2 = a[i*n+k+1];
+	a[i*n+k]   = c[k]*t1 + conj(s[k])*t2;
+	a[i*n+k+1] = -s[k]*t1 + c[k]*t2;
+      }
+    }
+    for(int k = l; k <= hi; ++k) a[k*n+k] += mu;
+  }
+  return true;
+}
+
+
+// Least squares solution of a x = b, with a m x c (m >= c) and b m x k,
+// both column major, by Householder QR with the columns scaled to unit
+// length. a and b are overwritten; x is c x k, column major. Columns
+// which are nearly dependent on earlier ones get zero coefficients.
+void householder(vector<double> & a, int m, int c, vector<double> & b, int k)
+{
+  vector<double> v(m);
+  for(int j = 0; j < c && j < m; ++j) {
+    double xn = 0.0;
+    for(int i = j; i < m; ++i) xn += a[j*m+i]*a[j*m+i];
+    xn = sqrt(xn);
+    if(xn == 0.0) continue;
+    double alpha = (a[j*m+j] > 0.0) ? -xn : xn;
+    for(int i = j; i < m; ++i) v[i] = a[j*m+i];
+    v[j] -= alpha;
+    double vn = 0.0;
+    for(int i = j; i < m; ++i) vn += v[i]*v[i];
+    if(vn == 0.0) continue;
+    for(int l = j; l < c; ++l) {
+      double s = 0.0;
+      for(int i = j; i < m; ++i) s += v[i]*a[l*m+i];
+      s *= 2.0/vn;
+      for(int i = j; i < m; ++i) a[l*m+i] -= s*v[i];
+    }
+    for(int l = 0; l < k; ++l) {
+      double s = 0.0;
+      for(int i = j; i < m; ++i) s += v[i]*b[l*m+i];
+      s *= 2.0/vn;
+      for(int i = j; i < m; ++i) b[l*m+i] -= s*v[i];
+    }
+    for(int i = j+1; i < m; ++i) a[j*m+i] = 0.0;
+  }
+}
+
+void least_squares(vector<double> & a, int m, int c, vector<double> & b, int k,
+		   vector<double> & x)
+{
+  vector<double> sc(c, 1.0);
+  for(int j = 0; j < c; ++j) {
+    double t = 0.0;
+    for(int i = 0; i < m; ++i) t += a[j*m+i]*a[j*m+i];
+    if(t > 0.0) {
+      sc[j] = 1.0/sqrt(t);
+      for(int i = 0; i < m; ++i) a[j*m+i] *= sc[j];
+    }
+  }
+  householder(a, m, c, b, k);
+
+  double big = 0.0;
+  for(int j = 0; j < c; ++j) big = max(big, fabs(a[j*m+j]));
+  x.assign(c*k, 0.0);
+  for(int l = 0; l < k; ++l)
+    for(int j = c-1; j >= 0; --j) {
+      if(fabs(a[j*m+j]) <= 1.0e-13*big) continue;
+      double t = b[l*m+j];
+      for(int i = j+1; i < c; ++i) t -= a[i*m+j]*x[l*c+i];
+      x[l*c+j] = t/a[j*m+j];
+    }
+  for(int l = 0; l < k; ++l)
+    for(int j = 0; j < c; ++j) x[l*c+j] *= sc[j];
+}
+
+
+// The basis functions for the poles q, which holds the real poles and the
+// upper member of each complex pair: 1/(s-a) for a real pole, and
+// 1/(s-p) + 1/(s-p*), j/(s-p) - j/(s-p*) for a pair. Real coefficients of
+// these give a response with real impulse response.
+void basis(const vector<Complex> & q, Complex s, Complex * phi)
+{
+  const Complex J(0.0, 1.0);
+  int j = 0;
+  for(unsigned k = 0; k < q.size(); ++k) {
+    if(q[k].imaginary == 0.0)
+      phi[j++] = 1.0/(s - q[k]);
+    else {
+      Complex g1 = 1.0/(s - q[k]), g2 = 1.0/(s - conj(q[k]));
+      phi[j++] = g1 + g2;
+      phi[j++] = J*(g1 - g2);
+    }
+  }
+}
+
+// sort by decreasing imaginary part, then real part
+bool by_imaginary(const Complex & x, const Complex & y)
+{
+  return (x.imaginary != y.imaginary) ? x.imaginary > y.imaginary : x.real > y.real;
+}
+
+} // namespace
+
+
+// ********************************************************************
+// rational_nport
+
+rational_nport::rational_nport(int ports, const abstract_real_parameter & f)
+  : nport(ports), pf(&f), Zn_(0.0), w0(1.0), fitted(false), rms(0.0)
+{
+  if(ports <= 0) error::fatal("rational_nport: must be constructed with ports > 0");
+  info.source = false;
+}
+
+
+rational_nport & rational_nport::add_S(double f, const Matrix & S, double Zn)
+{
+  const int N = size();
+  if(S.Lmode != Index_1 || S.Rmode != Index_1 || S.Lsize != N || S.Rsize != N) {
+    error::warning("rational_nport::add_S(): improperly sized S matrix argument");
+    return *this;
+  }
+  if(Zn_ <= 0.0) Zn_ = device::Z0;
+  Matrix M = (Zn == Zn_ || Zn <= 0.0) ? S : S_renormalize(S, Zn_, Zn);
+
+  freqs.push_back(f);
+  for(int i = 1; i <= N; ++i)
+    for(int j = 1; j <= N; ++j)
+      Ssamples.push_back(M.read(i, j));
+  return *this;
+}
+
+
+rational_nport & rational_nport::add_S(double f, const sdata & Sd)
+{
+  return add_S(f, Sd.S, Sd.get_znorm());
+}
+
+
+bool rational_nport::touchstone(const char * name, double f_scale)
+{
+  touchstone_stream d;
+  d.read(name, size(), f_scale);
+  if(d.points() == 0) return false;
+  d.to_S();
+  for(unsigned long k = 0; k < d.points(); ++k) add_S(d.freq(k), d.matrix(k));
+  return true;
+}
+
+
+bool rational_nport::sample(nport & np, sweeper & swp)
+{
+  if(np.size() != size()) {
+    error::warning("rational_nport::sample(): nport has the wrong number of ports");
+    return false;
+  }
+  for(swp.reset(); !swp.finished(); swp++) {
+    const sdata & sd = np.get_data_S();
+    add_S(*pf, sd.S, sd.get_znorm());
+  }
+  return true;
+}
+
+
+rational_nport & rational_nport::clear()
+{
+  Zn_ = 0.0;
+  freqs.clear();
+  Ssamples.clear();
+  p.clear();
+  R.clear();
+  D.clear();
+  fitted = false;
+  rms = 0.0;
+  return *this;
+}
+
+
+bool rational_nport::fit(int n, int iterations)
+{
+  const int F = freqs.size();
+  const int N2 = size()*size();
+  if(n < 0) n = 0;
+  if(F == 0 || 2*F < 2*n + 1) {
+    error::warning("rational_nport::fit(): too few samples for the number of poles");
+    return false;
+  }
+
+  // scale the frequencies so the highest is 1
+  double fmax = 0.0, fmin = HUGE_VAL;
+  for(int i = 0; i < F; ++i) {
+    fmax = max(fmax, fabs(freqs[i]));
+    if(freqs[i] > 0.0) fmin = min(fmin, freqs[i]);
+  }
+  w0 = (fmax > 0.0) ? 2*Pi*fmax : 1.0;
+  vector<Complex> s(F);
+  for(int i = 0; i < F; ++i) s[i] = Complex(0.0, 2*Pi*freqs[i]/w0);
+
+  // the starting poles: lightly damped pairs spread over the band, and a
+  // real pole if n is odd
+  vector<Complex> q;
+  double b0 = (fmin < fmax) ? max(fmin/fmax, 0.01) : 0.01;
+  int pairs = n/2;
+  for(int k = 0; k < pairs; ++k) {
+    double b = (pairs > 1) ? b0 + k*(1.0 - b0)/(pairs - 1) : 0.5*(1.0 + b0);
+    q.push_back(Complex(-0.01*b, b));
+  }
+  if(n % 2) q.push_back(Complex(-0.5*(1.0 + b0), 0.0));
+
+  vector<Complex> phi(n + 1);
+  const int m = 2*F;
+
+  // relocate the poles: fit sigma(s) = 1 + Sum[c~ phi] and (sigma S)(s) =
+  // Sum[c phi] + d for each element, then the new poles are the zeros of
+  // sigma
+  for(int it = 0; it < iterations && n > 0; ++it) {
+    // the sigma equations for each element, reduced by QR
+    vector<double> sa(N2*n*n), sb(N2*n);
+    const int c = 2*n + 1;
+    vector<double> a(m*c), b(m);
+    for(int e = 0; e < N2; ++e) {
+      for(int i = 0; i < F; ++i) {
+	basis(q, s[i], &phi[0]);
+	Complex h = Ssamples[i*N2 + e];
+	for(int j = 0; j < n; ++j) {
+	  a[j*m + i]     = phi[j].real;
+	  a[j*m + F + i] = phi[j].imaginary;
+	  Complex t = -h*phi[j];
+	  a[(n+1+j)*m + i]     = t.real;
+	  a[(n+1+j)*m + F + i] = t.imaginary;
+	}
+	a[n*m + i] = 1.0;
+	a[n*m + F + i] = 0.0;
+	b[i] = h.real;
+	b[F + i] = h.imaginary;
+      }
+      // (scaling the first n+1 columns doesn't change the sigma block)
+      for(int j = 0; j <= n; ++j) {
+	double t = 0.0;
+	for(int i = 0; i < m; ++i) t += a[j*m+i]*a[j*m+i];
+	if(t > 0.0) { t = 1.0/sqrt(t); for(int i = 0; i < m; ++i) a[j*m+i] *= t; }
+      }
+      householder(a, m, c, b, 1);
+      for(int r = 0; r < n; ++r) {
+	for(int j = 0; j < n; ++j)
+	  sa[j*(N2*n) + e*n + r] = a[(n+1+j)*m + n+1+r];
+	sb[e*n + r] = b[n+1+r];
+      }
+    }
+    vector<double> ct;
+    least_squares(sa, N2*n, n, sb, 1, ct);
+
+    // the zeros of sigma are the eigenvalues of A - b c~', where (A, b)
+    // realize the basis functions
+    vector<Complex> H(n*n, Complex(0.0));
+    vector<double> bv(n, 0.0);
+    int j = 0;
+    for(unsigned k = 0; k < q.size(); ++k) {
+      if(q[k].imaginary == 0.0) {
+	H[j*n+j] = q[k].real;
+	bv[j] = 1.0;
+	++j;
+      }
+      else {
+	double al = q[k].real, be = q[k].imaginary;
+	H[j*n+j] = al;       H[j*n+j+1] = be;
+	H[(j+1)*n+j] = -be;  H[(j+1)*n+j+1] = al;
+	bv[j] = 2.0;
+	j += 2;
+      }
+    }
+    for(int r = 0; r < n; ++r)
+      for(int k = 0; k < n; ++k)
+	H[r*n+k] -= bv[r]*ct[k];
+
+    vector<Complex> z;
+    if(!eigenvalues(H, n, z)) {
+      error::warning("rational_nport::fit(): pole relocation failed to converge");
+      break;
+    }
+
+    // sort into real poles and conjugate pairs, reflecting any unstable
+    // poles into the left half plane
+    sort(z.begin(), z.end(), by_imaginary);
+    int npos = 0, nneg = 0;
+    for(int k = 0; k < n; ++k) {
+      double tol = 1.0e-8*abs(z[k]);
+      if(z[k].imaginary > tol) ++npos;
+      else if(z[k].imaginary < -tol) ++nneg;
+    }
+    // (the largest npair eigenvalues pair with the smallest npair; any
+    // others are taken to be real)
+    int npair = min(npos, nneg);
+    vector<Complex> qn;
+    for(int k = 0; k < n - npair; ++k) {
+      double al = -fabs(z[k].real);
+      if(al == 0.0) al = -1.0e-6*max(abs(z[k]), 1.0e-6);
+      qn.push_back(Complex(al, (k < npair) ? fabs(z[k].imaginary) : 0.0));
+    }
+    sort(qn.begin(), qn.end(), by_imaginary);
+
+    // converged?
+    double change = 0.0;
+    if(qn.size() == q.size()) {
+      for(unsigned k = 0; k < q.size(); ++k)
+	change = max(change, abs(qn[k] - q[k])/max(abs(q[k]), 1.0e-6));
+    }
+    else
+      change = 1.0;
+    q = qn;
+    if(change < 1.0e-10) break;
+  }
+
+  // the residues and constant terms, for all elements at once
+  const int c = n + 1;
+  vector<double> a(m*c), b(m*N2), x;
+  for(int i = 0; i < F; ++i) {
+    basis(q, s[i], &phi[0]);
+    for(int j = 0; j < n; ++j) {
+      a[j*m + i]     = phi[j].real;
+      a[j*m + F + i] = phi[j].imaginary;
+    }
+    a[n*m + i] = 1.0;
+    a[n*m + F + i] = 0.0;
+    for(int e = 0; e < N2; ++e) {
+      b[e*m + i]     = Ssamples[i*N2 + e].real;
+      b[e*m + F + i] = Ssamples[i*N2 + e].imaginary;
+    }
+  }
+  least_squares(a, m, c, b, N2, x);
+
+  p.clear();
+  R.clear();
+  D.assign(N2, 0.0);
+  int j = 0;
+  for(unsigned k = 0; k < q.size(); ++k) {
+    if(q[k].imaginary == 0.0) {
+      p.push_back(q[k]);
+      for(int e = 0; e < N2; ++e) R.push_back(Complex(x[e*c + j], 0.0));
+      ++j;
+    }
+    else {
+      p.push_back(q[k]);
+      for(int e = 0; e < N2; ++e) R.push_back(Complex(x[e*c + j], x[e*c + j+1]));
+      p.push_back(conj(q[k]));
+      for(int e = 0; e < N2; ++e) R.push_back(Complex(x[e*c + j], -x[e*c + j+1]));
+      j += 2;
+    }
+  }
+  for(int e = 0; e < N2; ++e) D[e] = x[e*c + n];
+  fitted = true;
+
+  // the rms error at the samples
+  const int NP = size();
+  Matrix S(NP);
+  double sum = 0.0;
+  for(int i = 0; i < F; ++i) {
+    evaluate(freqs[i], S);
+    for(int e = 0; e < N2; ++e)
+      sum += norm(S.read(e/NP + 1, e%NP + 1) - Ssamples[i*N2 + e]);
+  }
+  rms = sqrt(sum/(F*N2));
+  return true;
+}
+
+
+void rational_nport::evaluate(double f, Matrix & S) const
+{
+  const int N = data.size(), N2 = N*N, np = p.size();
+  const double w = 2*Pi*f/w0;
+
+  // g[k] = 1/(s - p[k]), s = jw
+  g_re.resize(np);
+  g_im.resize(np);
+  for(int k = 0; k < np; ++k) {
+    double dr = -p[k].real, di = w - p[k].imaginary;
+    double t = 1.0/(dr*dr + di*di);
+    g_re[k] = dr*t;
+    g_im[k] = -di*t;
+  }
+
+  // then each element is D + Sum[R g]
+  for(int i = 1, e = 0; i <= N; ++i)
+    for(int j = 1; j <= N; ++j, ++e) {
+      double sr = D[e], si = 0.0;
+      const Complex * r = &R[e];
+      for(int k = 0; k < np; ++k, r += N2) {
+	sr += r->real*g_re[k] - r->imaginary*g_im[k];
+	si += r->real*g_im[k] + r->imaginary*g_re[k];
+      }
+      S[i][j] = Complex(sr, si);
+    }
+}
+
+
+Matrix rational_nport::response(double f) const
+{
+  Matrix S(data.size());
+  if(!fitted)
+    error::warning("rational_nport::response(): no model has been fitted");
+  else
+    evaluate(f, S);
+  return S;
+}
+
+
+// The largest singular value of S, the square root of the largest
+// eigenvalue of S'S.
+static double max_singular(const Matrix & S, int N)
+{
+  vector<Complex> a(N*N), ev;
+  for(int i = 0; i < N; ++i)
+    for(int j = 0; j < N; ++j) {
+      Complex t = 0.0;
+      for(int k = 1; k <= N; ++k) t += conj(S.read(k, i+1))*S.read(k, j+1);
+      a[i*N+j] = t;
+    }
+  eigenvalues(a, N, ev);
+  double m = 0.0;
+  for(int i = 0; i < N; ++i) m = max(m, ev[i].real);
+  return sqrt(m);
+}
+
+
+double rational_nport::passivity() const
+{
+  if(!fitted) return 0.0;
+  const int N = data.size();
+  Matrix S(N);
+  double m = 0.0;
+  double fmax = 0.0;
+  for(unsigned i = 0; i < freqs.size(); ++i) fmax = max(fmax, fabs(freqs[i]));
+  const int npts = max(1000, 20*int(freqs.size()));
+  for(int k = 0; k <= npts; ++k) {
+    evaluate(fmax*k/npts, S);
+    m = max(m, max_singular(S, N));
+  }
+  return m;
+}
+
+
+rational_nport & rational_nport::enforce_passivity()
+{
+  double m = passivity();
+  if(m > 1.0) {
+    double r = 1.0/m;
+    for(unsigned k = 0; k < R.size(); ++k) R[k] *= r;
+    for(unsigned e = 0; e < D.size(); ++e) D[e] *= r;
+  }
+  return *this;
+}
+
+
+void rational_nport::recalc_S()
+{
+  if(!fitted) {
+    error::warning("rational_nport::recalc(): no model has been fitted");
+    return;
+  }
+  evaluate(*pf, data.S);
+  data.B = 0.0;
+  data.set_znorm(Zn_);
+  if(Zn_ != device::Z0) {
+    data.S = S_renormalize(data.S, device::Z0, Zn_);
+    data.set_znorm(device::Z0);
+  }
+}
+
+
+void rational_nport::recalc()
+{
+  recalc_S();
+  data.passive_noise(device::f, device::T);
+}
@@ -8,6 +8,7 @@
 #include "global.h"
 #include "error.h"
 #include "parameter/abstract_real_parameter.h"
+#include "parameter/parameter_program.h"
 #include "datafile.h"
 #include "real_interp.h"
 #include "io.h"
@@ -211,17 +212,36 @@ double real_interp::get() const
     return(0.) ;
   }
 
-  double xval = xparam->get() ;  // find out x value
-  double yval = (*this)(xval) ;
+  return at(this, xparam->get()) ;
+}
+
 
-  if (phase==PHASE) {
-    yval = phase_adjust(yval) ;  // force range to -Pi, Pi
+double real_interp::at(const void * r, double x)
+{
+  const real_interp & f = *static_cast<const real_interp *>(r) ;
+  if(!f.ready()) {   // points may have been added since compile()
+    error::warning(
+    "attempted use of a real_interp object that was not properly constructed");
+    return(0.) ;
+  }
+
+  double yval = f(x) ;
+
+  if (f.phase==PHASE) {
+    yval = f.phase_adjust(yval) ;  // force range to -Pi, Pi
   }
 
   return(yval) ;
 }
 
 
+int real_interp::compile(parameter_program & p) const
+{
+  if(!xparam) return p.call(*this) ;  // so the warning is given
+  return p.apply(&real_interp::at, this, p.node(*xparam)) ;
+}
+
+
 double real_interp::phase_adjust(double phase) const
 {
   return( phase - 2.*Pi*floor((phase+Pi)/(2.*Pi))) ;
@@ -5,6 +5,7 @@
 // real_parameter.cc
 
 #include "parameter/real_parameter.h"
+#include "parameter/parameter_program.h"
 #include "global.h"
 #include "error.h"
 #include <iostream>
@@ -73,6 +74,7 @@ real_parameter & real_parameter::shadow(const abstract_real_parameter &p)
     error::warning("real_parameter::shadow(): a real_parameter must not shadow itself.");
   }
   else {
+    if(shadowed != &p) restructured();
     shadowed = &p;
   }
   return *this;
@@ -86,6 +88,7 @@ real_parameter & real_parameter::set_min(double m)
     m = max;
   }
 
+  restructured();
   use_min = true;
   min = m;
   if(is_local() && value < min) value = min;
@@ -100,6 +103,7 @@ real_parameter & real_parameter::set_max(double m)
     m = min;
   }
 
+  restructured();
   use_max = true;
   max = m;
   if(is_local() && value > max) value = max;
@@ -121,6 +125,10 @@ real_parameter& real_parameter::clone(const real_parameter & p)
   // do nothing in case argument is this object or directly shadows this object
   if (&p == this || p.shadowed == this) return *this;
 
+  if(shadowed != p.shadowed || use_min != p.use_min || min != p.min
+     || use_max != p.use_max || max != p.max)
+    restructured();
+
   // make an identical twin of the argument
   value = p.value;
   shadowed = p.shadowed;
@@ -132,6 +140,12 @@ real_parameter& real_parameter::clone(const real_parameter & p)
   return *this;
 }
 
+int real_parameter::compile(parameter_program & p) const
+{
+  if(is_local()) return p.leaf(value);
+  return p.limit(p.node(*shadowed), use_min, min, use_max, max);
+}
+
 istream & operator >>(istream & in_file, real_parameter & p)
 {
   double temp;
@@ -5,6 +5,7 @@
 // scaled_real_parameter.cc
 
 #include "parameter/scaled_real_parameter.h"
+#include "parameter/parameter_program.h"
 #include "global.h"
 #include "error.h"
 
@@ -52,4 +53,11 @@ void scaled_real_parameter::set(const double s, abstract_real_parameter & p)
 {
   shadowed = &p;
   scale = s;
+  restructured();
+}
+
+int scaled_real_parameter::compile(parameter_program & p) const
+{
+  if(shadowed == 0) return p.call(*this);  // so the warning is given
+  return p.scale(scale, p.node(*shadowed));
 }
@@ -216,7 +216,7 @@ sdata & sdata::change_norm(double new_z0)
   Matrix I = identity_matrix(S) ;
   Matrix Factor = Sigma*I - Delta*S ;
   B = Factor * B ;
-  C = Factor * C * dagger(Factor) ;
+  MAMdagger(C, Factor, C);   // C = Factor * C * dagger(Factor)
   Factor += (2*Delta) * S ;    // now Factor == Sigma*I + Delta*S
   S = solve(Factor, Delta*I + Sigma*S);
   return *this;
@@ -265,6 +265,70 @@ sdata & sdata::passive_noise(double freq, double Temp)
   return *this;
 }
 
+//*************************************************************
+// sdata_batch member functions
+//
+
+sdata_batch & sdata_batch::resize(int ports, unsigned long points)
+{
+  if(ports < 0)
+    error::fatal("Cannot create sdata_batch for negative number of ports.");
+  n = ports; m = points;
+  unsigned long len = (unsigned long)(n)*n*m;
+  f.assign(m, 0.0);
+  s.assign(len, Complex(0.0));
+  c.assign(len, Complex(0.0));
+  b.assign(n*m, Complex(0.0));
+  return *this;
+}
+
+void sdata_batch::get(unsigned long k, sdata & sd) const
+{
+  if(sd.size() != n || sd.mode() != Index_1) sd = sdata(n);
+  sd.set_znorm(z_norm);
+  for(int i = 1; i <= n; ++i) {
+    for(int j = 1; j <= n; ++j) {
+      sd.S[i][j] = S(i,j)[k];
+      sd.C[i][j] = C(i,j)[k];
+    }
+    sd.B[i] = B(i)[k];
+  }
+}
+
+void sdata_batch::set(unsigned long k, const sdata & sd)
+{
+  if(sd.size() != n)
+    error::fatal("sdata_batch::set(): sdata has the wrong number of ports.");
+  z_norm = sd.get_znorm();
+  const int o = sd.S.Lminindex() - 1;  // so any index mode works
+  for(int i = 1; i <= n; ++i) {
+    for(int j = 1; j <= n; ++j) {
+      S(i,j)[k] = sd.S.read(i+o,j+o);
+      C(i,j)[k] = sd.C.read(i+o,j+o);
+    }
+    B(i)[k] = sd.B.read(i+o);
+  }
+}
+
+sdata_batch & sdata_batch::passive_noise(unsigned long k, double Temp)
+{
+  // the same calculation as sdata::passive_noise(), summing in the same
+  // order, so the results are identical
+  double d = passive_noise_temp(f[k], Temp);
+  for (int i = 1; i <= n; ++i) {
+    Complex sum(0.0);
+    for (int l = n; l >= 1; --l) sum += conj(S(i,l)[k]) * S(i,l)[k];
+    C(i,i)[k] = d*(complex(1) - sum);
+    for (int j = i + 1; j <= n; ++j) {
+      sum = 0.0;
+      for (int l = n; l >= 1; --l) sum += conj(S(j,l)[k]) * S(i,l)[k];
+      C(j,i)[k] = conj( C(i,j)[k] = -d * sum );
+    }
+  }
+  return *this;
+}
+
+
 //*************************************************************
 // zdata member functions
 //
@@ -298,7 +362,9 @@ zdata::zdata(const sdata &sd) :
     }
     else {
       Z = z0*(Temp * (I + sd.S)) ;
-      C = (4.0 * BoltzK *z0)*(Temp * sd.C * dagger(Temp)) ;
+      C.resize(Z);
+      MAMdagger(C, Temp, sd.C);   // C = Temp * C * dagger(Temp)
+      C *= 4.0 * BoltzK *z0;
       Vs = (2.0 * sqrt(z0))*(Temp * sd.B) ;
     }
   }
@@ -314,7 +380,8 @@ zdata::zdata(const ydata &yd) :
     "Impedance representation does not exist in ydata to zdata constructor!");
   }
   else {
-    C = Z * yd.C * dagger(Z) ;
+    C.resize(Z);
+    MAMdagger(C, Z, yd.C);      // C = Z * C * dagger(Z)
     Vs = -Z * yd.Is ;
   }
 }
@@ -379,7 +446,9 @@ ydata::ydata(const sdata &sd) :
     }
     else {
       Y = (1.0 / z0)*(Temp * (I - sd.S)) ;
-      C = (4.0 *BoltzK / z0)*(Temp * sd.C * dagger(Temp)) ;
+      C.resize(Y);
+      MAMdagger(C, Temp, sd.C);   // C = Temp * C * dagger(Temp)
+      C *= 4.0 *BoltzK / z0;
       Is = (-2.0 / sqrt(z0))*(Temp * sd.B) ;
     }
   }
@@ -395,7 +464,8 @@ ydata::ydata(const zdata &zd) :
     "Admittance representation does not exist in zdata to ydata constructor!");
   }
   else {
-    C = Y * zd.C * dagger(Y) ;
+    C.resize(Y);
+    MAMdagger(C, Y, zd.C);      // C = Y * C * dagger(Y)
     Is = -Y * zd.Vs ;
   }
 }
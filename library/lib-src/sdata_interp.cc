@@ -5,6 +5,8 @@
 // sdata_interp.cc
 
 #include "sdata_interp.h"
+#include "bindata.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -89,15 +91,18 @@ S_interp & S_interp::add_SC(double f, const Matrix & S, const Matrix & C, double
 
 bool S_interp::touchstone(const char * name, double f_scale)
 {
-  touchstone_read d;
-  if(!d.open(name, N, f_scale)) return false;
+  // the whole file is read and converted to S matrices at once
+  touchstone_stream d;
+  d.read(name, N, f_scale);
+  if(d.points() == 0) return false;
+  d.to_S();
 
   if(Znorm_ <= 0.0) Znorm_ = device::Z0;
   double f;
   Matrix S;
 
-  // read in the S matrix data and rebuild the S interpolator
-  while(d.Svalue(f,S)) add_S(f,S);
+  // add the S matrix data and rebuild the S interpolator
+  for(unsigned long k = 0; k < d.points(); ++k) add_S(d.freq(k), d.matrix(k));
   s.build();
 
   // if a 2-port, there may also be noise data
@@ -106,10 +111,11 @@ bool S_interp::touchstone(const char * name, double f_scale)
 
     // here's where we fetch and convert the noise data:
     Matrix C(2);
-    touchstone_read::noise N;
     double To = 290.0*Kelvin;
     double Zo = device::Z0;
-    while(d.get_noise(f,N)) {
+    for(unsigned long k = 0; k < d.noise_points(); ++k) {
+      f = d.noise_freq(k);
+      const touchstone_read::noise & N = d.noise(k);
       S = s(f);
       // renormalize S to device::Z0 if necessary
       if (Znorm_ != Zo) S = S_renormalize(S,Zo,Znorm_);
@@ -140,10 +146,198 @@ bool S_interp::touchstone(const char * name, double f_scale)
 
   } // if
 
+  build_fast();
   return d.good() && s.ready() && (!noise_ || c.ready());
 }
 
 
+bool S_interp::binary(const char * name)
+{
+  bindata_file d(name);
+  if(!d.good()) return false;
+
+  int fs = d.column("f"), ss = d.column("S");
+  unsigned long NN = N*N;
+  if(d.kind() != bindata_file::SDATA || d.ports() != N || fs == 0 || ss == 0 ||
+     d.rows(ss) != d.rows(fs) || d.width(ss) != NN) {
+    error::warning("S_interp::binary(): no S matrix data for the proper number of ports in file: ", name);
+    return false;
+  }
+
+  // the file replaces any data we had, and keeps its own normalization, so
+  // each point is added as stored: the interpolators copy the matrices
+  // from Matrix aliases of the mapped file, which is unmapped on return
+  clear();
+  Znorm_ = (d.znorm() > 0.0) ? d.znorm() : double(device::Z0);
+  double * f = d.real_data(fs);
+  Complex * p = d.complex_data(ss);
+  for(unsigned long k = 0; k < d.rows(fs); ++k, p += NN)
+    s.add(f[k], Matrix(p, N, N, Index_1, Index_1));
+  s.build();
+
+  // there may also be noise data
+  int fc = d.column("fC"), cc = d.column("C");
+  if(fc != 0 && cc != 0 && d.rows(cc) == d.rows(fc) && d.width(cc) == NN) {
+    noise_ = true;
+    f = d.real_data(fc);
+    p = d.complex_data(cc);
+    for(unsigned long k = 0; k < d.rows(fc); ++k, p += NN)
+      c.add(f[k], Matrix(p, N, N, Index_1, Index_1));
+    c.build();
+  }
+
+  build_fast();
+  return s.ready() && (!noise_ || c.ready());
+}
+
+
+S_interp & S_interp::build()
+{
+  if(Znorm_ != 0.0) {
+    s.build();
+    if(noise_) c.build();
+    build_fast();
+  }
+  return *this;
+}
+
+
+void S_interp::build_fast()
+{
+  fs.build(s);
+  if(noise_) fc.build(c); else fc.clear();
+  fast_ = fs.ready() && (!noise_ || fc.ready());
+}
+
+
+bool S_interp::fill(sdata & Sd, double f) const
+{
+  if(fast_ && Sd.size() == N && Sd.mode() == Index_1) {
+    fs(f, Sd.S);
+    if(noise_) fc(f, Sd.C);
+  }
+  else {
+    Sd.S = S(f);
+    if(noise_) Sd.C = C(f);
+  }
+  Sd.set_znorm(Znorm_);
+  return noise_;
+}
+
+
+// ********************************************************************
+// matrix_table_interp
+
+matrix_table_interp & matrix_table_interp::build(const interpolator<Matrix> & I)
+{
+  clear();
+  unsigned n = I.size();
+  if(!I.ready() || n < 2) return *this;
+  const Matrix & M0 = I[0];
+  int m = M0.Lmaxindex();
+  if(m < 1 || M0.Lmode != Index_1 || M0.Rmode != Index_1 || M0.Rmaxindex() != m)
+    return *this;
+
+  type_ = I.type();
+  no_warn_ = I.is_quiet();
+  unsigned long NN = m*m;
+  x_.resize(n);
+  y_.resize(2*NN*n);
+  ls_.resize(NN);
+  rs_.resize(NN);
+
+  // copy a matrix into NN consecutive values, row by row
+  #define COPY(p, A) \
+    for(int i = 1; i <= m; ++i) for(int j = 1; j <= m; ++j) *(p)++ = (A).read(i,j)
+
+  Complex * p = &y_[0];
+  for(unsigned k = 0; k < n; ++k) {
+    x_[k] = I.x(k);
+    COPY(p, I[k]);
+    if(type_ == interpolator<Matrix>::SPLINE || k < n-1)
+      COPY(p, I.coef(k));
+    else
+      p += NN;  // a linear interpolation has no slope for the last point
+  }
+  p = &ls_[0]; COPY(p, I.left_slope());
+  p = &rs_[0]; COPY(p, I.right_slope());
+  #undef COPY
+
+  N = m;
+  return *this;
+}
+
+
+void matrix_table_interp::operator()(double x, Matrix & M) const
+{
+  if(!ready())
+    error::fatal("Must build interpolator before use.");
+
+  // M = w1 Y[k] + w2 Z[k] + w3 Y[k+1] + w4 Z[k+1], where Z is the coefficient
+  // (Y'' or slope) data and k+1 is only used for a spline:
+  double w1 = 1.0, w2, w3 = 0.0, w4 = 0.0;
+  const Complex * a, * b = 0;
+  unsigned long NN = N*N;
+
+  // find j, the first point with x[j] >= x
+  unsigned long j = std::lower_bound(x_.begin(), x_.end(), x) - x_.begin();
+
+  if(j == 0 || j == x_.size()) {
+    // linear extrapolation from an end point
+    if(j == x_.size()) --j;
+    if(!no_warn_ && (x < x_[j] || x > x_[j]))
+      error::warning("Interpolator extrapolating beyond range of data points.");
+    a = &y_[2*NN*j];
+    b = (j == 0) ? &ls_[0] : &rs_[0];
+    w2 = x - x_[j];
+  }
+  else {
+    --j;  // now x[j] < x <= x[j+1]
+    a = &y_[2*NN*j];
+    double D = x - x_[j], Do = x_[j+1] - x_[j];
+    if(type_ == interpolator<Matrix>::LINEAR)
+      w2 = D;
+    else {
+      double A = D/Do, B = 1.0 - A;
+      w1 = B;
+      w2 = -Do*Do*A*(B+1)*B/6.0;
+      w3 = A;
+      w4 = -Do*Do*B*(A+1)*A/6.0;
+    }
+  }
+
+  // now a single pass through the values, treating the Complex values as
+  // pairs of doubles:
+  const double * y0 = reinterpret_cast<const double *>(a);
+  const double * z0 = y0 + 2*NN;
+  if(b) {
+    // extrapolation: Y + w2 * slope
+    const double * s = reinterpret_cast<const double *>(b);
+    for(int i = 0; i < N; ++i) {
+      double * r = reinterpret_cast<double *>(M[i+1] + 1);
+      for(int k = 0; k < 2*N; ++k) r[k] = y0[k] + w2*s[k];
+      y0 += 2*N; s += 2*N;
+    }
+  }
+  else if(type_ == interpolator<Matrix>::LINEAR) {
+    for(int i = 0; i < N; ++i) {
+      double * r = reinterpret_cast<double *>(M[i+1] + 1);
+      for(int k = 0; k < 2*N; ++k) r[k] = y0[k] + w2*z0[k];
+      y0 += 2*N; z0 += 2*N;
+    }
+  }
+  else {
+    const double * y1 = y0 + 4*NN, * z1 = z0 + 4*NN;
+    for(int i = 0; i < N; ++i) {
+      double * r = reinterpret_cast<double *>(M[i+1] + 1);
+      for(int k = 0; k < 2*N; ++k)
+	r[k] = w1*y0[k] + w2*z0[k] + w3*y1[k] + w4*z1[k];
+      y0 += 2*N; z0 += 2*N; y1 += 2*N; z1 += 2*N;
+    }
+  }
+}
+
+
 // ********************************************************************
 
 sdata_interp::sdata_interp(int ports, const abstract_real_parameter & f)
@@ -8,6 +8,7 @@
 #include "error.h"
 #include "units.h"
 #include <cmath>   // for double tanh(), fabs()
+#include <algorithm>
 
 using namespace std;
 
@@ -18,7 +19,7 @@ static const double deps = 1.0e-6;  // normalized voltage close to 0.0
 // error if all set-up is incomplete.
 
 sis_basic_device::sis_basic_device()
-  : Vn(0), Rn(0), Cap(0), piv(0), iv_data_ok(0)
+  : Vn(0), Rn(0), Cap(0), piv(0), iv_data_ok(0), method_(AUTO)
 { }
 
 
@@ -158,7 +159,40 @@ const Matrix & sis_basic_device::small_signal(
   Y.reallocate(max_harmonics,max_harmonics,Index_S,Index_S).fill(0.0);
   limit = C.Ck.maxindex();  // reusing the variable defined above
 
-  if (fIF != 0.0) {
+  if (method_ != DIRECT) {
+    // All of the Ymn with n != 0 (and all of them if fIF != 0) have the form:
+    //   Ymn = f(n) * sum(k) C(k)C(k+m-n)* [ I(k) - Imif(k-n) + Ipif(k+m)* - I(k+m-n)* ]
+    // where f(n) = 1/(2(Vif + n VLO)). The terms in Imif and Ipif are found by
+    // ck_sums(); the others depend only on d = m-n, so are found here.
+    int J = limit + max_harmonics;
+    vector<Complex> W1(2*J+1), W2(2*J+1);
+    for(int j = -J; j <= J; ++j) {
+      W1[j+J] = conj(I_pVIF[j]);
+      W2[j+J] = -I_mVIF[j];
+    }
+    ck_sums(W1, W2, max_harmonics, Y);
+
+    int D = 2*max_harmonics;
+    vector<Complex> Sd(2*D+1);
+    for(int d = -D; d <= D; ++d) {
+      Complex sum = 0.0;
+      int lo = max(-limit, -limit-d), hi = min(limit, limit-d);
+      for(int k = lo; k <= hi; ++k)
+	sum += (C.Ck[k] * conj(C.Ck[k+d])) * (I_VLO[k] - conj(I_VLO[k+d]));
+      Sd[d+D] = sum;
+    }
+
+    // If fIF == 0, only the Ymn with m > 0 and n != 0 have this form; the
+    // others are found below just as for the DIRECT method.
+    for(int m = -max_harmonics; m <= max_harmonics; ++m)
+      for(int n = -max_harmonics; n <= max_harmonics; ++n)
+	if(fIF != 0.0 || (m > 0 && n != 0))
+	  Y[m][n] = (Y[m][n] + Sd[m-n+D]) * (1/(2*(Vif+n*VLO)));
+	else
+	  Y[m][n] = 0.0;
+  }
+
+  if (fIF != 0.0 && method_ == DIRECT) {
     // Normal small signal analysis condition
     double Vi2 = 1/(2*Vif);  // used inside the loops
     for(/*register*/ int k = -limit; k <= limit; ++k) {
@@ -215,7 +249,7 @@ const Matrix & sis_basic_device::small_signal(
     }}} // for m,n,k loops
   }
 
-  else {
+  else if (fIF == 0.0) {
     // fIF = 0; we need to look at derivatives of the I(V) curve (notes, pp 110-113)
     for(/*register*/ int k = -limit; k <= limit; ++k) {
       complex Ck = C.Ck[k];               // C(k)
@@ -235,6 +269,9 @@ const Matrix & sis_basic_device::small_signal(
 	  Y[0][-n] -= Co*(2*f*RmsToPeak*Ikpn.real);  // note -= vice +=
 	}
 
+	// the other elements were already found if method_ != DIRECT
+	if (method_ != DIRECT) continue;
+
 	for(/*register*/ int m = 1; m <= max_harmonics; ++m) {
 	  complex Ikpm = conj(I_pVIF[k+m]);
 	  /*register*/ int kk = kmn+m; // k+m-n
@@ -268,6 +305,30 @@ const Matrix & sis_basic_device::small_signal(
 } // small_signal()
 
 
+// --------------------------------------------------------------------
+// The direct detection response, from Tucker's theory: a small RMS
+// voltage v at frequency f changes the DC current by
+//   (alpha^2/4) * (Idc(V0 + hf/e) - 2*Idc(V0) + Idc(V0 - hf/e)),
+// where alpha = e*sqrt(2)*|v|/(hf). Uses the DC voltage of the most recent
+// call to large_signal(), which should have been made with no harmonic
+// voltages.
+
+double sis_basic_device::rectification(double f)
+{
+  if (call_large_signal())
+    error::fatal("SIS junction parameters changed since last large_signal() call.");
+
+  if (f <= 0.0)
+    error::fatal("Invalid frequency in call to junction::rectification().");
+
+  double V0 = Voltages.read(0).real/Vn_;   // the normalized bias voltage
+  double Vph = f/(Vn_ * VoltToFreq);       // normalized photon voltage
+  double d2 = piv->I(V0 + Vph).imaginary - 2*piv->I(V0).imaginary
+    + piv->I(V0 - Vph).imaginary;
+  return d2 / (2 * Vn_ * Rn_ * Vph * Vph);
+}
+
+
 // --------------------------------------------------------------------
 // The routine that returns the symmetrical harmonic noise correlation
 // matrix using several private variables set by the large signal
@@ -375,6 +436,17 @@ const Matrix & sis_basic_device::noise(
   // See FR notebook, pp 104-105 for formulas
 
   H.reallocate(max_harmonics,max_harmonics,Index_S,Index_S).fill(0.0);
+  if (method_ != DIRECT) {
+    int J = limit;  // == C.Ck.maxindex()+max_harmonics
+    vector<double> W1(2*J+1), W2(2*J+1);
+    for(int j = -J; j <= J; ++j) {
+      W1[j+J] = cothp[j];
+      W2[j+J] = cothm[j];
+    }
+    ck_sums(W1, W2, max_harmonics, H);
+    return H;
+  }
+
   limit = C.Ck.maxindex();
   for(int n = -max_harmonics; n <= max_harmonics; ++n)
     for(/*register*/ int m = -max_harmonics; m <= max_harmonics; ++m) {
@@ -389,6 +461,145 @@ const Matrix & sis_basic_device::noise(
 } // noise()
 
 
+// --------------------------------------------------------------------
+// fixed_ck_sums<h>() does the sums of the TOEPLITZ method of ck_sums() (see
+// below) for a fixed number of harmonics h. Each diagonal d = m-n is handled
+// by its own instance of fixed_diagonal<h,d>(), so the number of elements on
+// the diagonal is a constant: their sums are kept in a local array, which
+// the compiler may keep in registers, and all of them are updated from a
+// single pass over k. The results are identical to those of the TOEPLITZ
+// code, since the terms are added in the same order.
+
+namespace {
+
+template <int h, int d, class T>
+void fixed_diagonal(const Complex * pc, int L, const T * w1, const T * w2, Matrix & G)
+{
+  constexpr int m0 = (d > 0) ? d-h : -h;   // the range of m on this diagonal
+  constexpr int m1 = (d < 0) ? d+h : h;
+  constexpr int len = m1 - m0 + 1;
+
+  Complex sum[len];
+  for(int k = max(-L, -L-d); k <= min(L, L-d); ++k) {
+    const Complex a = pc[k] * conj(pc[k+d]);
+    for(int i = 0; i < len; ++i)
+      sum[i] += a * (w1[k+m0+i] + w2[k-m0-i+d]);
+  }
+  for(int i = 0; i < len; ++i)
+    G[m0+i][m0+i-d] = sum[i];
+
+  if constexpr (d < 2*h) fixed_diagonal<h, d+1>(pc, L, w1, w2, G);
+}
+
+template <int h, class T>
+inline void fixed_ck_sums(const Complex * pc, int L, const T * w1, const T * w2, Matrix & G)
+{ fixed_diagonal<h, -2*h>(pc, L, w1, w2, G); }
+
+} // namespace
+
+
+// --------------------------------------------------------------------
+// ck_sums() calculates, for -h <= m,n <= h:
+//
+//   G[m][n] = sum(k) C(k)C(k+m-n)* (W1[k+m] + W2[k-n])
+//
+// Writing d = m-n, the products C(k)C(k+d)* depend only on d, and the sums
+// for a fixed d are a correlation of those products with the W's; for a
+// fixed m they are correlations of C with W1[j]C(j-m) and W2[j]C(j+m)*.
+// The TOEPLITZ method uses the first form, the FFT method the second.
+
+template <class T>
+void sis_basic_device::ck_sums(
+		      const vector<T> & W1,   // W1[j+J] holds W1(j), J = L+h
+		      const vector<T> & W2,   // likewise for W2
+		      int h,                  // the max number of harmonics
+		      Matrix & G )            // the results, Index_S
+{
+  int L = C.Ck.maxindex();  // C(k) is nonzero for |k| <= L
+  int J = L + h;
+  vector<Complex> c(2*L+1);
+  for(int k = -L; k <= L; ++k) c[k+L] = C.Ck[k];
+  const Complex * pc = &c[L];          // so pc[k] == C(k)
+  const T * w1 = &W1[J], * w2 = &W2[J];
+
+  sum_method m = method_;
+  if (m == AUTO) {
+    // rough operation counts, with relative weights found by timing tests
+    unsigned long nfft = fft_plan::size_for(2*J+1);
+    unsigned long lg = 0;
+    while ((1UL << lg) < nfft) ++lg;
+    double direct = double(2*h+1)*(2*h+1)*(2*L+1);
+    double fft = 4.0*(2*h+1)*nfft*lg;
+    m = (fft < direct) ? FFT : TOEPLITZ;
+  }
+
+  if (m == TOEPLITZ) {
+    // the usual small numbers of harmonics have specialized versions
+    switch (h) {
+    case 1: fixed_ck_sums<1>(pc, L, w1, w2, G); return;
+    case 2: fixed_ck_sums<2>(pc, L, w1, w2, G); return;
+    case 3: fixed_ck_sums<3>(pc, L, w1, w2, G); return;
+    case 4: fixed_ck_sums<4>(pc, L, w1, w2, G); return;
+    default: break;
+    }
+
+    vector<Complex> a(2*L+1);
+    for(int d = -2*h; d <= 2*h; ++d) {
+      // the range of k for which C(k)C(k+d)* is nonzero
+      int lo = max(-L, -L-d), hi = min(L, L-d);
+      if (lo > hi) continue;
+      int len = hi - lo + 1;
+      for(int i = 0; i < len; ++i) a[i] = pc[lo+i] * conj(pc[lo+i+d]);
+
+      for(int mm = max(-h, d-h); mm <= min(h, d+h); ++mm) {
+	int n = mm - d;
+	const T * p1 = w1 + lo + mm, * p2 = w2 + lo - n;
+	Complex sum = 0.0;
+	for(int i = 0; i < len; ++i) sum += a[i] * (p1[i] + p2[i]);
+	G[mm][n] = sum;
+      }
+    }
+    return;
+  }
+
+  // The FFT method. For each row m, G[m][n] is the sum of two convolutions
+  // evaluated at n:
+  //   x * conj(C(-i)),  with x(j) = W1[j]C(j-m)
+  //   y * C(i),         with y(i) = W2[-i]C(m-i)*
+  // Only the results for |n| <= h are needed, so the circular convolutions
+  // need only 2J+1 points to avoid aliasing those results.
+  unsigned long N = fft_plan::size_for(2*J+1);
+  if (plan.size() != N) plan = fft_plan(N);
+  vector<Complex> Chat(N, 0.0), x(N), y(N);
+  #define WRAP(i) (((i) < 0) ? N + (i) : (unsigned long)(i))
+  for(int k = -L; k <= L; ++k) Chat[WRAP(k)] = pc[k];
+  plan.forward(&Chat[0]);
+
+  for(int mm = -h; mm <= h; ++mm) {
+    std::fill(x.begin(), x.end(), Complex(0.0));
+    std::fill(y.begin(), y.end(), Complex(0.0));
+    for(int j = mm-L; j <= mm+L; ++j) x[WRAP(j)] = pc[j-mm] * w1[j];
+    for(int j = -mm-L; j <= -mm+L; ++j) y[WRAP(-j)] = conj(pc[j+mm]) * w2[j];
+    plan.forward(&x[0]);
+    plan.forward(&y[0]);
+    for(unsigned long i = 0; i < N; ++i)
+      x[i] = x[i] * conj(Chat[i]) + y[i] * Chat[i];
+    plan.inverse(&x[0]);
+    for(int n = -h; n <= h; ++n) G[mm][n] = x[WRAP(n)];
+  }
+  #undef WRAP
+}
+
+
+// --------------------------------------------------------------------
+
+void sis_basic_device::tolerance(double tol)
+{
+  double old = C.tolerance();
+  if (C.tolerance(tol).tolerance() != old) iv_data_ok = 0;
+}
+
+
 // --------------------------------------------------------------------
 
 int sis_basic_device::call_large_signal() const
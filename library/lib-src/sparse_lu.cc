@@ -0,0 +1,185 @@
+// SuperMix version 1.6 C++ source file
+// Copyright (c) 1999, 2001, 2004, 2009 California Institute of Technology.
+// All rights reserved.
+//
+// sparse_lu.cc
+
+#include "sparse_lu.h"
+#include "error.h"
+#include "global.h"
+#include <set>
+#include <algorithm>
+
+using namespace std;
+
+const double sparse_lu::pivot_threshold = 1.0e-3;
+
+void sparse_lu::analyze(int size, const vector< pair<int,int> > & entries)
+{
+  n = size;
+  if (n < 0)
+    error::fatal("sparse_lu::analyze: matrix size must not be negative.");
+
+  // the graph of the symmetrized pattern, without the diagonal
+  vector< set<int> > adj(n);
+  for (unsigned long e = 0; e < entries.size(); ++e) {
+    int i = entries[e].first, j = entries[e].second;
+    if (i < 0 || i >= n || j < 0 || j >= n)
+      error::fatal("sparse_lu::analyze: entry position out of range.");
+    if (i != j) { adj[i].insert(j); adj[j].insert(i); }
+  }
+
+  // minimum degree ordering: repeatedly eliminate the node with the fewest
+  // neighbors, joining its neighbors together (ties go to the lowest index)
+  perm.resize(n); iperm.resize(n);
+  {
+    vector< set<int> > g(adj);
+    set< pair<int,int> > order;
+    for (int i = 0; i < n; ++i) order.insert(make_pair(int(g[i].size()), i));
+    for (int k = 0; k < n; ++k) {
+      int v = order.begin()->second;
+      order.erase(order.begin());
+      perm[k] = v; iperm[v] = k;
+      vector<int> nb(g[v].begin(), g[v].end());
+      for (unsigned a = 0; a < nb.size(); ++a)
+	order.erase(make_pair(int(g[nb[a]].size()), nb[a]));
+      for (unsigned a = 0; a < nb.size(); ++a) {
+	set<int> & ga = g[nb[a]];
+	ga.erase(v);
+	for (unsigned b = 0; b < nb.size(); ++b)
+	  if (b != a) ga.insert(nb[b]);
+      }
+      for (unsigned a = 0; a < nb.size(); ++a)
+	order.insert(make_pair(int(g[nb[a]].size()), nb[a]));
+      g[v].clear();
+    }
+  }
+
+  // the pattern of each row of the permuted matrix, in the new numbering
+  vector< vector<int> > rows(n);
+  for (int i = 0; i < n; ++i) rows[iperm[i]].push_back(iperm[i]);
+  for (unsigned long e = 0; e < entries.size(); ++e)
+    rows[iperm[entries[e].first]].push_back(iperm[entries[e].second]);
+
+  // symbolic factorization, row by row: row i gains the upper pattern of
+  // each earlier row k which it has an entry in, taking k in ascending order
+  start.assign(1, 0); col.clear(); diag.resize(n);
+  vector<int> mark(n, -1);
+  for (int i = 0; i < n; ++i) {
+    vector<int> r;
+    set<int> lower;
+    for (unsigned a = 0; a < rows[i].size(); ++a) {
+      int j = rows[i][a];
+      if (mark[j] == i) continue;
+      mark[j] = i; r.push_back(j);
+      if (j < i) lower.insert(j);
+    }
+    while (!lower.empty()) {
+      int k = *lower.begin();
+      lower.erase(lower.begin());
+      for (int idx = diag[k] + 1; idx < start[k+1]; ++idx) {
+	int j = col[idx];
+	if (mark[j] == i) continue;
+	mark[j] = i; r.push_back(j);
+	if (j < i) lower.insert(j);
+      }
+    }
+    sort(r.begin(), r.end());
+    for (unsigned a = 0; a < r.size(); ++a) {
+      if (r[a] == i) diag[i] = col.size();
+      col.push_back(r[a]);
+    }
+    start.push_back(col.size());
+  }
+
+  val.assign(col.size(), Complex(0.0));
+  work.assign(n, Complex(0.0));
+}
+
+
+int sparse_lu::position(int i, int j) const
+{
+  if (i < 0 || i >= n || j < 0 || j >= n) return -1;
+  int r = iperm[i], c = iperm[j];
+  vector<int>::const_iterator b = col.begin() + start[r], e = col.begin() + start[r+1];
+  vector<int>::const_iterator p = lower_bound(b, e, c);
+  return (p != e && *p == c) ? int(p - col.begin()) : -1;
+}
+
+
+void sparse_lu::clear()
+{
+  fill(val.begin(), val.end(), Complex(0.0));
+}
+
+
+// row-oriented (IKJ) Gaussian elimination; a row's entries are scattered
+// into the work vector, so the updates need no searching. Each pivot is
+// compared with the largest entry of its row, before and after the
+// elimination, which catches both a small pivot and growth of the row.
+bool sparse_lu::factor()
+{
+  bool stable = true;
+  for (int i = 0; i < n; ++i) {
+    const int e = start[i+1];
+    double amax = 0.0;
+    for (int idx = start[i]; idx < e; ++idx) {
+      work[col[idx]] = val[idx];
+      amax = max(amax, zabs(val[idx]));
+    }
+    for (int idx = start[i]; idx < diag[i]; ++idx) {
+      const int k = col[idx];
+      const Complex l = work[k] / val[diag[k]];
+      work[k] = l;
+      for (int jdx = diag[k] + 1; jdx < start[k+1]; ++jdx)
+	work[col[jdx]] -= l * val[jdx];
+    }
+    for (int idx = start[i]; idx < e; ++idx) val[idx] = work[col[idx]];
+    for (int idx = diag[i]; idx < e; ++idx) amax = max(amax, zabs(val[idx]));
+    const double pivot = zabs(val[diag[i]]);
+    if (pivot < Tiny || pivot < pivot_threshold * amax) stable = false;
+    if (pivot < Tiny) val[diag[i]] = Tiny;
+  }
+  return stable;
+}
+
+
+void sparse_lu::solve(Complex * x) const
+{
+  for (int i = 0; i < n; ++i) work[i] = x[perm[i]];
+
+  // L y = b, L having a unit diagonal
+  for (int i = 0; i < n; ++i) {
+    Complex s = work[i];
+    for (int idx = start[i]; idx < diag[i]; ++idx) s -= val[idx] * work[col[idx]];
+    work[i] = s;
+  }
+  // U x = y
+  for (int i = n - 1; i >= 0; --i) {
+    Complex s = work[i];
+    for (int idx = diag[i] + 1; idx < start[i+1]; ++idx) s -= val[idx] * work[col[idx]];
+    work[i] = s / val[diag[i]];
+  }
+
+  for (int i = 0; i < n; ++i) x[perm[i]] = work[i];
+}
+
+
+void sparse_lu::solve_transpose(Complex * x) const
+{
+  for (int i = 0; i < n; ++i) work[i] = x[perm[i]];
+
+  // U^T z = b: a forward substitution, done by columns of U^T
+  for (int k = 0; k < n; ++k) {
+    const Complex z = work[k] / val[diag[k]];
+    work[k] = z;
+    for (int idx = diag[k] + 1; idx < start[k+1]; ++idx) work[col[idx]] -= val[idx] * z;
+  }
+  // L^T x = z: a back substitution, done by columns of L^T
+  for (int k = n - 1; k >= 0; --k) {
+    const Complex z = work[k];
+    for (int idx = start[k]; idx < diag[k]; ++idx) work[col[idx]] -= val[idx] * z;
+  }
+
+  for (int i = 0; i < n; ++i) x[perm[i]] = work[i];
+}
@@ -18,7 +18,7 @@ using namespace std;
 //                                                     electron charge)
 //     tau   - reduced temperature, k*T/e*DELTA(T)    (k = Boltzmann's const)
 
-static struct { double tau; double Omega; } lparms;
+static thread_local struct { double tau; double Omega; } lparms;
 
 // Integrand function declarations. static so we don't pollute the global
 // namespace.
@@ -52,7 +52,7 @@ complex supcond(double freq, double T, double Vgap, double Tc)
   // lparms.tau = 0.086170837*T/(DELTA*dratio)
 
   double S1, S2;                 // real and imaginary parts of conductivity
-  static integrator<double> Int; // static so it only gets constructed once
+  static thread_local integrator<double> Int; // static so it only gets constructed once
 
   // Calculate real part:
   
@@ -96,7 +96,8 @@ string real_matrix::out_separator(const char s)
 
 void real_matrix::construct(const int n, const int m,
 			   const v_index_mode tl,
-			   const v_index_mode tr)
+			   const v_index_mode tr,
+			   double *const block)
 {
   // set up matrix private member variables
   internal_Lsize = (n >= 0) ? n : 0;
@@ -114,9 +115,15 @@ void real_matrix::construct(const int n, const int m,
 
   // allocate memory for the array of data elements, if required:
   int nelem = ncols * nrows;
-  if (nelem) {
+  double * rows = 0;  // will point to the block of data elements
+  if (nelem && block) {
+    // alias the supplied block; it isn't ours to delete
+    delete_pointer_rows = 0;
+    rows = block;
+  }
+  else if (nelem) {
     // need to allocate memory
-    delete_pointer_rows = new double[nelem];
+    rows = delete_pointer_rows = new double[nelem];
     if (delete_pointer_rows == 0) {
       // memory alloc failed, so give back pointer array as well
       delete [] delete_pointer_data;
@@ -163,7 +170,7 @@ void real_matrix::construct(const int n, const int m,
   // setup of left index complete
 
   // now for the right index:
-  if (delete_pointer_rows == 0) {
+  if (rows == 0) {
     // no data elements
     internal_Rsize = ncols = 0; // in case they weren't already
     Rmaxindexvalue = (Rmode == Index_1) ? 0 : -1;
@@ -191,7 +198,7 @@ void real_matrix::construct(const int n, const int m,
   if (ncols == 0) offset = 0; // no offset if no data
   for(i = Lminindexvalue; i <= Lmaxindexvalue; ++i, offset += ncols)
     // this loop will only execute if pointer memory was allocated
-    data[i] = delete_pointer_rows + offset;
+    data[i] = rows + offset;
 
 } // construct()
 
@@ -276,7 +283,8 @@ real_matrix & real_matrix::reindex(const v_index_mode Lnew, const v_index_mode R
   }
 
   // finally, if resulting matrix is empty, just reallocate to fix modes
-  if (delete_pointer_rows == 0)  {
+  // (an alias has no delete_pointer_rows, so check the dimensions instead)
+  if (delete_pointer_data == 0 || nrows == 0 || ncols == 0)  {
     reallocate(0,0,Lnew,Rnew);
     return *this;
   }
@@ -1067,7 +1075,8 @@ string complex_matrix::out_separator(const char s)
 
 void complex_matrix::construct(const int n, const int m,
 			   const v_index_mode tl,
-			   const v_index_mode tr)
+			   const v_index_mode tr,
+			   Complex *const block)
 {
   // set up some internal constants
   internal_Lsize = (n >= 0) ? n : 0;
@@ -1085,9 +1094,15 @@ void complex_matrix::construct(const int n, const int m,
 
   // allocate memory for the array of data elements, if required:
   int nelem = ncols * nrows;
-  if (nelem) {
+  Complex * rows = 0;  // will point to the block of data elements
+  if (nelem && block) {
+    // alias the supplied block; it isn't ours to delete
+    delete_pointer_rows = 0;
+    rows = block;
+  }
+  else if (nelem) {
     // need to allocate memory
-    delete_pointer_rows = new Complex[nelem];
+    rows = delete_pointer_rows = new Complex[nelem];
     if (delete_pointer_rows == 0) {
       // memory alloc failed, so give back pointer array as well
       delete [] delete_pointer_data;
@@ -1133,7 +1148,7 @@ void complex_matrix::construct(const int n, const int m,
   }
   // setup of left index complete
   // now for the right index:
-  if (delete_pointer_rows == 0) {
+  if (rows == 0) {
     // no data elements
     internal_Rsize = ncols = 0; // in case they weren't already
     Rmaxindexvalue = (Rmode == Index_1) ? 0 : -1;
@@ -1161,7 +1176,7 @@ void complex_matrix::construct(const int n, const int m,
   if (ncols == 0) offset = 0; // no offset if no data
   for(i = Lminindexvalue; i <= Lmaxindexvalue; ++i, offset += ncols)
     // this loop will only execute if pointer memory was allocated
-    data[i] = delete_pointer_rows + offset;
+    data[i] = rows + offset;
 
 } // construct()
 
@@ -1263,7 +1278,8 @@ complex_matrix & complex_matrix::reindex(const v_index_mode Lnew, const v_index_
   }
 
   // finally, if resulting matrix is empty, just reallocate to fix modes
-  if (delete_pointer_rows == 0)  {
+  // (an alias has no delete_pointer_rows, so check the dimensions instead)
+  if (delete_pointer_data == 0 || nrows == 0 || ncols == 0)  {
     reallocate(0,0,Lnew,Rnew);
     return *this;
   }
@@ -24,6 +24,33 @@
 
 // calc calculates the scattering matrix
 void trl_base::calc(complex b, complex z, double length, double znorm)
+{
+  complex s11, s12;
+  line_S(b, z, length, znorm, s11, s12);
+
+  // fill in S matrix
+  data.set_znorm(znorm);        // added 12/29/97
+  data.S[1][1] = s11;
+  data.S[2][2] = s11;
+  data.S[1][2] = s12;
+  data.S[2][1] = s12;
+}
+
+void trl_base::calc(sdata_batch & batch, unsigned long k,
+		    complex b, complex z, double length, double znorm) const
+{
+  complex s11, s12;
+  line_S(b, z, length, znorm, s11, s12);
+
+  batch.set_znorm(znorm);
+  batch.S(1,1)[k] = s11;
+  batch.S(2,2)[k] = s11;
+  batch.S(1,2)[k] = s12;
+  batch.S(2,1)[k] = s12;
+}
+
+void trl_base::line_S(complex b, complex z, double length, double znorm,
+		      complex & s11, complex & s12)
 {
   // Note: propagation factor is taken to be exp(-b*length)
   // so b.real > 0 ensures attenuation of wave
@@ -41,7 +68,7 @@ void trl_base::calc(complex b, complex z, double length, double znorm)
   //
   // NOTE: if length == 0.0, then s11 = 0 and s12 = 1 will be returned
 
-  complex s11(0.0), s12(1.0);   // the values if length == 0
+  s11 = 0.0; s12 = 1.0;         // the values if length == 0
 
   if(length != 0.0) {
     z /= znorm;                // normalize to standard impedance
@@ -54,13 +81,6 @@ void trl_base::calc(complex b, complex z, double length, double znorm)
     s12 /= denom;
     s11 *= z*(1-b)/denom;
   }
-
-  // fill in S matrix
-  data.set_znorm(znorm);        // added 12/29/97
-  data.S[1][1] = s11;
-  data.S[2][2] = s11;
-  data.S[1][2] = s12;
-  data.S[2][1] = s12;
 }
 
 double trl_base::wavelength(complex prop_constant)
@@ -84,10 +104,32 @@ double trl_base::percent_loss(complex prop_constant)
 // Default constructor
 microstrip::microstrip()
   : trl_base(), length(0.), width(0.), sub_thick(0.), Temp(&device::T),
-    sub(0), super(0), top(0), ground(0)
+    sub(0), super(0), top(0), ground(0), geometry(0), widths_geometry(0)
 { }
 
 void microstrip::update(double freq, double T)
+{
+  if(length.get() < 0.)
+    error::fatal("Microstrip length is negative !");
+  if(width.get() <= 0.)
+    error::fatal("Microstrip width is zero or negative !");
+
+  int stage = set_params(freq, T);
+
+  // Check if a call to mstrip3() is needed...
+  double dtemp = width.get();
+  if(dtemp != i_param.w) {
+    i_param.w = dtemp;
+    stage = 3;
+  }
+
+  // call the remaining mstrip() functions
+  if (stage <= 3) mstrip3();
+  if (stage <= 4) mstrip4();
+  if (stage <= 5) mstrip5();
+}
+
+int microstrip::set_params(double freq, double T)
 {
   // Make sure we have valid pointers
   if(sub == 0)
@@ -98,10 +140,6 @@ void microstrip::update(double freq, double T)
     error::fatal("Ground plane film not defined for microstrip line !");
   if(top == 0)
     error::fatal("Top strip film not defined for microstrip line !");
-  if(length.get() < 0.)
-    error::fatal("Microstrip length is negative !");
-  if(width.get() <= 0.)
-    error::fatal("Microstrip width is zero or negative !");
   if(sub_thick.get() <= 0.)
     error::fatal("Microstrip substrate thickness is zero or negative !");
 
@@ -148,13 +186,6 @@ void microstrip::update(double freq, double T)
     c2 = c3 = true;
   }
 
-  // Check if a call to mstrip3() is needed...
-  dtemp = width.get();
-  if(dtemp != i_param.w) {
-    i_param.w = dtemp;
-    c3 = true;
-  }
-
   // Check if a call to mstrip4() is needed...
   if(freq != i_param.freq) {
     i_param.freq = freq;
@@ -182,9 +213,65 @@ void microstrip::update(double freq, double T)
   // call mstrip() functions
   if (c1)        mstrip1();
   if (c2)        mstrip2();
-  if (c3)      { mstrip3(); mstrip4(); mstrip5(); }
-  else if (c4) { mstrip4(); mstrip5(); }
-  else if (c5)   mstrip5();
+  if (c1 || c2)  ++geometry;
+
+  return c3 ? 3 : c4 ? 4 : c5 ? 5 : 6;
+}
+
+void microstrip::Kprop_Zchar(int n, const double * w, double freq, double T,
+			     Complex * kprop, Complex * zc)
+{
+  for(int i = 0; i < n; ++i)
+    if(w[i] <= 0.)
+      error::fatal("Microstrip width is zero or negative !");
+
+  set_params(freq, T);
+
+  // The mstrip3() results are kept for each width, and only recalculated
+  // if the widths or the results of mstrip1() or mstrip2() have changed.
+  bool same = (widths_geometry == geometry && int(widths.size()) == n);
+  for(int i = 0; same && i < n; ++i)
+    same = (widths[i].w == w[i]);
+  if(!same) {
+    widths.resize(n);
+    for(int i = 0; i < n; ++i) {
+      i_param.w = w[i];
+      mstrip3();
+      widths[i].w = w[i];
+      widths[i].m3 = m3;
+      widths[i].g2strip  = m4.g2strip;
+      widths[i].g2ground = m4.g2ground;
+    }
+    widths_geometry = geometry;
+  }
+
+  // Each line then needs only the width-dependent parts of mstrip4() and
+  // mstrip5(); mstrip4f() does the rest once for all of them.
+  mstrip4f();
+  for(int i = 0; i < n; ++i) {
+    m3 = widths[i].m3;
+    m4.g2strip  = widths[i].g2strip;
+    m4.g2ground = widths[i].g2ground;
+    mstrip4w();
+    mstrip5();
+    kprop[i] = beta;
+    zc[i] = zchar;
+  }
+
+  // m3 and m4 no longer match this microstrip's own width, so force
+  // update() to call mstrip3() next time.
+  i_param.w = 0.;
+}
+
+
+void microstrip::recalc_batch(sdata_batch & b, bool noise)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    double f = device::f = b.freq(k);
+    if(length != 0.0) update(f, Temp);
+    calc(b, k, beta, zchar, length, device::Z0);
+    if(noise) b.passive_noise(k, Temp);
+  }
 }
 
 
@@ -310,6 +397,16 @@ void cpw::update(double freq, double /* T */ )  // lossless, so T isn't needed y
 */
 }
 
+void cpw::recalc_batch(sdata_batch & b, bool)
+{
+  // noiseless, so C is left 0
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    double f = device::f = b.freq(k);
+    if(length != 0.0) update(f, Temp);
+    calc(b, k, beta, zchar, length, device::Z0);
+  }
+}
+
 // ************************************************************************
 //
 // class r_waveguide
@@ -373,3 +470,29 @@ const nport::data_info & r_waveguide::get_data_info()
   info.active = (info.noise && Temp != device::T);
   return info;
 }
+
+void r_waveguide::recalc_batch(sdata_batch & batch, bool)
+{
+  // noiseless, so C is left 0
+  for(unsigned long k = 0; k < batch.points(); ++k) {
+    double f = device::f = batch.freq(k);
+    if(length != 0.0) update(f, Temp);
+    calc(batch, k, gamma, 2*b/a*zwave, length, device::Z0);
+  }
+}
+
+
+// ************************************************************************
+//
+// class trline
+//
+// ************************************************************************
+
+void trline::recalc_batch(sdata_batch & b, bool noise)
+{
+  for(unsigned long k = 0; k < b.points(); ++k) {
+    double f = device::f = b.freq(k);
+    calc(b, k, Kprop(f,device::T), zchar, theta, device::Z0);
+    if(noise) b.passive_noise(k, Temp);
+  }
+}
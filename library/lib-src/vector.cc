@@ -5,6 +5,7 @@
 // vector.cc
 
 #include "vector.h"
+#include "Amath.h"
 #include <iostream>
 #include <iomanip>
 
@@ -1055,8 +1056,8 @@ complex_vector & complex_vector::operator += (const complex_vector & v1)
   // loop over the intersection of the vectors' valid ranges:
   int minimum = max(minindexvalue, v1.minindex());
   int maximum = min(maxindexvalue, v1.maxindex());
-  for (/*register*/ int i = minimum; i <= maximum; ++i)
-    data[i] += v1[i];
+  if (minimum <= maximum)
+    Aadd(data + minimum, &v1[minimum], maximum - minimum + 1);
   return *this;
 }
 
@@ -1066,8 +1067,8 @@ complex_vector & complex_vector::operator -= (const complex_vector & v1)
   if (maxindexvalue < v1.maxindex()) maxindex(v1.maxindex());
   int minimum = max(minindexvalue, v1.minindex());
   int maximum = min(maxindexvalue, v1.maxindex());
-  for (/*register*/ int i = minimum; i <= maximum; ++i)
-    data[i] -= v1[i];
+  if (minimum <= maximum)
+    Asub(data + minimum, &v1[minimum], maximum - minimum + 1);
   return *this;
 }
 
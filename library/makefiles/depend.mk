@@ -5,7 +5,17 @@ SIScmplx.o: SIScmplx.cc SIScmplx.h \
 abstract_complex_parameter.o: abstract_complex_parameter.cc \
   parameter/abstract_complex_parameter.h SIScmplx.h
 abstract_real_parameter.o: abstract_real_parameter.cc \
-  parameter/abstract_real_parameter.h SIScmplx.h
+  parameter/abstract_real_parameter.h SIScmplx.h \
+  parameter/parameter_program.h parameter/real_parameter.h
+adaptive_sweeper.o: adaptive_sweeper.cc \
+  adaptive_sweeper.h sweeper.h \
+  parameter/real_parameter.h \
+  parameter/abstract_real_parameter.h SIScmplx.h \
+  state_tag.h vector.h interpolate.h \
+  numerical/num_interpolate.h nport.h device.h \
+  global.h matmath.h table.h units.h \
+  parameter.h port.h sdata.h \
+  parameter/abstract_complex_parameter.h error.h
 ampdata.o: ampdata.cc ampdata.h sdata.h \
   global.h SIScmplx.h matmath.h \
   vector.h table.h units.h \
@@ -22,7 +32,8 @@ analyze.o: analyze.cc mixer.h circuit.h \
   sources.h junction.h interpolate.h \
   numerical/num_interpolate.h error.h \
   newton.h mixer_helper.h \
-  parameter/scaled_real_parameter.h Amath.h
+  parameter/scaled_real_parameter.h Amath.h \
+  parameter/abstract_complex_parameter.h
 antenna.o: antenna.cc antenna.h \
   circuit.h nport.h device.h \
   global.h SIScmplx.h matmath.h \
@@ -40,7 +51,8 @@ attenuator.o: attenuator.cc attenuator.h \
   table.h units.h state_tag.h \
   parameter.h parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 balance.o: balance.cc mixer.h circuit.h \
   nport.h device.h global.h \
   SIScmplx.h matmath.h vector.h \
@@ -51,7 +63,18 @@ balance.o: balance.cc mixer.h circuit.h \
   sources.h junction.h interpolate.h \
   numerical/num_interpolate.h error.h \
   newton.h mixer_helper.h \
-  parameter/scaled_real_parameter.h
+  parameter/scaled_real_parameter.h \
+  parameter/abstract_complex_parameter.h matview.h
+bindata.o: bindata.cc bindata.h table.h \
+  SIScmplx.h units.h datafile.h \
+  sdata_interp.h interpolate.h \
+  numerical/num_interpolate.h error.h \
+  io.h matmath.h vector.h global.h \
+  nport.h device.h state_tag.h \
+  parameter.h parameter/real_parameter.h \
+  parameter/abstract_real_parameter.h port.h \
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 circuit.o: circuit.cc circuit.h nport.h \
   device.h global.h SIScmplx.h \
   matmath.h vector.h table.h \
@@ -59,21 +82,24 @@ circuit.o: circuit.cc circuit.h nport.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
   sdata.h circuitADT.h connection.h \
-  error.h
+  error.h sparse_lu.h \
+  parameter/abstract_complex_parameter.h
 circuitADT.o: circuitADT.cc circuitADT.h \
   nport.h device.h global.h \
   SIScmplx.h matmath.h vector.h \
   table.h units.h state_tag.h \
   parameter.h parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h connection.h error.h
+  sdata.h connection.h error.h \
+  parameter/abstract_complex_parameter.h
 circulator.o: circulator.cc circulator.h \
   nport.h device.h global.h \
   SIScmplx.h matmath.h vector.h \
   table.h units.h state_tag.h \
   parameter.h parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 ckdata.o: ckdata.cc junction.h global.h \
   SIScmplx.h matmath.h vector.h \
   table.h units.h interpolate.h \
@@ -98,23 +124,27 @@ connection.o: connection.cc connection.h \
   table.h units.h state_tag.h \
   parameter.h parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h error.h
+  sdata.h error.h \
+  parameter/abstract_complex_parameter.h
 datafile.o: datafile.cc datafile.h \
-  table.h SIScmplx.h error.h
+  table.h SIScmplx.h error.h bindata.h \
+  units.h
 deembed.o: deembed.cc deembed.h nport.h \
   device.h global.h SIScmplx.h \
   matmath.h vector.h table.h \
   units.h state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h error.h
+  sdata.h error.h \
+  parameter/abstract_complex_parameter.h
 delay.o: delay.cc delay.h nport.h \
   device.h global.h SIScmplx.h \
   matmath.h vector.h table.h \
   units.h state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 elements.o: elements.cc elements.h \
   nport.h device.h global.h \
   SIScmplx.h matmath.h vector.h \
@@ -143,8 +173,9 @@ error_terms.o: error_terms.cc error_terms.h \
   port.h sdata.h mixer.h \
   circuit.h circuitADT.h connection.h \
   sources.h junction.h newton.h \
-  mixer_helper.h parameter/scaled_real_parameter.h \
-  real_interp.h datafile.h ampdata.h
+  mixer_helper.h mixer_batch.h parameter/scaled_real_parameter.h \
+  real_interp.h datafile.h ampdata.h \
+  parameter/abstract_complex_parameter.h
 fet.o: fet.cc fet.h nport.h \
   device.h global.h SIScmplx.h \
   matmath.h vector.h table.h \
@@ -155,6 +186,8 @@ fet.o: fet.cc fet.h nport.h \
   connection.h elements.h \
   parameter/complex_parameter.h \
   parameter/abstract_complex_parameter.h error.h
+fft.o: fft.cc fft.h SIScmplx.h \
+  error.h global.h
 function_real_parameter.o: function_real_parameter.cc \
   parameter/function_real_parameter.h \
   parameter/abstract_real_parameter.h SIScmplx.h \
@@ -175,7 +208,8 @@ hybrid.o: hybrid.cc hybrid.h nport.h \
   units.h state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 instrument.o: instrument.cc instrument.h \
   circuit.h nport.h device.h \
   global.h SIScmplx.h matmath.h \
@@ -192,14 +226,21 @@ io.o: io.cc io.h matmath.h \
   nport.h device.h state_tag.h \
   parameter.h parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 ivcurve.o: ivcurve.cc global.h \
   SIScmplx.h matmath.h vector.h \
   table.h units.h datafile.h \
   junction.h interpolate.h \
+  numerical/num_interpolate.h error.h fft.h
+junction.o: junction.cc junction.h global.h \
+  SIScmplx.h matmath.h vector.h \
+  table.h units.h interpolate.h \
   numerical/num_interpolate.h error.h
 matmath.o: matmath.cc matmath.h vector.h \
-  SIScmplx.h table.h Amath.h
+  SIScmplx.h table.h Amath.h matview.h
+matview.o: matview.cc matview.h matmath.h \
+  vector.h SIScmplx.h table.h
 mixer.o: mixer.cc mixer.h circuit.h \
   nport.h device.h global.h \
   SIScmplx.h matmath.h vector.h \
@@ -210,7 +251,20 @@ mixer.o: mixer.cc mixer.h circuit.h \
   sources.h junction.h interpolate.h \
   numerical/num_interpolate.h error.h \
   newton.h mixer_helper.h \
-  parameter/scaled_real_parameter.h
+  parameter/scaled_real_parameter.h \
+  parameter/abstract_complex_parameter.h
+mixer_batch.o: mixer_batch.cc mixer_batch.h mixer.h circuit.h \
+  nport.h device.h global.h \
+  SIScmplx.h matmath.h vector.h \
+  table.h units.h state_tag.h \
+  parameter.h parameter/real_parameter.h \
+  parameter/abstract_real_parameter.h port.h \
+  sdata.h circuitADT.h connection.h \
+  sources.h junction.h interpolate.h \
+  numerical/num_interpolate.h error.h \
+  newton.h mixer_helper.h \
+  parameter/scaled_real_parameter.h \
+  parameter/abstract_complex_parameter.h
 montecarlo.o: montecarlo.cc error.h \
   montecarlo.h powell.h vector.h \
   SIScmplx.h optimizer.h matmath.h \
@@ -225,6 +279,16 @@ mstrip.o: mstrip.cc units.h global.h \
   parameter/abstract_complex_parameter.h nport.h \
   device.h state_tag.h port.h \
   sdata.h
+multitone.o: multitone.cc multitone.h circuit.h \
+  nport.h device.h global.h \
+  SIScmplx.h matmath.h vector.h \
+  table.h units.h state_tag.h \
+  parameter.h parameter/real_parameter.h \
+  parameter/abstract_real_parameter.h port.h \
+  sdata.h circuitADT.h connection.h \
+  sources.h sisdevice.h junction.h interpolate.h \
+  numerical/num_interpolate.h error.h \
+  newton.h fft.h
 newton.o: newton.cc error.h newton.h \
   global.h SIScmplx.h matmath.h \
   vector.h table.h units.h
@@ -234,7 +298,12 @@ nport.o: nport.cc nport.h device.h \
   state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h error.h
+  sdata.h error.h \
+  parameter/abstract_complex_parameter.h
+parameter_program.o: parameter_program.cc \
+  parameter/parameter_program.h \
+  parameter/abstract_real_parameter.h SIScmplx.h \
+  parameter/real_parameter.h error.h
 port.o: port.cc port.h error.h
 powell.o: powell.cc powell.h vector.h \
   SIScmplx.h optimizer.h matmath.h \
@@ -252,38 +321,53 @@ radial_stub.o: radial_stub.cc radial_stub.h \
   numerical/num_interpolate.h error.h \
   parameter/complex_parameter.h \
   parameter/abstract_complex_parameter.h
+rational_nport.o: rational_nport.cc \
+  rational_nport.h nport.h device.h \
+  global.h SIScmplx.h matmath.h \
+  vector.h table.h units.h \
+  state_tag.h parameter.h \
+  parameter/real_parameter.h \
+  parameter/abstract_real_parameter.h port.h \
+  sdata.h parameter/abstract_complex_parameter.h \
+  sweeper.h interpolate.h numerical/num_interpolate.h \
+  sdata_interp.h io.h error.h
 real_interp.o: real_interp.cc global.h \
   SIScmplx.h matmath.h vector.h \
   table.h units.h error.h \
   parameter/abstract_real_parameter.h datafile.h \
   real_interp.h interpolate.h \
-  numerical/num_interpolate.h io.h
+  numerical/num_interpolate.h io.h \
+  parameter/parameter_program.h parameter/real_parameter.h
 real_parameter.o: real_parameter.cc \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h SIScmplx.h \
   global.h matmath.h vector.h \
-  table.h units.h error.h
+  table.h units.h error.h \
+  parameter/parameter_program.h
 scaled_real_parameter.o: scaled_real_parameter.cc \
   parameter/scaled_real_parameter.h \
   parameter/abstract_real_parameter.h SIScmplx.h \
   global.h matmath.h vector.h \
-  table.h units.h error.h
+  table.h units.h error.h \
+  parameter/parameter_program.h parameter/real_parameter.h
 sdata.o: sdata.cc units.h global.h \
   SIScmplx.h matmath.h vector.h \
   table.h error.h nport.h \
   device.h state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h Amath.h
+  sdata.h Amath.h \
+  parameter/abstract_complex_parameter.h
 sdata_interp.o: sdata_interp.cc sdata_interp.h \
-  interpolate.h numerical/num_interpolate.h \
+  bindata.h interpolate.h numerical/num_interpolate.h \
   error.h io.h matmath.h \
   vector.h SIScmplx.h table.h \
   units.h global.h nport.h \
   device.h state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h
+  sdata.h \
+  parameter/abstract_complex_parameter.h
 simple_error_func.o: simple_error_func.cc \
   simple_error_func.h optimizer.h \
   matmath.h vector.h SIScmplx.h \
@@ -295,14 +379,17 @@ sisdevice.o: sisdevice.cc sisdevice.h \
   junction.h interpolate.h \
   numerical/num_interpolate.h error.h \
   parameter.h parameter/real_parameter.h \
-  parameter/abstract_real_parameter.h
+  parameter/abstract_real_parameter.h fft.h
 sources.o: sources.cc sources.h nport.h \
   device.h global.h SIScmplx.h \
   matmath.h vector.h table.h \
   units.h state_tag.h parameter.h \
   parameter/real_parameter.h \
   parameter/abstract_real_parameter.h port.h \
-  sdata.h error.h
+  sdata.h error.h \
+  parameter/abstract_complex_parameter.h
+sparse_lu.o: sparse_lu.cc sparse_lu.h SIScmplx.h \
+  error.h global.h
 state_display.o: state_display.cc \
   extras/state_display.h extras/cmd_line.h \
   parameter.h parameter/real_parameter.h \
@@ -322,7 +409,7 @@ surfaceZ.o: surfaceZ.cc global.h \
   numerical/num_interpolate.h adaptive.h \
   num_utility.h
 sweeper.o: sweeper.cc sweeper.h \
-  parameter/real_parameter.h \
+  parameter/real_parameter.h state_tag.h \
   parameter/abstract_real_parameter.h SIScmplx.h \
   vector.h interpolate.h \
   numerical/num_interpolate.h error.h
@@ -346,4 +433,4 @@ trlines.o: trlines.cc global.h \
   port.h sdata.h mstrip.h \
   trlines.h parameter/complex_parameter.h \
   parameter/abstract_complex_parameter.h
-vector.o: vector.cc vector.h SIScmplx.h
+vector.o: vector.cc vector.h SIScmplx.h Amath.h
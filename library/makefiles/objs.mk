@@ -4,12 +4,14 @@
 
 OBJS =	abstract_complex_parameter.o \
 	abstract_real_parameter.o \
+	adaptive_sweeper.o \
 	Amath.o \
 	ampdata.o \
 	analyze.o \
 	antenna.o \
 	attenuator.o \
 	balance.o \
+	bindata.o \
 	circuit.o \
 	circuitADT.o \
 	circulator.o \
@@ -25,21 +27,28 @@ OBJS =	abstract_complex_parameter.o \
 	error_func.o \
 	error_terms.o \
 	fet.o \
+	fft.o \
 	function_real_parameter.o \
 	hemt.o \
 	hybrid.o \
 	instrument.o \
 	io.o \
 	ivcurve.o \
+	junction.o \
 	matmath.o \
+	matview.o \
 	mixer.o \
+	mixer_batch.o \
 	montecarlo.o \
 	mstrip.o \
+	multitone.o \
 	newton.o \
 	nport.o \
+	parameter_program.o \
 	port.o \
 	powell.o \
 	radial_stub.o \
+	rational_nport.o \
 	real_interp.o \
 	real_parameter.o \
 	scaled_real_parameter.o \
@@ -49,6 +58,7 @@ OBJS =	abstract_complex_parameter.o \
 	SIScmplx.o \
 	sisdevice.o \
 	sources.o \
+	sparse_lu.o \
 	state_display.o \
 	supcond.o \
 	surfaceZ.o \
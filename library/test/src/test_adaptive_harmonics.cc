@@ -0,0 +1,86 @@
+// test_adaptive_harmonics.cc
+// check that a mixer with adaptive harmonics chooses few harmonics and Ck
+// for a weakly pumped junction and more for a strongly pumped one, and that
+// its balance agrees with a balance using many harmonics to the tolerance.
+
+#include "supermix.h"
+
+int main()
+{
+  parameter LO, IF, P;
+  device::f = &IF;
+  device::T = 4*Kelvin;
+  LO = 300*GHz; IF = 5*GHz;
+
+  trline t;
+  t.set_theta(Pi/3).set_freq(500*GHz).set_zchar(20*Ohm);
+  branch b(2);
+  circuit rf;
+  rf.add_port(b,1); rf.connect(b,2,t,1); rf.add_port(t,2);
+
+  ivcurve iv("iv.dat","ikk.dat");
+  parameter Rn = 10*Ohm, Vn = 3*mVolt, Cap = 20*fFarad;
+  sis_basic_device sis;
+  sis.set_iv(iv); sis.Rn = &Rn; sis.Vn = &Vn; sis.Cap = &Cap;
+
+  voltage_source vb;
+  vb.source_voltage = 0.6*Vn;
+  vb.R = 2*Ohm;
+  circuit bias;
+  bias.add_port(vb,1);
+
+  generator g;
+  g.source_f = &LO;
+  g.source_width = 1*GHz;
+  g.source_power = &P;
+
+  mixer m;
+  m.set_rf(rf).set_if(rf).set_LO(&LO).add_junction(sis).set_bias(bias);
+  m.set_balance_terminator(g,2);
+
+  const double tol = 1.0e-3;
+  double pumps[] = { 1, 1000 };
+  int H[2], nck[2], nck_ref[2];
+  for (int i = 0; i < 2; ++i) {
+    P = pumps[i]*Nano*Watt;
+
+    // the reference: 12 harmonics, the usual Ck
+    m.adaptive_harmonics(0).harmonics(12);
+    m.initialize_operating_state();
+    m.balance();
+    Vector V_ref[13];
+    for (int h = 0; h <= 12; ++h) V_ref[h] = m.V_junc(h);
+    Complex I0_ref = m.I_junc(0)[1];
+    nck_ref[i] = sis.Ck().maxindex();
+
+    // adaptive, starting from 1 harmonic
+    m.harmonics(1).adaptive_harmonics(tol, 12);
+    m.initialize_operating_state();
+    int ok = (m.balance() == 0);
+    H[i] = m.harmonics();
+    nck[i] = sis.Ck().maxindex();
+    double scale = abs(V_ref[1][1]), d = 0.0;
+    for (int h = 0; h <= 12; ++h)
+      d = max(d, abs(m.V_junc(h).read(1) - V_ref[h][1]));
+    cout << "P = " << pumps[i] << " nW: balanced: " << ok
+	 << ", error estimate below tolerance: " << (m.truncation_error() <= tol)
+	 << ", voltages agree: " << (d < tol*scale)
+	 << ", DC current agrees: " << (abs(m.I_junc(0)[1] - I0_ref) < tol*abs(I0_ref))
+	 << endl;
+  }
+  cout << "weak pump needs few harmonics: " << (H[0] <= 3)
+       << ", strong pump needs more: " << (H[1] >= 6 && H[1] < 12) << endl;
+  cout << "fewer Ck than usual: " << (nck[0] < nck_ref[0] && nck[1] < nck_ref[1])
+       << ", more Ck for the strong pump: " << (nck[1] > nck[0]) << endl;
+
+  // the chosen harmonics are kept for the small signal analysis
+  const sdata & s = m.get_data();
+  cout << "small signal size: " << (s.size() == 2*H[1] + 1) << endl;
+
+  // turning the adaptive mode off restores the usual Ck
+  m.adaptive_harmonics(0);
+  m.balance();
+  cout << "usual Ck again: " << (sis.Ck().maxindex() > nck[1]) << endl;
+
+  return 0;
+}
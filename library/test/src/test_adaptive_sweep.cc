@@ -0,0 +1,118 @@
+// test_adaptive_sweep.cc
+// check that an adaptive_sweeper resolves a resonant filter's response
+// with many fewer points than a uniform sweep, that error_func averages
+// over it correctly, and that its points and weights are consistent.
+
+#include "supermix.h"
+#include <vector>
+#include <algorithm>
+
+// the largest error of linear interpolation of |S21| between the points x
+double interp_error(nport & np, std::vector<double> x)
+{
+  parameter old_f(device::f);
+  std::sort(x.begin(), x.end());
+  double e = 0.0;
+  for(unsigned j = 0; j + 1 < x.size(); ++j) {
+    device::f = x[j];   double a = abs(np.get_data().S[2][1]);
+    device::f = x[j+1]; double b = abs(np.get_data().S[2][1]);
+    for(int i = 1; i < 10; ++i) {
+      double t = i/10.0;
+      device::f = x[j] + t*(x[j+1] - x[j]);
+      e = max(e, fabs(abs(np.get_data().S[2][1]) - (a + t*(b - a))));
+    }
+  }
+  device::f = old_f;
+  return e;
+}
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 5*GHz;
+
+  // a coupled resonator: a sharp peak in |S21| near 5 GHz
+  capacitor c1, c2;  c1.series(); c2.series();
+  c1.C = 0.08*pFarad; c2.C = 0.08*pFarad;
+  inductor l; l.parallel(); l.L = 1*nHenry;
+  capacitor c; c.parallel(); c.C = 1*pFarad;
+  resistor r; r.parallel(); r.R = 5000*Ohm; r.Temp = 300*Kelvin;
+  cascade filter;
+  filter.add(c1).add(l).add(c).add(r).add(c2);
+
+  s_mag s21(filter, 1, 2, error_term_mode::MATCH, 0.0);
+
+  // the average of |S21|^2 over the band, from a very dense sweep
+  sweeper dense;
+  dense.sweep(device::f, 2.0, 10.0, 0.001, GHz);
+  error_func ref;
+  ref.add_term(1.0, s21, dense);
+  double exact = ref();
+
+  // the adaptive sweep
+  s_monitor m21(filter, 1, 2);
+  adaptive_sweeper band;
+  band.sweep(device::f, 2.0, 10.0, 9, GHz);
+  band.monitor(m21, 0.001);
+  error_func ef;
+  ef.add_term(1.0, s21, band);
+  double adapt = ef();
+  int n = band.npoints();
+  cout << "adaptive band average within 1%: " << (fabs(adapt - exact) < 0.01*exact) << endl;
+
+  // the response is resolved to about the tolerance, which takes a
+  // uniform sweep many more points
+  std::vector<double> x(n);
+  for(int k = 0; k < n; ++k) x[k] = band.point(k);
+  double err = interp_error(filter, x);
+  cout << "|S21| resolved to 0.002: " << (err < 0.002) << endl;
+  int nu = 9;
+  for(; nu < 10000; nu = 2*nu - 1) {
+    x.resize(nu);
+    for(int k = 0; k < nu; ++k) x[k] = 2.0*GHz + k*8.0*GHz/(nu - 1);
+    if(interp_error(filter, x) <= err) break;
+  }
+  cout << "at least 5 times fewer points than a uniform sweep: " << (nu >= 5*n) << endl;
+
+  // the weights add up to the number of points, and integrate a straight
+  // line exactly
+  double wsum = 0.0, fsum = 0.0;
+  for(int k = 0; k < n; ++k) {
+    wsum += band.weight(k);
+    fsum += band.weight(k)*band.point(k);
+  }
+  cout << "weights sum to npoints: " << (fabs(wsum - n) < 1e-9*n) << endl;
+  cout << "weighted mean frequency is band center: "
+       << (fabs(fsum/n - 6*GHz) < 1e-9*GHz) << endl;
+
+  // points are refined near the resonance
+  int near = 0;
+  for(int k = 0; k < n; ++k)
+    if(fabs(band.point(k) - 5.03*GHz) < 0.5*GHz) ++near;
+  cout << "most points within 0.5 GHz of the resonance: " << (2*near > n) << endl;
+
+  // used in a loop, with a noise monitor as well
+  tn_monitor tn(filter, 1, 2);
+  band.monitor(tn, 0.0, 0.01);
+  int count = 0;
+  for(band.reset(); !band.finished(); band++) ++count;
+  cout << "loop visits npoints: " << (count == band.npoints())
+       << ", more points with noise monitored: " << (count > n) << endl;
+
+  // a FLAT term isn't weighted: it's the plain variance over the points
+  s_mag flat(filter, 1, 2, error_term_mode::FLAT);
+  error_func ff;
+  ff.add_term(1.0, flat, band);
+  double v = ff();
+  double sx = 0.0, sxx = 0.0;
+  n = band.npoints();
+  for(int k = 0; k < n; ++k) {
+    device::f = band.point(k);
+    double x = abs(filter.get_data().S[2][1]);
+    sx += x; sxx += x*x;
+  }
+  double var = (sxx - sx*sx/n)/n;
+  cout << "FLAT term is unweighted: " << (fabs(v - var) < 1e-9*var) << endl;
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+// test_balance_krylov.cc
+// check that the matrix-free (GMRES) harmonic balance of a distributed
+// array of junctions finds the same operating state as the balance using
+// the dense Jacobian, in the same number of Newton iterations.
+
+#include "supermix.h"
+
+int main()
+{
+  const int nj = 30;
+  parameter LO, IF, P;
+  device::f = &IF;
+  device::T = 4*Kelvin;
+  IF = 5*GHz; LO = 300*GHz;
+
+  ivcurve iv("iv.dat","ikk.dat");
+  parameter Rn = 20*Ohm*nj, Vn = 3*mVolt, Cap = 10*fFarad/nj;
+  P = 20*Nano*Watt*nj;
+
+  // junctions shunting a transmission line at nj points, with the LO
+  // coming in at one end and a Z0 termination at the other
+  std::vector<sis_basic_device> j(nj);
+  std::vector<trline> t(nj+1);
+  std::vector<branch> b(nj, branch(3));
+  circuit rf;
+  for (int k = 0; k <= nj; ++k)
+    t[k].set_theta(0.3).set_freq(300*GHz).set_zchar(15*Ohm);
+  for (int k = 0; k < nj; ++k) {
+    rf.connect(t[k],2,b[k],2);
+    rf.connect(b[k],3,t[k+1],1);
+  }
+  for (int k = 0; k < nj; ++k)
+    rf.add_port(b[k],1);
+  rf.add_port(t[0],1);
+  rf.add_port(t[nj],2);
+
+  std::vector<voltage_source> vs(nj);
+  circuit bias;
+  for (int k = 0; k < nj; ++k) {
+    vs[k].source_voltage = (0.5 + 0.2*k/nj)*Vn;
+    vs[k].R = 1*Ohm;
+    bias.add_port(vs[k],1);
+    j[k].set_iv(iv); j[k].Rn = &Rn; j[k].Vn = &Vn; j[k].Cap = &Cap;
+  }
+
+  generator g;
+  g.source_f = &LO;
+  g.source_width = 1*GHz;
+  g.source_power = &P;
+
+  mixer m;
+  m.harmonics(3);
+  m.set_rf(rf).set_if(rf).set_LO(&LO).set_bias(bias);
+  for (int k = 0; k < nj; ++k)
+    m.add_junction(j[k]);
+  m.set_balance_terminator(g, nj+1);
+
+  // the dense balance
+  m.initialize_operating_state();
+  int ok = (m.balance() == 0);
+  int its = m.balance_iterations();
+  Vector V[4];
+  for (int h = 0; h <= 3; ++h) V[h] = m.V_junc(h);
+
+  // the matrix-free balance
+  m.krylov_balance(1);
+  m.initialize_operating_state();
+  ok = ok && (m.balance() == 0);
+  double d = 0.0, big = 0.0;
+  for (int h = 0; h <= 3; ++h)
+    for (int k = 1; k <= nj; ++k) {
+      d = max(d, abs(m.V_junc(h)[k] - V[h][k]));
+      big = max(big, abs(V[h][k]));
+    }
+  cout << "balanced: " << ok
+       << ", same state: " << (d < 1.0e-6*big)
+       << ", same iterations: " << (m.balance_iterations() == its)
+       << ", used gmres: " << (m.krylov_iterations() > 0) << endl;
+
+  // and back again
+  m.krylov_balance(0);
+  m.initialize_operating_state();
+  m.balance();
+  cout << "dense again: " << (m.krylov_iterations() == 0
+			      && abs(m.V_junc(1)[nj/2] - V[1][nj/2]) < 1.0e-9*big) << endl;
+
+  return 0;
+}
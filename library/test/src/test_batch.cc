@@ -0,0 +1,121 @@
+// test_batch.cc
+// check that nport::get_batch() gives the same results as get_data() at
+// each frequency, for the elements with their own recalc_batch() and
+// for circuits built from them.
+
+#include "supermix.h"
+#include <vector>
+
+// max magnitude of the difference between a batch and get_data() results
+double compare(nport & n, const std::vector<double> & f, bool noise = true)
+{
+  sdata_batch b;
+  sdata d;
+  parameter old_f(device::f);
+  if(noise) n.get_batch(&f[0], f.size(), b);
+  else      n.get_batch_S(&f[0], f.size(), b);
+  double diff = (device::f == old_f) ? 0.0 : 1.0;
+
+  for(unsigned long k = 0; k < f.size(); ++k) {
+    device::f = f[k];
+    const sdata & s = noise ? n.get_data() : n.get_data_S();
+    b.get(k, d);
+    diff = max(diff, fabs(d.get_znorm() - s.get_znorm()));
+    for(int i = 1; i <= s.size(); ++i) {
+      diff = max(diff, abs(d.B[i] - s.B[i]));
+      for(int j = 1; j <= s.size(); ++j) {
+	diff = max(diff, abs(d.S[i][j] - s.S[i][j]));
+	if(noise) diff = max(diff, abs(d.C[i][j] - s.C[i][j]));
+      }
+    }
+  }
+  device::f = old_f;
+  return diff;
+}
+
+void check(nport & n, const std::vector<double> & f, const char * label)
+{
+  cout << label << ": max difference < 1e-12: " << (compare(n, f) < 1e-12)
+       << " (S only: " << (compare(n, f, false) < 1e-12) << ")" << endl;
+}
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 1*GHz;
+
+  std::vector<double> f;
+  for(double x = 10; x <= 300; x += 7.5) f.push_back(x*GHz);
+
+  resistor r; r.series(); r.R = 20*Ohm;
+  resistor hot; hot.parallel(); hot.R = 500*Ohm; hot.Temp = 300*Kelvin;
+  capacitor c; c.parallel(); c.C = 0.1*pFarad;
+  inductor l; l.series(); l.L = 0.1*nHenry;
+  series_RLC s(5*Ohm, 0.2*nHenry, 0.05*pFarad);
+  parallel_RLC p(80*Ohm, 0.1*nHenry, 0.02*pFarad); p.parallel();
+  branch br(3);
+  series_tee st;
+  zterm z; z.Z = Complex(60*Ohm, 10*Ohm);
+  yterm y; y.Y = Complex(0.01, -0.02);
+  trline t; t.set_theta(Pi/3).set_freq(100*GHz).set_zchar(35*Ohm).set_loss(0.05);
+
+  const_diel sio(5.6, 0.001), vacuum;
+  super_film nb;
+  nb.Vgap = 2.9*mVolt; nb.Tc = 9.2*Kelvin;
+  nb.rho_normal = 5.*Micro*Ohm*Centi*Meter; nb.Thick = 3000.*Angstrom;
+  microstrip m;
+  m.substrate(sio).superstrate(vacuum).top_strip(nb).ground_plane(nb);
+  m.sub_thick = 4500*Angstrom; m.width = 5*Micron; m.length = 50*Micron;
+  cpw w;
+  w.substrate(sio).top_strip(nb);
+  w.sub_thick = 200*Micron; w.width = 5*Micron; w.space = 3*Micron; w.length = 50*Micron;
+  voltage_source vs; vs.R = 30*Ohm; vs.source_voltage = 1*mVolt; vs.source_f = 100*GHz;
+
+  check(r, f, "resistor");
+  check(hot, f, "hot resistor");
+  check(c, f, "capacitor");
+  check(l, f, "inductor");
+  check(s, f, "series_RLC");
+  check(p, f, "parallel_RLC");
+  check(br, f, "branch");
+  check(st, f, "series_tee");
+  check(z, f, "zterm");
+  check(y, f, "yterm");
+  check(t, f, "trline");
+  check(m, f, "microstrip");
+  check(w, f, "cpw");
+  check(vs, f, "voltage_source");
+
+  // a circuit with two parallel paths (an intraconnection) and a
+  // separate 1-port (a block connection)
+  branch b1(3), b2(3);
+  circuit ck;
+  ck.connect(b1, 2, r, 1);
+  ck.connect(r, 2, hot, 1);
+  ck.connect(hot, 2, b2, 1);
+  ck.connect(b1, 3, m, 1);
+  ck.connect(m, 2, b2, 2);
+  ck.connect(b2, 3, t, 1);
+  ck.add_port(b1, 1);
+  ck.add_port(t, 2);
+  ck.add_port(z, 1);
+  check(ck, f, "circuit");
+
+  // a circuit containing a circuit, at a different temperature
+  circuit outer;
+  outer.connect(vs, 1, s, 1);
+  outer.connect(s, 2, ck, 1);
+  outer.connect(ck, 2, l, 1);
+  outer.add_port(l, 2);
+  outer.add_port(ck, 3);
+  outer.Temp = 20*Kelvin;
+  check(outer, f, "nested circuit");
+
+  sdata_batch b;
+  outer.get_batch(&f[0], f.size(), b);
+  cout << "size(): " << b.size() << " points(): " << b.points()
+       << " freq(3): " << b.freq(3)/GHz << " GHz" << endl;
+  complex::out_degree(); complex::out_delimited();
+  cout << "S11, C11 at " << b.freq(3)/GHz << " GHz: " << b.S(1,1)[3]
+       << ", " << real(b.C(1,1)[3]) << endl;
+}
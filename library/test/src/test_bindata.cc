@@ -0,0 +1,105 @@
+// test_bindata.cc
+// convert a datafile and a Touchstone file to bindata files, then check
+// that the binary versions read back identically, keeping the normalization
+// of the file.
+
+#include "supermix.h"
+#include <cstdio>
+
+int main(int argc, char ** argv)
+{
+  if(argc < 3) {
+    error::fatal(argv[0],
+		 " : Need to specify a datafile and a 2-port Touchstone file on command line") ;
+  }
+
+  const char * table_name = "test_bindata.table.tmp";
+  const char * sdata_name = "test_bindata.sdata.tmp";
+
+  // ----------------------------------------------------------------
+  // the datafile
+
+  datafile text(argv[1]);
+  cout << "datafile_to_bindata(): " << datafile_to_bindata(argv[1], table_name) << endl;
+  cout << "is_bindata(): " << bindata_file::is_bindata(table_name)
+       << " " << bindata_file::is_bindata(argv[1]) << endl;
+
+  {
+    bindata_table bin(table_name);
+    datafile copy(table_name);
+    cout << "columns: " << text.numcolumns() << " " << bin.numcolumns()
+	 << " " << copy.numcolumns() << endl;
+    cout << "lines: " << text.numlines() << " " << bin.numlines()
+	 << " " << copy.numlines() << endl;
+    int bad = 0;
+    for(int i = 1; i <= text.numlines(); ++i)
+      for(int j = 1; j <= text.numcolumns(); ++j)
+	bad += (bin.read(j,i) != text.read(j,i)) + (copy.read(j,i) != text.read(j,i));
+    cout << "mismatched values: " << bad << endl;
+    cout << "table alias:" << endl << *bin.table() << endl;
+  }
+
+  // ----------------------------------------------------------------
+  // the Touchstone file
+
+  cout << endl << "touchstone_to_bindata(): "
+       << touchstone_to_bindata(argv[2], sdata_name) << endl;
+
+  {
+    bindata_file f(sdata_name);
+    cout << "version: " << f.version() << " kind: " << f.kind()
+	 << " ports: " << f.ports() << " znorm: " << f.znorm()/Ohm << endl;
+    for(int i = 1; i <= f.columns(); ++i)
+      cout << "column " << f.name(i) << ": type " << f.type(i)
+	   << ", " << f.rows(i) << " x " << f.width(i) << endl;
+  }
+
+  S_interp t(2), b(2);
+  t.touchstone(argv[2]);
+  cout << "binary(): " << b.binary(sdata_name) << endl;
+  cout << "ready(): " << b.ready() << " ; has_noise(): " << b.has_noise() << endl;
+
+  double maxdiff = 0.0;
+  for(double f = 2.0; f <= 10.0; f += 0.25) {
+    Matrix dS = t.S(f*GHz) - b.S(f*GHz);
+    Matrix dC = t.C(f*GHz) - b.C(f*GHz);
+    for(int i = 1; i <= 2; ++i)
+      for(int j = 1; j <= 2; ++j) {
+	if(abs(dS[i][j]) > maxdiff) maxdiff = abs(dS[i][j]);
+	if(abs(dC[i][j]) > maxdiff) maxdiff = abs(dC[i][j]);
+      }
+  }
+  cout << "max difference: " << maxdiff << endl;
+
+  // a file normalized to 75 Ohm, loaded into an S_interp already holding
+  // 50 Ohm data: the file's data and normalization replace it unchanged
+  const char * z75_name = "test_bindata.z75.tmp";
+  parameter old_Z0(device::Z0);
+  device::Z0 = 75*Ohm;
+  S_interp z75(2);
+  for(double f = 2.0; f <= 10.0; f += 0.5)
+    z75.add_SC(f*GHz, t.S(f*GHz), t.C(f*GHz), t.Znorm());
+  z75.build();
+  device::Z0 = old_Z0;
+  cout << "bindata_write(): " << bindata_write(z75_name, z75) << endl;
+
+  S_interp r(2);
+  r.add_S(2*GHz, t.S(2*GHz)).add_S(10*GHz, t.S(10*GHz)).build();
+  cout << "binary() over " << r.Znorm()/Ohm << " Ohm data: " << r.binary(z75_name)
+       << " ; Znorm(): " << r.Znorm()/Ohm << endl;
+  int same = 1;
+  for(double f = 2.0; f <= 10.0; f += 0.25) {
+    Matrix dS = r.S(f*GHz) - z75.S(f*GHz), dC = r.C(f*GHz) - z75.C(f*GHz);
+    for(int i = 1; i <= 2; ++i)
+      for(int j = 1; j <= 2; ++j)
+	same = same && dS[i][j] == 0.0 && dC[i][j] == 0.0;
+  }
+  cout << "same as written: " << same << endl;
+
+  complex::out_degree(); complex::out_delimited();
+  cout << "S at 10 GHz:"; b.S(10*GHz).show();
+
+  remove(table_name);
+  remove(sdata_name);
+  remove(z75_name);
+}
@@ -0,0 +1,85 @@
+// test_cascade.cc
+// check that a cascade gives the same results as the equivalent circuit,
+// including noise and sources, and for 1-port cascades.
+
+#include "supermix.h"
+
+// max magnitude of the difference between the elements of two sdata's
+double diff(const sdata & A, const sdata & B, bool noise = true)
+{
+  double d = 0.0;
+  for(int i = 1; i <= A.size(); ++i) {
+    d = max(d, abs(A.B[i] - B.B[i]));
+    for(int j = 1; j <= A.size(); ++j) {
+      d = max(d, abs(A.S[i][j] - B.S[i][j]));
+      if(noise) d = max(d, abs(A.C[i][j] - B.C[i][j]));
+    }
+  }
+  return d;
+}
+
+// build the circuit equivalent to a cascade of the devices in v
+void build(circuit & c, std::vector<nport *> & v)
+{
+  c.add_port(*v[0], 1);
+  for(unsigned i = 1; i < v.size(); ++i)
+    c.connect(*v[i-1], 2, *v[i], 1);
+  if(v.back()->size() == 2) c.add_port(*v.back(), 2);
+}
+
+void compare(std::vector<nport *> & v, const char * label, double Temp = 0.0)
+{
+  cascade cs;
+  circuit ck;
+  for(unsigned i = 0; i < v.size(); ++i) cs.add(*v[i]);
+  build(ck, v);
+  if(Temp != 0.0) cs.Temp = ck.Temp = Temp;
+
+  double d = 0.0, ds = 0.0;
+  for(double f = 50; f <= 150; f += 10) {
+    device::f = f*GHz;
+    d = max(d, diff(cs.get_data(), ck.get_data()));
+    ds = max(ds, diff(cs.get_data_S(), ck.get_data_S(), false));
+  }
+  const nport::data_info & i1 = cs.get_data_info();
+  const nport::data_info & i2 = ck.get_data_info();
+  cout << label << ": size " << cs.size()
+       << ", same info: " << (i1.noise == i2.noise && i1.active == i2.active && i1.source == i2.source)
+       << ", noise " << i1.noise << ", active " << i1.active << ", source " << i1.source
+       << ", max difference < 1e-12: " << (d < 1e-12) << " (S only: " << (ds < 1e-12) << ")" << endl;
+}
+
+int main()
+{
+  device::T = 4*Kelvin;
+
+  resistor r; r.series(); r.R = 20*Ohm;
+  capacitor c; c.parallel(); c.C = 0.1*pFarad;
+  inductor l; l.series(); l.L = 0.1*nHenry;
+  trline t1; t1.set_theta(Pi/3).set_freq(100*GHz).set_zchar(35*Ohm).set_loss(0.05);
+  trline t2; t2.set_theta(Pi/5).set_freq(100*GHz).set_zchar(70*Ohm);
+  resistor hot; hot.parallel(); hot.R = 500*Ohm; hot.Temp = 300*Kelvin;
+  voltage_source vs; vs.R = 30*Ohm; vs.source_voltage = 1*mVolt; vs.source_f = 100*GHz;
+  zterm z; z.Z = Complex(60*Ohm, 10*Ohm);
+
+  std::vector<nport *> v;
+  v.push_back(&r);
+  compare(v, "one 2-port");
+  v.push_back(&c); v.push_back(&t1); v.push_back(&l); v.push_back(&t2);
+  compare(v, "passive chain");
+  compare(v, "passive chain at 77 K", 77*Kelvin);
+  v.insert(v.begin() + 2, &hot);
+  compare(v, "active chain");
+  v.push_back(&z);
+  compare(v, "terminated active chain");
+  v.back() = &vs;
+  device::f = 100*GHz;
+  compare(v, "chain with source");
+  v.erase(v.begin() + 2);
+  compare(v, "passive chain with source");
+
+  // the empty cascade is a branch
+  cascade e;
+  complex::out_degree(); complex::out_delimited();
+  cout << "empty cascade size " << e.size() << ", S:"; e.get_data().S.show();
+}
@@ -0,0 +1,143 @@
+// test_error_parallel.cc
+// check that iv_match and fts_match give the same error function values
+// when their sweeps are balanced in parallel by a mixer_batch as when
+// they are balanced one point at a time, and that the parallel values
+// don't depend on the number of threads; and that a change to a fit
+// parameter between evaluations reaches the parallel mixers, which are
+// only built once.
+
+#include "supermix.h"
+#include <atomic>
+
+std::atomic<int> builds(0);
+
+// a two junction mixer like that of test_mixer_batch, with an LO generator
+class two_junctions : public mixer_model
+{
+public:
+  two_junctions() :
+    iv("iv.dat", "ikk.dat"), R1(50*Ohm), R2(100*Ohm), b(3)
+  {
+    Rn = 10*Ohm; Vn = 3*mVolt; Cap = 20*fFarad;
+    LO = 0.5*Vn*VoltToFreq;
+    P = 20*Nano*Watt;
+    bias = 0.6*Vn;
+
+    Rf.connect(R1,1,b,1); Rf.connect(R2,1,b,2);
+    Rf.add_port(R1,2); Rf.add_port(R2,2); Rf.add_port(b,3);
+    If.connect(R1,1,b,1); If.connect(R2,1,b,2);
+    If.add_port(R1,2); If.add_port(R2,2); If.add_port(b,3);
+
+    j1.set_iv(iv); j1.Rn = &Rn; j1.Vn = &Vn; j1.Cap = &Cap;
+    j2.set_iv(iv); j2.Rn = &Rn; j2.Vn = &Vn; j2.Cap = &Cap;
+    j1_bias.source_voltage = &bias;
+    j2_bias.source_voltage = Vn/3;
+    dc.add_port(j1_bias, 1);
+    dc.add_port(j2_bias, 1);
+
+    LO_source.source_f = &LO;
+    LO_source.source_width = 1*GHz;
+    LO_source.source_power = &P;
+
+    m.harmonics(3);
+    m.set_rf(Rf).set_if(If).set_LO(&LO);
+    m.add_junction(j1).add_junction(j2).set_bias(dc);
+    m.set_balance_terminator(LO_source, 3);
+  }
+
+  mixer & get_mixer() { return m; }
+  void parameters(std::vector<real_parameter *> & p) { p.push_back(&Rn); p.push_back(&Cap); }
+
+  parameter LO, P, bias;
+  parameter Rn, Cap;   // the fit parameters
+
+private:
+  ivcurve iv;
+  parameter Vn;
+  resistor R1, R2;
+  branch b;
+  circuit Rf, If, dc;
+  sis_basic_device j1, j2;
+  voltage_source j1_bias, j2_bias;
+  generator LO_source;
+  mixer m;
+};
+
+// the operating points of the two terms
+class iv_model : public two_junctions
+{
+public:
+  mixer_model * build() const { ++builds; return new iv_model; }
+  void set(const real_vector & x) { bias = x[1]; }
+};
+
+class fts_model : public two_junctions
+{
+public:
+  mixer_model * build() const { ++builds; return new fts_model; }
+  void set(const real_vector & x) { LO = x[1]; P = x[2]; }
+};
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 5*GHz;
+
+  // a pumped IV curve of 40 points
+  iv_model a;
+  iv_match iv_term(a.get_mixer(), a.bias, "iv.dat", 3*mVolt, 0.3*Milli*Amp);
+  sweeper iv_sweep;
+  iv_sweep.sweep(a.bias, 0.2, 2.15, 0.05, mVolt);
+
+  error_func ef;
+  ef.add_term(1.0, iv_term, iv_sweep);
+  double serial = ef.func_value();
+
+  iv_term.parallel(a, iv_sweep, 4);
+  double par4 = ef.func_value();
+  builds = 0;
+  iv_term.parallel(a, iv_sweep, 1);
+  double par1 = ef.func_value();
+
+  cout << "iv_match: same as serial: " << (fabs(par4 - serial) < 1.0e-6*serial)
+       << ", independent of threads: " << (par4 == par1) << endl;
+
+  // change the fit parameters between evaluations, as an optimizer would
+  double before = ef.func_value();
+  a.Rn = 12*Ohm; a.Cap = 25*fFarad;
+  double after = ef.func_value();
+  iv_term.serial();
+  double serial_after = ef.func_value();
+  a.Rn = 10*Ohm; a.Cap = 20*fFarad;
+  cout << "fit parameters changed: "
+       << (fabs(after - before) > 1.0e-3*before
+	   && fabs(after - serial_after) < 1.0e-6*serial_after)
+       << ", built once: " << (builds == 1) << endl;
+
+  // an FTS response of 21 points
+  fts_model f;
+  fts_match fts_term(f.get_mixer(), f.LO, f.P, "fts.dat", GHz, 1*Nano*Watt);
+  sweeper fts_sweep;
+  fts_sweep.sweep(f.LO, 200, 700, 25, GHz);
+
+  error_func ef2;
+  ef2.add_term(1.0, fts_term, fts_sweep);
+  serial = ef2.func_value();
+  double scale = fts_term.scale();
+
+  fts_term.parallel(f, fts_sweep, 4);
+  par4 = ef2.func_value();
+  double scale4 = fts_term.scale();
+  fts_term.parallel(f, fts_sweep, 1);
+  par1 = ef2.func_value();
+
+  cout << "fts_match: same as serial: "
+       << (fabs(par4 - serial) < 1.0e-6 && fabs(scale4 - scale) < 1.0e-4*fabs(scale))
+       << ", independent of threads: " << (par4 == par1) << endl;
+
+  // back to serial
+  fts_term.serial();
+  cout << "serial again: " << (fabs(ef2.func_value() - serial) < 1.0e-9) << endl;
+
+  return 0;
+}
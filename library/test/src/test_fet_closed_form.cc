@@ -0,0 +1,82 @@
+// test_fet_closed_form.cc
+// check that the closed form calculation of a fet's equivalent circuit
+// gives the same S and C matrices as the circuit of elements, for the
+// transistors of hemt.h, one at a time and in batches.
+
+#include "supermix.h"
+
+double diff(const sdata & a, const sdata & b)
+{
+  double d = 0.0;
+  for(int i = 1; i <= 2; ++i)
+    for(int j = 1; j <= 2; ++j)
+      d = max(d, max(abs(a.S[i][j] - b.S[i][j]),
+		     abs(a.C[i][j] - b.C[i][j])/(1.0 + abs(b.C[i][j]))));
+  return d;
+}
+
+// the largest difference between the closed form and circuit results
+double compare(fet & q)
+{
+  double d = 0.0;
+  for(double f = 0.0; f <= 100*GHz; f += 3.7*GHz) {
+    device::f = f;
+    q.closed_form(true);
+    sdata a = q.get_data();
+    q.closed_form(false);
+    d = max(d, diff(a, q.get_data()));
+  }
+  q.closed_form(true);
+  return d;
+}
+
+int main()
+{
+  device::Z0 = 50*Ohm;
+  fhx13x a;  fhr02x b;  kukje c;  jpltrw160 d;  jpltrw300 e;
+  fet * q[] = { &a, &b, &c, &d, &e };
+  const char * name[] = { "fhx13x", "fhr02x", "kukje", "jpltrw160", "jpltrw300" };
+
+  double temps[] = { 4*Kelvin, 20*Kelvin, 297*Kelvin };
+  for(int k = 0; k < 5; ++k) {
+    double dd = 0.0;
+    for(int t = 0; t < 3; ++t) {
+      device::T = temps[t];
+      dd = max(dd, compare(*q[k]));
+    }
+    cout << name[k] << " same as circuit: " << (dd < 1e-12) << endl;
+  }
+
+  // without bond wires, and with resistors at their own temperatures
+  device::T = 4*Kelvin;
+  d.remove_bond_wires();
+  d.Rg.Temp = 30*Kelvin;
+  d.Rs.Temp = 10*Kelvin;
+  cout << "jpltrw160 without bond wires: " << (compare(d) < 1e-12) << endl;
+
+  // a batch of frequencies
+  const int n = 50;
+  double freqs[n];
+  for(int k = 0; k < n; ++k) freqs[k] = (k + 0.5)*GHz;
+  sdata_batch batch;
+  a.get_batch(freqs, n, batch);
+  double db = 0.0;
+  sdata sd;
+  a.closed_form(false);
+  for(int k = 0; k < n; ++k) {
+    device::f = freqs[k];
+    batch.get(k, sd);
+    db = max(db, diff(sd, a.get_data()));
+  }
+  a.closed_form(true);
+  cout << "batch same as circuit: " << (db < 1e-12) << endl;
+
+  // the circuit is used if an element's mode has been changed
+  e.Cpg.series();
+  device::f = 10*GHz;
+  sdata s1 = e.get_data();
+  e.closed_form(false);
+  cout << "changed circuit: " << (diff(s1, e.get_data()) == 0.0) << endl;
+
+  return 0;
+}
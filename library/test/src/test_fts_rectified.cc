@@ -0,0 +1,98 @@
+// test_fts_rectified.cc
+// check that the perturbative FTS response of fts_match, calculated with
+// mixer::I_rectified() from the unpumped junctions, agrees with the
+// response found by harmonic balances at a small LO power.
+
+#include "supermix.h"
+
+int main()
+{
+  parameter LO, IF, LO_power = 0;
+  device::f = &IF;
+  device::T = 4*Kelvin;
+  IF = 1*GHz;
+
+  // a two junction mixer like that of test_mixer_cache, with capacitance,
+  // an LO generator, and some resistance in the bias circuit
+  resistor R1(50*Ohm), R2(100*Ohm);
+  trline t1, t2;
+  t1.set_theta(Pi/4).set_freq(500*GHz).set_zchar(30*Ohm);
+  t2.set_theta(Pi/3).set_freq(500*GHz).set_zchar(20*Ohm);
+  branch b(3);
+  circuit Rf, If;
+  Rf.connect(R1,1,b,1); Rf.connect(R2,1,t1,1); Rf.connect(t1,2,b,2);
+  Rf.add_port(R1,2); Rf.add_port(R2,2); Rf.connect(b,3,t2,1); Rf.add_port(t2,2);
+  If.connect(R1,1,b,1); If.connect(R2,1,b,2);
+  If.add_port(R1,2); If.add_port(R2,2); If.add_port(b,3);
+
+  ivcurve iv("iv.dat","ikk.dat");
+  parameter Rn = 10*Ohm, Vn = 3*mVolt, Cap = 20*fFarad;
+  sis_basic_device j1, j2;
+  j1.set_iv(iv); j1.Rn = &Rn; j1.Vn = &Vn; j1.Cap = &Cap;
+  j2.set_iv(iv); j2.Rn = &Rn; j2.Vn = &Vn; j2.Cap = &Cap;
+
+  voltage_source j1_bias, j2_bias;
+  j1_bias.source_voltage = 0.6*Vn;
+  j1_bias.R = 2*Ohm;
+  j2_bias.source_voltage = 0.7*Vn;
+  j2_bias.R = 1*Ohm;
+  circuit bias;
+  bias.add_port(j1_bias, 1);
+  bias.add_port(j2_bias, 1);
+
+  generator LO_source;
+  LO_source.source_f = &LO;
+  LO_source.source_width = 1*GHz;
+  LO_source.source_power = &LO_power;
+
+  mixer mix;
+  mix.harmonics(3);
+  mix.set_rf(Rf).set_if(If).set_LO(&LO);
+  mix.add_junction(j1).add_junction(j2).set_bias(bias);
+  mix.set_balance_terminator(LO_source, 3);
+
+  // the two fts_match modes over the band, at a 0.1 nW pump
+  LO = 300*GHz;
+  fts_match full(mix, LO, LO_power, "fts.dat", GHz, 0.1*Nano*Watt);
+  fts_match pert(mix, LO, LO_power, "fts.dat", GHz, 0.1*Nano*Watt);
+  pert.perturbative();
+  full.reset();
+  pert.reset();
+
+  double d = 0.0, big = 0.0;
+  for(LO = 200*GHz; LO <= 700*GHz; LO += 25*GHz) {
+    double a = full.get_b(state_tag());
+    double c = pert.get_b(state_tag());
+    d = max(d, fabs(a - c));
+    big = max(big, fabs(a));
+  }
+  cout << "same response as balance: " << (d < 1.0e-3*big) << endl;
+  cout << "junctions left unpumped: " << (abs(mix.V_junc(1)[1]) == 0.0) << endl;
+
+  // the response is proportional to the LO power, and to second order in
+  // the LO amplitude the balance agrees more closely at lower power
+  LO = 500*GHz;
+  Vector V0 = mix.V_junc(0);
+  LO_power = 1*Nano*Watt;
+  Vector r1 = mix.I_rectified(V0);
+  LO_power = 4*Nano*Watt;
+  Vector r4 = mix.I_rectified(V0);
+  cout << "proportional to power: " << (abs(r4[1] - 4.0*r1[1]) < 1.0e-12*abs(r1[1])
+				       && abs(r4[2] - 4.0*r1[2]) < 1.0e-12*abs(r1[2])) << endl;
+
+  double e[2];
+  double p[2] = { 4*Nano*Watt, 1*Nano*Watt };
+  for(int k = 0; k < 2; ++k) {
+    LO_power = 0;
+    mix.initialize_operating_state();
+    mix.balance();
+    Vector I0 = mix.I_junc(0);
+    LO_power = p[k];
+    mix.balance();
+    Vector dI = mix.I_junc(0) - I0;
+    e[k] = abs(dI[1] - r1[1]*(p[k]/p[1])) + abs(dI[2] - r1[2]*(p[k]/p[1]));
+  }
+  cout << "balance converges to it: " << (e[1] < 0.5*e[0]) << endl;
+
+  return 0;
+}
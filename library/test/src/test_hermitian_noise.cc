@@ -0,0 +1,120 @@
+// test_hermitian_noise.cc
+// check the hermitian congruence kernel MAMdagger() against the full
+// matrix products, including in place and with symmetric indexing, and
+// that the noise correlation matrices of a connected active circuit and
+// of a mixer, which now have only their upper triangles calculated, are
+// hermitian and agree with their conversions.
+
+#include "supermix.h"
+#include <cstdlib>
+
+static double hermitian_error(const Matrix & C)
+{
+  double d = 0.0, big = 0.0;
+  for (int i = C.Lminindex(); i <= C.Lmaxindex(); ++i)
+    for (int j = C.Rminindex(); j <= C.Rmaxindex(); ++j) {
+      // the lower triangle is copied exactly; the diagonal is real to rounding
+      double e = abs(C[i][j] - conj(C[j][i]));
+      d = max(d, (i == j) ? ((e > 1.0e-12*abs(C[i][i])) ? e : 0.0) : e);
+      big = max(big, abs(C[i][j]));
+    }
+  return (big > 0) ? d/big : 0.0;
+}
+
+static Complex random_complex()
+{ return Complex(rand()/double(RAND_MAX) - 0.5, rand()/double(RAND_MAX) - 0.5); }
+
+int main()
+{
+  // the kernel
+  v_index_mode modes[] = { Index_1, Index_S };
+  for (int t = 0; t < 2; ++t) {
+    int n = 7;
+    Matrix V(n, n, modes[t], modes[t]), A(n, n, modes[t], modes[t]);
+    for (int i = V.Lminindex(); i <= V.Lmaxindex(); ++i)
+      for (int j = V.Rminindex(); j <= V.Rmaxindex(); ++j) {
+	V[i][j] = random_complex();
+	A[i][j] = random_complex();
+      }
+    Matrix W = A * dagger(A);
+    Matrix R = V * W * dagger(V);
+    Matrix U(R); U = 0.0;
+    MAMdagger(U, V, W);
+    Matrix Ui(W);
+    MAMdagger(Ui, V, Ui);
+    double d = 0.0, di = 0.0, big = 0.0;
+    for (int i = R.Lminindex(); i <= R.Lmaxindex(); ++i)
+      for (int j = R.Rminindex(); j <= R.Rmaxindex(); ++j) {
+	d = max(d, abs(U[i][j] - R[i][j]));
+	di = max(di, abs(Ui[i][j] - R[i][j]));
+	big = max(big, abs(R[i][j]));
+      }
+    cout << ((t == 0) ? "Index_1" : "Index_S") << ": same as products: " << (d < 1.0e-12*big)
+	 << ", in place: " << (di < 1.0e-12*big)
+	 << ", hermitian: " << (hermitian_error(U) == 0.0) << endl;
+  }
+
+  // an active circuit: a fet with a hot drain resistance between resistors
+  device::T = 12*Kelvin;
+  device::f = 5*GHz;
+  fet f;
+  f.Gm.G = 73.1621 * mSiemens;
+  f.Gm.Tau = 0.7 * Pico * Second;
+  f.Cgs.C = 0.18305 * pFarad;
+  f.Rds.R = 166.21 * Ohm;
+  f.Cgd.C = 0.0242041 * pFarad;
+  f.Cds.C = 0.0230908 * pFarad;
+  f.Rgs.R = 1.47226 * Ohm;
+  f.Rd.R = 5.0 * Ohm;
+  f.Rd.Temp = 500.0 * Kelvin;
+  resistor R1(30*Ohm), R2(70*Ohm), R3(200*Ohm);
+  R1.series(); R2.parallel(); R3.series();
+  circuit c;
+  c.connect(R1, 2, f, 1);
+  c.connect(f, 2, R2, 1);
+  c.connect(R2, 2, R3, 1);
+  c.add_port(R1, 1); c.add_port(R3, 2);
+  const sdata & s = c.get_data();
+  zdata z(s);
+  sdata sz(z);
+  double d = 0.0;
+  for (int i = 1; i <= 2; ++i)
+    for (int j = 1; j <= 2; ++j)
+      d = max(d, abs(sz.C[i][j] - s.C[i][j]));
+  cout << "circuit noise hermitian: " << (hermitian_error(s.C) == 0.0)
+       << ", same through zdata: " << (d < 1.0e-9*abs(s.C[2][2])) << endl;
+
+  // a mixer
+  parameter LO, IF, P;
+  device::f = &IF;
+  device::T = 4*Kelvin;
+  LO = 300*GHz; IF = 5*GHz;
+  P = 20*Nano*Watt;
+  trline tl;
+  tl.set_theta(Pi/3).set_freq(500*GHz).set_zchar(20*Ohm);
+  branch b(2);
+  circuit rf;
+  rf.add_port(b,1); rf.connect(b,2,tl,1); rf.add_port(tl,2);
+  ivcurve iv("iv.dat","ikk.dat");
+  parameter Rn = 10*Ohm, Vn = 3*mVolt, Cap = 20*fFarad;
+  sis_basic_device sis;
+  sis.set_iv(iv); sis.Rn = &Rn; sis.Vn = &Vn; sis.Cap = &Cap;
+  voltage_source vb;
+  vb.source_voltage = 0.6*Vn;
+  circuit bias;
+  bias.add_port(vb,1);
+  generator g;
+  g.source_f = &LO;
+  g.source_width = 1*GHz;
+  g.source_power = &P;
+  mixer m;
+  m.harmonics(3);
+  m.set_rf(rf).set_if(rf).set_LO(&LO).add_junction(sis).set_bias(bias);
+  m.set_balance_terminator(g,2);
+  m.balance();
+  const sdata & ms = m.get_data();
+  cout << "mixer noise hermitian: " << (hermitian_error(ms.C) == 0.0)
+       << ", DSB noise temperature: " << (ms.tn(m.port(2,0), m.port(2,1)) > 0) << endl;
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+// test_iv_kk.cc
+// check the Kramers-Kronig transform calculated by ivcurve from DC IV
+// data alone.
+//
+// usage: test_iv_kk <idc_file> <ikk_file>
+
+#include "supermix.h"
+
+int main(int argc, char ** argv)
+{
+  if(argc < 3) {
+    error::fatal(argv[0],
+		 " : Need to specify the idc and ikk files on command line") ;
+  }
+
+  // I(V) = V-1 above V = 1 and 0 below has the transform:
+  //   Ikk(V) = (V log|(1+V)/(1-V)| + log|1-V^2|)/Pi
+  std::vector<double> V, I;
+  for(int i = 0; i <= 500; ++i) {
+    V.push_back(0.005*i);
+    I.push_back((i > 200) ? 0.005*i - 1 : 0.0);
+  }
+  ivcurve c;
+  c.data(V, I);
+  double maxdiff = 0.0;
+  for(double v = 0.1; v < 20.0; v *= 1.1) {
+    if(fabs(v - 1) < 0.05) continue;  // the log singularity
+    double d = fabs(c(v).real - (v*log(fabs((1+v)/(1-v))) + log(fabs(1-v*v)))/Pi);
+    if(d > maxdiff) maxdiff = d;
+  }
+  cout << "kk_points(): " << c.kk_points()
+       << " analytic max difference < 1e-5: " << (maxdiff < 1e-5) << endl;
+
+  // compare with the ikk file, allowing for its offset
+  ivcurve iv(argv[1], argv[2]), kk(argv[1]);
+  double offset = iv(0.0).real - kk(0.0).real;
+  maxdiff = 0.0;
+  for(double v = 0.0; v <= 2.0; v += 0.001) {
+    double d = fabs(iv(v).real - kk(v).real - offset);
+    if(d > maxdiff) maxdiff = d;
+  }
+  cout << "ikk file max difference < 0.002: " << (maxdiff < 0.002) << endl;
+
+  // Idc is unchanged, and Ikk is even
+  double idcdiff = 0.0, evendiff = 0.0;
+  for(double v = 0.0; v <= 6.0; v += 0.01) {
+    idcdiff = max(idcdiff, fabs(iv(v).imaginary - kk(v).imaginary));
+    evendiff = max(evendiff, fabs(kk(v).real - kk(-v).real));
+  }
+  cout << "Idc unchanged: " << (idcdiff == 0.0)
+       << " Ikk even: " << (evendiff == 0.0) << endl;
+
+  cout.precision(4);
+  cout << fixed;
+  for(double v = 0.0; v <= 8.0; v += 0.5)
+    cout << v << "\t" << kk(v).imaginary << "\t" << kk(v).real << endl;
+}
@@ -0,0 +1,69 @@
+// test_matrix_table_interp.cc
+// check that matrix_table_interp (used by S_interp) reproduces the
+// interpolations of the interpolator<Matrix> it was built from.
+
+#include "supermix.h"
+
+// max magnitude of the difference between the elements of two matrices
+double diff(const Matrix & A, const Matrix & B)
+{
+  double d = 0.0;
+  for(int i = 1; i <= A.Lmaxindex(); ++i)
+    for(int j = 1; j <= A.Rmaxindex(); ++j)
+      if(abs(A.read(i,j) - B.read(i,j)) > d) d = abs(A.read(i,j) - B.read(i,j));
+  return d;
+}
+
+// compare over a frequency range which includes extrapolation at both ends
+void compare(const interpolator<Matrix> & I, const char * label)
+{
+  matrix_table_interp T;
+  T.build(I);
+  Matrix M(T.size());
+  double maxdiff = 0.0;
+  for(double f = 0.0; f <= 14.0; f += 0.05) {
+    T(f*GHz, M);
+    double d = diff(M, I(f*GHz));
+    if(d > maxdiff) maxdiff = d;
+  }
+  cout << label << ": ready(): " << T.ready() << " size(): " << T.size()
+       << " max difference < 1e-12: " << (maxdiff < 1e-12) << endl;
+}
+
+int main(int argc, char ** argv)
+{
+  if(argc < 2) {
+    error::fatal(argv[0],
+		 " : Need to specify a 2-port Touchstone file on command line") ;
+  }
+
+  S_interp s(2);
+  s.touchstone(argv[1]);
+  s.S_interpolator().quiet();
+  s.C_interpolator().quiet();
+
+  compare(s.S_interpolator(), "S spline");
+  compare(s.C_interpolator(), "C spline");
+  s.S_interpolator().linear().build();
+  compare(s.S_interpolator(), "S linear");
+
+  // S_interp uses its matrix_table_interp's after build()
+  s.build();
+  sdata sd(2);
+  double maxdiff = 0.0;
+  for(double f = 1.0; f <= 12.0; f += 0.1) {
+    s.fill(sd, f*GHz);
+    double d = diff(sd.S, s.S_interpolator()(f*GHz)) + diff(sd.C, s.C_interpolator()(f*GHz));
+    if(d > maxdiff) maxdiff = d;
+  }
+  cout << "fill(): max difference < 1e-12: " << (maxdiff < 1e-12) << endl;
+
+  // an empty or unbuilt interpolator gives an empty matrix_table_interp
+  interpolator<Matrix> empty;
+  matrix_table_interp T;
+  cout << "empty: ready(): " << T.build(empty).ready() << endl;
+
+  complex::out_degree(); complex::out_delimited();
+  cout << "S at 5.5 GHz:"; s.S(5.5*GHz).show();
+  cout << "C at 5.5 GHz:"; s.C(5.5*GHz).show();
+}
@@ -0,0 +1,101 @@
+// test_matview.cc
+// check the vector and matrix views: that they refer to the elements of
+// the matrices they view, in each index mode; that the operations and
+// solvers using them agree with those of matmath.h; and that writing
+// through them writes to the viewed matrix.
+
+#include "supermix.h"
+
+int main()
+{
+  // a complex Index_S x Index_1 matrix and a real Index_C matrix
+  Matrix U(2, 4, Index_S, Index_1);
+  for (int i = -2; i <= 2; ++i)
+    for (int j = 1; j <= 4; ++j)
+      U[i][j] = Complex(i + 0.1*j, j - 0.3*i*i);
+  real_matrix X(4, 4, Index_C);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      X[i][j] = 1.0/(i + j + 1) + (i == j);
+
+  // rows, columns and diagonals
+  int ok = 1;
+  for (int n = -2; n <= 2; ++n) {
+    complex_vector_view r = row_view(n, U);
+    Vector v = row(n, U);
+    ok = ok && r.mode == Index_1 && r.minindex() == 1 && r.maxindex() == 4;
+    for (int j = 1; j <= 4; ++j) ok = ok && r[j] == v[j];
+  }
+  for (int n = 1; n <= 4; ++n) {
+    complex_vector_view c = col_view(n, U);
+    Vector v = col(n, U);
+    ok = ok && c.mode == Index_S && c.minindex() == -2 && c.maxindex() == 2;
+    for (int i = -2; i <= 2; ++i) ok = ok && c[i] == v[i];
+  }
+  complex_vector_view d = diag_view(U);
+  ok = ok && d.mode == Index_1 && d.minindex() == 1 && d.maxindex() == 2
+    && d[1] == U[1][1] && d[2] == U[2][2];
+  ok = ok && row_view(3, U).is_empty() && col_view(0, U).is_empty();
+  cout << "rows, columns and diagonal: " << ok << endl;
+
+  // blocks, with the parent's indexes and reindexed
+  complex_matrix_view B = block_view(U, -1, 5, 2, 3);
+  ok = B.Lminindex() == -1 && B.Lmaxindex() == 2 && B.Rminindex() == 2
+    && B.Rmaxindex() == 3 && B[-1][2] == U[-1][2] && B.read(2,4) == 0.0;
+  complex_matrix_view C = block_view(U, -2, 1, 2, 4, Index_S, Index_C);
+  ok = ok && C.Lminindex() == -2 && C.Lmaxindex() == 1 && C.Rminindex() == 0
+    && C.Rmaxindex() == 2 && C[-2][0] == U[-2][2] && C[1][2] == U[1][4];
+  complex_vector_view c = col_view(1, block_view(C, -1, 0, 0, 2));
+  ok = ok && c.minindex() == -1 && c.maxindex() == 0 && c[0] == U[0][3];
+  complex_vector_view s = row_view(1, U).sub(2, 9);
+  ok = ok && s.minindex() == 2 && s.maxindex() == 4 && s[3] == U[1][3];
+  complex_vector_view sc = col_view(3, U).sub(-1, 1);
+  ok = ok && sc.minindex() == -1 && sc.maxindex() == 1 && sc[-1] == U[-1][3]
+    && sc[1] == U[1][3];
+  real_vector x(6, Index_C);   // indexes 0..5
+  for (int i = 0; i <= 5; ++i) x[i] = 10.0*i;
+  real_vector_view sx = real_vector_view(x).sub(2, 4);
+  ok = ok && sx.minindex() == 2 && sx.maxindex() == 4 && sx[2] == 20.0
+    && sx[3] == 30.0 && sx[4] == 40.0 && sx.sub(4, 7)[4] == 40.0;
+  cout << "blocks: " << ok << endl;
+
+  // arithmetic agrees with that of the vectors and matrices
+  Vector u = row(-1, U), v = col(2, U);
+  Vector w(4); w[1] = 1.0; w[2] = Complex(0,2); w[3] = -1.0; w[4] = 0.5;
+  ok = abs(row_view(-1, U) * w - u * w) < 1.0e-12
+    && abs(dot(col_view(2, U), col_view(3, U)) - dot(v, col(3, U))) < 1.0e-12
+    && fabs(norm(col_view(2, U)) - norm(v)) < 1.0e-12
+    && norm(complex_vector(block_view(U, -2, 2, 1, 4) * w) - U * w) < 1.0e-24;
+  Matrix XC = X;
+  complex_matrix_view P = block_view(XC, 0, 3, 0, 3, Index_1, Index_1);
+  ok = ok && norm(complex_matrix(U * P) - U * to_matrix(P)) < 1.0e-24;
+  real_matrix Y = to_matrix(block_view(X, 1, 2, 0, 3, Index_1, Index_1));
+  ok = ok && Y.Lmode == Index_1 && Y.Lmaxindex() == 2 && Y.Rmaxindex() == 4
+    && Y[2][4] == X[2][3];
+  cout << "arithmetic: " << ok << endl;
+
+  // writing through views
+  Matrix W = U;
+  row_view(0, W) = 2.0;
+  col_view(1, W) += col_view(2, W);
+  diag_view(W) *= Complex(0,1);
+  block_view(W, -2, -1, 3, 4, Index_S, Index_1) = block_view(U, 1, 2, 1, 2, Index_S, Index_1);
+  ok = W[0][3] == 2.0 && W[-2][1] == U[-2][1] + U[-2][2]
+    && W[1][1] == Complex(0,1)*(U[1][1] + U[1][2]) && W[2][2] == Complex(0,1)*U[2][2]
+    && W[-2][3] == U[1][1] && W[-1][4] == U[2][2] && W[-1][2] == U[-1][2];
+  cout << "writing: " << ok << endl;
+
+  // solving straight into a column of a matrix
+  real_matrix Z(4, 3, Index_C, Index_1);
+  real_vector b(4, Index_C);
+  for (int i = 0; i < 4; ++i) b[i] = i + 1.0;
+  ok = solve(col_view(2, Z), X, b) && norm(X * real_vector(col(2, Z)) - b) < 1.0e-24
+    && Z[0][1] == 0.0 && Z[3][3] == 0.0;
+  ok = ok && norm(solve(block_view(X, 0, 3, 0, 3), b) - solve(X, b)) < 1.0e-24;
+  real_matrix Xi(4, Index_C);
+  ok = ok && solve(Xi, X, identity_matrix(4, Index_C))
+    && norm(Xi - inverse(X)) < 1.0e-24 && ! solve(col_view(1, Z), X, real_vector(3, Index_C));
+  cout << "solving: " << ok << endl;
+
+  return 0;
+}
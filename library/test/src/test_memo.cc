@@ -0,0 +1,102 @@
+// test_memo.cc
+// check that a memo_nport returns the same results as the device it
+// remembers, recalculating only when the operating state is new.
+
+#include "supermix.h"
+
+// the largest difference between two sdata
+double diff(const sdata & a, const sdata & b, bool noise = true)
+{
+  double d = 0.0;
+  for(int i = 1; i <= a.size(); ++i) {
+    d = max(d, abs(a.B[i] - b.B[i]));
+    for(int j = 1; j <= a.size(); ++j) {
+      d = max(d, abs(a.S[i][j] - b.S[i][j]));
+      if(noise) d = max(d, abs(a.C[i][j] - b.C[i][j]));
+    }
+  }
+  return d;
+}
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 5*GHz;
+
+  // a subcircuit which depends on the parameters R and L
+  parameter R = 40*Ohm, L = 1*nHenry;
+  resistor r; r.series(); r.R = &R;
+  inductor l; l.parallel(); l.L = &L;
+  capacitor c; c.parallel(); c.C = 0.2*pFarad;
+  trline t; t.set_theta(Pi/4).set_freq(5*GHz).set_zchar(30*Ohm).set_loss(0.1);
+  cascade sub;
+  sub.add(r).add(l).add(t).add(c);
+
+  memo_nport m(sub, 6);
+  m.depends_on(R).depends_on(L);
+
+  // the outer circuit, which also depends on Cout
+  parameter Cout = 0.1*pFarad;
+  capacitor out; out.series(); out.C = &Cout;
+  circuit plain, memo;
+  plain.connect(sub, 2, out, 1);
+  plain.add_port(sub, 1);
+  plain.add_port(out, 2);
+  memo.connect(m, 2, out, 1);
+  memo.add_port(m, 1);
+  memo.add_port(out, 2);
+
+  // a "line search" over Cout at a few frequencies, revisiting R and L
+  double d = 0.0;
+  double Rs[] = { 40, 50, 40, 50 };
+  for(int pass = 0; pass < 4; ++pass) {
+    R = Rs[pass]*Ohm;
+    for(int k = 0; k < 3; ++k) {
+      Cout = (0.1 + 0.05*k)*pFarad;
+      device::f = (4 + k)*GHz;
+      sdata a = plain.get_data();
+      d = max(d, diff(a, memo.get_data()));
+      d = max(d, diff(a, memo.get_data_S(), false));
+    }
+  }
+  cout << "memo results match: " << (d == 0.0) << endl;
+  cout << "entries: " << m.entries() << " (capacity " << m.capacity() << ")" << endl;
+  cout << "hits: " << m.hits() << ", misses: " << m.misses() << endl;
+
+  // reducing the capacity discards the least recently used results
+  m.capacity(2);
+  R = 50*Ohm;
+  device::f = 6*GHz;
+  m.get_data();
+  device::f = 4*GHz;
+  m.get_data();
+  cout << "entries: " << m.entries() << " (capacity " << m.capacity()
+       << "), hits: " << m.hits() << ", misses: " << m.misses() << endl;
+
+  // results calculated without noise are recalculated with it when needed
+  m.clear();
+  device::f = 9*GHz;
+  m.get_data_S();
+  sdata a = sub.get_data();
+  cout << "S-only entry upgraded: " << (diff(a, m.get_data()) == 0.0)
+       << " (misses: " << m.misses() << ")" << endl;
+
+  // the key includes T and Z0
+  m.clear();
+  m.get_data();
+  device::T = 300*Kelvin;
+  a = sub.get_data();
+  cout << "new T recalculates: " << (diff(a, m.get_data()) == 0.0)
+       << " (misses: " << m.misses() << ")" << endl;
+  device::Z0 = 25*Ohm;
+  a = sub.get_data();
+  cout << "new Z0 recalculates: " << (diff(a, m.get_data()) == 0.0)
+       << " (misses: " << m.misses() << ")" << endl;
+
+  // capacity 0 just passes results through
+  m.capacity(0);
+  cout << "capacity 0: entries " << m.entries() << ", matches "
+       << (diff(sub.get_data(), m.get_data()) == 0.0) << endl;
+
+  return 0;
+}
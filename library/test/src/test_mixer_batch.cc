@@ -0,0 +1,124 @@
+// test_mixer_batch.cc
+// check that a mixer_batch balances a mixer over a grid of operating
+// points on several threads, giving the same results, in the same order,
+// as balancing one point at a time.
+
+#include "supermix.h"
+
+// a two junction mixer like that of test_mixer_speed; the operating point
+// is (LO voltage, bias voltage of junction 1)
+class two_junctions : public mixer_model
+{
+public:
+  two_junctions() :
+    iv("iv.dat", "ikk.dat"), R1(50*Ohm), R2(100*Ohm), b(3)
+  {
+    Rn = 10*Ohm; Vn = 3*mVolt; Cap = 0;
+    LO = 0.5*Vn*VoltToFreq;
+
+    Rf.connect(R1,1,b,1); Rf.connect(R2,1,b,2);
+    Rf.add_port(R1,2); Rf.add_port(R2,2); Rf.add_port(b,3);
+    If.connect(R1,1,b,1); If.connect(R2,1,b,2);
+    If.add_port(R1,2); If.add_port(R2,2); If.add_port(b,3);
+
+    j1.set_iv(iv); j1.Rn = &Rn; j1.Vn = &Vn; j1.Cap = &Cap;
+    j2.set_iv(iv); j2.Rn = &Rn; j2.Vn = &Vn; j2.Cap = &Cap;
+    j1_bias.source_voltage = Vn/2;
+    j2_bias.source_voltage = Vn/3;
+    bias.add_port(j1_bias, 1);
+    bias.add_port(j2_bias, 1);
+
+    LO_source.source_f = &LO;
+    LO_source.source_width = 1*GHz;
+
+    m.harmonics(3);
+    m.set_rf(Rf).set_if(If).set_LO(&LO);
+    m.add_junction(j1).add_junction(j2).set_bias(bias);
+    m.set_balance_terminator(LO_source, 3);
+  }
+
+  mixer_model * build() const { return new two_junctions; }
+  mixer & get_mixer() { return m; }
+  void set(const real_vector & x)
+  {
+    LO_source.source_voltage = x[1]*Vn/RmsToPeak;
+    j1_bias.source_voltage = x[2]*Vn;
+  }
+
+private:
+  ivcurve iv;
+  parameter LO, Rn, Vn, Cap;
+  resistor R1, R2;
+  branch b;
+  circuit Rf, If, bias;
+  sis_basic_device j1, j2;
+  voltage_source j1_bias, j2_bias, LO_source;
+  mixer m;
+};
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 10*GHz;
+
+  // the grid of points, added in an order which isn't the snake order
+  two_junctions model;
+  mixer_batch batch(model);
+  real_vector x(2);
+  for(int b = 0; b < 8; ++b)
+    for(int l = 0; l < 3; ++l) {
+      x[1] = 0.3 + 0.1*l;
+      x[2] = 0.35 + 0.05*b;
+      batch.add(x);
+    }
+  int n = batch.points();
+  cout << "points: " << n << endl;
+
+  int failed = batch.threads(4).run();
+  cout << "all balanced: " << (failed == 0) << endl;
+
+  // balance each point on its own, from a fresh state
+  two_junctions serial;
+  mixer & m = serial.get_mixer();
+  m.initialize_mode(1);
+  double ds = 0.0, dv = 0.0;
+  int warm = 0, cold = 0;
+  for(int k = 0, b = 0; b < 8; ++b)
+    for(int l = 0; l < 3; ++l, ++k) {
+      x[1] = 0.3 + 0.1*l;
+      x[2] = 0.35 + 0.05*b;
+      serial.set(x);
+      m.balance();
+      cold += m.balance_iterations();
+      const sdata & sd = m.get_data();
+      for(int i = 1; i <= sd.size(); ++i)
+	for(int j = 1; j <= sd.size(); ++j)
+	  ds = max(ds, abs(sd.S[i][j] - batch[k].data.S[i][j]));
+      Matrix V;
+      m.save_operating_state(V);
+      for(int i = 0; i <= V.Lmaxindex(); ++i)
+	for(int j = 0; j <= V.Rmaxindex(); ++j)
+	  dv = max(dv, abs(V[i][j] - batch[k].state[i][j]));
+      if(batch[k].warm) ++warm;
+    }
+  cout << "same small signal results as serial: " << (ds < 1.0e-5) << endl;
+  cout << "same junction states as serial: " << (dv < 1.0e-5*mVolt) << endl;
+  cout << "some points warm started: " << (warm > 0) << endl;
+
+  // on one thread, every point after the first follows the one before
+  batch.threads(1).run();
+  warm = 0;
+  int it1 = 0;
+  for(int k = 0; k < n; ++k) {
+    if(batch[k].warm) ++warm;
+    it1 += batch[k].iterations;
+  }
+  cout << "one thread: all but one warm started: " << (warm == n - 1) << endl;
+  cout << "warm starts save iterations: " << (it1 < cold) << endl;
+
+  // without the small signal analysis
+  batch.small_signal(false).run();
+  cout << "balance only: " << (batch[0].data.size() == 0 && batch[0].status == 0) << endl;
+
+  return 0;
+}
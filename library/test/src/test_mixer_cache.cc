@@ -0,0 +1,111 @@
+// test_mixer_cache.cc
+// check that a mixer with its embedding caches on gives the same results
+// as an identical mixer without, with junctions and circuits of its own,
+// while calculating its linear circuits only once per frequency during a
+// bias sweep.
+
+#include "supermix.h"
+
+parameter LO, IF;
+parameter Zline = 20*Ohm;
+parameter Rn = 10*Ohm, Vn = 3*mVolt, Cap = 0;
+
+// a two junction mixer like that of test_mixer_speed, with some
+// transmission line in the RF circuit; everything it uses is its own
+struct test_mixer {
+  resistor R1, R2;
+  trline t1, t2;
+  branch b;
+  circuit Rf, If, bias;
+  sis_basic_device j1, j2;
+  voltage_source j1_bias, j2_bias, LO_source;
+  mixer m;
+
+  test_mixer(ivcurve & iv) : R1(50*Ohm), R2(100*Ohm), b(3)
+  {
+    t1.set_theta(Pi/4).set_freq(500*GHz).set_zchar(30*Ohm);
+    t2.set_theta(Pi/3).set_freq(500*GHz);
+    t2.zchar = &Zline;
+    Rf.connect(R1,1,b,1); Rf.connect(R2,1,t1,1); Rf.connect(t1,2,b,2);
+    Rf.add_port(R1,2); Rf.add_port(R2,2); Rf.connect(b,3,t2,1); Rf.add_port(t2,2);
+    If.connect(R1,1,b,1); If.connect(R2,1,b,2);
+    If.add_port(R1,2); If.add_port(R2,2); If.add_port(b,3);
+
+    j1.set_iv(iv); j1.Rn = &Rn; j1.Vn = &Vn; j1.Cap = &Cap;
+    j2.set_iv(iv); j2.Rn = &Rn; j2.Vn = &Vn; j2.Cap = &Cap;
+
+    j2_bias.source_voltage = Vn/3;
+    bias.add_port(j1_bias, 1);
+    bias.add_port(j2_bias, 1);
+
+    LO_source.source_f = &LO;
+    LO_source.source_width = 1*GHz;
+    LO_source.source_voltage = 0.5*Vn/RmsToPeak;
+
+    m.harmonics(3);
+    m.set_rf(Rf).set_if(If).set_LO(&LO);
+    m.add_junction(j1).add_junction(j2).set_bias(bias);
+    m.set_balance_terminator(LO_source, 3);
+  }
+};
+
+// balance each mixer and compare their operating states and small signal
+// responses, returning the largest difference
+double compare(test_mixer & p, test_mixer & c)
+{
+  p.m.balance();
+  sdata a = p.m.get_data();
+  c.m.balance();
+  const sdata & b = c.m.get_data();
+  double d = 0.0;
+  for(int i = 1; i <= a.size(); ++i)
+    for(int j = 1; j <= a.size(); ++j)
+      d = max(d, max(abs(a.S[i][j] - b.S[i][j]), abs(a.C[i][j] - b.C[i][j])));
+  for(int h = 0; h <= 3; ++h)
+    for(int k = 1; k <= 2; ++k)
+      d = max(d, abs(p.m.V_junc(h)[k] - c.m.V_junc(h)[k]));
+  return d;
+}
+
+int main()
+{
+  device::f = &IF;
+  device::T = 4*Kelvin;
+  LO = 0.5*Vn*VoltToFreq;
+  IF = 5*GHz;
+
+  ivcurve iv("iv.dat","ikk.dat");
+  test_mixer plain(iv), cached(iv);
+  cached.m.cache_embedding(100).embedding_depends_on(Zline);
+
+  // a bias sweep; the bias voltages must reach the cached mixer
+  double d = 0.0, dc = 0.0, V0 = 0.0;
+  int nbias = 10;
+  for(int k = 0; k < nbias; ++k) {
+    plain.j1_bias.source_voltage = cached.j1_bias.source_voltage = (0.3 + 0.04*k)*Vn;
+    d = max(d, compare(plain, cached));
+    double V = cached.m.V_junc(0)[1].real;
+    if (k > 0) dc = max(dc, fabs(V - V0));
+    V0 = V;
+  }
+  cout << "same results: " << (d < 1e-12)
+       << ", bias followed: " << (dc > 0.01*Vn) << endl;
+
+  // the RF circuit at 3 harmonics and 6 sidebands, and the IF circuit at
+  // IF; calculated once each
+  cout << "calculated once per frequency: " << (cached.m.embedding_misses() == 10UL) << endl;
+  cout << "found in the cache otherwise: " << (cached.m.embedding_hits() == 10UL*(nbias-1)) << endl;
+
+  // a parameter the cache depends on
+  Zline = 25*Ohm;
+  d = compare(plain, cached);
+  cout << "dependency changed: " << (d < 1e-12)
+       << ", recalculated: " << (cached.m.embedding_misses() == 2*10UL) << endl;
+
+  // turned off
+  cached.m.cache_embedding(0);
+  cached.m.get_data();
+  cout << "turned off: " << (cached.m.embedding_hits() + cached.m.embedding_misses() == 0) << endl;
+
+  return 0;
+}
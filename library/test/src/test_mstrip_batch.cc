@@ -0,0 +1,111 @@
+// test_mstrip_batch.cc
+// check microstrip::Kprop_Zchar() against separate microstrips, and
+// radial_stub against a circuit of microstrip sections.
+
+#include "supermix.h"
+#include <vector>
+
+// max magnitude of the difference between the elements of two matrices
+double diff(const Matrix & A, const Matrix & B)
+{
+  double d = 0.0;
+  for(int i = 1; i <= A.Lmaxindex(); ++i)
+    for(int j = 1; j <= A.Rmaxindex(); ++j)
+      if(abs(A.read(i,j) - B.read(i,j)) > d) d = abs(A.read(i,j) - B.read(i,j));
+  return d;
+}
+
+int main(void)
+{
+  device::T = 4.2 * Kelvin;
+
+  super_film nb;
+  nb.Vgap = 2.9*mVolt;
+  nb.Tc = 9.2*Kelvin;
+  nb.rho_normal = 5.*Micro*Ohm*Centi*Meter;
+  nb.Thick = 3000.*Angstrom;
+
+  super_film nbtin;
+  nbtin.Vgap = 5.0*mVolt;
+  nbtin.Tc = 15.75*Kelvin;
+  nbtin.rho_normal = 30.*Micro*Ohm*Centi*Meter;
+  nbtin.Thick = 3000.*Angstrom;
+
+  const_diel vacuum;
+  const_diel sio(5.6, 0.001);
+
+  // Kprop_Zchar() compared with a microstrip for each width
+  const int n = 8;
+  double w[n];
+  microstrip batch, single[n];
+  batch.substrate(sio).superstrate(vacuum).top_strip(nb).ground_plane(nbtin);
+  batch.sub_thick = 4500.*Angstrom;
+  for(int i = 0; i < n; ++i) {
+    w[i] = (1.0 + 2.5*i)*Micron;
+    single[i].substrate(sio).superstrate(vacuum).top_strip(nb).ground_plane(nbtin);
+    single[i].sub_thick = 4500.*Angstrom;
+    single[i].width = w[i];
+  }
+  Complex k[n], z[n];
+  double maxdiff = 0.0;
+  for(double f = 100.0; f <= 1000.0; f += 50.0) {
+    batch.Kprop_Zchar(n, w, f*GHz, device::T, k, z);
+    for(int i = 0; i < n; ++i) {
+      double d = abs(k[i] - single[i].Kprop(f*GHz, device::T))/abs(k[i])
+	+ abs(z[i] - single[i].Zchar(f*GHz, device::T))/abs(z[i]);
+      if(d > maxdiff) maxdiff = d;
+    }
+  }
+  cout << "Kprop_Zchar(): max difference < 1e-14: " << (maxdiff < 1e-14) << endl;
+
+  // the microstrip's own width still works after Kprop_Zchar()
+  batch.width = 5.0*Micron;
+  single[0].width = 5.0*Micron;
+  cout << "Zchar() after Kprop_Zchar(): "
+       << (batch.Zchar(600*GHz, device::T) == single[0].Zchar(600*GHz, device::T))
+       << endl;
+
+  // radial_stub compared with the equivalent circuit of microstrips
+  radial_stub r;
+  r.substrate(sio).superstrate(vacuum).top_strip(nb).ground_plane(nbtin);
+  r.radius = 36 * Micron;
+  r.angle = 90. * Degree;
+  r.width = 5.8 * Micron;
+  r.length = 3.3 * Micron;
+  r.sub_thick = 4500. * Angstrom;
+
+  int sections[] = { 1, 15, 60 };
+  for(int s = 0; s < 3; ++s) {
+    int m = sections[s];
+    r.sections(m);
+    std::vector<microstrip> sec(m+1);
+    circuit c;
+    double r0 = r.width / sqrt(2. * r.angle * tan(0.5*r.angle));
+    double len = (r.radius - r0)/m;
+    for(int i = 0; i <= m; ++i) {
+      sec[i].substrate(sio).superstrate(vacuum).top_strip(nb).ground_plane(nbtin);
+      sec[i].sub_thick = 4500. * Angstrom;
+      sec[i].width  = (i == 0) ? r.width.get() : r.angle * (r0 + (i-0.5)*len);
+      sec[i].length = (i == 0) ? r.length.get() : len;
+    }
+    for(int i = 0; i < m; ++i)
+      c.connect(sec[i], 2, sec[i+1], 1);
+    c.add_port(sec[0], 1);
+    c.add_port(sec[m], 2);
+
+    double maxS = 0.0, maxC = 0.0;
+    for(double f = 50.0; f <= 1000.0; f += 25.0) {
+      device::f = f*GHz;
+      sdata a = r.get_data(), b = c.get_data();
+      if(diff(a.S, b.S) > maxS) maxS = diff(a.S, b.S);
+      if(diff(a.C, b.C) > maxC) maxC = diff(a.C, b.C);
+    }
+    cout << "sections(): " << r.sections() << " S max difference < 1e-10: " << (maxS < 1e-10)
+	 << " C max difference < 1e-10: " << (maxC < 1e-10) << endl;
+  }
+
+  // the input line may have length 0
+  r.length = 0.0;
+  device::f = 600.0*GHz;
+  cout << "no input line:" << endl << r.get_data().S << endl;
+}
@@ -0,0 +1,96 @@
+// test_multitone.cc
+// check the multitone harmonic balance: with the LO alone it must agree
+// with mixer::balance(); with a weak signal added, the IF product must
+// give the conversion gain found by the mixer's small signal analysis;
+// the products must grow as the right powers of the signal amplitude;
+// and a strong signal must compress the gain.
+
+#include "supermix.h"
+
+int main()
+{
+  parameter LO, RF, IF, P_LO = 20*Nano*Watt, P_RF = 0;
+  device::f = &IF;
+  device::T = 4*Kelvin;
+  LO = 300*GHz; RF = 305*GHz; IF = 5*GHz;
+
+  // one junction, with the LO through a transmission line and the signal
+  // weakly coupled through a resistor; the IF load is connected directly
+  trline t;
+  t.set_theta(Pi/3).set_freq(500*GHz).set_zchar(20*Ohm);
+  resistor R(200*Ohm);
+  branch b(3);
+  circuit Rf;
+  Rf.add_port(b,1); Rf.connect(b,2,t,1); Rf.add_port(t,2);
+  Rf.connect(b,3,R,1); Rf.add_port(R,2);
+  branch bi(2);
+  circuit If;
+  If.add_port(bi,1); If.add_port(bi,2);
+
+  ivcurve iv("iv.dat","ikk.dat");
+  parameter Rn = 10*Ohm, Vn = 3*mVolt, Cap = 20*fFarad;
+  sis_basic_device sis;
+  sis.set_iv(iv); sis.Rn = &Rn; sis.Vn = &Vn; sis.Cap = &Cap;
+
+  voltage_source vb;
+  vb.source_voltage = 0.6*Vn;
+  vb.R = 2*Ohm;
+  circuit bias;
+  bias.add_port(vb, 1);
+
+  generator LO_source, RF_source;
+  LO_source.source_f = &LO;
+  LO_source.source_width = 1*GHz;
+  LO_source.source_power = &P_LO;
+  RF_source.source_f = &RF;
+  RF_source.source_width = 1*GHz;
+  RF_source.source_power = &P_RF;
+
+  mixer mix;
+  mix.harmonics(3);
+  mix.set_rf(Rf).set_if(If).set_LO(&LO).add_junction(sis).set_bias(bias);
+  mix.set_balance_terminator(LO_source, 2);
+  mix.balance();
+  Vector V_mix[4];
+  for (int h = 0; h <= 3; ++h) V_mix[h] = mix.V_junc(h);
+  double G_mix = norm(mix.get_data().S[mix.port(2,0)][mix.port(3,1)]);
+
+  multitone m;
+  m.add_tone(&LO, 3).add_tone(&RF, 2);
+  m.add_junction(sis).set_bias(bias).set_rf(Rf).set_if(If, 50*GHz);
+  m.set_balance_terminator(LO_source, 2).set_balance_terminator(RF_source, 3);
+  m.balance_parameters(100, 1.0e-12, 1.0e-14, 1.0e-10, 1.0e-4);
+
+  // the LO alone
+  int ok = (m.balance() == 0);
+  double d = 0.0;
+  for (int h = 0; h <= 3; ++h)
+    d = max(d, abs(m.V_junc(m.product(h))[1] - V_mix[h][1]));
+  cout << "products: " << m.products()
+       << ", same as mixer balance: " << (ok && d < 1.0e-5*abs(V_mix[1][1])) << endl;
+
+  // a weak signal: the conversion gain into the Z0 IF load
+  int k_if = m.product(-1, 1), k_2if = m.product(-2, 2);
+  P_RF = 1.0e-3*Nano*Watt;
+  ok = (m.balance() == 0);
+  Complex V_if = m.V_junc(k_if)[1], V_2if = m.V_junc(k_2if)[1];
+  double G = norm(V_if)/device::Z0/P_RF;
+  cout << "IF frequency: " << m.freq(k_if)/GHz
+       << ", same gain as small signal: " << (ok && fabs(G - G_mix) < 1.0e-3*G_mix) << endl;
+
+  // the IF grows as the signal amplitude, and the 2*IF product as its square
+  P_RF = 4.0e-3*Nano*Watt;
+  m.balance();
+  cout << "IF product linear: "
+       << (abs(m.V_junc(k_if)[1]/V_if - 2.0) < 1.0e-4)
+       << ", 2*IF product quadratic: "
+       << (abs(m.V_junc(k_2if)[1]/V_2if - 4.0) < 1.0e-3) << endl;
+
+  // a strong signal compresses the gain
+  P_RF = 50*Nano*Watt;
+  ok = (m.balance() == 0);
+  double G_strong = norm(m.V_junc(k_if)[1])/device::Z0/P_RF;
+  cout << "compressed: " << (ok && G_strong < 0.99*G) << endl;
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+// test_param_program.cc
+// check that a parameter_program gives the same values as get() for
+// chains of shadowed, bounded, scaled, interpolated and function
+// parameters, and that it recalculates only when something has changed.
+
+#include "supermix.h"
+#include "real_interp.h"
+#include "parameter/scaled_real_parameter.h"
+#include "parameter/function_real_parameter.h"
+
+double sum(real_parameter * p) { return p[0] + p[1]; }
+
+int main()
+{
+  parameter a = 2.0, b = 5.0;
+
+  parameter c(&a);              // a shadow with bounds
+  c.set_min(0.0).set_max(3.0);
+  scaled_real_parameter d(4.0, c);
+  parameter e(&d);              // shadows a shadow
+  scaled_real_parameter g(0.5, e);
+
+  real_interp h(b);             // an interpolation in b
+  h.add(0.0, 1.0).add(10.0, 21.0).build();
+
+  parameter pars[2] = { 1.0, 2.0 };
+  pars[1] = &b;
+  function_real_parameter fn(sum, pars);
+
+  parameter_program prog;
+  const abstract_real_parameter * p[] = { &c, &d, &e, &g, &h, &fn, &a };
+  const int n = sizeof(p)/sizeof(p[0]);
+  for(int i = 0; i < n; ++i) prog.add(*p[i]);
+
+  parameter target = 7.0;
+  prog.bind(target, g);
+
+  // compare all of the values with get()
+  bool ok = true;
+#define CHECK(label) \
+  { bool m = (target == g.get()); \
+    for(int i = 0; i < n; ++i) m = m && (prog[i] == p[i]->get()); \
+    cout << label << ": values match: " << m << endl; ok = ok && m; }
+
+  cout << "steps: " << prog.steps() << endl;
+  prog.run();
+  CHECK("initial");
+
+  a = 0.5;
+  prog.run();
+  CHECK("after a changed");
+
+  a = 10.0;   // now beyond c's maximum
+  b = 7.5;
+  prog.run();
+  CHECK("after a and b changed");
+
+  c.set_max(20.0);
+  prog.run();
+  CHECK("after c's bound changed");
+
+  e = &b;     // different shadowing
+  prog.run();
+  CHECK("after e shadows b");
+
+  e = 1.25;   // stop shadowing
+  prog.run();
+  CHECK("after e made local");
+
+  // without function or interpolated parameters, a run with no changes
+  // does nothing
+  parameter_program p2;
+  p2.add(g);
+  p2.add(d);
+  p2.run();
+  bool again = p2.run();
+  a = 3.0;
+  bool changed = p2.run();
+  cout << "steps: " << p2.steps() << "; runs without change: " << !again
+       << ", with change: " << changed << endl;
+  cout << "values match: " << (p2[0] == g.get() && p2[1] == d.get()) << endl;
+
+  return ok ? 0 : 1;
+}
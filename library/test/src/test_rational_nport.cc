@@ -0,0 +1,95 @@
+// test_rational_nport.cc
+// check that a rational_nport fits lumped networks exactly, fits
+// distributed networks and Touchstone data closely with stable poles,
+// and can stand in for the network it models.
+
+#include "supermix.h"
+
+// the largest difference between the S matrices of two nports over a
+// range of frequencies which don't coincide with the samples
+double compare(nport & a, nport & b, double f1, double f2)
+{
+  parameter old_f(device::f);
+  double d = 0.0;
+  for(double f = f1; f <= f2; f += 0.0937*GHz) {
+    device::f = f;
+    sdata sa = a.get_data(), sb = b.get_data();
+    for(int i = 1; i <= sa.size(); ++i)
+      for(int j = 1; j <= sa.size(); ++j)
+	d = max(d, abs(sa.S[i][j] - sb.S[i][j]));
+  }
+  device::f = old_f;
+  return d;
+}
+
+bool stable(const rational_nport & r)
+{
+  bool ok = true;
+  for(int k = 0; k < r.poles(); ++k) ok = ok && (r.pole(k).real < 0.0);
+  return ok;
+}
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 5*GHz;
+
+  // a lumped lowpass ladder, with 5 reactive elements
+  inductor l1, l2, l3;  l1.series(); l2.series(); l3.series();
+  l1.L = 2*nHenry; l2.L = 3*nHenry; l3.L = 1.5*nHenry;
+  capacitor c1, c2;  c1.parallel(); c2.parallel();
+  c1.C = 1*pFarad; c2.C = 0.8*pFarad;
+  resistor r; r.series(); r.R = 5*Ohm;
+  cascade ladder;
+  ladder.add(l1).add(c1).add(l2).add(r).add(c2).add(l3);
+
+  rational_nport lm(2);
+  sweeper band;
+  band.sweep(device::f, 0.5, 10.0, 0.25, GHz);
+  lm.sample(ladder, band);
+  lm.fit(5);
+  cout << "lumped: samples " << lm.samples() << ", poles " << lm.poles()
+       << ", stable: " << stable(lm) << endl;
+  cout << "lumped: fit error < 1e-10: " << (lm.fit_error() < 1e-10)
+       << ", between samples: " << (compare(ladder, lm, 0.6*GHz, 10*GHz) < 1e-10) << endl;
+  cout << "lumped: passive: " << (lm.passivity() < 1.0 + 1e-9) << endl;
+
+  // the model is renormalized like any other nport
+  parameter old_Z0(device::Z0);
+  device::Z0 = 25*Ohm;
+  cout << "lumped: renormalized: " << (compare(ladder, lm, 0.6*GHz, 10*GHz) < 1e-10) << endl;
+  device::Z0 = old_Z0;
+
+  // a network with transmission lines needs more poles
+  trline t1; t1.set_theta(Pi/2).set_freq(5*GHz).set_zchar(70*Ohm).set_loss(0.01);
+  trline t2; t2.set_theta(Pi/3).set_freq(5*GHz).set_zchar(30*Ohm).set_loss(0.01);
+  cascade dist;
+  dist.add(t1).add(c1).add(t2).add(l2);
+
+  rational_nport dm(2);
+  sweeper wide;
+  wide.sweep(device::f, 0.1, 20.0, 0.1, GHz);
+  dm.sample(dist, wide);
+  dm.fit(16);
+  cout << "distributed: poles " << dm.poles() << ", stable: " << stable(dm) << endl;
+  cout << "distributed: fit error < 1e-4: " << (dm.fit_error() < 1e-4)
+       << ", between samples < 1e-3: " << (compare(dist, dm, 0.15*GHz, 19.9*GHz) < 1e-3) << endl;
+  dm.enforce_passivity();
+  cout << "distributed: passive: " << (dm.passivity() <= 1.0) << endl;
+
+  // standing in for the network within a circuit
+  resistor load; load.parallel(); load.R = 80*Ohm;
+  cascade with_net, with_model;
+  with_net.add(dist).add(load);
+  with_model.add(dm).add(load);
+  cout << "in a circuit: " << (compare(with_net, with_model, 1*GHz, 19*GHz) < 1e-3) << endl;
+
+  // from Touchstone data of an amplifier
+  rational_nport am(2);
+  am.touchstone("fhx13x");
+  am.fit(4);
+  cout << "touchstone: samples " << am.samples() << ", poles " << am.poles()
+       << ", stable: " << stable(am) << ", fit error < 0.01: " << (am.fit_error() < 0.01) << endl;
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+// test_simd.cc
+// check that each SIMD kernel set of the Complex array routines (see
+// Amath.h) that the processor supports gives the same results as the
+// scalar set: exactly, except for the dot products, for all lengths
+// including those leaving partial vectors at the end; and that the
+// vector operations using them agree with element-by-element results.
+
+#include "supermix.h"
+#include "Amath.h"
+#include <cstdlib>
+
+static const int N = 37;
+
+static void fill(Complex * a, int n)
+{
+  for (int i = 0; i < n; ++i)
+    a[i] = Complex(rand()/(RAND_MAX + 1.0) - 0.5, rand()/(RAND_MAX + 1.0) - 0.5);
+}
+
+static int same(const Complex * a, const Complex * b, int n)
+{
+  for (int i = 0; i < n; ++i)
+    if (a[i].real != b[i].real || a[i].imaginary != b[i].imaginary) return 0;
+  return 1;
+}
+
+int main()
+{
+  const char * sets[] = { "sse2", "avx2", "avx512" };
+  Complex x[N], y[N], d[N];
+  srand(1);
+  fill(x, N); fill(y, N);
+  Complex f(0.3, -0.7);
+
+  int ok_add = 1, ok_mul = 1, ok_div = 1, ok_scale = 1, ok_sub = 1, ok_dot = 1;
+  for (int k = 0; k < 3; ++k) {
+    for (int n = 0; n <= N; ++n) {
+      // the scalar results
+      Asimd("scalar");
+      Complex r_add[N], r_sub[N], r_mul[N], r_div[N], r_scale[N], r_ssub[N], r_axpy[N];
+      Acopy(r_add, x, n); Aadd(r_add, y, n);
+      Acopy(r_sub, x, n); Asub(r_sub, y, n);
+      Acopy(r_mul, x, n); Amul(r_mul, y, n);
+      Acopy(r_div, x, n); Adiv(r_div, y, n);
+      Acopy(r_scale, x, n); Ascale(r_scale, f, n);
+      Acopy(r_ssub, x, n); Ascalesub(r_ssub, y, f, n);
+      Acopy(r_axpy, x, n); Aaxpy(r_axpy, y, f, n);
+      Complex r_dot = Adot(x, y, n), r_dotu = Adotu(x, y, n);
+
+      if ( ! Asimd(sets[k])) break;  // not supported here
+      Acopy(d, x, n); Aadd(d, y, n); ok_add = ok_add && same(d, r_add, n);
+      Acopy(d, x, n); Asub(d, y, n); ok_sub = ok_sub && same(d, r_sub, n);
+      Acopy(d, x, n); Amul(d, y, n); ok_mul = ok_mul && same(d, r_mul, n);
+      Acopy(d, x, n); Adiv(d, y, n); ok_div = ok_div && same(d, r_div, n);
+      Acopy(d, x, n); Ascale(d, f, n); ok_scale = ok_scale && same(d, r_scale, n);
+      Acopy(d, x, n); Ascalesub(d, y, f, n); ok_sub = ok_sub && same(d, r_ssub, n);
+      Acopy(d, x, n); Aaxpy(d, y, f, n); ok_add = ok_add && same(d, r_axpy, n);
+      ok_dot = ok_dot && abs(Adot(x, y, n) - r_dot) < 1.0e-14*(n + 1)
+	&& abs(Adotu(x, y, n) - r_dotu) < 1.0e-14*(n + 1);
+    }
+  }
+  cout << "add and axpy: " << ok_add << ", subtract: " << ok_sub
+       << ", multiply: " << ok_mul << ", divide: " << ok_div
+       << ", scale: " << ok_scale << ", dot products: " << ok_dot << endl;
+
+  // the vector operations, with the widest kernels
+  Asimd("scalar");
+  const char * best = "scalar";
+  for (int k = 0; k < 3; ++k) if (Asimd(sets[k])) best = sets[k];
+  Asimd(best);
+
+  // u has indexes 0..N-1, v -M..M, so they overlap in M+1 >= Adot_simd_min
+  // elements; a short product checks the scalar path
+  const int M = N/2;
+  Vector u(N, Index_C), v(M, Index_S);
+  for (int i = u.minindex(); i <= u.maxindex(); ++i) u[i] = x[i];
+  for (int i = v.minindex(); i <= v.maxindex(); ++i) v[i] = y[i + M];
+  Vector m = scalemult(u, v), q = scalediv(u, v), s = u; s += v;
+  int ok = 1;
+  Complex dot_uv = 0.0, prod_uv = 0.0;
+  for (int i = -M; i < N; ++i) {
+    ok = ok && m.read(i) == u.read(i)*v.read(i);
+    if (i >= s.minindex())
+      ok = ok && s.read(i) == u.read(i) + v.read(i);
+    if (i >= 0 && i <= M) {
+      ok = ok && q[i] == u[i]/v[i];
+      dot_uv += conj(u[i])*v[i]; prod_uv += u[i]*v[i];
+    }
+  }
+  Vector w(3, Index_S);
+  for (int i = -3; i <= 3; ++i) w[i] = y[i + 3];
+  Complex dot_uw = 0.0, prod_uw = 0.0;
+  for (int i = 0; i <= 3; ++i) { dot_uw += conj(u[i])*w[i]; prod_uw += u[i]*w[i]; }
+  cout << "vector operations: " << ok
+       << ", vector dot products: "
+       << (abs(dot(u, v) - dot_uv) < 1.0e-13 && abs(u*v - prod_uv) < 1.0e-13)
+       << ", short ones exact: " << (dot(u, w) == dot_uw && u*w == prod_uw) << endl;
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+// test_simd_speed
+// time the Complex array routines of Amath.h with each SIMD kernel set
+// the processor supports, over a range of array lengths
+
+
+#include "supermix.h"
+#include "Amath.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace std;
+
+// nanoseconds per element of one call of f(), repeated over n elements
+template <class F>
+static double timed(F f, int iter, int n)
+{
+  auto t0 = chrono::steady_clock::now();
+  for (int i = 0; i < iter; ++i) f();
+  auto t1 = chrono::steady_clock::now();
+  return chrono::duration<double, nano>(t1 - t0).count() / (double(iter) * n);
+}
+
+int main(int argc, char** argv)
+{
+  // get total elements per test from the command line
+  if (argc != 2) {
+    cout << "Usage: " << argv[0] << " <elements>\n"
+	 << "where the argument gives the number of array elements processed\n"
+	 << "by each routine at each array length, in millions." << endl;
+    cout << "Returns: nanoseconds per element for each routine, kernel set and length." << endl;
+    return 1;
+  }
+  double total = atof(argv[1]) * 1.0e6;
+  if (total < 1.0) total = 1.0;
+
+  const char * sets[] = { "scalar", "sse2", "avx2", "avx512" };
+  const int lengths[] = { 4, 8, 16, 32, 256, 4096 };
+  const int nmax = 4096;
+
+  Complex * x = new Complex[nmax], * y = new Complex[nmax], * d = new Complex[nmax];
+  for (int i = 0; i < nmax; ++i) {
+    x[i] = Complex(1.0 + 1.0e-3*i, 0.5 - 1.0e-4*i);
+    y[i] = Complex(cos(1.0e-3*i), sin(1.0e-3*i));
+  }
+  // unit magnitudes, so repeated products neither overflow nor underflow
+  const Complex f(0.6, 0.8);
+  volatile double sink = 0.0;
+
+  const char * original = Asimd();
+  printf("%-8s %6s %8s %8s %8s %8s %8s %8s %8s\n",
+	 "kernels", "length", "add", "mul", "div", "scale", "axpy", "dot", "dotu");
+  for (int k = 0; k < 4; ++k) {
+    if ( ! Asimd(sets[k])) continue;
+    for (unsigned l = 0; l < sizeof(lengths)/sizeof(lengths[0]); ++l) {
+      const int n = lengths[l];
+      const int iter = int(total/n) + 1;
+      Acopy(d, x, n);
+      double t_add = timed([&]{ Aadd(d, y, n); }, iter, n);
+      double t_mul = timed([&]{ Amul(d, y, n); }, iter, n);
+      double t_div = timed([&]{ Adiv(d, y, n); }, iter, n);
+      double t_scale = timed([&]{ Ascale(d, f, n); }, iter, n);
+      double t_axpy = timed([&]{ Aaxpy(d, y, f, n); }, iter, n);
+      double t_dot = timed([&]{ sink = sink + Adot(x, y, n).real; }, iter, n);
+      double t_dotu = timed([&]{ sink = sink + Adotu(x, y, n).real; }, iter, n);
+      printf("%-8s %6d %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n", sets[k], n,
+	     t_add, t_mul, t_div, t_scale, t_axpy, t_dot, t_dotu);
+    }
+  }
+  Asimd(original);
+
+  delete [] x; delete [] y; delete [] d;
+  return 0;
+}
@@ -0,0 +1,67 @@
+// test_sis_sums.cc
+// check that the TOEPLITZ, FFT and AUTO methods of sis_basic_device for
+// the small signal and noise sums agree with the DIRECT sums.
+//
+// usage: test_sis_sums <idc_file> <ikk_file>
+
+#include "supermix.h"
+
+// max magnitude of the difference between the elements of two matrices,
+// relative to the largest element of the first
+double diff(const Matrix & A, const Matrix & B)
+{
+  double d = 0.0, m = 0.0;
+  for(int i = A.Lminindex(); i <= A.Lmaxindex(); ++i)
+    for(int j = A.Rminindex(); j <= A.Rmaxindex(); ++j) {
+      if(abs(A.read(i,j) - B.read(i,j)) > d) d = abs(A.read(i,j) - B.read(i,j));
+      if(abs(A.read(i,j)) > m) m = abs(A.read(i,j));
+    }
+  return (m > 0.0) ? d/m : d;
+}
+
+int main(int argc, char ** argv)
+{
+  if(argc < 3) {
+    error::fatal(argv[0],
+		 " : Need to specify the idc and ikk files on command line") ;
+  }
+
+  ivcurve iv(argv[1], argv[2]);
+  device::T = 4*Kelvin;
+  double Vgap = 3.0*mVolt;
+  double Fgap = VoltToFreq*Vgap;
+
+  sis_basic_device sis;
+  sis.set_iv(iv);
+  sis.Vn = Vgap;
+  sis.Rn = 10*Ohm;
+  sis.Cap = 10*fFarad;
+  cout << "default method: " << sis.method() << endl;
+
+  const char * names[] = { "DIRECT", "TOEPLITZ", "FFT", "AUTO" };
+  Vector V(2,Index_C);
+  V[0] = 0.7*Vgap;
+  V[1] = 3.0*Vgap/RmsToPeak;
+
+  int harmonics[] = { 1, 2, 3, 4, 8, 24 };
+  for(int h = 0; h < 6; ++h) {
+    int H = harmonics[h];
+    sis.method(sis_basic_device::DIRECT);
+    sis.large_signal(V, 0.02*Fgap, H);
+
+    double fif[] = { 0.0, 0.003*Fgap };
+    for(int i = 0; i < 2; ++i) {
+      sis.method(sis_basic_device::DIRECT);
+      Matrix Y = sis.small_signal(fif[i], H);
+      Matrix N = sis.noise(fif[i], device::T, H);
+      for(int m = 1; m <= 3; ++m) {
+	sis.method(sis_basic_device::sum_method(m));
+	cout << "H = " << H << ", IF = " << fif[i]/GHz << " GHz, "
+	     << names[sis.method()] << ": small signal < 1e-10: "
+	     << (diff(Y, sis.small_signal(fif[i], H)) < 1e-10)
+	     << ", noise < 1e-10: "
+	     << (diff(N, sis.noise(fif[i], device::T, H)) < 1e-10) << endl;
+      }
+    }
+  }
+}
@@ -0,0 +1,175 @@
+// test_sparse_circuit.cc
+// check that circuit::method(circuit::SPARSE) gives the same results as
+// the default connection tree, for circuits with loops, intra-connections,
+// unconnected (block diagonal) devices, sources, and active noise, and
+// that it falls back on the connection tree when its pivots are unstable.
+
+#include "supermix.h"
+#include <vector>
+
+// the largest difference between the two methods, relative to the
+// largest magnitude of each matrix
+double compare(circuit & c, const std::vector<double> & f)
+{
+  double diff = 0.0;
+  parameter old_f(device::f);
+  for(unsigned long k = 0; k < f.size(); ++k) {
+    device::f = f[k];
+    sdata a = c.method(circuit::CONNECTIONS).get_data();
+    sdata b = c.method(circuit::SPARSE).get_data();
+    double sa = 0.0, ca = 0.0, ba = 1e-300;
+    for(int i = 1; i <= a.size(); ++i) {
+      ba = max(ba, abs(a.B[i]));
+      for(int j = 1; j <= a.size(); ++j) {
+	sa = max(sa, abs(a.S[i][j]));
+	ca = max(ca, abs(a.C[i][j]));
+      }
+    }
+    if(a.size() != b.size() || a.get_znorm() != b.get_znorm()) return 1.0;
+    for(int i = 1; i <= a.size(); ++i) {
+      diff = max(diff, abs(a.B[i] - b.B[i])/ba);
+      for(int j = 1; j <= a.size(); ++j) {
+	diff = max(diff, abs(a.S[i][j] - b.S[i][j])/sa);
+	if(ca > 0.0) diff = max(diff, abs(a.C[i][j] - b.C[i][j])/ca);
+      }
+    }
+  }
+  device::f = old_f;
+  return diff;
+}
+
+void check(circuit & c, const std::vector<double> & f, const char * label)
+{
+  cout << label << ": max difference < 1e-12: " << (compare(c, f) < 1e-12) << endl;
+}
+
+int main()
+{
+  device::T = 4*Kelvin;
+  device::f = 5*GHz;
+
+  std::vector<double> f;
+  for(double x = 1; x <= 12; x += 1.5) f.push_back(x*GHz);
+
+  // a bridged-T network: the loop can't be reduced to a cascade
+  resistor r1; r1.series(); r1.R = 30*Ohm;
+  resistor r2; r2.series(); r2.R = 70*Ohm;
+  capacitor c1; c1.parallel(); c1.C = 0.5*pFarad;
+  inductor l1; l1.series(); l1.L = 2*nHenry;
+  branch b1(3), b2(3);
+  trline t1; t1.set_theta(Pi/3).set_freq(6*GHz).set_zchar(35*Ohm).set_loss(0.05);
+
+  circuit bt;
+  bt.connect(b1, 2, r1, 1);
+  bt.connect(r1, 2, c1, 1);
+  bt.connect(c1, 2, r2, 1);
+  bt.connect(r2, 2, b2, 2);
+  bt.connect(b1, 3, l1, 1);
+  bt.connect(l1, 2, t1, 1);
+  bt.connect(t1, 2, b2, 3);
+  bt.add_port(b1, 1);
+  bt.add_port(b2, 1);
+  check(bt, f, "passive bridged-T");
+
+  bt.Temp = 300*Kelvin;
+  check(bt, f, "bridged-T with Temp != T");
+  bt.Temp = &device::T;
+
+  // an amplifier with feedback, a source at the input and a hot load
+  fhx13x amp;
+  resistor fb; fb.series(); fb.R = 500*Ohm;
+  resistor hot; hot.parallel(); hot.R = 200*Ohm; hot.Temp = 300*Kelvin;
+  branch in(3), out(3);
+  voltage_source v; v.R = 50*Ohm; v.source_f = 5*GHz; v.source_width = 30*GHz;
+  v.source_voltage = 1*mVolt;
+
+  circuit a;
+  a.connect(v, 1, in, 1);
+  a.connect(in, 2, amp, 1);
+  a.connect(amp, 2, out, 1);
+  a.connect(in, 3, fb, 1);
+  a.connect(fb, 2, hot, 1);
+  a.connect(hot, 2, out, 3);
+  a.add_port(out, 2);
+  check(a, f, "amplifier with feedback and source");
+
+  // intra-connections: join two ports of a 5-port subcircuit, which is
+  // itself calculated by either method
+  circuit five;
+  five.connect(b1, 2, r1, 1);
+  five.connect(b1, 3, c1, 1);
+  five.add_port(b1, 1);
+  five.add_port(r1, 2);
+  five.add_port(c1, 2);
+  five.add_port(amp, 1);
+  five.add_port(amp, 2);
+  circuit loop;
+  loop.connect(five, 2, five, 3);
+  loop.connect(five, 1, t1, 1);
+  loop.connect(five, 4, l1, 1);
+  loop.add_port(t1, 2);
+  loop.add_port(l1, 2);
+  loop.add_port(five, 5);
+  check(loop, f, "intra-connections");
+  five.method(circuit::SPARSE);
+  check(loop, f, "intra-connections, sparse subcircuit");
+
+  // an active device with two of its own ports joined: the diagonal
+  // entries 1 - S[2][3] and 1 - S[3][2] of the sparse system are 0, though
+  // it isn't singular, so SPARSE must fall back on CONNECTIONS
+  simple_nport g(4);
+  const double gs[4][4] = { { 0.1, 0.2, 0.3, 0.1 }, { 0.0, 0.5, 1.0, 0.2 },
+			    { 0.0, 1.0, 0.5, 0.1 }, { 0.2, 0.3, 0.4, 0.1 } };
+  for(int i = 1; i <= 4; ++i)
+    for(int j = 1; j <= 4; ++j) g().S[i][j] = gs[i-1][j-1];
+  g().set_znorm(device::Z0);
+  g.set_info().active = true;
+  circuit gain;
+  gain.connect(amp, 2, g, 1);
+  gain.connect(g, 2, g, 3);
+  gain.add_port(amp, 1);
+  gain.add_port(g, 4);
+  check(gain, f, "active device joined to itself");
+
+  // unconnected devices, in a different normalizing impedance
+  parameter old_Z0(device::Z0);
+  device::Z0 = 25*Ohm;
+  circuit blk;
+  blk.add_port(t1, 2);
+  blk.add_port(amp, 2);
+  blk.add_port(t1, 1);
+  blk.add_port(amp, 1);
+  check(blk, f, "block diagonal");
+  device::Z0 = old_Z0;
+
+  // a long ladder of lines and shunt capacitors, whose batch results
+  // must match too
+  const int n = 60;
+  std::vector<trline> lines(n);
+  std::vector<capacitor> caps(n);
+  std::vector<branch> tees(n, branch(3));
+  circuit lad;
+  for(int i = 0; i < n; ++i) {
+    lines[i].set_theta(Pi/8 + i*0.01).set_freq(6*GHz).set_zchar(40*Ohm + i*Ohm).set_loss(0.02);
+    caps[i].C = 0.05*pFarad; caps[i].series();
+    lad.connect(lines[i], 2, tees[i], 1);
+    lad.connect(tees[i], 2, caps[i], 1);
+    if(i > 0) lad.connect(tees[i-1], 3, lines[i], 1);
+  }
+  lad.add_port(lines[0], 1);
+  lad.add_port(tees[n-1], 3);
+  for(int i = 0; i < n; ++i) lad.add_port(caps[i], 2);
+  check(lad, f, "ladder");
+
+  sdata_batch sb, cb;
+  lad.method(circuit::SPARSE).get_batch(&f[0], f.size(), sb);
+  lad.method(circuit::CONNECTIONS).get_batch(&f[0], f.size(), cb);
+  double diff = 0.0;
+  for(unsigned long k = 0; k < f.size(); ++k)
+    for(int i = 1; i <= sb.size(); ++i)
+      for(int j = 1; j <= sb.size(); ++j)
+	diff = max(diff, abs(sb.S(i,j)[k] - cb.S(i,j)[k]) + abs(sb.C(i,j)[k] - cb.C(i,j)[k]));
+  cout << "ladder batch: max difference < 1e-12: " << (diff < 1e-12) << endl;
+
+  return 0;
+}
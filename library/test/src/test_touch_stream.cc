@@ -0,0 +1,91 @@
+// test_touch_stream.cc
+// read Touchstone files with touchstone_stream and check that the data
+// matches that read by touchstone_read.
+
+#include "supermix.h"
+#include <cstdio>
+#include <fstream>
+
+// compare the S matrices and any noise data of a file read both ways
+void compare(const char * name, int ports)
+{
+  touchstone_read r;
+  touchstone_stream t;
+  r.open(name, ports);
+  cout << name << ": read(): " << t.read(name, ports) << endl;
+  cout << "type: " << t.type() << " z: " << t.z()/Ohm
+       << " points: " << t.points() << endl;
+  t.to_S();
+
+  double f, maxdiff = 0.0;
+  Matrix S;
+  unsigned long k = 0, bad = 0;
+  for( ; r.Svalue(f, S); ++k) {
+    if(k >= t.points() || f != t.freq(k)) { ++bad; continue; }
+    Matrix D = S - t.matrix(k);
+    for(int i = 1; i <= ports; ++i)
+      for(int j = 1; j <= ports; ++j)
+	if(abs(D[i][j]) > maxdiff) maxdiff = abs(D[i][j]);
+  }
+  cout << "touchstone_read points: " << k << " mismatched frequencies: " << bad
+       << " max difference < 1e-12: " << (maxdiff < 1e-12) << endl;
+
+  cout << "noise points: " << t.noise_points() << endl;
+  touchstone_read::noise N;
+  maxdiff = 0.0; k = 0; bad = 0;
+  for( ; r.get_noise(f, N); ++k) {
+    if(k >= t.noise_points() || f != t.noise_freq(k)) { ++bad; continue; }
+    const touchstone_read::noise & M = t.noise(k);
+    double d = fabs(N.Fmin - M.Fmin) + abs(N.Gopt - M.Gopt) + fabs(N.Reff - M.Reff);
+    if(d > maxdiff) maxdiff = d;
+  }
+  cout << "touchstone_read noise points: " << k << " mismatched frequencies: " << bad
+       << " max difference < 1e-12: " << (maxdiff < 1e-12) << endl << endl;
+}
+
+int main(int argc, char ** argv)
+{
+  if(argc < 3) {
+    error::fatal(argv[0],
+		 " : Need to specify a 2-port and a 1-port Touchstone file on command line") ;
+  }
+
+  compare(argv[1], 2);
+  compare(argv[2], 1);
+
+  // a 3-port file with values split across lines, requiring renormalization
+  const char * name = "test_touch_stream.tmp";
+  {
+    ofstream out(name);
+    out << "! a 3-port" << endl << "# MHZ S RI R 25" << endl;
+    for(int n = 1; n <= 5; ++n) {
+      out << 100*n;
+      for(int i = 1; i <= 3; ++i) {
+	for(int j = 1; j <= 3; ++j)
+	  out << " " << 0.1*i/n << " " << 0.05*(j-i) << "  ";
+	out << "  ! row " << i << endl;
+      }
+    }
+  }
+  compare(name, 3);
+
+  // reading files in parallel
+  std::vector<std::string> names(4, argv[1]);
+  std::vector<touchstone_stream> files;
+  cout << "read_all(): " << touchstone_stream::read_all(files, names, 2, GHz, 2) << endl;
+  touchstone_stream t;
+  t.read(argv[1]);
+  int same = 0;
+  for(unsigned i = 0; i < files.size(); ++i) {
+    bool ok = files[i].points() == t.points() && files[i].noise_points() == t.noise_points();
+    for(unsigned long k = 0; ok && k < 4*t.points(); ++k)
+      ok = files[i].data()[k] == t.data()[k];
+    same += ok;
+  }
+  cout << "identical files: " << same << endl;
+
+  complex::out_degree(); complex::out_delimited();
+  cout << "S at " << t.freq(3)/GHz << " GHz:"; t.matrix(3).show();
+
+  remove(name);
+}